@@ -0,0 +1,100 @@
+# Copyright 2019 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+include(CMakeParseArguments)
+
+# iree_cc_benchmark()
+#
+# CMake function to create a Google Benchmark binary.
+#
+# Parameters:
+# NAME: name of target (see Usage below)
+# SRCS: List of source files for the binary
+# DEPS: List of other libraries to be linked in to the binary targets
+# COPTS: List of private compile options
+# DEFINES: List of public defines
+# LINKOPTS: List of link options
+#
+# Note:
+# By default, iree_cc_benchmark will always create a binary named
+# iree_${NAME}. Benchmarks are not added to the ctest list as they are
+# expected to be run manually (or by a harness collecting their
+# --benchmark_format=json output).
+#
+# Usage:
+# iree_cc_library(
+#   NAME
+#     awesome
+#   HDRS
+#     "a.h"
+#   SRCS
+#     "a.cc"
+#   PUBLIC
+# )
+#
+# iree_cc_benchmark(
+#   NAME
+#     awesome_benchmark
+#   SRCS
+#     "awesome_benchmark.cc"
+#   DEPS
+#     benchmark_main
+#     iree::awesome
+# )
+function(iree_cc_benchmark)
+  if(NOT IREE_BUILD_BENCHMARKS)
+    return()
+  endif()
+
+  cmake_parse_arguments(IREE_CC_BENCHMARK
+    ""
+    "NAME"
+    "SRCS;COPTS;DEFINES;LINKOPTS;DEPS"
+    ${ARGN}
+  )
+
+  # Prefix the library with the package name, so we get: iree_package_name
+  iree_package_name(_PACKAGE_NAME)
+  set(_NAME "${_PACKAGE_NAME}_${IREE_CC_BENCHMARK_NAME}")
+
+  add_executable(${_NAME} "")
+  target_sources(${_NAME}
+    PRIVATE
+      ${IREE_CC_BENCHMARK_SRCS}
+  )
+  target_include_directories(${_NAME}
+    PUBLIC
+      ${IREE_COMMON_INCLUDE_DIRS}
+  )
+  target_compile_definitions(${_NAME}
+    PUBLIC
+      ${IREE_CC_BENCHMARK_DEFINES}
+  )
+  target_compile_options(${_NAME}
+    PRIVATE
+      ${IREE_CC_BENCHMARK_COPTS}
+  )
+  target_link_libraries(${_NAME}
+    PUBLIC
+      ${IREE_CC_BENCHMARK_DEPS}
+      benchmark
+    PRIVATE
+      ${IREE_CC_BENCHMARK_LINKOPTS}
+  )
+  # Add all IREE targets to a a folder in the IDE for organization.
+  set_property(TARGET ${_NAME} PROPERTY FOLDER ${IREE_IDE_FOLDER}/benchmark)
+
+  set_property(TARGET ${_NAME} PROPERTY CXX_STANDARD ${IREE_CXX_STANDARD})
+  set_property(TARGET ${_NAME} PROPERTY CXX_STANDARD_REQUIRED ON)
+endfunction()
@@ -187,6 +187,41 @@ LogicalResult writeOp(IREEInterp::LL::StaticCopyOp op, BytecodeWriter *writer) {
   return success();
 }
 
+LogicalResult writeOp(IREEInterp::LL::ElementwiseFOp op,
+                      BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(
+      writer->WriteOpcode(iree::InterpreterOpcode::kElementwiseF));
+  RETURN_IF_FAILURE(writer->WriteLocals(op.srcs()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(op.program()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::MatMulBiasFOp op,
+                      BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(
+      writer->WriteOpcode(iree::InterpreterOpcode::kMatMulBiasF));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.lhs()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.rhs()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.bias()));
+  RETURN_IF_FAILURE(writer->WriteLocals(op.clamp_bounds()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::ConvFOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConvF));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.input()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.filter()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(op.window_strides()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(op.padding()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(op.dilation()));
+  RETURN_IF_FAILURE(
+      writer->WriteInt32(op.feature_group_count().getZExtValue()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
 LogicalResult writeReduceOperands(Operation *op, BytecodeWriter *writer,
                                   APInt dimension) {
   RETURN_IF_FAILURE(writer->WriteLocal(op->getOperand(0)));
@@ -226,6 +261,33 @@ LogicalResult writeOp(IREEInterp::LL::ReduceMaxFOp op, BytecodeWriter *writer) {
   return writeReduceOperands(op, writer, op.dimension());
 }
 
+// Quantized ops take their rounding mode between the zero points and dst.
+LogicalResult writeQuantizedOperands(Operation *op, BytecodeWriter *writer,
+                                     APInt roundingMode) {
+  for (int i = 0, e = op->getNumOperands() - 1; i < e; ++i) {
+    RETURN_IF_FAILURE(writer->WriteLocal(op->getOperand(i)));
+  }
+  RETURN_IF_FAILURE(writer->WriteInt32(roundingMode.getZExtValue()));
+  RETURN_IF_FAILURE(
+      writer->WriteLocal(op->getOperand(op->getNumOperands() - 1)));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::RequantizeOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kRequantize));
+  return writeQuantizedOperands(op, writer, op.rounding_mode());
+}
+
+LogicalResult writeOp(IREEInterp::LL::AddQOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kAddQ));
+  return writeQuantizedOperands(op, writer, op.rounding_mode());
+}
+
+LogicalResult writeOp(IREEInterp::LL::MulQOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kMulQ));
+  return writeQuantizedOperands(op, writer, op.rounding_mode());
+}
+
 }  // namespace
 
 void registerInterpreterCustomWriters(VMFunctionBuilder *builder) {
@@ -249,12 +311,18 @@ void registerInterpreterCustomWriters(VMFunctionBuilder *builder) {
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::CmpFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::AllocHeapOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::StaticCopyOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ElementwiseFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::MatMulBiasFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceSumIOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceSumFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceMinIOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceMinFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceMaxIOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceMaxFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::RequantizeOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::AddQOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::MulQOp);
 }
 
 }  // namespace iree_compiler
@@ -53,3 +53,19 @@ func @not_scalar_bool(%cond : memref<i32>, %a : memref<1xf32>) {
   "iree_hl_interp.cond_assign"(%cond, %a, %a) : (memref<i32>, memref<1xf32>, memref<1xf32>) -> memref<1xf32>
   return
 }
+
+// -----
+
+func @float_add_q(%a : memref<4xf32>, %m : memref<2xi32>, %z : memref<3xi32>) {
+  // expected-error@+1 {{must be memref of integer values}}
+  "iree_hl_interp.add_q"(%a, %a, %m, %m, %z) {rounding_mode = 0 : i32} : (memref<4xf32>, memref<4xf32>, memref<2xi32>, memref<2xi32>, memref<3xi32>) -> memref<4xf32>
+  return
+}
+
+// -----
+
+func @widened_mul_q(%a : memref<4xi8>, %m : memref<1xi32>, %z : memref<3xi32>) {
+  // expected-error@+1 {{have same element type}}
+  "iree_hl_interp.mul_q"(%a, %a, %m, %m, %z) {rounding_mode = 0 : i32} : (memref<4xi8>, memref<4xi8>, memref<1xi32>, memref<1xi32>, memref<3xi32>) -> memref<4xi32>
+  return
+}
@@ -185,6 +185,17 @@ LogicalResult writeOp(IREESeq::LL::StaticDispatchOp op,
   return success();
 }
 
+LogicalResult writeOp(IREESeq::LL::AllocStaticOp op, BytecodeWriter *writer) {
+  auto memRefType = op.getType().cast<MemRefType>();
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::SequencerOpcode::kAllocStatic));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.arena()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.offset().getZExtValue()));
+  RETURN_IF_FAILURE(writer->WriteTypeIndex(memRefType.getElementType()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(memRefType));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.getResult()));
+  return success();
+}
+
 LogicalResult writeOp(IREESeq::LL::AllocHeapOp op, BytecodeWriter *writer) {
   auto memRefType = op.getType().cast<MemRefType>();
   RETURN_IF_FAILURE(writer->WriteOpcode(iree::SequencerOpcode::kAllocHeap));
@@ -255,6 +266,7 @@ void registerSequencerCustomWriters(VMFunctionBuilder *builder) {
   REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::CondBranchOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::DynamicDispatchOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::StaticDispatchOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::AllocStaticOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::AllocHeapOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::ComputeRangeOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREESeq::LL::StaticSliceOp);
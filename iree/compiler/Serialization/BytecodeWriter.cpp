@@ -85,6 +85,24 @@ LogicalResult BytecodeWriter::WriteConstant(MemRefType memRefType,
     RETURN_IF_FAILURE(WriteInt32(memRefType.getDimSize(i)));
   }
 
+  if (constantPool_) {
+    // Write the contents to the end of the bytecode so that we can reuse the
+    // attribute encoding and then move them into the pool.
+    auto splatAttr = baseAttr.dyn_cast<SplatElementsAttr>();
+    size_t dataOffset = bytecode_.size();
+    RETURN_IF_FAILURE(
+        WriteAttributeData(splatAttr ? splatAttr.getSplatValue() : baseAttr));
+    std::vector<uint8_t> data(bytecode_.begin() + dataOffset, bytecode_.end());
+    bytecode_.resize(dataOffset);
+    uint64_t length =
+        splatAttr ? data.size() * memRefType.getNumElements() : data.size();
+    int constantOrdinal = constantPool_->AddConstant(
+        data, length, splatAttr ? static_cast<int>(data.size()) : 0);
+    RETURN_IF_FAILURE(
+        WriteUint8(static_cast<uint8_t>(iree::ConstantEncoding::kPooled)));
+    return WriteUint32(constantOrdinal);
+  }
+
   if (auto attr = baseAttr.dyn_cast<SplatElementsAttr>()) {
     RETURN_IF_FAILURE(
         WriteUint8(static_cast<uint8_t>(iree::ConstantEncoding::kSplat)));
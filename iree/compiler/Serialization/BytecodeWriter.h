@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "iree/compiler/IR/StructureOps.h"
+#include "iree/compiler/Serialization/VMConstantPoolBuilder.h"
 #include "iree/schemas/bytecode/bytecode_v0.h"
 #include "llvm/ADT/Optional.h"
 #include "mlir/IR/Attributes.h"
@@ -35,6 +36,11 @@ namespace iree_compiler {
 
 class BytecodeWriter {
  public:
+  // If |constantPool| is provided dense and splat constant contents are stored
+  // in the pool and referenced by ordinal instead of being written inline.
+  explicit BytecodeWriter(VMConstantPoolBuilder *constantPool = nullptr)
+      : constantPool_(constantPool) {}
+
   int offset() const { return bytecode_.size(); }
 
   int local_count() const { return localMap_.size(); }
@@ -82,6 +88,8 @@ class BytecodeWriter {
   std::vector<uint8_t> Finish();
 
  private:
+  VMConstantPoolBuilder *constantPool_ = nullptr;
+
   std::vector<uint8_t> bytecode_;
 
   llvm::DenseMap<Value *, int> localMap_;
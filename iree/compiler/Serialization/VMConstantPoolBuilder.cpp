@@ -0,0 +1,85 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/compiler/Serialization/VMConstantPoolBuilder.h"
+
+#include <cstring>
+
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/MathExtras.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+constexpr size_t VMConstantPoolBuilder::kAlignment;
+
+VMConstantPoolBuilder::VMConstantPoolBuilder(
+    ::flatbuffers::FlatBufferBuilder *fbb)
+    : fbb_(fbb) {}
+
+int VMConstantPoolBuilder::AddConstant(ArrayRef<uint8_t> data, uint64_t length,
+                                       int splatSize) {
+  // Key on the stored bytes along with how they are expanded.
+  size_t hash = llvm::hash_combine(
+      length, splatSize, llvm::hash_combine_range(data.begin(), data.end()));
+  auto &candidateOrdinals = constantOrdinalsByHash_[hash];
+  for (int candidateOrdinal : candidateOrdinals) {
+    const auto &candidate = constants_[candidateOrdinal];
+    if (candidate.length == length && candidate.splatSize == splatSize &&
+        candidate.storedLength == data.size() &&
+        (data.empty() || std::memcmp(data_.data() + candidate.offset,
+                                     data.data(), data.size()) == 0)) {
+      return candidateOrdinal;
+    }
+  }
+
+  Constant constant;
+  constant.offset = llvm::alignTo(data_.size(), kAlignment);
+  constant.length = length;
+  constant.splatSize = splatSize;
+  constant.storedLength = data.size();
+  data_.resize(constant.offset);
+  data_.insert(data_.end(), data.begin(), data.end());
+
+  int constantOrdinal = constants_.size();
+  constants_.push_back(constant);
+  candidateOrdinals.push_back(constantOrdinal);
+  return constantOrdinal;
+}
+
+::flatbuffers::Offset<iree::ConstantPoolDef> VMConstantPoolBuilder::Finish() {
+  if (constants_.empty()) return {};
+
+  std::vector<::flatbuffers::Offset<iree::ConstantDef>> constantDefs;
+  constantDefs.reserve(constants_.size());
+  for (const auto &constant : constants_) {
+    constantDefs.push_back(iree::CreateConstantDef(
+        *fbb_, constant.offset, constant.length, constant.splatSize));
+  }
+  auto constantsOffset = fbb_->CreateVector(constantDefs);
+
+  // Align the start of the data such that offsets within it retain their
+  // alignment in the final buffer.
+  fbb_->ForceVectorAlignment(data_.size(), sizeof(uint8_t), kAlignment);
+  auto dataOffset = fbb_->CreateVector(data_);
+
+  iree::ConstantPoolDefBuilder cpdb(*fbb_);
+  cpdb.add_alignment(kAlignment);
+  cpdb.add_constants(constantsOffset);
+  cpdb.add_data(dataOffset);
+  return cpdb.Finish();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
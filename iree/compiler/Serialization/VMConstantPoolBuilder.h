@@ -0,0 +1,69 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_COMPILER_SERIALIZATION_VM_CONSTANT_POOL_BUILDER_H_
+#define IREE_COMPILER_SERIALIZATION_VM_CONSTANT_POOL_BUILDER_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/flatbuffers/include/flatbuffers/flatbuffers.h"
+#include "iree/schemas/constant_pool_def_generated.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Accumulates constant data referenced by bytecode into a single pool stored
+// alongside the module. Constant contents are aligned such that the runtime
+// can reference them in-place when the module is loaded at an aligned address.
+class VMConstantPoolBuilder {
+ public:
+  // Alignment in bytes of the pool data and each constant within it.
+  static constexpr size_t kAlignment = 64;
+
+  explicit VMConstantPoolBuilder(::flatbuffers::FlatBufferBuilder *fbb);
+
+  // Adds a constant with the given contents and returns its ordinal.
+  // If |splatSize| is non-zero |data| contains a single element that is
+  // repeated to fill |length| bytes; otherwise |data| has |length| bytes.
+  // Identical constants are only stored once.
+  int AddConstant(ArrayRef<uint8_t> data, uint64_t length, int splatSize);
+
+  ::flatbuffers::Offset<iree::ConstantPoolDef> Finish();
+
+ private:
+  struct Constant {
+    uint64_t offset;
+    uint64_t length;
+    int splatSize;
+    // Number of bytes stored in |data_| at |offset|.
+    uint64_t storedLength;
+  };
+
+  ::flatbuffers::FlatBufferBuilder *fbb_;
+  std::vector<uint8_t> data_;
+  std::vector<Constant> constants_;
+  // Ordinals of the constants with a given content hash. Candidates are
+  // compared against |data_| to resolve collisions.
+  std::unordered_map<size_t, llvm::SmallVector<int, 1>>
+      constantOrdinalsByHash_;
+};
+
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_SERIALIZATION_VM_CONSTANT_POOL_BUILDER_H_
@@ -136,11 +136,13 @@ LogicalResult WriteGenericIreeOp(Block *block, Operation *op,
 
 VMFunctionBuilder::VMFunctionBuilder(FuncOp function,
                                      VMFunctionTableBuilder *functionTable,
-                                     ::flatbuffers::FlatBufferBuilder *fbb)
+                                     ::flatbuffers::FlatBufferBuilder *fbb,
+                                     VMConstantPoolBuilder *constantPool)
     : context_(function.getContext()),
       function_(function),
       functionTable_(functionTable),
-      fbb_(fbb) {}
+      fbb_(fbb),
+      constantPool_(constantPool) {}
 
 void VMFunctionBuilder::RegisterCustomWriter(StringRef operationName,
                                              CustomWriterFn writerFn) {
@@ -148,7 +150,7 @@ void VMFunctionBuilder::RegisterCustomWriter(StringRef operationName,
 }
 
 LogicalResult VMFunctionBuilder::ConvertBytecode() {
-  BytecodeWriter writer;
+  BytecodeWriter writer(constantPool_);
   sourceMap_ = {};
 
   RETURN_IF_FAILURE(BeginFunction(function_, &writer));
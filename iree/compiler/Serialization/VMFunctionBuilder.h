@@ -16,6 +16,7 @@
 #define IREE_COMPILER_SERIALIZATION_VM_FUNCTION_BUILDER_H_
 
 #include "iree/compiler/Serialization/BytecodeWriter.h"
+#include "iree/compiler/Serialization/VMConstantPoolBuilder.h"
 #include "iree/compiler/Serialization/VMFunctionTableBuilder.h"
 #include "iree/compiler/Serialization/VMSourceMapBuilder.h"
 #include "iree/schemas/bytecode_def_generated.h"
@@ -33,8 +34,11 @@ class VMFunctionBuilder {
   using CustomWriterFn =
       std::function<LogicalResult(Operation *, BytecodeWriter *writer)>;
 
+  // Constants are written inline in the bytecode unless |constantPool| is
+  // provided.
   VMFunctionBuilder(FuncOp function, VMFunctionTableBuilder *functionTable,
-                    ::flatbuffers::FlatBufferBuilder *fbb);
+                    ::flatbuffers::FlatBufferBuilder *fbb,
+                    VMConstantPoolBuilder *constantPool = nullptr);
   ~VMFunctionBuilder() = default;
 
   void RegisterCustomWriter(StringRef operationName, CustomWriterFn writerFn);
@@ -67,6 +71,7 @@ class VMFunctionBuilder {
   FuncOp function_;
   VMFunctionTableBuilder *functionTable_;
   ::flatbuffers::FlatBufferBuilder *fbb_;
+  VMConstantPoolBuilder *constantPool_;
   ::flatbuffers::Offset<iree::BytecodeDef> bytecodeDef_;
   VMFunctionSourceMap sourceMap_;
 };
@@ -24,7 +24,8 @@ VMModuleBuilder::VMModuleBuilder(::flatbuffers::FlatBufferBuilder *fbb)
       deviceTable_(fbb),
       functionTable_(fbb),
       executableTable_(fbb),
-      sourceMap_(fbb) {}
+      sourceMap_(fbb),
+      constantPool_(fbb) {}
 
 ::flatbuffers::Offset<iree::ModuleDef> VMModuleBuilder::Finish() {
   auto nameOffset = fbb_->CreateString("module");
@@ -47,6 +48,8 @@ VMModuleBuilder::VMModuleBuilder(::flatbuffers::FlatBufferBuilder *fbb)
   auto sourceMapOffset =
       sourceMap_.Finish(functionTable_.max_function_ordinal());
   if (sourceMapOffset.IsNull()) return {};
+  // The pool is omitted entirely when no constants were added.
+  auto constantPoolOffset = constantPool_.Finish();
 
   iree::ModuleDefBuilder mdb(*fbb_);
   mdb.add_name(nameOffset);
@@ -54,6 +57,9 @@ VMModuleBuilder::VMModuleBuilder(::flatbuffers::FlatBufferBuilder *fbb)
   mdb.add_function_table(functionTableOffset);
   mdb.add_executable_table(executableTableOffset);
   mdb.add_source_map(sourceMapOffset);
+  if (!constantPoolOffset.IsNull()) {
+    mdb.add_constant_pool(constantPoolOffset);
+  }
   return mdb.Finish();
 }
 
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "third_party/flatbuffers/include/flatbuffers/flatbuffers.h"
+#include "iree/compiler/Serialization/VMConstantPoolBuilder.h"
 #include "iree/compiler/Serialization/VMDeviceTableBuilder.h"
 #include "iree/compiler/Serialization/VMExecutableTableBuilder.h"
 #include "iree/compiler/Serialization/VMFunctionTableBuilder.h"
@@ -36,6 +37,7 @@ class VMModuleBuilder {
   VMFunctionTableBuilder *function_table() { return &functionTable_; }
   VMExecutableTableBuilder *executable_table() { return &executableTable_; }
   VMSourceMapBuilder *source_map() { return &sourceMap_; }
+  VMConstantPoolBuilder *constant_pool() { return &constantPool_; }
 
   ::flatbuffers::Offset<iree::ModuleDef> Finish();
 
@@ -49,6 +51,7 @@ class VMModuleBuilder {
   VMFunctionTableBuilder functionTable_;
   VMExecutableTableBuilder executableTable_;
   VMSourceMapBuilder sourceMap_;
+  VMConstantPoolBuilder constantPool_;
 };
 
 }  // namespace iree_compiler
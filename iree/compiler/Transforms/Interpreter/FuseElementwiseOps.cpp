@@ -0,0 +1,222 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+
+#include "iree/compiler/IR/Interpreter/HLOps.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Registers are addressed with 8 bits in the program encoding.
+constexpr int kMaxRegisterCount = 256;
+
+// Returns the program op that |op| maps to, if it can be fused.
+llvm::Optional<iree::ElementwiseOp> getElementwiseOp(Operation *op) {
+  using iree::ElementwiseOp;
+  if (isa<IREEInterp::HL::AbsFOp>(op)) return ElementwiseOp::kAbs;
+  if (isa<IREEInterp::HL::ExpFOp>(op)) return ElementwiseOp::kExp;
+  if (isa<IREEInterp::HL::LogFOp>(op)) return ElementwiseOp::kLog;
+  if (isa<IREEInterp::HL::RsqrtFOp>(op)) return ElementwiseOp::kRsqrt;
+  if (isa<IREEInterp::HL::CosFOp>(op)) return ElementwiseOp::kCos;
+  if (isa<IREEInterp::HL::SinFOp>(op)) return ElementwiseOp::kSin;
+  if (isa<IREEInterp::HL::TanhFOp>(op)) return ElementwiseOp::kTanh;
+  if (isa<IREEInterp::HL::FloorFOp>(op)) return ElementwiseOp::kFloor;
+  if (isa<IREEInterp::HL::CeilFOp>(op)) return ElementwiseOp::kCeil;
+  if (isa<IREEInterp::HL::AddFOp>(op)) return ElementwiseOp::kAdd;
+  if (isa<IREEInterp::HL::SubFOp>(op)) return ElementwiseOp::kSub;
+  if (isa<IREEInterp::HL::MulFOp>(op)) return ElementwiseOp::kMul;
+  if (isa<IREEInterp::HL::DivFOp>(op)) return ElementwiseOp::kDiv;
+  if (isa<IREEInterp::HL::MinFOp>(op)) return ElementwiseOp::kMin;
+  if (isa<IREEInterp::HL::MaxFOp>(op)) return ElementwiseOp::kMax;
+  if (isa<IREEInterp::HL::Atan2FOp>(op)) return ElementwiseOp::kAtan2;
+  if (isa<IREEInterp::HL::MulAddFOp>(op)) return ElementwiseOp::kMulAdd;
+  if (isa<IREEInterp::HL::ClampFOp>(op)) return ElementwiseOp::kClamp;
+  return llvm::None;
+}
+
+// Returns true if |op| is an elementwise op that can be fused into a program
+// operating on buffers of |type|. As the program kernels do not broadcast all
+// operands must match the result type exactly.
+bool isFusableOp(Operation *op, Type type) {
+  if (!getElementwiseOp(op).hasValue()) return false;
+  if (op->getNumResults() != 1 || op->getResult(0)->getType() != type) {
+    return false;
+  }
+  for (auto *operand : op->getOperands()) {
+    if (operand->getType() != type) return false;
+  }
+  return true;
+}
+
+// Returns true if any op between |producerOp| and |rootOp| may write memory.
+// Fused producers are evaluated at the position of |rootOp| and would observe
+// such writes (such as a copy into one of their operands).
+bool mayWriteMemoryBetween(Operation *producerOp, Operation *rootOp) {
+  for (auto *op = producerOp->getNextNode(); op && op != rootOp;
+       op = op->getNextNode()) {
+    if (!op->hasNoSideEffect()) return true;
+  }
+  return false;
+}
+
+// Returns true if |value| can be computed within the program rooted at
+// |rootOp| instead of being materialized into its own buffer.
+bool canFuseProducer(Value *value, Operation *rootOp) {
+  auto *defOp = value->getDefiningOp();
+  return defOp && defOp->getBlock() == rootOp->getBlock() &&
+         value->hasOneUse() &&
+         isFusableOp(defOp, rootOp->getResult(0)->getType()) &&
+         !mayWriteMemoryBetween(defOp, rootOp);
+}
+
+// Gathers the ops that can be fused into a program computing the result of
+// |rootOp| in block order. Producers are only fused when the root chain is
+// their sole user such that they can be erased after fusion.
+SmallVector<Operation *, 8> gatherFusedOps(Operation *rootOp) {
+  llvm::SetVector<Operation *> fusedOps;
+  fusedOps.insert(rootOp);
+  for (unsigned i = 0; i < fusedOps.size(); ++i) {
+    for (auto *operand : fusedOps[i]->getOperands()) {
+      if (fusedOps.size() + fusedOps[i]->getNumOperands() >=
+          kMaxRegisterCount) {
+        break;
+      }
+      if (canFuseProducer(operand, rootOp)) {
+        fusedOps.insert(operand->getDefiningOp());
+      }
+    }
+  }
+  SmallVector<Operation *, 8> orderedOps(fusedOps.begin(), fusedOps.end());
+  std::sort(orderedOps.begin(), orderedOps.end(),
+            [](Operation *lhs, Operation *rhs) {
+              return lhs->isBeforeInBlock(rhs);
+            });
+  return orderedOps;
+}
+
+// Replaces |fusedOps| (ending with the root op) with a single elementwise_f op.
+// Returns false if the program would exceed the register limit.
+bool fuseOps(ArrayRef<Operation *> fusedOps) {
+  auto *rootOp = fusedOps.back();
+  llvm::SmallPtrSet<Operation *, 8> fusedOpSet(fusedOps.begin(),
+                                              fusedOps.end());
+
+  // Inputs are all operands not produced within the program.
+  llvm::SetVector<Value *> inputs;
+  for (auto *op : fusedOps) {
+    for (auto *operand : op->getOperands()) {
+      auto *defOp = operand->getDefiningOp();
+      if (!defOp || !fusedOpSet.count(defOp)) inputs.insert(operand);
+    }
+  }
+  if (inputs.size() + fusedOps.size() > kMaxRegisterCount) return false;
+
+  llvm::DenseMap<Value *, int> registers;
+  int nextRegister = 0;
+  for (auto *input : inputs) {
+    registers[input] = nextRegister++;
+  }
+  SmallVector<int64_t, 8> program;
+  for (auto *op : fusedOps) {
+    uint32_t instruction =
+        static_cast<uint32_t>(getElementwiseOp(op).getValue()) << 24;
+    for (unsigned i = 0; i < op->getNumOperands(); ++i) {
+      instruction |= static_cast<uint32_t>(registers[op->getOperand(i)])
+                     << (16 - i * 8);
+    }
+    program.push_back(static_cast<int32_t>(instruction));
+    registers[op->getResult(0)] = nextRegister++;
+  }
+
+  OpBuilder builder(rootOp);
+  auto programAttr = builder.getDenseIntElementsAttr(
+      builder.getTensorType({static_cast<int64_t>(program.size())},
+                            builder.getIntegerType(32)),
+      program);
+  auto fusedOp = builder.create<IREEInterp::HL::ElementwiseFOp>(
+      rootOp->getLoc(), rootOp->getResult(0)->getType(), inputs.getArrayRef(),
+      programAttr);
+  rootOp->getResult(0)->replaceAllUsesWith(fusedOp.getResult());
+  for (auto *op : llvm::reverse(fusedOps)) {
+    op->erase();
+  }
+  return true;
+}
+
+}  // namespace
+
+// Fuses chains of float elementwise ops into iree_hl_interp.elementwise_f ops
+// that evaluate the whole chain per tile, avoiding the materialization of the
+// intermediate buffers and the dispatch of each op individually.
+//
+// Example:
+//   %0 = iree_hl_interp.mul_f %a, %b : memref<4xf32>
+//   %1 = iree_hl_interp.add_f %0, %c : memref<4xf32>
+//   %2 = iree_hl_interp.tanh_f %1 : memref<4xf32>
+//  ->
+//   %2 = iree_hl_interp.elementwise_f(%a, %b, %c) {program = [mul(0, 1),
+//            add(3, 2), tanh(4)]} : memref<4xf32>
+class FuseElementwiseOpsPass : public FunctionPass<FuseElementwiseOpsPass> {
+ public:
+  void runOnFunction() override {
+    for (auto &block : getFunction().getBlocks()) {
+      // Walk backwards such that the longest chains are formed from their
+      // final op. Roots are gathered first as fusion erases ops in the block.
+      SmallVector<Operation *, 16> rootOps;
+      for (auto &op : llvm::reverse(block)) {
+        if (op.getNumResults() == 1 &&
+            isFusableOp(&op, op.getResult(0)->getType())) {
+          rootOps.push_back(&op);
+        }
+      }
+      llvm::SmallPtrSet<Operation *, 16> erasedOps;
+      for (auto *rootOp : rootOps) {
+        if (erasedOps.count(rootOp)) continue;
+        auto fusedOps = gatherFusedOps(rootOp);
+        if (fusedOps.size() < 2) continue;
+        if (fuseOps(fusedOps)) {
+          erasedOps.insert(fusedOps.begin(), fusedOps.end());
+        }
+      }
+    }
+  }
+};
+
+std::unique_ptr<OpPassBase<FuncOp>> createFuseElementwiseOpsPass() {
+  return std::make_unique<FuseElementwiseOpsPass>();
+}
+
+static PassRegistration<FuseElementwiseOpsPass> pass(
+    "iree-interpreter-fuse-elementwise",
+    "Fuses chains of elementwise ops into elementwise programs");
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,188 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/compiler/IR/Interpreter/HLOps.h"
+#include "iree/compiler/IR/Ops.h"
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Returns the sole user of |value| if it is in |block|.
+Operation *getSoleUserInBlock(Value *value, Block *block) {
+  if (!value->hasOneUse()) return nullptr;
+  auto *user = value->use_begin()->getOwner();
+  return user->getBlock() == block ? user : nullptr;
+}
+
+// Returns the operand of |op| that is not |value|, or nullptr if both are.
+Value *getOtherOperand(Operation *op, Value *value) {
+  if (op->getOperand(0) == value) {
+    return op->getOperand(1) == value ? nullptr : op->getOperand(1);
+  }
+  return op->getOperand(0);
+}
+
+// Returns a buffer containing one bias element per column of |resultType| if
+// |value| is a row vector tiled to |resultType|, as produced by lowering a
+// broadcast_in_dim along dimension 1.
+Value *matchBias(Value *value, MemRefType resultType) {
+  auto tileOp =
+      dyn_cast_or_null<IREEInterp::HL::TileOp>(value->getDefiningOp());
+  if (!tileOp) return nullptr;
+  auto *bias = tileOp.operand();
+  auto biasType = bias->getType().cast<MemRefType>();
+  if (!biasType.hasStaticShape() || biasType.getRank() == 0 ||
+      biasType.getNumElements() != resultType.getDimSize(1) ||
+      biasType.getShape().back() != resultType.getDimSize(1)) {
+    return nullptr;
+  }
+  return bias;
+}
+
+// Returns the scalar broadcast by |value|, if any.
+Value *matchScalarBroadcast(Value *value) {
+  auto broadcastOp =
+      dyn_cast_or_null<IREEInterp::HL::BroadcastOp>(value->getDefiningOp());
+  if (!broadcastOp) return nullptr;
+  return broadcastOp.operand();
+}
+
+// Returns a scalar constant holding positive or negative infinity.
+Value *createInfinityConstant(OpBuilder &builder, Location loc,
+                              FloatType elementType, bool negative) {
+  auto value = builder.getFloatAttr(
+      elementType,
+      APFloat::getInf(elementType.getFloatSemantics(), negative));
+  return builder.create<IREE::ConstantOp>(
+      loc, builder.getMemRefType({}, elementType),
+      DenseElementsAttr::get(builder.getTensorType({}, elementType), value));
+}
+
+// Fuses |matMulOp| with the following bias add and activation, if any.
+// Returns true if the ops were replaced.
+bool fuseMatMul(IREEInterp::HL::MatMulFOp matMulOp) {
+  auto *block = matMulOp.getOperation()->getBlock();
+  auto resultType = matMulOp.getResult()->getType().cast<MemRefType>();
+  if (!resultType.hasStaticShape() || resultType.getRank() != 2) return false;
+
+  auto addOp = dyn_cast_or_null<IREEInterp::HL::AddFOp>(
+      getSoleUserInBlock(matMulOp.getResult(), block));
+  if (!addOp || addOp.getResult()->getType() != resultType) return false;
+  auto *addend = getOtherOperand(addOp, matMulOp.getResult());
+  auto *bias = addend ? matchBias(addend, resultType) : nullptr;
+  if (!bias) return false;
+
+  // Fold up to one max_f (clamp min) and one min_f (clamp max) against
+  // broadcast scalars, such as relu (max(x, 0)) or relu6 (min(max(x, 0), 6)).
+  SmallVector<Operation *, 4> fusedOps{matMulOp, addOp};
+  // The tiled bias and broadcast bounds are dropped if only used here.
+  SmallVector<Operation *, 4> broadcastOps{addend->getDefiningOp()};
+  Value *clampMin = nullptr;
+  Value *clampMax = nullptr;
+  while (fusedOps.size() < 4) {
+    auto *result = fusedOps.back()->getResult(0);
+    auto *user = getSoleUserInBlock(result, block);
+    if (!user || user->getNumResults() != 1 ||
+        user->getResult(0)->getType() != resultType) {
+      break;
+    }
+    bool isMax = isa<IREEInterp::HL::MaxFOp>(user);
+    bool isMin = isa<IREEInterp::HL::MinFOp>(user);
+    if ((!isMax || clampMin) && (!isMin || clampMax)) break;
+    auto *other = getOtherOperand(user, result);
+    auto *scalar = other ? matchScalarBroadcast(other) : nullptr;
+    if (!scalar) break;
+    (isMax ? clampMin : clampMax) = scalar;
+    fusedOps.push_back(user);
+    broadcastOps.push_back(other->getDefiningOp());
+  }
+
+  auto *rootOp = fusedOps.back();
+  OpBuilder builder(rootOp);
+  SmallVector<Value *, 2> clampBounds;
+  if (clampMin || clampMax) {
+    auto elementType = resultType.getElementType().cast<FloatType>();
+    if (!clampMin) {
+      clampMin = createInfinityConstant(builder, rootOp->getLoc(), elementType,
+                                        /*negative=*/true);
+    }
+    if (!clampMax) {
+      clampMax = createInfinityConstant(builder, rootOp->getLoc(), elementType,
+                                        /*negative=*/false);
+    }
+    clampBounds = {clampMin, clampMax};
+  }
+  auto fusedOp = builder.create<IREEInterp::HL::MatMulBiasFOp>(
+      rootOp->getLoc(), resultType, matMulOp.lhs(), matMulOp.rhs(), bias,
+      clampBounds);
+  rootOp->getResult(0)->replaceAllUsesWith(fusedOp.getResult());
+  for (auto *op : llvm::reverse(fusedOps)) {
+    op->erase();
+  }
+  for (auto *op : broadcastOps) {
+    if (op->use_empty()) op->erase();
+  }
+  return true;
+}
+
+}  // namespace
+
+// Fuses matmul_f ops followed by a bias add and an optional relu-like
+// activation into iree_hl_interp.matmul_bias_f ops. These execute as a single
+// matmul that applies the bias and clamp while storing the result instead of
+// making two additional passes over it.
+//
+// Example:
+//   %0 = iree_hl_interp.matmul_f %a, %b : memref<4x8xf32>
+//   %1 = iree_hl_interp.tile %bias, %shape : memref<4x8xf32>
+//   %2 = iree_hl_interp.add_f %0, %1 : memref<4x8xf32>
+//   %3 = iree_hl_interp.broadcast %zero, %shape : memref<4x8xf32>
+//   %4 = iree_hl_interp.max_f %3, %2 : memref<4x8xf32>
+//  ->
+//   %4 = iree_hl_interp.matmul_bias_f %a, %b, %bias, %zero, %inf
+//            : memref<4x8xf32>
+class FuseMatMulBiasOpsPass : public FunctionPass<FuseMatMulBiasOpsPass> {
+ public:
+  void runOnFunction() override {
+    // Gathered first as fusion erases ops.
+    SmallVector<IREEInterp::HL::MatMulFOp, 8> matMulOps;
+    getFunction().walk(
+        [&](IREEInterp::HL::MatMulFOp op) { matMulOps.push_back(op); });
+    for (auto matMulOp : matMulOps) {
+      fuseMatMul(matMulOp);
+    }
+  }
+};
+
+std::unique_ptr<OpPassBase<FuncOp>> createFuseMatMulBiasOpsPass() {
+  return std::make_unique<FuseMatMulBiasOpsPass>();
+}
+
+static PassRegistration<FuseMatMulBiasOpsPass> pass(
+    "iree-interpreter-fuse-matmul-bias",
+    "Fuses matmuls with their bias add and activation");
+
+}  // namespace iree_compiler
+}  // namespace mlir
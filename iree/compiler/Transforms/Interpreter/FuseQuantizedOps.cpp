@@ -0,0 +1,330 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "iree/compiler/IR/Interpreter/HLOps.h"
+#include "iree/compiler/IR/Ops.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// add_q rescales its offset operands in fixed point with limited headroom;
+// larger multipliers could saturate the rescaled values.
+constexpr double kMaxAddMultiplier = 8.0;
+
+// Affine quantization parameters: real = (quantized - zeroPoint) * scale.
+struct QuantParams {
+  double scale = 1.0;
+  int32_t zeroPoint = 0;
+};
+
+// Returns the splat value of |value| if it is a float constant or a broadcast
+// of one. Matched ops are added to |matchedOps|.
+llvm::Optional<double> matchFloatSplat(
+    Value *value, llvm::SmallPtrSetImpl<Operation *> *matchedOps) {
+  if (auto broadcastOp = dyn_cast_or_null<IREEInterp::HL::BroadcastOp>(
+          value->getDefiningOp())) {
+    matchedOps->insert(broadcastOp);
+    value = broadcastOp.operand();
+  }
+  auto constantOp = dyn_cast_or_null<IREE::ConstantOp>(value->getDefiningOp());
+  if (!constantOp) return llvm::None;
+  auto attr = constantOp.getValue().dyn_cast<DenseElementsAttr>();
+  if (!attr || !attr.isSplat()) return llvm::None;
+  auto floatAttr = attr.getSplatValue().dyn_cast<FloatAttr>();
+  if (!floatAttr) return llvm::None;
+  matchedOps->insert(constantOp);
+  return floatAttr.getValueAsDouble();
+}
+
+// Returns |value| as an int32 zero point if it is integral.
+llvm::Optional<int32_t> toZeroPoint(double value) {
+  if (value != std::round(value) ||
+      value < std::numeric_limits<int32_t>::min() ||
+      value > std::numeric_limits<int32_t>::max()) {
+    return llvm::None;
+  }
+  return static_cast<int32_t>(value);
+}
+
+// Returns the quantized value dequantized to |value| by the float ops
+//   mul_f(sub_f(convert_s_f(q), zero_point), scale)
+// where the sub_f is omitted for a zero point of 0 and the zero point and
+// scale are splat constants.
+Value *matchDequantize(Value *value, QuantParams *params,
+                       llvm::SmallPtrSetImpl<Operation *> *matchedOps) {
+  auto mulOp =
+      dyn_cast_or_null<IREEInterp::HL::MulFOp>(value->getDefiningOp());
+  if (!mulOp) return nullptr;
+  Value *offsetValue = mulOp.lhs();
+  auto scale = matchFloatSplat(mulOp.rhs(), matchedOps);
+  if (!scale) {
+    offsetValue = mulOp.rhs();
+    scale = matchFloatSplat(mulOp.lhs(), matchedOps);
+  }
+  if (!scale || !(scale.getValue() > 0.0)) return nullptr;
+
+  Value *convertedValue = offsetValue;
+  llvm::Optional<int32_t> zeroPoint = 0;
+  if (auto subOp = dyn_cast_or_null<IREEInterp::HL::SubFOp>(
+          offsetValue->getDefiningOp())) {
+    auto zeroPointValue = matchFloatSplat(subOp.rhs(), matchedOps);
+    if (!zeroPointValue) return nullptr;
+    zeroPoint = toZeroPoint(zeroPointValue.getValue());
+    convertedValue = subOp.lhs();
+    matchedOps->insert(subOp);
+  }
+  if (!zeroPoint) return nullptr;
+
+  auto convertOp = dyn_cast_or_null<IREEInterp::HL::ConvertSFOp>(
+      convertedValue->getDefiningOp());
+  if (!convertOp) return nullptr;
+  matchedOps->insert(mulOp);
+  matchedOps->insert(convertOp);
+  params->scale = scale.getValue();
+  params->zeroPoint = zeroPoint.getValue();
+  return convertOp.getOperand();
+}
+
+// Returns the float value quantized by |convertOp| through
+//   convert_f_s(clamp_f(add_f(div_f(x, scale), zero_point), min, max))
+// where the add_f is omitted for a zero point of 0 and the clamp bounds are
+// the full range of the result type, matching the saturation of the fused ops.
+Value *matchQuantize(IREEInterp::HL::ConvertFSOp convertOp,
+                     QuantParams *params,
+                     llvm::SmallPtrSetImpl<Operation *> *matchedOps) {
+  auto resultType = convertOp.getResult()->getType().cast<MemRefType>();
+  unsigned bitWidth = resultType.getElementTypeBitWidth();
+  if (bitWidth > 32) return nullptr;
+  auto clampOp = dyn_cast_or_null<IREEInterp::HL::ClampFOp>(
+      convertOp.getOperand()->getDefiningOp());
+  if (!clampOp) return nullptr;
+  auto clampMin = matchFloatSplat(clampOp.b(), matchedOps);
+  auto clampMax = matchFloatSplat(clampOp.c(), matchedOps);
+  if (!clampMin || !clampMax ||
+      clampMin.getValue() !=
+          llvm::APInt::getSignedMinValue(bitWidth).getSExtValue() ||
+      clampMax.getValue() !=
+          llvm::APInt::getSignedMaxValue(bitWidth).getSExtValue()) {
+    return nullptr;
+  }
+
+  Value *scaledValue = clampOp.a();
+  llvm::Optional<int32_t> zeroPoint = 0;
+  if (auto addOp = dyn_cast_or_null<IREEInterp::HL::AddFOp>(
+          scaledValue->getDefiningOp())) {
+    auto zeroPointValue = matchFloatSplat(addOp.rhs(), matchedOps);
+    if (!zeroPointValue) return nullptr;
+    zeroPoint = toZeroPoint(zeroPointValue.getValue());
+    scaledValue = addOp.lhs();
+    matchedOps->insert(addOp);
+  }
+  if (!zeroPoint) return nullptr;
+
+  auto divOp =
+      dyn_cast_or_null<IREEInterp::HL::DivFOp>(scaledValue->getDefiningOp());
+  if (!divOp) return nullptr;
+  auto scale = matchFloatSplat(divOp.rhs(), matchedOps);
+  if (!scale || !(scale.getValue() > 0.0)) return nullptr;
+  matchedOps->insert(clampOp);
+  matchedOps->insert(divOp);
+  params->scale = scale.getValue();
+  params->zeroPoint = zeroPoint.getValue();
+  return divOp.lhs();
+}
+
+// Encodes |multiplier| as the Q0.31 mantissa and exponent pair used by the
+// quantized interpreter kernels: multiplier = mantissa * 2^(exponent - 31).
+// Returns false if the multiplier is not positive.
+bool encodeMultiplier(double multiplier, int32_t *mantissa,
+                      int32_t *exponent) {
+  if (!(multiplier > 0.0) || !std::isfinite(multiplier)) return false;
+  int shift = 0;
+  double fraction = std::frexp(multiplier, &shift);
+  auto value = static_cast<int64_t>(std::round(fraction * (1ll << 31)));
+  if (value == (1ll << 31)) {
+    value /= 2;
+    ++shift;
+  }
+  *mantissa = static_cast<int32_t>(value);
+  *exponent = shift;
+  return true;
+}
+
+Value *createI32Constant(OpBuilder &builder, Location loc,
+                         ArrayRef<int32_t> values) {
+  auto type = builder.getTensorType({static_cast<int64_t>(values.size())},
+                                    builder.getIntegerType(32));
+  return builder.create<IREE::ConstantOp>(
+      loc, DenseIntElementsAttr::get<int32_t>(type, values));
+}
+
+// Replaces the float chain ending in |convertOp| with a quantized op.
+// Returns true if the chain was replaced.
+bool fuseQuantizedChain(IREEInterp::HL::ConvertFSOp convertOp) {
+  llvm::SmallPtrSet<Operation *, 16> matchedOps;
+  QuantParams resultParams;
+  auto *floatValue = matchQuantize(convertOp, &resultParams, &matchedOps);
+  if (!floatValue) return false;
+  auto resultType = convertOp.getResult()->getType().cast<MemRefType>();
+
+  // Adds and multiplies of two dequantized operands of the result type.
+  auto *floatOp = floatValue->getDefiningOp();
+  bool isAdd = isa_and_nonnull<IREEInterp::HL::AddFOp>(floatOp);
+  bool isMul = isa_and_nonnull<IREEInterp::HL::MulFOp>(floatOp);
+  QuantParams lhsParams, rhsParams;
+  Value *lhs = nullptr;
+  Value *rhs = nullptr;
+  if ((isAdd || isMul) && resultType.getElementTypeBitWidth() <= 16) {
+    lhs = matchDequantize(floatOp->getOperand(0), &lhsParams, &matchedOps);
+    rhs = matchDequantize(floatOp->getOperand(1), &rhsParams, &matchedOps);
+  }
+  if (!lhs || !rhs || lhs->getType() != resultType ||
+      rhs->getType() != resultType) {
+    isAdd = isMul = false;
+  }
+
+  SmallVector<double, 2> multipliers;
+  SmallVector<int32_t, 3> zeroPoints;
+  Value *src = nullptr;
+  if (isAdd) {
+    multipliers = {lhsParams.scale / resultParams.scale,
+                   rhsParams.scale / resultParams.scale};
+    for (double multiplier : multipliers) {
+      if (multiplier >= kMaxAddMultiplier) return false;
+    }
+    zeroPoints = {lhsParams.zeroPoint, rhsParams.zeroPoint,
+                  resultParams.zeroPoint};
+  } else if (isMul) {
+    multipliers = {lhsParams.scale * rhsParams.scale / resultParams.scale};
+    zeroPoints = {lhsParams.zeroPoint, rhsParams.zeroPoint,
+                  resultParams.zeroPoint};
+  } else {
+    // A dequantize directly followed by a quantize rescales the value.
+    QuantParams srcParams;
+    src = matchDequantize(floatValue, &srcParams, &matchedOps);
+    if (!src) return false;
+    multipliers = {srcParams.scale / resultParams.scale};
+    zeroPoints = {srcParams.zeroPoint, resultParams.zeroPoint};
+  }
+  SmallVector<int32_t, 2> mantissas(multipliers.size());
+  SmallVector<int32_t, 2> exponents(multipliers.size());
+  for (int i = 0, e = multipliers.size(); i < e; ++i) {
+    if (!encodeMultiplier(multipliers[i], &mantissas[i], &exponents[i])) {
+      return false;
+    }
+  }
+
+  OpBuilder builder(convertOp);
+  auto loc = convertOp.getLoc();
+  auto *mantissaValue = createI32Constant(builder, loc, mantissas);
+  auto *exponentValue = createI32Constant(builder, loc, exponents);
+  auto *zeroPointValue = createI32Constant(builder, loc, zeroPoints);
+  // convert_f_s truncates toward zero.
+  auto roundingMode = builder.getI32IntegerAttr(
+      static_cast<int32_t>(iree::RoundingMode::kTowardZero));
+  Value *result = nullptr;
+  if (isAdd) {
+    result = builder.create<IREEInterp::HL::AddQOp>(
+        loc, resultType, lhs, rhs, mantissaValue, exponentValue,
+        zeroPointValue, roundingMode);
+  } else if (isMul) {
+    result = builder.create<IREEInterp::HL::MulQOp>(
+        loc, resultType, lhs, rhs, mantissaValue, exponentValue,
+        zeroPointValue, roundingMode);
+  } else {
+    result = builder.create<IREEInterp::HL::RequantizeOp>(
+        loc, resultType, src, mantissaValue, exponentValue, zeroPointValue,
+        roundingMode);
+  }
+  if (floatOp) matchedOps.insert(floatOp);
+  convertOp.getResult()->replaceAllUsesWith(result);
+  convertOp.erase();
+
+  // Drop the float ops that are no longer used. Intermediates with other
+  // users (such as a dequantized value that is also returned) remain.
+  bool didErase;
+  do {
+    didErase = false;
+    for (auto *op : matchedOps) {
+      if (op->use_empty()) {
+        op->erase();
+        matchedOps.erase(op);
+        didErase = true;
+        break;
+      }
+    }
+  } while (didErase);
+  return true;
+}
+
+}  // namespace
+
+// Rewrites dequantize -> float op -> quantize chains into the quantized
+// iree_hl_interp.add_q, mul_q and requantize ops so that the values stay
+// quantized instead of making several float passes over them. The fused ops
+// truncate toward zero as convert_f_s does so that results are unchanged.
+//
+// Example:
+//   %0 = iree_hl_interp.convert_s_f %a : memref<4xi8> -> memref<4xf32>
+//   %1 = iree_hl_interp.sub_f %0, %a_zero_point : memref<4xf32>
+//   %2 = iree_hl_interp.mul_f %1, %a_scale : memref<4xf32>
+//   ... likewise %b to %5 ...
+//   %6 = iree_hl_interp.add_f %2, %5 : memref<4xf32>
+//   %7 = iree_hl_interp.div_f %6, %scale : memref<4xf32>
+//   %8 = iree_hl_interp.add_f %7, %zero_point : memref<4xf32>
+//   %9 = iree_hl_interp.clamp_f %8, %min, %max : memref<4xf32>
+//   %10 = iree_hl_interp.convert_f_s %9 : memref<4xf32> -> memref<4xi8>
+//  ->
+//   %10 = iree_hl_interp.add_q %a, %b, %mantissas, %exponents, %zero_points
+//             {rounding_mode = kTowardZero} : memref<4xi8>
+class FuseQuantizedOpsPass : public FunctionPass<FuseQuantizedOpsPass> {
+ public:
+  void runOnFunction() override {
+    // Gathered first as fusion erases ops.
+    SmallVector<IREEInterp::HL::ConvertFSOp, 8> convertOps;
+    getFunction().walk(
+        [&](IREEInterp::HL::ConvertFSOp op) { convertOps.push_back(op); });
+    for (auto convertOp : convertOps) {
+      fuseQuantizedChain(convertOp);
+    }
+  }
+};
+
+std::unique_ptr<OpPassBase<FuncOp>> createFuseQuantizedOpsPass() {
+  return std::make_unique<FuseQuantizedOpsPass>();
+}
+
+static PassRegistration<FuseQuantizedOpsPass> pass(
+    "iree-interpreter-fuse-quantized-ops",
+    "Rewrites dequantize/float op/quantize chains into quantized ops");
+
+}  // namespace iree_compiler
+}  // namespace mlir
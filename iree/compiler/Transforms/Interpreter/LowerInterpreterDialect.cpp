@@ -152,6 +152,7 @@ void populateInterpreterLoweringPatterns(OwningRewritePatternList &patterns,
       SAME_NAME_SIMPLE_PATTERN(AbsIOp),
       SAME_NAME_SIMPLE_PATTERN(AddFOp),
       SAME_NAME_SIMPLE_PATTERN(AddIOp),
+      SAME_NAME_SIMPLE_PATTERN(AddQOp),
       SAME_NAME_SIMPLE_PATTERN(AllocHeapOp),
       SAME_NAME_SIMPLE_PATTERN(AndOp),
       SAME_NAME_SIMPLE_PATTERN(Atan2FOp),
@@ -169,17 +170,20 @@ void populateInterpreterLoweringPatterns(OwningRewritePatternList &patterns,
       SAME_NAME_SIMPLE_PATTERN(ConvertUUOp),
       SAME_NAME_SIMPLE_PATTERN(ConvertSUOp),
       SAME_NAME_SIMPLE_PATTERN(ConvertUSOp),
+      SAME_NAME_SIMPLE_PATTERN(ConvFOp),
       SAME_NAME_SIMPLE_PATTERN(CondBreakOp),
       SAME_NAME_SIMPLE_PATTERN(CosFOp),
       SAME_NAME_SIMPLE_PATTERN(DimOp),
       SAME_NAME_SIMPLE_PATTERN(DivFOp),
       SAME_NAME_SIMPLE_PATTERN(DivISOp),
       SAME_NAME_SIMPLE_PATTERN(DivIUOp),
+      SAME_NAME_SIMPLE_PATTERN(ElementwiseFOp),
       SAME_NAME_SIMPLE_PATTERN(ExpFOp),
       SAME_NAME_SIMPLE_PATTERN(LogFOp),
       SAME_NAME_SIMPLE_PATTERN(RsqrtFOp),
       SAME_NAME_SIMPLE_PATTERN(FloorFOp),
       SAME_NAME_SIMPLE_PATTERN(LengthOp),
+      SAME_NAME_SIMPLE_PATTERN(MatMulBiasFOp),
       SAME_NAME_SIMPLE_PATTERN(MatMulFOp),
       SAME_NAME_SIMPLE_PATTERN(MatMulIOp),
       SAME_NAME_SIMPLE_PATTERN(MaxFOp),
@@ -192,10 +196,12 @@ void populateInterpreterLoweringPatterns(OwningRewritePatternList &patterns,
       SAME_NAME_SIMPLE_PATTERN(MulAddIOp),
       SAME_NAME_SIMPLE_PATTERN(MulFOp),
       SAME_NAME_SIMPLE_PATTERN(MulIOp),
+      SAME_NAME_SIMPLE_PATTERN(MulQOp),
       SAME_NAME_SIMPLE_PATTERN(NotOp),
       SAME_NAME_SIMPLE_PATTERN(OrOp),
       SAME_NAME_SIMPLE_PATTERN(PadOp),
       SAME_NAME_SIMPLE_PATTERN(RankOp),
+      SAME_NAME_SIMPLE_PATTERN(RequantizeOp),
       SAME_NAME_SIMPLE_PATTERN(ReduceSumIOp),
       SAME_NAME_SIMPLE_PATTERN(ReduceSumFOp),
       SAME_NAME_SIMPLE_PATTERN(ReduceMinIOp),
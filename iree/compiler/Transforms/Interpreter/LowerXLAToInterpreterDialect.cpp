@@ -191,6 +191,101 @@ struct ConstOpLowering : public XlaOpLowering<xla_hlo::ConstOp> {
   }
 };
 
+// Returns the values of the integer elements attribute |name| on |op| or
+// |count| copies of |defaultValue| if |op| has no such attribute.
+static SmallVector<int64_t, 4> getIntElementsAttrValues(Operation *op,
+                                                        StringRef name,
+                                                        int count,
+                                                        int64_t defaultValue) {
+  auto attr = op->getAttrOfType<DenseIntElementsAttr>(name);
+  if (!attr) return SmallVector<int64_t, 4>(count, defaultValue);
+  auto values = attr.getValues<int64_t>();
+  return {values.begin(), values.end()};
+}
+
+// Returns true if the dimension numbers of the convolution |op|, if any,
+// describe an NHWC input, HWIO filter, and NHWC output.
+static bool hasNHWCConvDimensionNumbers(Operation *op) {
+  auto dimensionNumbers =
+      op->getAttrOfType<DictionaryAttr>("dimension_numbers");
+  if (!dimensionNumbers) return true;
+  auto matches = [&](StringRef name, ArrayRef<int64_t> expected) {
+    auto attr = dimensionNumbers.get(name);
+    if (auto intAttr = attr.dyn_cast_or_null<IntegerAttr>()) {
+      return expected.size() == 1 && intAttr.getInt() == expected[0];
+    }
+    if (auto elementsAttr = attr.dyn_cast_or_null<DenseIntElementsAttr>()) {
+      auto values = elementsAttr.getValues<int64_t>();
+      SmallVector<int64_t, 4> actual{values.begin(), values.end()};
+      return ArrayRef<int64_t>(actual) == expected;
+    }
+    return false;
+  };
+  return matches("input_batch_dimension", {0}) &&
+         matches("input_feature_dimension", {3}) &&
+         matches("input_spatial_dimensions", {1, 2}) &&
+         matches("kernel_input_feature_dimension", {2}) &&
+         matches("kernel_output_feature_dimension", {3}) &&
+         matches("kernel_spatial_dimensions", {0, 1}) &&
+         matches("output_batch_dimension", {0}) &&
+         matches("output_feature_dimension", {3}) &&
+         matches("output_spatial_dimensions", {1, 2});
+}
+
+// Lowers 2D float convolutions with NHWC inputs and HWIO filters. Attributes
+// are read by name with the XLA defaults applied to those that are absent.
+struct ConvOpLowering : public XlaOpLowering<xla_hlo::ConvOp> {
+  using XlaOpLowering::XlaOpLowering;
+
+  Operation *rewriteInternal(
+      xla_hlo::ConvOp *op, ArrayRef<Value *> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    auto *convOp = op->getOperation();
+    auto inputType = operands[0]->getType().cast<MemRefType>();
+    auto filterType = operands[1]->getType().cast<MemRefType>();
+    auto finalType = getFinalType(rewriter, *op);
+    if (!finalType.getElementType().isa<FloatType>()) {
+      op->emitRemark() << "Could not lower conv op with non-float elements";
+      return nullptr;
+    }
+    if (inputType.getRank() != 4 || filterType.getRank() != 4 ||
+        !hasNHWCConvDimensionNumbers(convOp)) {
+      op->emitRemark()
+          << "Could not lower conv op that is not a 2D NHWC/HWIO convolution";
+      return nullptr;
+    }
+
+    auto lhsDilation = getIntElementsAttrValues(convOp, "lhs_dilation", 2, 1);
+    auto isNotOne = [](int64_t value) { return value != 1; };
+    auto batchGroupCount =
+        convOp->getAttrOfType<IntegerAttr>("batch_group_count");
+    if (llvm::any_of(lhsDilation, isNotOne) ||
+        (batchGroupCount && batchGroupCount.getInt() != 1)) {
+      op->emitRemark() << "Could not lower conv op with input dilation or "
+                          "batch groups";
+      return nullptr;
+    }
+    auto featureGroupCount =
+        convOp->getAttrOfType<IntegerAttr>("feature_group_count");
+
+    auto i32Type = rewriter.getIntegerType(32);
+    auto createI32ElementsAttr = [&](ArrayRef<int64_t> values) {
+      return rewriter.getDenseIntElementsAttr(
+          rewriter.getTensorType(values.size(), i32Type), values);
+    };
+    return rewriter.create<IREEInterp::HL::ConvFOp>(
+        op->getLoc(), finalType, operands[0], operands[1],
+        createI32ElementsAttr(
+            getIntElementsAttrValues(convOp, "window_strides", 2, 1)),
+        createI32ElementsAttr(
+            getIntElementsAttrValues(convOp, "padding", 4, 0)),
+        createI32ElementsAttr(
+            getIntElementsAttrValues(convOp, "rhs_dilation", 2, 1)),
+        rewriter.getI32IntegerAttr(
+            featureGroupCount ? featureGroupCount.getInt() : 1));
+  }
+};
+
 struct DotOpLowering : public XlaOpLowering<xla_hlo::DotOp> {
   using XlaOpLowering::XlaOpLowering;
 
@@ -560,12 +655,13 @@ struct ReverseOpLowering : public XlaOpLowering<xla_hlo::ReverseOp> {
 void populateLowerXlaToInterpreterPatterns(OwningRewritePatternList &patterns,
                                            MLIRContext *ctx) {
   patterns.insert<BroadcastInDimOpLowering, ConcatOpLowering, ConstOpLowering,
-                  ConvertLowering, CopyOpLowering, DotOpLowering,
-                  DynamicUpdateSliceOpLowering, ExpOpLowering, FloorOpLowering,
-                  GatherOpLowering, LogOpLowering, MaxOpLowering, MinOpLowering,
-                  PadOpLowering, ReshapeOpLowering, ReverseOpLowering,
-                  RsqrtOpLowering, SelectOpLowering, SliceOpLowering,
-                  TransposeOpLowering, TanhOpLowering>(ctx);
+                  ConvertLowering, ConvOpLowering, CopyOpLowering,
+                  DotOpLowering, DynamicUpdateSliceOpLowering, ExpOpLowering,
+                  FloorOpLowering, GatherOpLowering, LogOpLowering,
+                  MaxOpLowering, MinOpLowering, PadOpLowering,
+                  ReshapeOpLowering, ReverseOpLowering, RsqrtOpLowering,
+                  SelectOpLowering, SliceOpLowering, TransposeOpLowering,
+                  TanhOpLowering>(ctx);
 }
 
 namespace {
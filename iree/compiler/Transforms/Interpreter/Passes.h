@@ -28,6 +28,17 @@ std::unique_ptr<OpPassBase<ModuleOp>> createExpandReductionsToOpsPass();
 // Refactors entry points to match the IREE dispatch executable ABI.
 std::unique_ptr<OpPassBase<ModuleOp>> createMakeExecutableABIPass();
 
+// Fuses chains of elementwise ops into iree_hl_interp.elementwise_f programs.
+std::unique_ptr<OpPassBase<FuncOp>> createFuseElementwiseOpsPass();
+
+// Fuses matmuls with their bias add and activation into
+// iree_hl_interp.matmul_bias_f ops.
+std::unique_ptr<OpPassBase<FuncOp>> createFuseMatMulBiasOpsPass();
+
+// Rewrites dequantize -> add/mul -> quantize float op chains into the quantized
+// iree_hl_interp.add_q, mul_q and requantize ops.
+std::unique_ptr<OpPassBase<FuncOp>> createFuseQuantizedOpsPass();
+
 // Lowers IREE HL ops (iree_hl_interp.*) to LL ops (iree_ll_interp.*).
 std::unique_ptr<OpPassBase<FuncOp>> createLowerInterpreterDialectPass();
 
@@ -0,0 +1,88 @@
+// RUN: iree-opt %s -iree-interpreter-fuse-elementwise -split-input-file | FileCheck %s --dump-input=fail
+
+// Program instructions are encoded as (op << 24) | (r0 << 16) | (r1 << 8) | r2
+// with inputs in registers [0, N) followed by the result of each instruction.
+
+// CHECK-LABEL: func @fusedChain
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[C:%[a-zA-Z0-9]+]]
+func @fusedChain(%a : memref<4xf32>, %b : memref<4xf32>, %c : memref<4xf32>) -> memref<4xf32> {
+  // mul(0, 1), add(3, 2), tanh(4)
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.elementwise_f"([[A]], [[B]], [[C]]) {program = dense<[301990144, 268632576, 100925440]> : tensor<3xi32>} : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %0 = "iree_hl_interp.mul_f"(%a, %b) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %1 = "iree_hl_interp.add_f"(%0, %c) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.tanh_f"(%1) : (memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: return [[R]]
+  return %2 : memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @multiUseProducer
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+func @multiUseProducer(%a : memref<4xf32>, %b : memref<4xf32>) -> (memref<4xf32>, memref<4xf32>) {
+  // The product is needed outside of the chain and cannot be fused away.
+  // CHECK-NEXT: [[P:%.+]] = "iree_hl_interp.mul_f"([[A]], [[B]])
+  %0 = "iree_hl_interp.mul_f"(%a, %b) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: [[T:%.+]] = "iree_hl_interp.tanh_f"([[P]])
+  %1 = "iree_hl_interp.tanh_f"(%0) : (memref<4xf32>) -> memref<4xf32>
+  // CHECK-NOT: iree_hl_interp.elementwise_f
+  // CHECK-NEXT: return [[P]], [[T]]
+  return %0, %1 : memref<4xf32>, memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @partiallyFusedChain
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[C:%[a-zA-Z0-9]+]]
+func @partiallyFusedChain(%a : memref<4xf32>, %b : memref<4xf32>, %c : memref<4xf32>) -> memref<4xf32> {
+  // The product has two users and becomes an input of the fused program.
+  // CHECK-NEXT: [[P:%.+]] = "iree_hl_interp.mul_f"([[A]], [[B]])
+  %0 = "iree_hl_interp.mul_f"(%a, %b) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // add(0, 1), sub(0, 2)
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.elementwise_f"([[P]], [[C]]) {program = dense<[268435712, 285213184]> : tensor<2xi32>}
+  %1 = "iree_hl_interp.add_f"(%0, %c) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.sub_f"(%0, %1) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: return [[R]]
+  return %2 : memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @atan2
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[C:%[a-zA-Z0-9]+]]
+func @atan2(%a : memref<4xf32>, %b : memref<4xf32>, %c : memref<4xf32>) -> memref<4xf32> {
+  // atan2(0, 1), mul(3, 2)
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.elementwise_f"([[A]], [[B]], [[C]]) {program = dense<[369099008, 302187008]> : tensor<2xi32>}
+  %0 = "iree_hl_interp.atan2_f"(%a, %b) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %c) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: return [[R]]
+  return %1 : memref<4xf32>
+}
+
+
+// -----
+
+// CHECK-LABEL: func @interveningCopy
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[C:%[a-zA-Z0-9]+]]
+func @interveningCopy(%a : memref<4xf32>, %b : memref<4xf32>, %c : memref<4xf32>, %indices : memref<1xi32>, %lengths : memref<1xi32>) -> memref<4xf32> {
+  // The copy overwrites an operand of the product, which must be computed
+  // before it and cannot move into a program at the position of the add.
+  // CHECK-NEXT: [[P:%.+]] = "iree_hl_interp.mul_f"([[A]], [[B]])
+  %0 = "iree_hl_interp.mul_f"(%a, %b) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: "iree_hl_interp.copy"([[C]], {{.+}}, [[A]],
+  "iree_hl_interp.copy"(%c, %indices, %a, %indices, %lengths) : (memref<4xf32>, memref<1xi32>, memref<4xf32>, memref<1xi32>, memref<1xi32>) -> ()
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.add_f"([[P]], [[C]])
+  %1 = "iree_hl_interp.add_f"(%0, %c) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NOT: iree_hl_interp.elementwise_f
+  // CHECK-NEXT: return [[R]]
+  return %1 : memref<4xf32>
+}
@@ -0,0 +1,165 @@
+// RUN: iree-opt %s -iree-interpreter-fuse-matmul-bias -split-input-file | FileCheck %s --dump-input=fail
+
+// CHECK-LABEL: func @biasOnly
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+func @biasOnly(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<8xf32>, %shape : memref<2xi32>) -> memref<4x8xf32> {
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.matmul_bias_f"([[A]], [[B]], [[BIAS]]) : (memref<4x2xf32>, memref<2x8xf32>, memref<8xf32>) -> memref<4x8xf32>
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<8xf32>, memref<2xi32>) -> memref<4x8xf32>
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: return [[R]]
+  return %2 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @relu
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ZERO:%[a-zA-Z0-9]+]]
+func @relu(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<8xf32>, %shape : memref<2xi32>, %zero : memref<f32>) -> memref<4x8xf32> {
+  // The missing upper bound is filled in with +inf.
+  // CHECK-NEXT: [[INF:%.+]] = iree.constant dense<0x7F800000> : tensor<f32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.matmul_bias_f"([[A]], [[B]], [[BIAS]], [[ZERO]], [[INF]])
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<8xf32>, memref<2xi32>) -> memref<4x8xf32>
+  %2 = "iree_hl_interp.add_f"(%1, %0) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  %3 = "iree_hl_interp.broadcast"(%zero, %shape) : (memref<f32>, memref<2xi32>) -> memref<4x8xf32>
+  %4 = "iree_hl_interp.max_f"(%3, %2) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NOT: iree_hl_interp.tile
+  // CHECK-NOT: iree_hl_interp.broadcast
+  // CHECK-NEXT: return [[R]]
+  return %4 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @relu6
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ZERO:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SIX:%[a-zA-Z0-9]+]]
+func @relu6(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<8xf32>, %shape : memref<2xi32>, %zero : memref<f32>, %six : memref<f32>) -> memref<4x8xf32> {
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.matmul_bias_f"([[A]], [[B]], [[BIAS]], [[ZERO]], [[SIX]])
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<8xf32>, memref<2xi32>) -> memref<4x8xf32>
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  %3 = "iree_hl_interp.broadcast"(%zero, %shape) : (memref<f32>, memref<2xi32>) -> memref<4x8xf32>
+  %4 = "iree_hl_interp.max_f"(%2, %3) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  %5 = "iree_hl_interp.broadcast"(%six, %shape) : (memref<f32>, memref<2xi32>) -> memref<4x8xf32>
+  %6 = "iree_hl_interp.min_f"(%4, %5) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NOT: iree_hl_interp.max_f
+  // CHECK-NOT: iree_hl_interp.min_f
+  // CHECK-NEXT: return [[R]]
+  return %6 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @repeatedMax
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ZERO:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ONE:%[a-zA-Z0-9]+]]
+func @repeatedMax(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<8xf32>, %shape : memref<2xi32>, %zero : memref<f32>, %one : memref<f32>) -> memref<4x8xf32> {
+  // Only one lower bound is folded; the second max_f remains.
+  // CHECK-NEXT: [[INF:%.+]] = iree.constant dense<0x7F800000> : tensor<f32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.matmul_bias_f"([[A]], [[B]], [[BIAS]], [[ZERO]], [[INF]])
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<8xf32>, memref<2xi32>) -> memref<4x8xf32>
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  %3 = "iree_hl_interp.broadcast"(%zero, %shape) : (memref<f32>, memref<2xi32>) -> memref<4x8xf32>
+  %4 = "iree_hl_interp.max_f"(%2, %3) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[ONES:%.+]] = "iree_hl_interp.broadcast"([[ONE]], [[SHAPE]])
+  %5 = "iree_hl_interp.broadcast"(%one, %shape) : (memref<f32>, memref<2xi32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[M:%.+]] = "iree_hl_interp.max_f"([[R]], [[ONES]])
+  %6 = "iree_hl_interp.max_f"(%4, %5) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: return [[M]]
+  return %6 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @nonTiledAddend
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[C:%[a-zA-Z0-9]+]]
+func @nonTiledAddend(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %c : memref<4x8xf32>) -> memref<4x8xf32> {
+  // The addend varies per row and cannot be applied as a bias.
+  // CHECK-NEXT: [[P:%.+]] = "iree_hl_interp.matmul_f"([[A]], [[B]])
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.add_f"([[P]], [[C]])
+  %1 = "iree_hl_interp.add_f"(%0, %c) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NOT: iree_hl_interp.matmul_bias_f
+  // CHECK-NEXT: return [[R]]
+  return %1 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @columnBias
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+func @columnBias(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<4x1xf32>, %shape : memref<2xi32>) -> memref<4x8xf32> {
+  // The tiled operand holds one element per row rather than per column.
+  // CHECK-NEXT: [[P:%.+]] = "iree_hl_interp.matmul_f"([[A]], [[B]])
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[T:%.+]] = "iree_hl_interp.tile"([[BIAS]], [[SHAPE]])
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<4x1xf32>, memref<2xi32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.add_f"([[P]], [[T]])
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: return [[R]]
+  return %2 : memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @multiUseProduct
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+func @multiUseProduct(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<8xf32>, %shape : memref<2xi32>) -> (memref<4x8xf32>, memref<4x8xf32>) {
+  // The product is needed without the bias and cannot be fused away.
+  // CHECK-NEXT: [[P:%.+]] = "iree_hl_interp.matmul_f"([[A]], [[B]])
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[T:%.+]] = "iree_hl_interp.tile"([[BIAS]], [[SHAPE]])
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<8xf32>, memref<2xi32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.add_f"([[P]], [[T]])
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NOT: iree_hl_interp.matmul_bias_f
+  // CHECK-NEXT: return [[P]], [[R]]
+  return %0, %2 : memref<4x8xf32>, memref<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @multiUseSum
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ZERO:%[a-zA-Z0-9]+]]
+func @multiUseSum(%a : memref<4x2xf32>, %b : memref<2x8xf32>, %bias : memref<8xf32>, %shape : memref<2xi32>, %zero : memref<f32>) -> (memref<4x8xf32>, memref<4x8xf32>) {
+  // The biased sum is needed before the activation so only the bias is fused.
+  // CHECK-NEXT: [[S:%.+]] = "iree_hl_interp.matmul_bias_f"([[A]], [[B]], [[BIAS]]) : (memref<4x2xf32>, memref<2x8xf32>, memref<8xf32>) -> memref<4x8xf32>
+  %0 = "iree_hl_interp.matmul_f"(%a, %b) : (memref<4x2xf32>, memref<2x8xf32>) -> memref<4x8xf32>
+  %1 = "iree_hl_interp.tile"(%bias, %shape) : (memref<8xf32>, memref<2xi32>) -> memref<4x8xf32>
+  %2 = "iree_hl_interp.add_f"(%0, %1) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[Z:%.+]] = "iree_hl_interp.broadcast"([[ZERO]], [[SHAPE]])
+  %3 = "iree_hl_interp.broadcast"(%zero, %shape) : (memref<f32>, memref<2xi32>) -> memref<4x8xf32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.max_f"([[S]], [[Z]])
+  %4 = "iree_hl_interp.max_f"(%2, %3) : (memref<4x8xf32>, memref<4x8xf32>) -> memref<4x8xf32>
+  // CHECK-NEXT: return [[S]], [[R]]
+  return %2, %4 : memref<4x8xf32>, memref<4x8xf32>
+}
@@ -0,0 +1,186 @@
+// RUN: iree-opt %s -iree-interpreter-fuse-quantized-ops -split-input-file | FileCheck %s --dump-input=fail
+
+// Multipliers are encoded as Q0.31 mantissas and exponents such that 0.5 is
+// (1073741824, 0) and 0.25 is (1073741824, -1). The fused ops truncate toward
+// zero (rounding_mode 1) as convert_f_s does.
+
+// CHECK-LABEL: func @addQ
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+func @addQ(%a : memref<4xi8>, %b : memref<4xi8>) -> memref<4xi8> {
+  // (a - 2) * 0.5 + (b + 4) * 0.25 rescaled to a scale of 1 and zero point 3.
+  // CHECK-NEXT: [[M:%.+]] = iree.constant dense<1073741824> : tensor<2xi32>
+  // CHECK-NEXT: [[E:%.+]] = iree.constant dense<[0, -1]> : tensor<2xi32>
+  // CHECK-NEXT: [[Z:%.+]] = iree.constant dense<[2, -4, 3]> : tensor<3xi32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.add_q"([[A]], [[B]], [[M]], [[E]], [[Z]]) {rounding_mode = 1 : i32} : (memref<4xi8>, memref<4xi8>, memref<2xi32>, memref<2xi32>, memref<3xi32>) -> memref<4xi8>
+  %a_zero_point = "iree.constant"() {value = dense<2.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %a_scale = "iree.constant"() {value = dense<0.5> : tensor<4xf32>} : () -> memref<4xf32>
+  %b_zero_point = "iree.constant"() {value = dense<-4.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %b_scale = "iree.constant"() {value = dense<0.25> : tensor<4xf32>} : () -> memref<4xf32>
+  %scale = "iree.constant"() {value = dense<1.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %zero_point = "iree.constant"() {value = dense<3.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %min = "iree.constant"() {value = dense<-128.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%a) : (memref<4xi8>) -> memref<4xf32>
+  %1 = "iree_hl_interp.sub_f"(%0, %a_zero_point) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.mul_f"(%1, %a_scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %3 = "iree_hl_interp.convert_s_f"(%b) : (memref<4xi8>) -> memref<4xf32>
+  %4 = "iree_hl_interp.sub_f"(%3, %b_zero_point) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %5 = "iree_hl_interp.mul_f"(%b_scale, %4) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %6 = "iree_hl_interp.add_f"(%2, %5) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %7 = "iree_hl_interp.div_f"(%6, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %8 = "iree_hl_interp.add_f"(%7, %zero_point) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %9 = "iree_hl_interp.clamp_f"(%8, %min, %max) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %10 = "iree_hl_interp.convert_f_s"(%9) : (memref<4xf32>) -> memref<4xi8>
+  // CHECK-NEXT: return [[R]]
+  return %10 : memref<4xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @mulQ
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+func @mulQ(%a : memref<4xi8>, %b : memref<4xi8>, %shape : memref<1xi32>) -> memref<4xi8> {
+  // a * 0.5 * (b - 1) * 0.25 rescaled to a scale of 0.5: a multiplier of 0.25.
+  // Scalar parameters are broadcast and zero points of 0 have no ops.
+  // CHECK-NEXT: [[M:%.+]] = iree.constant dense<1073741824> : tensor<1xi32>
+  // CHECK-NEXT: [[E:%.+]] = iree.constant dense<-1> : tensor<1xi32>
+  // CHECK-NEXT: [[Z:%.+]] = iree.constant dense<[0, 1, 0]> : tensor<3xi32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.mul_q"([[A]], [[B]], [[M]], [[E]], [[Z]]) {rounding_mode = 1 : i32} : (memref<4xi8>, memref<4xi8>, memref<1xi32>, memref<1xi32>, memref<3xi32>) -> memref<4xi8>
+  %half = "iree.constant"() {value = dense<0.5> : tensor<f32>} : () -> memref<f32>
+  %quarter = "iree.constant"() {value = dense<0.25> : tensor<f32>} : () -> memref<f32>
+  %one = "iree.constant"() {value = dense<1.0> : tensor<f32>} : () -> memref<f32>
+  %min = "iree.constant"() {value = dense<-128.0> : tensor<f32>} : () -> memref<f32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<f32>} : () -> memref<f32>
+  %a_scale = "iree_hl_interp.broadcast"(%half, %shape) : (memref<f32>, memref<1xi32>) -> memref<4xf32>
+  %b_scale = "iree_hl_interp.broadcast"(%quarter, %shape) : (memref<f32>, memref<1xi32>) -> memref<4xf32>
+  %b_zero_point = "iree_hl_interp.broadcast"(%one, %shape) : (memref<f32>, memref<1xi32>) -> memref<4xf32>
+  %scale = "iree_hl_interp.broadcast"(%half, %shape) : (memref<f32>, memref<1xi32>) -> memref<4xf32>
+  %min_bound = "iree_hl_interp.broadcast"(%min, %shape) : (memref<f32>, memref<1xi32>) -> memref<4xf32>
+  %max_bound = "iree_hl_interp.broadcast"(%max, %shape) : (memref<f32>, memref<1xi32>) -> memref<4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%a) : (memref<4xi8>) -> memref<4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %a_scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.convert_s_f"(%b) : (memref<4xi8>) -> memref<4xf32>
+  %3 = "iree_hl_interp.sub_f"(%2, %b_zero_point) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %4 = "iree_hl_interp.mul_f"(%3, %b_scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %5 = "iree_hl_interp.mul_f"(%1, %4) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %6 = "iree_hl_interp.div_f"(%5, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %7 = "iree_hl_interp.clamp_f"(%6, %min_bound, %max_bound) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %8 = "iree_hl_interp.convert_f_s"(%7) : (memref<4xf32>) -> memref<4xi8>
+  // CHECK-NEXT: return [[R]]
+  return %8 : memref<4xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @requantize
+// CHECK-SAME: [[ACC:%[a-zA-Z0-9]+]]
+func @requantize(%acc : memref<2x4xi32>) -> memref<2x4xi8> {
+  // An i32 accumulator with a scale of 0.125 narrowed to a scale of 0.5 and a
+  // zero point of -1.
+  // CHECK-NEXT: [[M:%.+]] = iree.constant dense<1073741824> : tensor<1xi32>
+  // CHECK-NEXT: [[E:%.+]] = iree.constant dense<-1> : tensor<1xi32>
+  // CHECK-NEXT: [[Z:%.+]] = iree.constant dense<[0, -1]> : tensor<2xi32>
+  // CHECK-NEXT: [[R:%.+]] = "iree_hl_interp.requantize"([[ACC]], [[M]], [[E]], [[Z]]) {rounding_mode = 1 : i32} : (memref<2x4xi32>, memref<1xi32>, memref<1xi32>, memref<2xi32>) -> memref<2x4xi8>
+  %acc_scale = "iree.constant"() {value = dense<0.125> : tensor<2x4xf32>} : () -> memref<2x4xf32>
+  %scale = "iree.constant"() {value = dense<0.5> : tensor<2x4xf32>} : () -> memref<2x4xf32>
+  %zero_point = "iree.constant"() {value = dense<-1.0> : tensor<2x4xf32>} : () -> memref<2x4xf32>
+  %min = "iree.constant"() {value = dense<-128.0> : tensor<2x4xf32>} : () -> memref<2x4xf32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<2x4xf32>} : () -> memref<2x4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%acc) : (memref<2x4xi32>) -> memref<2x4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %acc_scale) : (memref<2x4xf32>, memref<2x4xf32>) -> memref<2x4xf32>
+  %2 = "iree_hl_interp.div_f"(%1, %scale) : (memref<2x4xf32>, memref<2x4xf32>) -> memref<2x4xf32>
+  %3 = "iree_hl_interp.add_f"(%2, %zero_point) : (memref<2x4xf32>, memref<2x4xf32>) -> memref<2x4xf32>
+  %4 = "iree_hl_interp.clamp_f"(%3, %min, %max) : (memref<2x4xf32>, memref<2x4xf32>, memref<2x4xf32>) -> memref<2x4xf32>
+  %5 = "iree_hl_interp.convert_f_s"(%4) : (memref<2x4xf32>) -> memref<2x4xi8>
+  // CHECK-NEXT: return [[R]]
+  return %5 : memref<2x4xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @sharedDequantize
+// CHECK-SAME: [[A:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[B:%[a-zA-Z0-9]+]]
+func @sharedDequantize(%a : memref<4xi8>, %b : memref<4xi8>) -> (memref<4xi8>, memref<4xf32>) {
+  // The dequantized lhs is also returned so its float ops remain.
+  // CHECK: [[DA:%.+]] = "iree_hl_interp.mul_f"
+  // CHECK-NOT: iree_hl_interp.add_f
+  // CHECK: [[R:%.+]] = "iree_hl_interp.add_q"([[A]], [[B]],
+  // CHECK-NEXT: return [[R]], [[DA]]
+  %scale = "iree.constant"() {value = dense<0.5> : tensor<4xf32>} : () -> memref<4xf32>
+  %min = "iree.constant"() {value = dense<-128.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%a) : (memref<4xi8>) -> memref<4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.convert_s_f"(%b) : (memref<4xi8>) -> memref<4xf32>
+  %3 = "iree_hl_interp.mul_f"(%2, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %4 = "iree_hl_interp.add_f"(%1, %3) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %5 = "iree_hl_interp.div_f"(%4, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %6 = "iree_hl_interp.clamp_f"(%5, %min, %max) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %7 = "iree_hl_interp.convert_f_s"(%6) : (memref<4xf32>) -> memref<4xi8>
+  return %7, %1 : memref<4xi8>, memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @narrowClamp
+func @narrowClamp(%a : memref<4xi8>) -> memref<4xi8> {
+  // Clamping to less than the range of the result (such as a fused relu)
+  // cannot be expressed by the saturating quantized ops.
+  // CHECK-NOT: iree_hl_interp.requantize
+  // CHECK: "iree_hl_interp.convert_f_s"
+  %scale = "iree.constant"() {value = dense<0.5> : tensor<4xf32>} : () -> memref<4xf32>
+  %min = "iree.constant"() {value = dense<0.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%a) : (memref<4xi8>) -> memref<4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.div_f"(%1, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %3 = "iree_hl_interp.clamp_f"(%2, %min, %max) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %4 = "iree_hl_interp.convert_f_s"(%3) : (memref<4xf32>) -> memref<4xi8>
+  return %4 : memref<4xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @mixedOperandTypes
+func @mixedOperandTypes(%a : memref<4xi8>, %b : memref<4xi16>) -> memref<4xi8> {
+  // add_q requires both operands to have the type of the result.
+  // CHECK-NOT: iree_hl_interp.add_q
+  // CHECK: "iree_hl_interp.convert_f_s"
+  %scale = "iree.constant"() {value = dense<0.5> : tensor<4xf32>} : () -> memref<4xf32>
+  %min = "iree.constant"() {value = dense<-128.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%a) : (memref<4xi8>) -> memref<4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.convert_s_f"(%b) : (memref<4xi16>) -> memref<4xf32>
+  %3 = "iree_hl_interp.mul_f"(%2, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %4 = "iree_hl_interp.add_f"(%1, %3) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %5 = "iree_hl_interp.div_f"(%4, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %6 = "iree_hl_interp.clamp_f"(%5, %min, %max) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %7 = "iree_hl_interp.convert_f_s"(%6) : (memref<4xf32>) -> memref<4xi8>
+  return %7 : memref<4xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @largeAddMultiplier
+func @largeAddMultiplier(%a : memref<4xi8>, %b : memref<4xi8>) -> memref<4xi8> {
+  // A multiplier of 16 could saturate the shifted operands of add_q.
+  // CHECK-NOT: iree_hl_interp.add_q
+  // CHECK: "iree_hl_interp.convert_f_s"
+  %a_scale = "iree.constant"() {value = dense<4.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %scale = "iree.constant"() {value = dense<0.25> : tensor<4xf32>} : () -> memref<4xf32>
+  %min = "iree.constant"() {value = dense<-128.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %max = "iree.constant"() {value = dense<127.0> : tensor<4xf32>} : () -> memref<4xf32>
+  %0 = "iree_hl_interp.convert_s_f"(%a) : (memref<4xi8>) -> memref<4xf32>
+  %1 = "iree_hl_interp.mul_f"(%0, %a_scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.convert_s_f"(%b) : (memref<4xi8>) -> memref<4xf32>
+  %3 = "iree_hl_interp.mul_f"(%2, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %4 = "iree_hl_interp.add_f"(%1, %3) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %5 = "iree_hl_interp.div_f"(%4, %scale) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %6 = "iree_hl_interp.clamp_f"(%5, %min, %max) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %7 = "iree_hl_interp.convert_f_s"(%6) : (memref<4xf32>) -> memref<4xi8>
+  return %7 : memref<4xi8>
+}
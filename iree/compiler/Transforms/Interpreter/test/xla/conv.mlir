@@ -0,0 +1,30 @@
+// RUN: iree-opt --lower-xla-to-iree-interpreter %s | FileCheck %s --dump-input=fail
+
+// CHECK-LABEL: @conv
+// CHECK-SAME: [[INPUT:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[FILTER:%[a-zA-Z0-9]+]]
+func @conv(%input : tensor<1x8x8x4xf32>, %filter : tensor<3x3x4x16xf32>) -> tensor<1x4x4x16xf32> {
+  // CHECK-DAG:  [[INPUT_MEMREF:%.+]] = iree.tensor_to_memref([[INPUT]]
+  // CHECK-DAG:  [[FILTER_MEMREF:%.+]] = iree.tensor_to_memref([[FILTER]]
+  // CHECK-NEXT: [[RESULT:%.+]] = "iree_hl_interp.conv_f"([[INPUT_MEMREF]], [[FILTER_MEMREF]])
+  // CHECK-SAME: dilation = dense<1> : tensor<2xi32>
+  // CHECK-SAME: feature_group_count = 1 : i32
+  // CHECK-SAME: padding = dense<[0, 1, 0, 1]> : tensor<4xi32>
+  // CHECK-SAME: window_strides = dense<2> : tensor<2xi32>
+  // CHECK-SAME: (memref<1x8x8x4xf32>, memref<3x3x4x16xf32>) -> memref<1x4x4x16xf32>
+  // CHECK-NEXT: [[RESULT_TENSOR:%.+]] = iree.memref_to_tensor([[RESULT]]
+  %result = "xla_hlo.conv"(%input, %filter) {window_strides = dense<2> : tensor<2xi64>, padding = dense<[[0, 1], [0, 1]]> : tensor<2x2xi64>, feature_group_count = 1 : i64} : (tensor<1x8x8x4xf32>, tensor<3x3x4x16xf32>) -> tensor<1x4x4x16xf32>
+  // CHECK-NEXT: return [[RESULT_TENSOR]]
+  return %result : tensor<1x4x4x16xf32>
+}
+
+// CHECK-LABEL: @depthwise_conv
+func @depthwise_conv(%input : tensor<1x8x8x4xf32>, %filter : tensor<3x3x1x8xf32>) -> tensor<1x6x6x8xf32> {
+  // CHECK: "iree_hl_interp.conv_f"
+  // CHECK-SAME: dilation = dense<1> : tensor<2xi32>
+  // CHECK-SAME: feature_group_count = 4 : i32
+  // CHECK-SAME: padding = dense<0> : tensor<4xi32>
+  // CHECK-SAME: window_strides = dense<1> : tensor<2xi32>
+  %result = "xla_hlo.conv"(%input, %filter) {feature_group_count = 4 : i64} : (tensor<1x8x8x4xf32>, tensor<3x3x1x8xf32>) -> tensor<1x6x6x8xf32>
+  return %result : tensor<1x6x6x8xf32>
+}
@@ -22,6 +22,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
 #include "mlir/Dialect/StandardOps/Ops.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BlockAndValueMapping.h"
@@ -36,6 +37,12 @@
 #include "mlir/Transforms/Utils.h"
 #include "tensorflow/compiler/mlir/xla/ir/hlo_ops.h"
 
+static llvm::cl::opt<bool> clFuseMatMulEpilogues(
+    "iree-fuse-matmul-epilogues",
+    llvm::cl::desc("Fuse dots with their bias add and activation when "
+                   "identifying dispatch regions (interpreter-only)."),
+    llvm::cl::init(false));
+
 namespace mlir {
 namespace iree_compiler {
 
@@ -97,6 +104,16 @@ bool isFusionRootOp(Operation *op) {
   return true;
 }
 
+// Returns true if |op| is a dot whose sole user adds to its result, such as
+// the bias add of a fully-connected layer. Backends able to apply the bias
+// and any following activation while storing the dot result may fuse these
+// epilogues with the dot.
+bool isMatMulWithEpilogue(Operation *op) {
+  if (!isa<xla_hlo::DotOp>(op) || !op->getResult(0)->hasOneUse()) return false;
+  auto *user = op->getResult(0)->use_begin()->getOwner();
+  return isa<xla_hlo::AddOp>(user) || isa<AddFOp>(user);
+}
+
 // Returns true if the given |op| can be fused into other ops.
 //
 // Ops that perform narrowing on shapes (such as reduction ops) should not
@@ -105,8 +122,10 @@ bool isFusionRootOp(Operation *op) {
 // more efficient rooted cascading reduction dispatches.
 //
 // Preconditions: isDispatchableOp(op) == true.
-bool isFusableOp(Operation *op) {
-  if (isa<xla_hlo::DotOp>(op) || isa<xla_hlo::ConvOp>(op)) {
+bool isFusableOp(Operation *op, bool fuseMatMulEpilogues) {
+  if (fuseMatMulEpilogues && isMatMulWithEpilogue(op)) {
+    return true;
+  } else if (isa<xla_hlo::DotOp>(op) || isa<xla_hlo::ConvOp>(op)) {
     return false;
   } else if (isa<xla_hlo::ReduceOp>(op)) {
     // Reduction is usually a dedicated root operation - we can shove things in
@@ -152,7 +171,8 @@ std::vector<Operation *> sortOpsTopologically(
 
 // Recursively traverses the IR DAG along the operand edges to find ops we are
 // able to fuse and appends them to |subgraph|.
-void gatherFusionOps(Operation *op, llvm::SetVector<Operation *> *subgraph) {
+void gatherFusionOps(Operation *op, bool fuseMatMulEpilogues,
+                     llvm::SetVector<Operation *> *subgraph) {
   // Skip ops that are used outside of the subgraph we are building.
   for (auto *result : op->getResults()) {
     if (result->use_empty() || result->hasOneUse()) continue;
@@ -166,13 +186,20 @@ void gatherFusionOps(Operation *op, llvm::SetVector<Operation *> *subgraph) {
     }
   }
 
+  // Dots are only fused with their epilogue; their operands remain inputs.
+  if (isa<xla_hlo::DotOp>(op)) {
+    subgraph->insert(op);
+    return;
+  }
+
   // Walk backward up to ops providing our input operands.
   for (auto *operand : op->getOperands()) {
     auto *sourceOp = operand->getDefiningOp();
     if (!sourceOp) continue;
     if (subgraph->count(sourceOp) == 0) {
-      if (isDispatchableOp(sourceOp) && isFusableOp(sourceOp)) {
-        gatherFusionOps(sourceOp, subgraph);
+      if (isDispatchableOp(sourceOp) &&
+          isFusableOp(sourceOp, fuseMatMulEpilogues)) {
+        gatherFusionOps(sourceOp, fuseMatMulEpilogues, subgraph);
       }
     }
   }
@@ -184,18 +211,20 @@ void gatherFusionOps(Operation *op, llvm::SetVector<Operation *> *subgraph) {
 // backwards in the op order through input edges.
 // Returns a topologically sorted list of all fused ops with |rootOp| at the
 // end.
-std::vector<Operation *> findFusionSubgraphFromRoot(Operation *rootOp) {
+std::vector<Operation *> findFusionSubgraphFromRoot(Operation *rootOp,
+                                                   bool fuseMatMulEpilogues) {
   if (!isFusionRootOp(rootOp)) {
     return {rootOp};
   }
   llvm::SetVector<Operation *> subgraph;
   subgraph.insert(rootOp);
-  gatherFusionOps(rootOp, &subgraph);
+  gatherFusionOps(rootOp, fuseMatMulEpilogues, &subgraph);
   return sortOpsTopologically(subgraph);
 }
 
 // Identifies ranges of dispatchable ops and moves them into dispatch regions.
-LogicalResult identifyBlockDispatchRegions(FuncOp func, Block *block) {
+LogicalResult identifyBlockDispatchRegions(FuncOp func, Block *block,
+                                           bool fuseMatMulEpilogues) {
   // Fixed point iteration until we can no longer fuse anything.
   bool didFindAnyNewRegions;
   do {
@@ -210,7 +239,8 @@ LogicalResult identifyBlockDispatchRegions(FuncOp func, Block *block) {
       // Attempt to find all operations, including rootOp, that can be fused.
       // The ops will be sorted in topological order with rootOp as the last op.
       // Worst case we may end up with a subgraph of only the rootOp.
-      auto fusedSubgraph = findFusionSubgraphFromRoot(&rootOp);
+      auto fusedSubgraph =
+          findFusionSubgraphFromRoot(&rootOp, fuseMatMulEpilogues);
 
       // Compute the workload based on the output shape.
       // When variadic all output shapes match so we can just take the first.
@@ -237,18 +267,29 @@ LogicalResult identifyBlockDispatchRegions(FuncOp func, Block *block) {
 class IdentifyDispatchRegionsPass
     : public FunctionPass<IdentifyDispatchRegionsPass> {
  public:
+  // Used by the pass registry; see -iree-fuse-matmul-epilogues.
+  IdentifyDispatchRegionsPass()
+      : fuseMatMulEpilogues_(clFuseMatMulEpilogues) {}
+  explicit IdentifyDispatchRegionsPass(bool fuseMatMulEpilogues)
+      : fuseMatMulEpilogues_(fuseMatMulEpilogues) {}
+
   void runOnFunction() override {
     auto func = getFunction();
     for (auto &block : func) {
-      if (failed(identifyBlockDispatchRegions(func, &block))) {
+      if (failed(identifyBlockDispatchRegions(func, &block,
+                                              fuseMatMulEpilogues_))) {
         return signalPassFailure();
       }
     }
   }
+
+ private:
+  bool fuseMatMulEpilogues_;
 };
 
-std::unique_ptr<OpPassBase<FuncOp>> createIdentifyDispatchRegionsPass() {
-  return std::make_unique<IdentifyDispatchRegionsPass>();
+std::unique_ptr<OpPassBase<FuncOp>> createIdentifyDispatchRegionsPass(
+    bool fuseMatMulEpilogues) {
+  return std::make_unique<IdentifyDispatchRegionsPass>(fuseMatMulEpilogues);
 }
 
 static PassRegistration<IdentifyDispatchRegionsPass> pass(
@@ -25,8 +25,10 @@ namespace iree_compiler {
 //===----------------------------------------------------------------------===//
 
 // Identifies dispatchable regions of functions and wraps them in
-// iree.dispatch_regions.
-std::unique_ptr<OpPassBase<FuncOp>> createIdentifyDispatchRegionsPass();
+// iree.dispatch_regions. When |fuseMatMulEpilogues| is set dots are placed in
+// the same region as their following bias add and activation.
+std::unique_ptr<OpPassBase<FuncOp>> createIdentifyDispatchRegionsPass(
+    bool fuseMatMulEpilogues = false);
 
 // Folds multiple dispatch regions together that have compatible workloads.
 std::unique_ptr<OpPassBase<FuncOp>> createFoldCompatibleDispatchRegionsPass();
@@ -64,6 +66,14 @@ std::unique_ptr<OpPassBase<FuncOp>> createLowerSequencerDialectPass();
 // Optimizes std.load and std.store to remove unnessisary copies.
 std::unique_ptr<OpPassBase<FuncOp>> createLoadStoreDataFlowOptPass();
 
+//===----------------------------------------------------------------------===//
+// Memory Planning
+//===----------------------------------------------------------------------===//
+
+// Packs intermediate iree_ll_seq.alloc_heap ops with static shapes and
+// non-overlapping lifetimes into a single per-function arena.
+std::unique_ptr<OpPassBase<FuncOp>> createPlanStaticAllocationsPass();
+
 //===----------------------------------------------------------------------===//
 // Module Analysis and Assignment
 //===----------------------------------------------------------------------===//
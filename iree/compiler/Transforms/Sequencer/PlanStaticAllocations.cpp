@@ -0,0 +1,229 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+
+#include "iree/compiler/IR/Sequencer/LLOps.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Byte alignment of each allocation within the arena. Matches the cache line
+// size so that neighboring allocations written by different workers do not
+// share lines.
+constexpr int64_t kAllocationAlignment = 64;
+
+// A static allocation that can be placed within the arena.
+struct PlannedAllocation {
+  IREESeq::LL::AllocHeapOp allocOp;
+  // Aligned size of the allocation in bytes.
+  int64_t size = 0;
+  // Live range as indices of ops within the parent block (inclusive).
+  int liveStart = 0;
+  int liveEnd = 0;
+  // Assigned byte offset within the arena.
+  int64_t offset = 0;
+};
+
+// Returns true if |op| produces results that alias its operands.
+bool isAliasingOp(Operation *op) {
+  return isa<IREESeq::LL::StaticSliceOp>(op) ||
+         isa<IREESeq::LL::DynamicSliceOp>(op) ||
+         isa<IREESeq::LL::ReshapeOp>(op) || isa<IREESeq::LL::AssignOp>(op) ||
+         isa<IREESeq::LL::CondAssignOp>(op);
+}
+
+// Returns true if |op| only accesses its operands while it executes and does
+// not retain references to them.
+bool isNonEscapingUse(Operation *op) {
+  return isa<IREESeq::LL::StaticDispatchOp>(op) ||
+         isa<IREESeq::LL::DynamicDispatchOp>(op) ||
+         isa<IREESeq::LL::StaticCopyOp>(op) ||
+         isa<IREESeq::LL::DynamicCopyOp>(op) ||
+         isa<IREESeq::LL::StaticFillOp>(op) ||
+         isa<IREESeq::LL::DynamicFillOp>(op) ||
+         isa<IREESeq::LL::CloneOp>(op) || isa<IREESeq::LL::ShapeOp>(op) ||
+         isa<IREESeq::LL::LengthOp>(op) ||
+         isa<IREESeq::LL::ComputeOffsetOp>(op) ||
+         isa<IREESeq::LL::ComputeRangeOp>(op) ||
+         isa<IREESeq::LL::DiscardOp>(op) || isa<IREESeq::LL::TraceOp>(op) ||
+         isa<IREESeq::LL::CondBreakOp>(op);
+}
+
+// Extends |liveEnd| to cover all uses of |value| and any values aliasing it.
+// Returns false if the value may escape the block, such as by being returned,
+// passed to a call, or used as a branch operand.
+bool extendLiveRange(Value *value, Block *block,
+                     const llvm::DenseMap<Operation *, int> &opIndices,
+                     int *liveEnd) {
+  for (auto &use : value->getUses()) {
+    auto *user = use.getOwner();
+    if (user->getBlock() != block) return false;
+    *liveEnd = std::max(*liveEnd, opIndices.lookup(user));
+    if (isAliasingOp(user)) {
+      for (auto *result : user->getResults()) {
+        if (!extendLiveRange(result, block, opIndices, liveEnd)) return false;
+      }
+    } else if (!isNonEscapingUse(user)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Assigns arena offsets to |allocations| such that allocations with
+// overlapping live ranges do not overlap in memory. Larger allocations are
+// placed first at the lowest offset that fits. Returns the required arena size.
+int64_t assignOffsets(MutableArrayRef<PlannedAllocation> allocations) {
+  SmallVector<PlannedAllocation *, 16> order;
+  for (auto &allocation : allocations) order.push_back(&allocation);
+  std::stable_sort(order.begin(), order.end(),
+                   [](PlannedAllocation *lhs, PlannedAllocation *rhs) {
+                     return lhs->size > rhs->size;
+                   });
+
+  int64_t arenaSize = 0;
+  SmallVector<PlannedAllocation *, 16> placed;
+  for (auto *allocation : order) {
+    // Gather the placed allocations live at the same time, ordered by offset.
+    SmallVector<PlannedAllocation *, 16> conflicts;
+    for (auto *other : placed) {
+      if (other->liveStart <= allocation->liveEnd &&
+          allocation->liveStart <= other->liveEnd) {
+        conflicts.push_back(other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](PlannedAllocation *lhs, PlannedAllocation *rhs) {
+                return lhs->offset < rhs->offset;
+              });
+
+    // Find the first gap large enough.
+    int64_t offset = 0;
+    for (auto *other : conflicts) {
+      if (offset + allocation->size <= other->offset) break;
+      offset = std::max(offset, other->offset + other->size);
+    }
+    allocation->offset = offset;
+    arenaSize = std::max(arenaSize, offset + allocation->size);
+    placed.push_back(allocation);
+  }
+  return arenaSize;
+}
+
+}  // namespace
+
+// Packs statically-shaped intermediate allocations into a single arena
+// allocated once on function entry. Each iree_ll_seq.alloc_heap whose buffer
+// does not escape its block is replaced with an iree_ll_seq.alloc_static
+// referencing a planned offset within the arena. Allocations whose live ranges
+// do not overlap share the same memory.
+//
+// Live ranges are computed per-block: a buffer that is only used within the
+// block it is allocated in cannot be live while any other block executes, and
+// as such allocations in different blocks may always alias.
+//
+// Example:
+//   %0 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+//   iree_ll_seq.static_dispatch ...(%arg0, %0)
+//   %1 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+//   iree_ll_seq.static_dispatch ...(%0, %1)
+//   %2 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+//   iree_ll_seq.static_dispatch ...(%1, %2)
+//  ->
+//   %arena = "iree_ll_seq.alloc_heap"() : () -> memref<128xi8>
+//   %0 = "iree_ll_seq.alloc_static"(%arena) {offset = 0} ...
+//   %1 = "iree_ll_seq.alloc_static"(%arena) {offset = 64} ...
+//   %2 = "iree_ll_seq.alloc_static"(%arena) {offset = 0} ...
+class PlanStaticAllocationsPass
+    : public FunctionPass<PlanStaticAllocationsPass> {
+ public:
+  void runOnFunction() override {
+    auto func = getFunction();
+    if (func.isExternal()) return;
+
+    SmallVector<PlannedAllocation, 16> allocations;
+    int64_t arenaSize = 0;
+    for (auto &block : func.getBlocks()) {
+      llvm::DenseMap<Operation *, int> opIndices;
+      int nextIndex = 0;
+      for (auto &op : block) opIndices[&op] = nextIndex++;
+
+      size_t blockBegin = allocations.size();
+      for (auto allocOp : block.getOps<IREESeq::LL::AllocHeapOp>()) {
+        auto memRefType = allocOp.getType().cast<MemRefType>();
+        if (allocOp.getNumOperands() != 0 || !memRefType.hasStaticShape()) {
+          continue;
+        }
+        PlannedAllocation allocation;
+        allocation.allocOp = allocOp;
+        allocation.size = llvm::alignTo(
+            std::max<int64_t>(memRefType.getSizeInBits() / 8, 1),
+            kAllocationAlignment);
+        allocation.liveStart = allocation.liveEnd =
+            opIndices.lookup(allocOp.getOperation());
+        if (!extendLiveRange(allocOp.getResult(), &block, opIndices,
+                             &allocation.liveEnd)) {
+          continue;
+        }
+        allocations.push_back(allocation);
+      }
+      arenaSize = std::max(
+          arenaSize,
+          assignOffsets(MutableArrayRef<PlannedAllocation>(allocations)
+                            .drop_front(blockBegin)));
+    }
+    if (allocations.empty()) return;
+
+    auto &entryBlock = func.getBlocks().front();
+    auto builder = OpBuilder::atBlockBegin(&entryBlock);
+    auto *arena = builder
+                      .create<IREESeq::LL::AllocHeapOp>(
+                          func.getLoc(),
+                          builder.getMemRefType({arenaSize},
+                                                builder.getIntegerType(8)),
+                          ArrayRef<Value *>{})
+                      .getResult();
+    for (auto &allocation : allocations) {
+      OpBuilder allocBuilder(allocation.allocOp);
+      auto allocStaticOp = allocBuilder.create<IREESeq::LL::AllocStaticOp>(
+          allocation.allocOp.getLoc(), allocation.allocOp.getType(), arena,
+          allocBuilder.getI32IntegerAttr(allocation.offset));
+      allocation.allocOp.replaceAllUsesWith(allocStaticOp.getResult());
+      allocation.allocOp.erase();
+    }
+  }
+};
+
+std::unique_ptr<OpPassBase<FuncOp>> createPlanStaticAllocationsPass() {
+  return std::make_unique<PlanStaticAllocationsPass>();
+}
+
+static PassRegistration<PlanStaticAllocationsPass> pass(
+    "iree-plan-static-allocations",
+    "Packs non-overlapping intermediate allocations into a static arena");
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,76 @@
+// RUN: iree-opt %s -iree-identify-dispatch-regions -split-input-file | FileCheck %s --dump-input=fail
+// RUN: iree-opt %s -iree-identify-dispatch-regions -iree-fuse-matmul-epilogues -split-input-file | FileCheck %s --check-prefix=FUSE --dump-input=fail
+
+// By default dots are dispatched alone. When fusing epilogues (as done when
+// only targeting the interpreter) the bias add and activation join the dot.
+
+// CHECK-LABEL: func @dotBiasRelu
+// FUSE-LABEL: func @dotBiasRelu
+func @dotBiasRelu(%a : tensor<4x2xf32>, %b : tensor<2x8xf32>, %bias : tensor<4x8xf32>, %zero : tensor<4x8xf32>) -> tensor<4x8xf32> {
+  // CHECK: [[WORKLOAD0:%.+]] = constant dense<[8, 4, 1]> : tensor<3xi32>
+  // CHECK-NEXT: [[P:%.+]] = iree.dispatch_region{{\[}}[[WORKLOAD0]] : tensor<3xi32>]
+  // CHECK-NEXT: "xla_hlo.dot"
+  // CHECK-NEXT: iree.return
+  // CHECK-NEXT: }
+  // CHECK: [[WORKLOAD1:%.+]] = constant dense<[8, 4, 1]> : tensor<3xi32>
+  // CHECK-NEXT: [[R:%.+]] = iree.dispatch_region{{\[}}[[WORKLOAD1]] : tensor<3xi32>]({{.+}} = [[P]] : tensor<4x8xf32>
+  // CHECK-NEXT: xla_hlo.add
+  // CHECK-NEXT: xla_hlo.max
+  // CHECK-NEXT: iree.return
+  // CHECK-NEXT: }
+  // CHECK-NEXT: return [[R]]
+
+  // FUSE: [[WORKLOAD:%.+]] = constant dense<[8, 4, 1]> : tensor<3xi32>
+  // FUSE-NEXT: [[R:%.+]] = iree.dispatch_region{{\[}}[[WORKLOAD]] : tensor<3xi32>]
+  // FUSE-NEXT: "xla_hlo.dot"
+  // FUSE-NEXT: xla_hlo.add
+  // FUSE-NEXT: xla_hlo.max
+  // FUSE-NEXT: iree.return
+  // FUSE-NEXT: }
+  // FUSE-NEXT: return [[R]]
+  %0 = "xla_hlo.dot"(%a, %b) : (tensor<4x2xf32>, tensor<2x8xf32>) -> tensor<4x8xf32>
+  %1 = xla_hlo.add %0, %bias : tensor<4x8xf32>
+  %2 = xla_hlo.max %1, %zero : tensor<4x8xf32>
+  return %2 : tensor<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @dotOperandsNotFused
+// FUSE-LABEL: func @dotOperandsNotFused
+func @dotOperandsNotFused(%a : tensor<4x2xf32>, %b : tensor<2x8xf32>, %bias : tensor<4x8xf32>) -> tensor<4x8xf32> {
+  // The ops producing the dot operands stay in their own region.
+  // FUSE: iree.dispatch_region
+  // FUSE-NEXT: xla_hlo.mul
+  // FUSE-NEXT: iree.return
+  // FUSE-NEXT: }
+  // FUSE: iree.dispatch_region
+  // FUSE-NEXT: "xla_hlo.dot"
+  // FUSE-NEXT: xla_hlo.add
+  // FUSE-NEXT: iree.return
+  // FUSE-NEXT: }
+  %0 = xla_hlo.mul %a, %a : tensor<4x2xf32>
+  %1 = "xla_hlo.dot"(%0, %b) : (tensor<4x2xf32>, tensor<2x8xf32>) -> tensor<4x8xf32>
+  %2 = xla_hlo.add %1, %bias : tensor<4x8xf32>
+  return %2 : tensor<4x8xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @multiUseDot
+// FUSE-LABEL: func @multiUseDot
+func @multiUseDot(%a : tensor<4x2xf32>, %b : tensor<2x8xf32>, %bias : tensor<4x8xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+  // The dot result escapes so the dot is dispatched alone in both modes.
+  // FUSE: [[P:%.+]] = iree.dispatch_region
+  // FUSE-NEXT: "xla_hlo.dot"
+  // FUSE-NEXT: iree.return
+  // FUSE-NEXT: }
+  // FUSE: [[R:%.+]] = iree.dispatch_region{{.+}}({{.+}} = [[P]] : tensor<4x8xf32>
+  // FUSE-NEXT: xla_hlo.add
+  // FUSE-NEXT: iree.return
+  // FUSE-NEXT: }
+  // FUSE-NEXT: return [[P]], [[R]]
+  %0 = "xla_hlo.dot"(%a, %b) : (tensor<4x2xf32>, tensor<2x8xf32>) -> tensor<4x8xf32>
+  %1 = xla_hlo.add %0, %bias : tensor<4x8xf32>
+  return %0, %1 : tensor<4x8xf32>, tensor<4x8xf32>
+}
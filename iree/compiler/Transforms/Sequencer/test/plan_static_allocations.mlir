@@ -0,0 +1,94 @@
+// RUN: iree-opt %s -iree-plan-static-allocations -split-input-file | FileCheck %s --dump-input=fail
+
+// CHECK-LABEL: func @overlappingLifetimes
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+func @overlappingLifetimes(%arg0 : memref<4xf32>) {
+  // CHECK-NEXT: [[ARENA:%.+]] = "iree_ll_seq.alloc_heap"() : () -> memref<128xi8>
+  // CHECK-NEXT: [[A0:%.+]] = "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 0 : i32} : (memref<128xi8>) -> memref<4xf32>
+  %0 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_fill"(%0) {value = 0 : i32, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>) -> ()
+  // CHECK: [[A1:%.+]] = "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 64 : i32} : (memref<128xi8>) -> memref<4xf32>
+  %1 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_copy"(%0, %1) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>, memref<4xf32>) -> ()
+  // %0 is dead by the time %2 is allocated and the memory is reused.
+  // CHECK: [[A2:%.+]] = "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 0 : i32} : (memref<128xi8>) -> memref<4xf32>
+  %2 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_copy"(%1, %2) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_seq.static_copy"(%2, %arg0) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>, memref<4xf32>) -> ()
+  // CHECK-NOT: iree_ll_seq.alloc_heap
+  // CHECK: iree_ll_seq.return
+  iree_ll_seq.return
+}
+
+// -----
+
+// CHECK-LABEL: func @disjointLifetimes
+func @disjointLifetimes(%arg0 : memref<4xf32>, %arg1 : memref<8xf32>) {
+  // The arena is sized to the largest allocation as none are live together.
+  // CHECK-NEXT: [[ARENA:%.+]] = "iree_ll_seq.alloc_heap"() : () -> memref<64xi8>
+  // CHECK-NEXT: "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 0 : i32} : (memref<64xi8>) -> memref<4xf32>
+  %0 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_fill"(%0) {value = 0 : i32, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>) -> ()
+  "iree_ll_seq.static_copy"(%0, %arg0) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>, memref<4xf32>) -> ()
+  // CHECK: "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 0 : i32} : (memref<64xi8>) -> memref<8xf32>
+  %1 = "iree_ll_seq.alloc_heap"() : () -> memref<8xf32>
+  "iree_ll_seq.static_fill"(%1) {value = 0 : i32, dstOffset = 0 : i64, length = 32 : i64} : (memref<8xf32>) -> ()
+  "iree_ll_seq.static_copy"(%1, %arg1) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 32 : i64} : (memref<8xf32>, memref<8xf32>) -> ()
+  // CHECK-NOT: iree_ll_seq.alloc_heap
+  // CHECK: iree_ll_seq.return
+  iree_ll_seq.return
+}
+
+// -----
+
+// CHECK-LABEL: func @aliasingOps
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+func @aliasingOps(%arg0 : memref<2x2xf32>, %shape : memref<2xi32>) {
+  // CHECK-NEXT: [[ARENA:%.+]] = "iree_ll_seq.alloc_heap"() : () -> memref<128xi8>
+  // CHECK-NEXT: [[A0:%.+]] = "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 0 : i32} : (memref<128xi8>) -> memref<4xf32>
+  %0 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_fill"(%0) {value = 0 : i32, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>) -> ()
+  // CHECK: [[R0:%.+]] = "iree_ll_seq.reshape"([[A0]], [[SHAPE]])
+  %1 = "iree_ll_seq.reshape"(%0, %shape) : (memref<4xf32>, memref<2xi32>) -> memref<2x2xf32>
+  // The reshape keeps %0 live until its last use below.
+  // CHECK: [[A1:%.+]] = "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 64 : i32} : (memref<128xi8>) -> memref<2x2xf32>
+  %2 = "iree_ll_seq.alloc_heap"() : () -> memref<2x2xf32>
+  "iree_ll_seq.static_copy"(%1, %2) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<2x2xf32>, memref<2x2xf32>) -> ()
+  "iree_ll_seq.static_copy"(%2, %arg0) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<2x2xf32>, memref<2x2xf32>) -> ()
+  // CHECK: iree_ll_seq.return
+  iree_ll_seq.return
+}
+
+// -----
+
+// CHECK-LABEL: func @escapingResult
+func @escapingResult() -> memref<4xf32> {
+  // Returned buffers must outlive the arena and are left as heap allocations.
+  // CHECK-NEXT: [[A0:%.+]] = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  // CHECK-NOT: iree_ll_seq.alloc_static
+  %0 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_fill"(%0) {value = 0 : i32, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>) -> ()
+  // CHECK: iree_ll_seq.return [[A0]] : memref<4xf32>
+  iree_ll_seq.return %0 : memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @escapingThroughAlias
+// CHECK-SAME: [[SHAPE:%[a-zA-Z0-9]+]]
+func @escapingThroughAlias(%shape : memref<2xi32>) -> memref<2x2xf32> {
+  // CHECK-NEXT: [[ARENA:%.+]] = "iree_ll_seq.alloc_heap"() : () -> memref<64xi8>
+  // CHECK-NEXT: [[A0:%.+]] = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  %0 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_fill"(%0) {value = 0 : i32, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>) -> ()
+  // CHECK: [[A1:%.+]] = "iree_ll_seq.alloc_static"([[ARENA]]) {offset = 0 : i32} : (memref<64xi8>) -> memref<4xf32>
+  %1 = "iree_ll_seq.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_seq.static_copy"(%0, %1) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_seq.static_copy"(%1, %0) {srcOffset = 0 : i64, dstOffset = 0 : i64, length = 16 : i64} : (memref<4xf32>, memref<4xf32>) -> ()
+  // %0 escapes via the reshape result being returned.
+  // CHECK: [[R0:%.+]] = "iree_ll_seq.reshape"([[A0]], [[SHAPE]])
+  %2 = "iree_ll_seq.reshape"(%0, %shape) : (memref<4xf32>, memref<2xi32>) -> memref<2x2xf32>
+  // CHECK: iree_ll_seq.return [[R0]] : memref<2x2xf32>
+  iree_ll_seq.return %2 : memref<2x2xf32>
+}
@@ -112,6 +112,18 @@ void buildInterpreterConversionPassPipeline(PassManager *passManager) {
   passManager->addPass(createCSEPass());
   passManager->addPass(createCanonicalizerPass());
 
+  // Keep quantized values quantized through adds and multiplies instead of
+  // converting them to float and back.
+  passManager->addPass(createFuseQuantizedOpsPass());
+
+  // Fuse matmuls with their bias and activation before the elementwise fusion
+  // would claim the add and max ops.
+  passManager->addPass(createFuseMatMulBiasOpsPass());
+
+  // Fuse the remaining chains of elementwise ops into single programs. This
+  // runs after CSE so that shared intermediates are not recomputed.
+  passManager->addPass(createFuseElementwiseOpsPass());
+
   // Drop all functions that are not reachable.
   passManager->addPass(createDropUnreachableExecutableFunctionsPass());
 }
@@ -252,7 +264,8 @@ LogicalResult InterpreterTranslator::declareFunction(
 LogicalResult InterpreterTranslator::defineFunction(
     FuncOp function, VMModuleBuilder *moduleBuilder) {
   VMFunctionBuilder functionBuilder(function, moduleBuilder->function_table(),
-                                    moduleBuilder->fbb());
+                                    moduleBuilder->fbb(),
+                                    moduleBuilder->constant_pool());
   registerInterpreterCustomWriters(&functionBuilder);
   RETURN_IF_FAILURE(functionBuilder.ConvertBytecode());
   auto functionOffset = functionBuilder.Finish();
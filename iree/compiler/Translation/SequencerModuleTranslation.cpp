@@ -87,7 +87,10 @@ void buildLegalizeInputPassPipeline(PassManager *passManager) {
 
 // Builds a pass pipeline that partitions the module into sequencer functions
 // and executables ready to be translated.
-void buildPartitioningPassPipeline(PassManager *passManager) {
+// |fuseMatMulEpilogues| must only be set if all target backends can execute
+// dots fused with their bias add and activation.
+void buildPartitioningPassPipeline(PassManager *passManager,
+                                   bool fuseMatMulEpilogues) {
   // Find reduction ops and create iree.reduction_regions. We do this prior to
   // performing dispatch region identification so that we can build as big of
   // fused reduction regions as possible. The remaining ops will be put into
@@ -96,7 +99,7 @@ void buildPartitioningPassPipeline(PassManager *passManager) {
   passManager->addPass(createCSEPass());
 
   // Create all of the dispatch regions, CSE their workloads, and fold.
-  passManager->addPass(createIdentifyDispatchRegionsPass());
+  passManager->addPass(createIdentifyDispatchRegionsPass(fuseMatMulEpilogues));
   passManager->addPass(createCSEPass());
   passManager->addPass(createFoldCompatibleDispatchRegionsPass());
 
@@ -168,6 +171,10 @@ void buildSequencerLoweringPassPipeline(PassManager *passManager) {
   passManager->addPass(createMemRefDataFlowOptPass());
   passManager->addPass(createAggressiveOpEliminationPass());
 
+  // Pack intermediate buffers into a single arena per function such that
+  // buffers with disjoint lifetimes share memory.
+  passManager->addPass(createPlanStaticAllocationsPass());
+
   // Assign ordinals used by the bytecode to reference executables and
   // functions.
   passManager->addPass(createAssignFunctionOrdinalsPass());
@@ -178,10 +185,9 @@ void buildSequencerLoweringPassPipeline(PassManager *passManager) {
   passManager->addPass(createAssignExecutableWorkloadAttrsPass());
 }
 
-// Inserts one or more iree.executable_target_config ops based on the
+// Returns the names of the executable translation backends selected by the
 // translation options.
-void insertTargetConfigOps(const ModuleTranslationOptions &options,
-                           OpBuilder *builder) {
+llvm::StringSet<> getTargetBackends(const ModuleTranslationOptions &options) {
   llvm::StringSet<> targetBackends;
   if (options.target_backends.empty()) {
     // Add all backends when none are explicitly provided.
@@ -195,7 +201,26 @@ void insertTargetConfigOps(const ModuleTranslationOptions &options,
       }
     }
   }
+  return targetBackends;
+}
+
+// Returns true if all selected backends can fuse dots with their epilogues.
+// Only the interpreter does so today; the SPIR-V backend substitutes a
+// standalone matmul kernel for any executable containing a dot.
+bool canFuseMatMulEpilogues(const ModuleTranslationOptions &options) {
+  auto targetBackends = getTargetBackends(options);
+  if (targetBackends.empty()) return false;
   for (auto &targetBackend : targetBackends) {
+    if (targetBackend.getKey() != "interpreter-bytecode") return false;
+  }
+  return true;
+}
+
+// Inserts one or more iree.executable_target_config ops based on the
+// translation options.
+void insertTargetConfigOps(const ModuleTranslationOptions &options,
+                           OpBuilder *builder) {
+  for (auto &targetBackend : getTargetBackends(options)) {
     builder->create<IREE::ExecutableTargetConfigOp>(builder->getUnknownLoc(),
                                                     targetBackend.getKey());
   }
@@ -227,7 +252,8 @@ std::vector<uint8_t> SequencerTranslator::translateModule(ModuleOp module) {
   // Run one large set of passes to get to a partitioned module.
   auto partitioningPasses = createPassManager(module.getContext(), options());
   buildLegalizeInputPassPipeline(partitioningPasses.get());
-  buildPartitioningPassPipeline(partitioningPasses.get());
+  buildPartitioningPassPipeline(partitioningPasses.get(),
+                                canFuseMatMulEpilogues(options()));
   if (failed(runPassPipeline(options(), partitioningPasses.get(), module))) {
     module.emitError() << "Failed to run partitioning passes";
     return {};
@@ -475,7 +501,8 @@ LogicalResult SequencerTranslator::declareFunction(
 LogicalResult SequencerTranslator::defineFunction(
     FuncOp function, VMModuleBuilder *moduleBuilder) {
   VMFunctionBuilder functionBuilder(function, moduleBuilder->function_table(),
-                                    moduleBuilder->fbb());
+                                    moduleBuilder->fbb(),
+                                    moduleBuilder->constant_pool());
   registerSequencerCustomWriters(&functionBuilder);
   RETURN_IF_FAILURE(functionBuilder.ConvertBytecode());
   auto functionOffset = functionBuilder.Finish();
@@ -322,6 +322,14 @@ class Buffer : public Resource {
   constexpr device_size_t byte_offset() const noexcept { return byte_offset_; }
   constexpr device_size_t byte_length() const noexcept { return byte_length_; }
 
+  // Returns a pointer to the contents of the buffer if they reside in
+  // persistently mapped host memory (such as a HostBuffer) that allows
+  // |memory_access|, or nullptr if the buffer must be mapped with MapMemory.
+  // The pointer is valid for byte_length() bytes for as long as the buffer is
+  // alive. This lets hot paths skip the validation and bookkeeping of a
+  // MappedMemory when mapping would be a no-op.
+  void* host_data(MemoryAccessBitfield memory_access) const noexcept;
+
   // TODO(benvanik): add debug_name.
 
   // Returns a longer debug string describing the buffer and its attributes.
@@ -449,6 +457,13 @@ class Buffer : public Resource {
     allowed_access_ = allowed_access;
   }
 
+  // Marks the allocation as persistently mapped at |host_data| such that
+  // host_data() may bypass MapMemory. Only valid when mapping needs no work
+  // beyond returning a pointer into this memory.
+  void set_host_data(void* host_data) {
+    host_data_ = static_cast<uint8_t*>(host_data);
+  }
+
   // Sets a range of the buffer to the given value.
   // State and parameters have already been validated. For the >8bit variants
   // the offset and length have already been validated to be aligned to the
@@ -594,6 +609,10 @@ class Buffer : public Resource {
   device_size_t byte_offset_ = 0;
   device_size_t byte_length_ = 0;
 
+  // Base of the allocation in host memory if it is persistently mapped.
+  // Only set on allocated buffers; see host_data().
+  uint8_t* host_data_ = nullptr;
+
 #if HAS_IREE_BUFFER_DEBUG_NAME
   // Friendly name for the buffer used in DebugString. May be set by the app or
   // auto generated.
@@ -694,6 +713,17 @@ class MappedMemory {
 
 // Inline functions and template definitions follow:
 
+inline void* Buffer::host_data(
+    MemoryAccessBitfield memory_access) const noexcept {
+  uint8_t* data = allocated_buffer_->host_data_;
+  if (!data || (allowed_access_ & memory_access) != memory_access ||
+      !AnyBitSet(memory_type_ & MemoryType::kHostVisible) ||
+      !AnyBitSet(usage_ & BufferUsage::kMapping)) {
+    return nullptr;
+  }
+  return data + byte_offset_;
+}
+
 template <typename T>
 Status Buffer::Fill8(device_size_t byte_offset, device_size_t byte_length,
                      T value) {
@@ -995,6 +995,33 @@ TEST(BufferTest, MapMemorySubspan) {
   EXPECT_OK(mapping.Flush());
 }
 
+TEST(BufferTest, HostData) {
+  std::vector<uint8_t> src_data = {0, 1, 2, 3, 4, 5, 6};
+  auto buffer = HeapBuffer::AllocateCopy(
+      BufferUsage::kTransfer | BufferUsage::kMapping, MemoryAccess::kRead,
+      src_data.data(), src_data.size());
+  ASSERT_TRUE(buffer);
+
+  // Host buffers expose their memory directly for the allowed access.
+  auto* data = static_cast<uint8_t*>(buffer->host_data(MemoryAccess::kRead));
+  ASSERT_NE(nullptr, data);
+  EXPECT_THAT(absl::MakeConstSpan(data, src_data.size()),
+              ElementsAre(0, 1, 2, 3, 4, 5, 6));
+  EXPECT_EQ(nullptr, buffer->host_data(MemoryAccess::kDiscardWrite));
+
+  // Subspans point into the allocation.
+  ASSERT_OK_AND_ASSIGN(auto subspan_buffer, Buffer::Subspan(buffer, 2, 3));
+  EXPECT_EQ(data + 2, subspan_buffer->host_data(MemoryAccess::kRead));
+
+  // Buffers that cannot be mapped must go through MapMemory (and fail).
+  auto transfer_buffer = HeapBuffer::Allocate(BufferUsage::kTransfer, 4);
+  EXPECT_EQ(nullptr, transfer_buffer->host_data(MemoryAccess::kRead));
+  auto device_buffer =
+      HeapBuffer::Wrap(MemoryType::kDeviceLocal, BufferUsage::kAll,
+                       absl::MakeConstSpan(src_data));
+  EXPECT_EQ(nullptr, device_buffer->host_data(MemoryAccess::kRead));
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
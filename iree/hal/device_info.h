@@ -61,10 +61,11 @@ using DeviceFeatureBitfield = DeviceFeature;
 class DeviceInfo {
  public:
   DeviceInfo(std::string name, DeviceFeatureBitfield supported_features,
-             void* driver_handle = nullptr)
+             void* driver_handle = nullptr, int numa_node = -1)
       : name_(std::move(name)),
         supported_features_(supported_features),
-        driver_handle_(driver_handle) {}
+        driver_handle_(driver_handle),
+        numa_node_(numa_node) {}
 
   const std::string& name() const { return name_; }
 
@@ -78,10 +79,16 @@ class DeviceInfo {
   // of the current process.
   void* driver_handle() const { return driver_handle_; }
 
+  // NUMA node the device is local to or -1 if unknown. Drivers that bind
+  // their threads and memory to a node report it here so that placement can
+  // keep work near the memory it touches.
+  int numa_node() const { return numa_node_; }
+
  private:
   const std::string name_;
   const DeviceFeatureBitfield supported_features_;
   void* driver_handle_;
+  int numa_node_;
 };
 
 }  // namespace hal
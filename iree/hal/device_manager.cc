@@ -31,11 +31,13 @@ DeviceManager::~DeviceManager() = default;
 Status DeviceManager::RegisterDevice(std::shared_ptr<Device> device) {
   IREE_TRACE_SCOPE0("DeviceManager::RegisterDevice");
   absl::MutexLock lock(&device_mutex_);
-  if (std::find(devices_.begin(), devices_.end(), device) != devices_.end()) {
+  if (FindDevice(device.get())) {
     return FailedPreconditionErrorBuilder(IREE_LOC)
            << "Device already registered";
   }
-  devices_.push_back(std::move(device));
+  RegisteredDevice registered_device;
+  registered_device.device = std::move(device);
+  devices_.push_back(std::move(registered_device));
   return OkStatus();
 }
 
@@ -43,8 +45,8 @@ Status DeviceManager::UnregisterDevice(Device* device) {
   IREE_TRACE_SCOPE0("DeviceManager::UnregisterDevice");
   absl::MutexLock lock(&device_mutex_);
   auto it = std::find_if(devices_.begin(), devices_.end(),
-                         [device](const std::shared_ptr<Device>& other_device) {
-                           return device == other_device.get();
+                         [device](const RegisteredDevice& registered_device) {
+                           return device == registered_device.device.get();
                          });
   if (it == devices_.end()) {
     return NotFoundErrorBuilder(IREE_LOC) << "Device not registered";
@@ -53,23 +55,87 @@ Status DeviceManager::UnregisterDevice(Device* device) {
   return OkStatus();
 }
 
+DeviceManager::RegisteredDevice* DeviceManager::FindDevice(Device* device) {
+  for (auto& registered_device : devices_) {
+    if (registered_device.device.get() == device) return &registered_device;
+  }
+  return nullptr;
+}
+
 StatusOr<DevicePlacement> DeviceManager::ResolvePlacement(
-    const PlacementSpec& placement_spec) const {
+    const PlacementSpec& placement_spec) {
   IREE_TRACE_SCOPE0("DeviceManager::ResolvePlacement");
   absl::MutexLock lock(&device_mutex_);
   if (devices_.empty()) {
     return NotFoundErrorBuilder(IREE_LOC) << "No devices registered";
   }
 
-  // TODO(benvanik): multiple devices and placement.
-  QCHECK_EQ(devices_.size(), 1)
-      << "Multiple devices not yet supported (need placement)";
-  DevicePlacement device_placement;
-  device_placement.device = devices_.front();
+  // Only consider devices local to the requested NUMA node if there are any.
+  bool match_numa_node = false;
+  if (placement_spec.numa_node >= 0) {
+    for (const auto& registered_device : devices_) {
+      if (registered_device.device->info().numa_node() ==
+          placement_spec.numa_node) {
+        match_numa_node = true;
+        break;
+      }
+    }
+  }
+
+  // Walk the candidates in round-robin order starting at the cursor. The
+  // first candidate wins for kRoundRobin and the first with the fewest
+  // outstanding placements wins for kLeastLoaded.
+  size_t device_count = devices_.size();
+  size_t selected_index = device_count;
+  for (size_t i = 0; i < device_count; ++i) {
+    size_t index = (next_device_index_ + i) % device_count;
+    const auto& registered_device = devices_[index];
+    if (match_numa_node && registered_device.device->info().numa_node() !=
+                               placement_spec.numa_node) {
+      continue;
+    }
+    if (selected_index == device_count) {
+      selected_index = index;
+      if (placement_spec.policy == PlacementPolicy::kRoundRobin) break;
+    } else if (registered_device.load.outstanding_placements <
+               devices_[selected_index].load.outstanding_placements) {
+      selected_index = index;
+    }
+  }
+  next_device_index_ = (selected_index + 1) % device_count;
 
+  auto& registered_device = devices_[selected_index];
+  ++registered_device.load.outstanding_placements;
+  ++registered_device.load.total_placements;
+
+  DevicePlacement device_placement;
+  device_placement.device = registered_device.device;
+  int queue_count = registered_device.device->dispatch_queues().size();
+  if (queue_count > 1) {
+    device_placement.queue_id = registered_device.next_queue_id % queue_count;
+    registered_device.next_queue_id =
+        (device_placement.queue_id + 1) % queue_count;
+  }
   return device_placement;
 }
 
+void DeviceManager::ReleasePlacement(const DevicePlacement& device_placement) {
+  absl::MutexLock lock(&device_mutex_);
+  auto* registered_device = FindDevice(device_placement.device.get());
+  if (registered_device) {
+    DCHECK_GT(registered_device->load.outstanding_placements, 0);
+    --registered_device->load.outstanding_placements;
+  }
+}
+
+StatusOr<DeviceLoad> DeviceManager::QueryDeviceLoad(Device* device) const {
+  absl::MutexLock lock(&device_mutex_);
+  for (const auto& registered_device : devices_) {
+    if (registered_device.device.get() == device) return registered_device.load;
+  }
+  return NotFoundErrorBuilder(IREE_LOC) << "Device not registered";
+}
+
 StatusOr<Allocator*> DeviceManager::FindCompatibleAllocator(
     MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
     absl::Span<const DevicePlacement> device_placements) const {
@@ -15,6 +15,8 @@
 #ifndef IREE_HAL_DEVICE_MANAGER_H_
 #define IREE_HAL_DEVICE_MANAGER_H_
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
@@ -29,6 +31,15 @@
 namespace iree {
 namespace hal {
 
+// Selects among the registered devices that satisfy a PlacementSpec.
+enum class PlacementPolicy {
+  // Cycles through the devices on each resolution.
+  kRoundRobin,
+  // Picks the device with the fewest outstanding placements, breaking ties in
+  // round-robin order.
+  kLeastLoaded,
+};
+
 // Specifies how devices should be resolved to DevicePlacements.
 // Most fields are optional and when not included will be ignored.
 struct PlacementSpec {
@@ -39,6 +50,21 @@ struct PlacementSpec {
   // will be considered for placement. The formats can be sorted in descending
   // priority order to prefer the first available format in the case of ties.
   absl::Span<const ExecutableFormat> available_formats;
+
+  // Policy used to choose between the candidate devices.
+  PlacementPolicy policy = PlacementPolicy::kRoundRobin;
+
+  // Preferred NUMA node (see DeviceInfo::numa_node) or -1 for no preference.
+  // Devices on other nodes are only chosen if none are local to the node.
+  int numa_node = -1;
+};
+
+// Load counters tracked per registered device.
+struct DeviceLoad {
+  // Placements resolved to the device that have not yet been released.
+  int64_t outstanding_placements = 0;
+  // Total placements resolved to the device since it was registered.
+  int64_t total_placements = 0;
 };
 
 // Manages device lifetime and placement resolution.
@@ -69,8 +95,19 @@ class DeviceManager final {
   // If the placement is not fully specified the device and queue may be chosen
   // at random. See PlacementSpec for more information about resolution and
   // ranking.
+  //
+  // The placement counts as outstanding load on its device until it is passed
+  // to ReleasePlacement.
   StatusOr<DevicePlacement> ResolvePlacement(
-      const PlacementSpec& placement_spec) const;
+      const PlacementSpec& placement_spec);
+
+  // Releases a placement returned by ResolvePlacement once the work submitted
+  // with it has completed. Placements on devices that have since been
+  // unregistered are ignored.
+  void ReleasePlacement(const DevicePlacement& device_placement);
+
+  // Returns the current load counters of a registered |device|.
+  StatusOr<DeviceLoad> QueryDeviceLoad(Device* device) const;
 
   // Finds an allocator that can allocate buffers of the given |memory_type| and
   // |buffer_usage| such that the buffers can be used interchangebly.
@@ -140,8 +177,24 @@ class DeviceManager final {
   }
 
  private:
+  struct RegisteredDevice {
+    std::shared_ptr<Device> device;
+    DeviceLoad load;
+    // Dispatch queue assigned to the next placement on the device. Placements
+    // are spread round-robin across the queues so that independent callers
+    // execute concurrently.
+    int next_queue_id = 0;
+  };
+
+  // Returns the registered device entry for |device| or nullptr.
+  RegisteredDevice* FindDevice(Device* device)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(device_mutex_);
+
   mutable absl::Mutex device_mutex_;
-  std::vector<std::shared_ptr<Device>> devices_ ABSL_GUARDED_BY(device_mutex_);
+  std::vector<RegisteredDevice> devices_ ABSL_GUARDED_BY(device_mutex_);
+
+  // Index into |devices_| at which the next round-robin search starts.
+  size_t next_device_index_ ABSL_GUARDED_BY(device_mutex_) = 0;
 };
 
 }  // namespace hal
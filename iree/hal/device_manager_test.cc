@@ -0,0 +1,164 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/device_manager.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/command_queue.h"
+#include "iree/hal/device_info.h"
+#include "iree/hal/testing/mock_device.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::hal::testing::MockDevice;
+using ::testing::Return;
+
+class DeviceManagerTest : public ::testing::Test {
+ protected:
+  // Registers a device with two dispatch queues on |numa_node|.
+  Device* AddDevice(int numa_node = -1) {
+    auto device = std::make_shared<MockDevice>(
+        DeviceInfo(absl::StrCat("mock", devices_.size()), DeviceFeature::kNone,
+                   /*driver_handle=*/nullptr, numa_node));
+    EXPECT_CALL(*device, dispatch_queues())
+        .WillRepeatedly(Return(absl::MakeSpan(queues_)));
+    devices_.push_back(device);
+    CHECK_OK(device_manager_.RegisterDevice(device));
+    return device.get();
+  }
+
+  // Resolves a placement and returns the device it was placed on.
+  Device* Resolve(const PlacementSpec& placement_spec,
+                  std::vector<DevicePlacement>* placements = nullptr) {
+    auto placement_or = device_manager_.ResolvePlacement(placement_spec);
+    EXPECT_OK(placement_or.status());
+    if (!placement_or.ok()) return nullptr;
+    auto placement = std::move(placement_or).ValueOrDie();
+    if (placements) placements->push_back(placement);
+    return placement.device.get();
+  }
+
+  int64_t OutstandingPlacements(Device* device) {
+    return device_manager_.QueryDeviceLoad(device)
+        .ValueOrDie()
+        .outstanding_placements;
+  }
+
+  std::vector<CommandQueue*> queues_ = {nullptr, nullptr};
+  std::vector<std::shared_ptr<MockDevice>> devices_;
+  DeviceManager device_manager_;
+};
+
+TEST_F(DeviceManagerTest, NoDevices) {
+  EXPECT_TRUE(IsNotFound(device_manager_.ResolvePlacement({}).status()));
+}
+
+TEST_F(DeviceManagerTest, DuplicateRegistration) {
+  AddDevice();
+  EXPECT_TRUE(
+      IsFailedPrecondition(device_manager_.RegisterDevice(devices_[0])));
+}
+
+TEST_F(DeviceManagerTest, RoundRobin) {
+  auto* device_0 = AddDevice();
+  auto* device_1 = AddDevice();
+  auto* device_2 = AddDevice();
+  PlacementSpec placement_spec;
+  placement_spec.policy = PlacementPolicy::kRoundRobin;
+  std::vector<DevicePlacement> placements;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(device_0, Resolve(placement_spec, &placements));
+    EXPECT_EQ(device_1, Resolve(placement_spec, &placements));
+    EXPECT_EQ(device_2, Resolve(placement_spec, &placements));
+  }
+
+  // Queues are assigned round-robin within each device.
+  EXPECT_EQ(0, placements[0].queue_id);
+  EXPECT_EQ(1, placements[3].queue_id);
+
+  EXPECT_EQ(2, OutstandingPlacements(device_0));
+  for (const auto& placement : placements) {
+    device_manager_.ReleasePlacement(placement);
+  }
+  ASSERT_OK_AND_ASSIGN(auto load, device_manager_.QueryDeviceLoad(device_0));
+  EXPECT_EQ(0, load.outstanding_placements);
+  EXPECT_EQ(2, load.total_placements);
+}
+
+TEST_F(DeviceManagerTest, LeastLoaded) {
+  auto* device_0 = AddDevice();
+  auto* device_1 = AddDevice();
+  auto* device_2 = AddDevice();
+  PlacementSpec placement_spec;
+  placement_spec.policy = PlacementPolicy::kLeastLoaded;
+  std::vector<DevicePlacement> placements;
+  EXPECT_EQ(device_0, Resolve(placement_spec, &placements));
+  EXPECT_EQ(device_1, Resolve(placement_spec, &placements));
+  EXPECT_EQ(device_2, Resolve(placement_spec, &placements));
+
+  // Releasing the placement on device 1 makes it the least loaded device even
+  // though round-robin order would pick device 0 next.
+  device_manager_.ReleasePlacement(placements[1]);
+  EXPECT_EQ(0, OutstandingPlacements(device_1));
+  EXPECT_EQ(device_1, Resolve(placement_spec, &placements));
+
+  // All devices are equally loaded again so ties continue after device 1.
+  EXPECT_EQ(device_2, Resolve(placement_spec, &placements));
+  EXPECT_EQ(2, OutstandingPlacements(device_2));
+  EXPECT_EQ(device_0, Resolve(placement_spec, &placements));
+  EXPECT_EQ(device_1, Resolve(placement_spec, &placements));
+}
+
+TEST_F(DeviceManagerTest, ReleaseAfterUnregister) {
+  auto* device = AddDevice();
+  std::vector<DevicePlacement> placements;
+  EXPECT_EQ(device, Resolve({}, &placements));
+  EXPECT_OK(device_manager_.UnregisterDevice(device));
+  device_manager_.ReleasePlacement(placements[0]);
+  EXPECT_TRUE(IsNotFound(device_manager_.QueryDeviceLoad(device).status()));
+}
+
+TEST_F(DeviceManagerTest, NumaNodeFiltering) {
+  auto* device_0 = AddDevice(/*numa_node=*/0);
+  auto* device_1 = AddDevice(/*numa_node=*/1);
+  auto* device_2 = AddDevice(/*numa_node=*/1);
+  PlacementSpec placement_spec;
+  placement_spec.numa_node = 1;
+  EXPECT_EQ(device_1, Resolve(placement_spec));
+  EXPECT_EQ(device_2, Resolve(placement_spec));
+  EXPECT_EQ(device_1, Resolve(placement_spec));
+
+  placement_spec.policy = PlacementPolicy::kLeastLoaded;
+  EXPECT_EQ(device_2, Resolve(placement_spec));
+  EXPECT_EQ(0, OutstandingPlacements(device_0));
+
+  // Devices on other nodes are used when none are local to the node.
+  placement_spec.numa_node = 3;
+  placement_spec.policy = PlacementPolicy::kRoundRobin;
+  EXPECT_NE(nullptr, Resolve(placement_spec));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -25,6 +25,7 @@ class Device;
 // TODO(benvanik): define device-specific placement info - possibly opaque.
 struct DevicePlacement {
   std::shared_ptr<Device> device;
+  // Index into the device's dispatch_queues() that work should be submitted to.
   int queue_id = 0;
 };
 
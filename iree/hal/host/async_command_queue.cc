@@ -14,6 +14,8 @@
 
 #include "iree/hal/host/async_command_queue.h"
 
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
@@ -37,6 +39,7 @@ AsyncCommandQueue::~AsyncCommandQueue() {
     absl::MutexLock lock(&submission_mutex_);
     submission_queue_.SignalShutdown();
   }
+  submission_event_.Set().IgnoreError();
   thread_.join();
 
   // Ensure we shut down OK.
@@ -61,6 +64,9 @@ void AsyncCommandQueue::ThreadMain() {
           return queue->has_shutdown() || !queue->empty();
         },
         &submission_queue_));
+    // Reset before processing so that any submission racing with us either
+    // gets processed below or sets the event again.
+    submission_event_.Reset().IgnoreError();
     if (!submission_queue_.empty()) {
       // Run all ready submissions (this may be called many times).
       submission_mutex_.AssertHeld();
@@ -93,15 +99,37 @@ void AsyncCommandQueue::ThreadMain() {
       // requested (or we errored out).
       is_exiting = true;
     }
+
+    // If work remains it is blocked on semaphores. Sleep until one of the
+    // timeline values it needs is reached or a new submission arrives instead
+    // of spinning on the lock. Binary semaphores have no wait handle so we can
+    // only poll for those.
+    std::vector<WaitHandle> wait_handles;
+    bool can_block = !is_exiting && !submission_queue_.empty() &&
+                     submission_queue_.permanent_error().ok() &&
+                     submission_queue_.GatherWaitHandles(&wait_handles);
     submission_mutex_.Unlock();
+    if (can_block) {
+      IREE_TRACE_SCOPE0("AsyncCommandQueue::ThreadMain:Wait");
+      wait_handles.push_back(submission_event_.OnSet());
+      std::vector<WaitHandle*> wait_handle_ptrs;
+      wait_handle_ptrs.reserve(wait_handles.size());
+      for (auto& wait_handle : wait_handles) {
+        wait_handle_ptrs.push_back(&wait_handle);
+      }
+      WaitHandle::WaitAny(absl::MakeSpan(wait_handle_ptrs)).IgnoreError();
+    }
   }
 }
 
 Status AsyncCommandQueue::Submit(absl::Span<const SubmissionBatch> batches,
                                  FenceValue fence) {
   IREE_TRACE_SCOPE0("AsyncCommandQueue::Submit");
-  absl::MutexLock lock(&submission_mutex_);
-  return submission_queue_.Enqueue(batches, fence);
+  {
+    absl::MutexLock lock(&submission_mutex_);
+    RETURN_IF_ERROR(submission_queue_.Enqueue(batches, fence));
+  }
+  return submission_event_.Set();
 }
 
 Status AsyncCommandQueue::Flush() {
@@ -20,6 +20,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "iree/base/wait_handle.h"
 #include "iree/hal/command_queue.h"
 #include "iree/hal/fence.h"
 #include "iree/hal/host/host_submission_queue.h"
@@ -64,6 +65,11 @@ class AsyncCommandQueue final : public CommandQueue {
   // Queue that manages submission ordering.
   mutable absl::Mutex submission_mutex_;
   HostSubmissionQueue submission_queue_ ABSL_GUARDED_BY(submission_mutex_);
+
+  // Set when new submissions are enqueued or shutdown is requested. The worker
+  // waits on this together with the timeline semaphores its pending batches
+  // are blocked on.
+  ManualResetEvent submission_event_{"AsyncCommandQueueSubmission"};
 };
 
 }  // namespace hal
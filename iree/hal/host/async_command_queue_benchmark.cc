@@ -0,0 +1,101 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the overhead AsyncCommandQueue adds to each submission: the time
+// from Submit to the fence being signaled when the target queue does no work.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/status.h"
+#include "iree/hal/command_queue.h"
+#include "iree/hal/host/async_command_queue.h"
+#include "iree/hal/host/host_fence.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// A CommandQueue that retires all submissions immediately.
+class NullCommandQueue final : public CommandQueue {
+ public:
+  NullCommandQueue()
+      : CommandQueue("null",
+                     CommandCategory::kTransfer | CommandCategory::kDispatch) {}
+
+  Status Submit(absl::Span<const SubmissionBatch> batches,
+                FenceValue fence) override {
+    return OkStatus();
+  }
+  Status Flush() override { return OkStatus(); }
+  Status WaitIdle(absl::Time deadline) override { return OkStatus(); }
+};
+
+// Submits a single batch and waits for its fence each iteration.
+void BM_SubmitToFenceLatency(benchmark::State& state) {
+  AsyncCommandQueue command_queue(absl::make_unique<NullCommandQueue>());
+  HostFence fence(0u);
+  uint64_t fence_value = 0;
+  for (auto _ : state) {
+    ++fence_value;
+    auto status = command_queue.Submit({{}, {}, {}}, {&fence, fence_value});
+    if (status.ok()) {
+      status = HostFence::WaitForFences({{&fence, fence_value}},
+                                        /*wait_all=*/true,
+                                        absl::InfiniteFuture());
+    }
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SubmitToFenceLatency)->UseRealTime();
+
+// Submits state.range(0) batches back-to-back and waits for the last fence
+// each iteration.
+void BM_SubmitThroughput(benchmark::State& state) {
+  AsyncCommandQueue command_queue(absl::make_unique<NullCommandQueue>());
+  HostFence fence(0u);
+  uint64_t fence_value = 0;
+  for (auto _ : state) {
+    Status status;
+    for (int i = 0; i < state.range(0) && status.ok(); ++i) {
+      ++fence_value;
+      status = command_queue.Submit({{}, {}, {}}, {&fence, fence_value});
+    }
+    if (status.ok()) {
+      status = HostFence::WaitForFences({{&fence, fence_value}},
+                                        /*wait_all=*/true,
+                                        absl::InfiniteFuture());
+    }
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SubmitThroughput)->Arg(8)->Arg(64)->UseRealTime();
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
+
+BENCHMARK_MAIN();
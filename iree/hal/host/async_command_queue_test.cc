@@ -23,6 +23,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "iree/base/status.h"
 #include "iree/base/status_matchers.h"
@@ -230,6 +231,68 @@ TEST_F(AsyncCommandQueueTest, FailuresCascadeAcrossSubmits) {
   EXPECT_TRUE(IsDataLoss(command_queue->WaitIdle()));
 }
 
+// Tests that a submission waiting on a timeline value signaled from the host
+// is run once the value is reached.
+TEST_F(AsyncCommandQueueTest, WaitsForHostTimelineSignal) {
+  ::testing::InSequence sequence;
+
+  auto cmd_buffer = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+
+  EXPECT_CALL(*mock_target_queue, Submit(_, _))
+      .WillOnce(
+          [&](absl::Span<const SubmissionBatch> batches, FenceValue fence) {
+            CHECK_EQ(1, batches.size());
+            CHECK_EQ(cmd_buffer.get(), batches[0].command_buffers[0]);
+            return OkStatus();
+          });
+
+  HostTimelineSemaphore semaphore(0u);
+  SemaphoreValue wait_1 =
+      std::make_pair(static_cast<TimelineSemaphore*>(&semaphore), 1ull);
+  SemaphoreValue signal_2 =
+      std::make_pair(static_cast<TimelineSemaphore*>(&semaphore), 2ull);
+  HostFence fence(0u);
+  ASSERT_OK(command_queue->Submit({{wait_1}, {cmd_buffer.get()}, {signal_2}},
+                                  {&fence, 1u}));
+
+  // The worker should be parked on the semaphore.
+  EXPECT_TRUE(IsDeadlineExceeded(
+      command_queue->WaitIdle(absl::Now() + absl::Milliseconds(10))));
+
+  ASSERT_OK(semaphore.Signal(1u));
+  ASSERT_OK(semaphore.Wait(2u, absl::InfiniteFuture()));
+  ASSERT_OK(HostFence::WaitForFences({{&fence, 1u}}, /*wait_all=*/true,
+                                     absl::InfiniteFuture()));
+  ASSERT_OK(command_queue->WaitIdle());
+}
+
+// Tests that a chain of submissions linked only by timeline values (and
+// without fences) runs to completion.
+TEST_F(AsyncCommandQueueTest, TimelineChainWithoutFences) {
+  constexpr int kSubmissionCount = 8;
+  auto cmd_buffer = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  EXPECT_CALL(*mock_target_queue, Submit(_, _))
+      .Times(kSubmissionCount)
+      .WillRepeatedly(
+          [](absl::Span<const SubmissionBatch> batches, FenceValue fence) {
+            return OkStatus();
+          });
+
+  HostTimelineSemaphore semaphore(0u);
+  for (uint64_t i = 0; i < kSubmissionCount; ++i) {
+    SemaphoreValue wait_value =
+        std::make_pair(static_cast<TimelineSemaphore*>(&semaphore), i);
+    SemaphoreValue signal_value =
+        std::make_pair(static_cast<TimelineSemaphore*>(&semaphore), i + 1);
+    ASSERT_OK(command_queue->Submit(
+        {{wait_value}, {cmd_buffer.get()}, {signal_value}}, {nullptr, 0u}));
+  }
+  ASSERT_OK(semaphore.Wait(kSubmissionCount, absl::InfiniteFuture()));
+  ASSERT_OK(command_queue->WaitIdle());
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -34,7 +34,9 @@ HostBuffer::HostBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
     : Buffer(allocator, memory_type, allowed_access, usage, allocation_size, 0,
              allocation_size),
       data_(data),
-      owns_data_(owns_data) {}
+      owns_data_(owns_data) {
+  set_host_data(data_);
+}
 
 HostBuffer::~HostBuffer() {
   if (owns_data_ && data_) {
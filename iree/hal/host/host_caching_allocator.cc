@@ -0,0 +1,216 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_caching_allocator.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/source_location.h"
+#include "iree/base/status.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/host/host_buffer.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+// Smallest size class; smaller allocations are rounded up to this.
+constexpr int kMinSizeClassShift = 6;
+constexpr int kSizeClassCount = 64;
+
+// Returns the size class (log2 of the block size) used for |allocation_size|.
+int SizeClassForAllocationSize(size_t allocation_size) {
+  int shift = kMinSizeClassShift;
+  while ((size_t{1} << shift) < allocation_size) ++shift;
+  return shift;
+}
+
+}  // namespace
+
+// Free lists of cached blocks, one per size class.
+// Shared with all outstanding buffers such that they can release their blocks
+// after the allocator has been destroyed.
+class HostCachingAllocator::BlockCache {
+ public:
+  explicit BlockCache(size_t max_retained_bytes)
+      : max_retained_bytes_(max_retained_bytes) {}
+
+  ~BlockCache() { Trim(0); }
+
+  // Returns a cached block of the given size class or nullptr if none are
+  // available.
+  void* Acquire(int size_class) {
+    absl::MutexLock lock(&mutex_);
+    auto& free_list = free_lists_[size_class];
+    if (free_list.empty()) {
+      ++stats_.misses;
+      return nullptr;
+    }
+    void* data = free_list.back();
+    free_list.pop_back();
+    --stats_.retained_blocks;
+    stats_.retained_bytes -= size_t{1} << size_class;
+    ++stats_.hits;
+    return data;
+  }
+
+  // Returns |data| to the cache or to the system if the cache is full or the
+  // allocator has been destroyed.
+  void Release(int size_class, void* data) {
+    size_t block_size = size_t{1} << size_class;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (stats_.retained_bytes + block_size <= max_retained_bytes_) {
+        free_lists_[size_class].push_back(data);
+        ++stats_.retained_blocks;
+        stats_.retained_bytes += block_size;
+        return;
+      }
+    }
+    std::free(data);
+  }
+
+  Stats stats() const {
+    absl::MutexLock lock(&mutex_);
+    return stats_;
+  }
+
+  void Trim(size_t max_retained_bytes) {
+    std::vector<void*> blocks;
+    {
+      absl::MutexLock lock(&mutex_);
+      for (int size_class = kSizeClassCount - 1;
+           size_class >= kMinSizeClassShift &&
+           stats_.retained_bytes > max_retained_bytes;
+           --size_class) {
+        auto& free_list = free_lists_[size_class];
+        while (!free_list.empty() &&
+               stats_.retained_bytes > max_retained_bytes) {
+          blocks.push_back(free_list.back());
+          free_list.pop_back();
+          --stats_.retained_blocks;
+          stats_.retained_bytes -= size_t{1} << size_class;
+        }
+      }
+    }
+    for (void* data : blocks) {
+      std::free(data);
+    }
+  }
+
+  // Stops caching released blocks; used when the allocator is destroyed.
+  void Close() {
+    {
+      absl::MutexLock lock(&mutex_);
+      max_retained_bytes_ = 0;
+    }
+    Trim(0);
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  size_t max_retained_bytes_ ABSL_GUARDED_BY(mutex_);
+  std::array<std::vector<void*>, kSizeClassCount> free_lists_
+      ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+// A HostBuffer whose memory is returned to the block cache when the buffer is
+// destroyed.
+class HostCachingAllocator::CachedBuffer final : public HostBuffer {
+ public:
+  CachedBuffer(HostCachingAllocator* allocator,
+               std::shared_ptr<BlockCache> block_cache,
+               MemoryTypeBitfield memory_type, BufferUsageBitfield usage,
+               device_size_t allocation_size, int size_class, void* data)
+      : HostBuffer(allocator, memory_type, MemoryAccess::kAll, usage,
+                   allocation_size, data, /*owns_data=*/false),
+        block_cache_(std::move(block_cache)),
+        size_class_(size_class),
+        data_(data) {}
+
+  ~CachedBuffer() override { block_cache_->Release(size_class_, data_); }
+
+ private:
+  std::shared_ptr<BlockCache> block_cache_;
+  int size_class_;
+  void* data_;
+};
+
+HostCachingAllocator::HostCachingAllocator()
+    : HostCachingAllocator(Options{}) {}
+
+HostCachingAllocator::HostCachingAllocator(Options options)
+    : options_(options),
+      block_cache_(std::make_shared<BlockCache>(options.max_retained_bytes)) {}
+
+HostCachingAllocator::~HostCachingAllocator() { block_cache_->Close(); }
+
+StatusOr<ref_ptr<Buffer>> HostCachingAllocator::Allocate(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+    size_t allocation_size) {
+  IREE_TRACE_SCOPE0("HostCachingAllocator::Allocate");
+
+  if (allocation_size > options_.max_cached_allocation_size) {
+    return HostLocalAllocator::Allocate(memory_type, buffer_usage,
+                                        allocation_size);
+  }
+
+  if (!CanAllocate(memory_type, buffer_usage, allocation_size)) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Allocation not supported; memory_type="
+           << MemoryTypeString(memory_type)
+           << ", buffer_usage=" << BufferUsageString(buffer_usage)
+           << ", allocation_size=" << allocation_size;
+  }
+
+  // Make compatible with our requirements.
+  RETURN_IF_ERROR(MakeCompatible(&memory_type, &buffer_usage));
+
+  int size_class = SizeClassForAllocationSize(allocation_size);
+  void* data = block_cache_->Acquire(size_class);
+  if (!data) {
+    size_t block_size = size_t{1} << size_class;
+    data = std::malloc(block_size);
+    if (!data) {
+      return ResourceExhaustedErrorBuilder(IREE_LOC)
+             << "Failed to malloc " << block_size << " bytes";
+    }
+  }
+  if (options_.zero_on_allocate) {
+    std::memset(data, 0, allocation_size);
+  }
+
+  return make_ref<CachedBuffer>(this, block_cache_, memory_type, buffer_usage,
+                                allocation_size, size_class, data);
+}
+
+HostCachingAllocator::Stats HostCachingAllocator::stats() const {
+  return block_cache_->stats();
+}
+
+void HostCachingAllocator::Trim(size_t max_retained_bytes) {
+  IREE_TRACE_SCOPE0("HostCachingAllocator::Trim");
+  block_cache_->Trim(max_retained_bytes);
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,90 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_HOST_CACHING_ALLOCATOR_H_
+#define IREE_HAL_HOST_HOST_CACHING_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "iree/base/status.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/host/host_local_allocator.h"
+
+namespace iree {
+namespace hal {
+
+// A HostLocalAllocator that retains the host memory of released buffers and
+// reuses it for subsequent allocations. Allocations are rounded up to a
+// power-of-two size class with one free list per class such that repeatedly
+// invoking the same function (which allocates the same intermediates each
+// time) does not need to return to the system allocator.
+//
+// Unlike HostLocalAllocator the contents of allocated buffers are undefined
+// unless Options::zero_on_allocate is set.
+//
+// Thread-safe. Buffers may outlive the allocator, in which case their memory is
+// returned to the system when they are destroyed.
+class HostCachingAllocator final : public HostLocalAllocator {
+ public:
+  struct Options {
+    // Zeros the contents of each buffer as it is allocated.
+    bool zero_on_allocate = false;
+
+    // Maximum total size of all cached blocks. Blocks released when the cache
+    // is full are returned to the system.
+    size_t max_retained_bytes = 256 * 1024 * 1024;
+
+    // Allocations larger than this bypass the cache entirely.
+    size_t max_cached_allocation_size = 64 * 1024 * 1024;
+  };
+
+  struct Stats {
+    // Total allocations satisfied from the cache.
+    int64_t hits = 0;
+    // Total allocations that required a new block.
+    int64_t misses = 0;
+    // Number and total size of blocks currently cached.
+    int64_t retained_blocks = 0;
+    size_t retained_bytes = 0;
+  };
+
+  HostCachingAllocator();
+  explicit HostCachingAllocator(Options options);
+  ~HostCachingAllocator() override;
+
+  StatusOr<ref_ptr<Buffer>> Allocate(MemoryTypeBitfield memory_type,
+                                     BufferUsageBitfield buffer_usage,
+                                     size_t allocation_size) override;
+
+  // Returns a snapshot of the cache statistics.
+  Stats stats() const;
+
+  // Frees cached blocks until at most |max_retained_bytes| remain cached.
+  // Larger blocks are freed first.
+  void Trim(size_t max_retained_bytes = 0);
+
+ private:
+  class BlockCache;
+  class CachedBuffer;
+
+  const Options options_;
+  std::shared_ptr<BlockCache> block_cache_;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_HOST_CACHING_ALLOCATOR_H_
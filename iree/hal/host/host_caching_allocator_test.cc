@@ -0,0 +1,133 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_caching_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+const MemoryTypeBitfield kMemoryType =
+    MemoryType::kHostLocal | MemoryType::kDeviceVisible;
+
+// Tests that released buffers are reused for allocations in the same size
+// class.
+TEST(HostCachingAllocatorTest, ReusesReleasedBuffers) {
+  HostCachingAllocator allocator;
+  ASSERT_OK_AND_ASSIGN(auto buffer,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 100));
+  EXPECT_EQ(100, buffer->byte_length());
+  EXPECT_EQ(0, allocator.stats().hits);
+  EXPECT_EQ(1, allocator.stats().misses);
+  buffer.reset();
+  EXPECT_EQ(1, allocator.stats().retained_blocks);
+  EXPECT_EQ(128, allocator.stats().retained_bytes);
+
+  // 120 rounds up to the same 128b size class as 100.
+  ASSERT_OK_AND_ASSIGN(buffer,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 120));
+  EXPECT_EQ(120, buffer->byte_length());
+  EXPECT_EQ(1, allocator.stats().hits);
+  EXPECT_EQ(0, allocator.stats().retained_blocks);
+
+  // 200 needs a new block.
+  ASSERT_OK_AND_ASSIGN(auto other_buffer,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 200));
+  EXPECT_EQ(2, allocator.stats().misses);
+}
+
+// Tests that buffers are zeroed when requested even if their memory is reused.
+TEST(HostCachingAllocatorTest, ZeroOnAllocate) {
+  HostCachingAllocator::Options options;
+  options.zero_on_allocate = true;
+  HostCachingAllocator allocator(options);
+  ASSERT_OK_AND_ASSIGN(auto buffer,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 64));
+  EXPECT_OK(buffer->Fill32(0, kWholeBuffer, 0xDEADBEEFu));
+  buffer.reset();
+
+  ASSERT_OK_AND_ASSIGN(buffer,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 64));
+  EXPECT_EQ(1, allocator.stats().hits);
+  std::vector<uint8_t> contents(64, 0xFF);
+  EXPECT_OK(buffer->ReadData(0, contents.data(), contents.size()));
+  EXPECT_THAT(contents, ::testing::Each(0));
+}
+
+// Tests that the cache does not grow past its retention limit and that large
+// allocations bypass it.
+TEST(HostCachingAllocatorTest, RetentionLimits) {
+  HostCachingAllocator::Options options;
+  options.max_retained_bytes = 256;
+  options.max_cached_allocation_size = 1024;
+  HostCachingAllocator allocator(options);
+
+  ASSERT_OK_AND_ASSIGN(auto buffer_a,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 256));
+  ASSERT_OK_AND_ASSIGN(auto buffer_b,
+                       allocator.Allocate(kMemoryType, BufferUsage::kAll, 256));
+  ASSERT_OK_AND_ASSIGN(auto buffer_c, allocator.Allocate(
+                                          kMemoryType, BufferUsage::kAll, 4096));
+  buffer_a.reset();
+  buffer_b.reset();
+  buffer_c.reset();
+  EXPECT_EQ(1, allocator.stats().retained_blocks);
+  EXPECT_EQ(256, allocator.stats().retained_bytes);
+  EXPECT_EQ(2, allocator.stats().misses);
+}
+
+// Tests that trimming frees cached blocks.
+TEST(HostCachingAllocatorTest, Trim) {
+  HostCachingAllocator allocator;
+  std::vector<ref_ptr<Buffer>> buffers;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto buffer, allocator.Allocate(
+                                          kMemoryType, BufferUsage::kAll, 1024));
+    buffers.push_back(std::move(buffer));
+  }
+  buffers.clear();
+  EXPECT_EQ(4, allocator.stats().retained_blocks);
+
+  allocator.Trim(2048);
+  EXPECT_EQ(2, allocator.stats().retained_blocks);
+  EXPECT_EQ(2048, allocator.stats().retained_bytes);
+
+  allocator.Trim();
+  EXPECT_EQ(0, allocator.stats().retained_blocks);
+  EXPECT_EQ(0, allocator.stats().retained_bytes);
+}
+
+// Tests that buffers may outlive the allocator they were allocated from.
+TEST(HostCachingAllocatorTest, BuffersOutliveAllocator) {
+  ref_ptr<Buffer> buffer;
+  {
+    HostCachingAllocator allocator;
+    ASSERT_OK_AND_ASSIGN(
+        buffer, allocator.Allocate(kMemoryType, BufferUsage::kAll, 64));
+  }
+  EXPECT_OK(buffer->Fill8(0, kWholeBuffer, 1));
+  buffer.reset();
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -14,6 +14,7 @@
 
 #include "iree/hal/host/host_submission_queue.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 
@@ -88,6 +89,95 @@ Status HostBinarySemaphore::EndWaiting() {
   return OkStatus();
 }
 
+HostTimelineSemaphore::HostTimelineSemaphore(uint64_t initial_value)
+    : value_(initial_value) {}
+
+HostTimelineSemaphore::~HostTimelineSemaphore() {
+  // Wake anyone still waiting; they'd otherwise never be signaled.
+  absl::MutexLock lock(&mutex_);
+  for (auto& waiter : waiters_) {
+    waiter.second->Set().IgnoreError();
+  }
+  waiters_.clear();
+}
+
+Status HostTimelineSemaphore::status() const {
+  absl::MutexLock lock(&mutex_);
+  return status_;
+}
+
+Status HostTimelineSemaphore::Signal(uint64_t value) {
+  absl::MutexLock lock(&mutex_);
+  if (!status_.ok()) {
+    return status_;
+  }
+  uint64_t current_value = value_.load(std::memory_order_relaxed);
+  if (value <= current_value) {
+    // Timeline payloads only move forward; the signal is a no-op.
+    return OkStatus();
+  }
+  value_.store(value, std::memory_order_release);
+  NotifyWaiters();
+  return OkStatus();
+}
+
+void HostTimelineSemaphore::Fail(Status status) {
+  absl::MutexLock lock(&mutex_);
+  status_ = std::move(status);
+  value_.store(UINT64_MAX, std::memory_order_release);
+  NotifyWaiters();
+}
+
+void HostTimelineSemaphore::NotifyWaiters() {
+  uint64_t current_value = value_.load(std::memory_order_relaxed);
+  auto it = std::partition(
+      waiters_.begin(), waiters_.end(),
+      [current_value](
+          const std::pair<uint64_t, ref_ptr<ManualResetEvent>>& waiter) {
+        return waiter.first > current_value;
+      });
+  for (auto signal_it = it; signal_it != waiters_.end(); ++signal_it) {
+    signal_it->second->Set().IgnoreError();
+  }
+  waiters_.erase(it, waiters_.end());
+}
+
+Status HostTimelineSemaphore::Wait(uint64_t value, absl::Time deadline) {
+  IREE_TRACE_SCOPE0("HostTimelineSemaphore::Wait");
+  if (value_.load(std::memory_order_acquire) < value) {
+    using WaitState = std::pair<HostTimelineSemaphore*, uint64_t>;
+    WaitState wait_state{this, value};
+    absl::MutexLock lock(&mutex_);
+    if (!mutex_.AwaitWithDeadline(
+            absl::Condition(
+                +[](WaitState* wait_state) {
+                  return wait_state->first->value_.load(
+                             std::memory_order_acquire) >= wait_state->second;
+                },
+                &wait_state),
+            deadline)) {
+      return DeadlineExceededErrorBuilder(IREE_LOC)
+             << "Deadline exceeded waiting for timeline semaphore";
+    }
+  }
+  return status();
+}
+
+WaitHandle HostTimelineSemaphore::OnValue(uint64_t value) {
+  absl::MutexLock lock(&mutex_);
+  if (value_.load(std::memory_order_relaxed) >= value) {
+    return WaitHandle::AlwaysSignaling();
+  }
+  for (auto& waiter : waiters_) {
+    if (waiter.first == value) {
+      return waiter.second->OnSet();
+    }
+  }
+  waiters_.emplace_back(value,
+                        make_ref<ManualResetEvent>("HostTimelineSemaphore"));
+  return waiters_.back().second->OnSet();
+}
+
 HostSubmissionQueue::HostSubmissionQueue() = default;
 
 HostSubmissionQueue::~HostSubmissionQueue() = default;
@@ -101,13 +191,42 @@ bool HostSubmissionQueue::IsBatchReady(const PendingBatch& batch) const {
         return false;
       }
     } else {
-      // TODO(b/140141417): implement timeline semaphores.
-      return false;
+      auto& timeline_value = absl::get<1>(wait_point);
+      auto* timeline_semaphore =
+          reinterpret_cast<HostTimelineSemaphore*>(timeline_value.first);
+      if (timeline_semaphore->value() < timeline_value.second) {
+        return false;
+      }
     }
   }
   return true;
 }
 
+bool HostSubmissionQueue::GatherWaitHandles(
+    std::vector<WaitHandle>* out_wait_handles) const {
+  bool all_waitable = true;
+  for (auto* submission : list_) {
+    for (auto& batch : submission->pending_batches) {
+      for (auto& wait_point : batch.wait_semaphores) {
+        if (wait_point.index() == 0) {
+          auto* binary_semaphore =
+              reinterpret_cast<HostBinarySemaphore*>(absl::get<0>(wait_point));
+          if (!binary_semaphore->is_signaled()) all_waitable = false;
+        } else {
+          auto& timeline_value = absl::get<1>(wait_point);
+          auto* timeline_semaphore =
+              reinterpret_cast<HostTimelineSemaphore*>(timeline_value.first);
+          if (timeline_semaphore->value() < timeline_value.second) {
+            out_wait_handles->push_back(
+                timeline_semaphore->OnValue(timeline_value.second));
+          }
+        }
+      }
+    }
+  }
+  return all_waitable;
+}
+
 Status HostSubmissionQueue::Enqueue(absl::Span<const SubmissionBatch> batches,
                                     FenceValue fence) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::Enqueue");
@@ -121,16 +240,14 @@ Status HostSubmissionQueue::Enqueue(absl::Span<const SubmissionBatch> batches,
 
   // Verify waiting/signaling behavior on semaphores and prepare them all.
   // We need to track this to ensure that we are modeling the Vulkan behavior
-  // and are consistent across HAL implementations.
+  // and are consistent across HAL implementations. Timeline semaphores may be
+  // waited on and signaled in any order and need no preparation.
   for (auto& batch : batches) {
     for (auto& semaphore_value : batch.wait_semaphores) {
       if (semaphore_value.index() == 0) {
         auto* binary_semaphore = reinterpret_cast<HostBinarySemaphore*>(
             absl::get<0>(semaphore_value));
         RETURN_IF_ERROR(binary_semaphore->BeginWaiting());
-      } else {
-        // TODO(b/140141417): implement timeline semaphores.
-        return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
       }
     }
     for (auto& semaphore_value : batch.signal_semaphores) {
@@ -138,9 +255,6 @@ Status HostSubmissionQueue::Enqueue(absl::Span<const SubmissionBatch> batches,
         auto* binary_semaphore = reinterpret_cast<HostBinarySemaphore*>(
             absl::get<0>(semaphore_value));
         RETURN_IF_ERROR(binary_semaphore->BeginSignaling());
-      } else {
-        // TODO(b/140141417): implement timeline semaphores.
-        return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
       }
     }
   }
@@ -189,6 +303,9 @@ Status HostSubmissionQueue::ProcessBatches(ExecuteFn execute_fn) {
         // Batch can run! Process now and remove it from the list so we don't
         // try to run it again.
         auto batch_status = ProcessBatch(batch, execute_fn);
+        if (!batch_status.ok()) {
+          FailSignalSemaphores(batch, batch_status);
+        }
         submission->pending_batches.erase(submission->pending_batches.begin() +
                                           i);
         if (batch_status.ok()) {
@@ -212,6 +329,11 @@ Status HostSubmissionQueue::ProcessBatches(ExecuteFn execute_fn) {
       }
       if (restart_iteration) break;
     }
+    if (!restart_iteration) {
+      // Everything remaining is blocked on semaphores that have not yet been
+      // signaled; the caller will need to try again once they have.
+      break;
+    }
   }
 
   if (!permanent_error_.ok()) {
@@ -235,8 +357,11 @@ Status HostSubmissionQueue::ProcessBatch(const PendingBatch& batch,
           reinterpret_cast<HostBinarySemaphore*>(absl::get<0>(semaphore_value));
       RETURN_IF_ERROR(binary_semaphore->EndWaiting());
     } else {
-      // TODO(b/140141417): implement timeline semaphores.
-      return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
+      // The wait has been satisfied (or the semaphore failed and needs to
+      // propagate its error).
+      auto* timeline_semaphore = reinterpret_cast<HostTimelineSemaphore*>(
+          absl::get<1>(semaphore_value).first);
+      RETURN_IF_ERROR(timeline_semaphore->status());
     }
   }
 
@@ -250,8 +375,10 @@ Status HostSubmissionQueue::ProcessBatch(const PendingBatch& batch,
           reinterpret_cast<HostBinarySemaphore*>(absl::get<0>(semaphore_value));
       RETURN_IF_ERROR(binary_semaphore->EndSignaling());
     } else {
-      // TODO(b/140141417): implement timeline semaphores.
-      return UnimplementedErrorBuilder(IREE_LOC) << "Timeline semaphores NYI";
+      auto& timeline_value = absl::get<1>(semaphore_value);
+      auto* timeline_semaphore =
+          reinterpret_cast<HostTimelineSemaphore*>(timeline_value.first);
+      RETURN_IF_ERROR(timeline_semaphore->Signal(timeline_value.second));
     }
   }
 
@@ -262,13 +389,21 @@ Status HostSubmissionQueue::CompleteSubmission(Submission* submission,
                                                Status status) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::CompleteSubmission");
 
-  // It's safe to drop any remaining batches - their semaphores will never be
-  // signaled but that's fine as we should be the only thing relying on them.
+  // It's safe to drop any remaining batches - their binary semaphores will
+  // never be signaled but that's fine as we should be the only thing relying on
+  // them. Timeline semaphores may be waited on by others so we fail them.
+  if (!status.ok()) {
+    for (auto& batch : submission->pending_batches) {
+      FailSignalSemaphores(batch, status);
+    }
+  }
   submission->pending_batches.clear();
 
-  // Signal the fence.
+  // Signal the fence, if one was provided.
   auto* fence = static_cast<HostFence*>(submission->fence.first);
-  if (status.ok()) {
+  if (!fence) {
+    return OkStatus();
+  } else if (status.ok()) {
     RETURN_IF_ERROR(fence->Signal(submission->fence.second));
   } else {
     RETURN_IF_ERROR(fence->Fail(std::move(status)));
@@ -277,6 +412,18 @@ Status HostSubmissionQueue::CompleteSubmission(Submission* submission,
   return OkStatus();
 }
 
+// static
+void HostSubmissionQueue::FailSignalSemaphores(const PendingBatch& batch,
+                                               const Status& status) {
+  for (auto& semaphore_value : batch.signal_semaphores) {
+    if (semaphore_value.index() == 1) {
+      auto* timeline_semaphore = reinterpret_cast<HostTimelineSemaphore*>(
+          absl::get<1>(semaphore_value).first);
+      timeline_semaphore->Fail(status);
+    }
+  }
+}
+
 void HostSubmissionQueue::FailAllPending(Status status) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::FailAllPending");
   while (!list_.empty()) {
@@ -15,11 +15,18 @@
 #ifndef IREE_HAL_HOST_HOST_SUBMISSION_QUEUE_H_
 #define IREE_HAL_HOST_HOST_SUBMISSION_QUEUE_H_
 
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "iree/base/intrusive_list.h"
+#include "iree/base/ref_ptr.h"
 #include "iree/base/status.h"
+#include "iree/base/wait_handle.h"
 #include "iree/hal/command_queue.h"
 #include "iree/hal/host/host_fence.h"
 #include "iree/hal/semaphore.h"
@@ -66,12 +73,56 @@ class HostBinarySemaphore final : public BinarySemaphore {
   std::atomic<State> state_{{0, 0, 0}};
 };
 
-// Simple host-only timeline semaphore implemented with a mutex.
+// Host-only timeline semaphore with a 64-bit payload.
+// Signals raise the payload to the maximum of the current and new values and
+// wake any waiters whose value has been reached. Waiters may either block
+// directly with Wait or request a WaitHandle (backed by an eventfd where
+// available) with OnValue to poll alongside other handles.
 //
 // Thread-safe (as instances may be imported and used by others).
 class HostTimelineSemaphore final : public TimelineSemaphore {
  public:
-  // TODO(b/140141417): implement timeline semaphores.
+  explicit HostTimelineSemaphore(uint64_t initial_value);
+  ~HostTimelineSemaphore() override;
+
+  // Returns the current payload value. This is UINT64_MAX if the semaphore has
+  // failed; query status() for the reason.
+  uint64_t value() const { return value_.load(std::memory_order_acquire); }
+
+  // Returns the failure status of the semaphore, if any.
+  Status status() const;
+
+  // Raises the payload to |value| (if larger than the current value) and wakes
+  // waiters that have been satisfied.
+  Status Signal(uint64_t value);
+
+  // Fails the semaphore with the given |status|. All current and future
+  // waiters are woken and will receive the status.
+  void Fail(Status status);
+
+  // Blocks the caller until the payload reaches |value| or the |deadline|
+  // elapses.
+  Status Wait(uint64_t value, absl::Time deadline);
+
+  // Returns a WaitHandle that is signaled once the payload reaches |value| or
+  // the semaphore fails. The handle must not outlive the semaphore.
+  WaitHandle OnValue(uint64_t value);
+
+ private:
+  // Sets all events for waiters at or below the current value.
+  void NotifyWaiters() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // The mutex is not required to query the value; this lets the submission
+  // queue cheaply check readiness. The mutex is only used to update the value
+  // and notify waiters.
+  std::atomic<uint64_t> value_;
+
+  mutable absl::Mutex mutex_;
+  Status status_ ABSL_GUARDED_BY(mutex_);
+
+  // Events for pending OnValue requests, one per distinct value.
+  absl::InlinedVector<std::pair<uint64_t, ref_ptr<ManualResetEvent>>, 4>
+      waiters_ ABSL_GUARDED_BY(mutex_);
 };
 
 // A queue managing CommandQueue submissions that uses host-local
@@ -79,6 +130,11 @@ class HostTimelineSemaphore final : public TimelineSemaphore {
 // wait and signal semaphores defined per batch and notifies fences upon
 // submission completion.
 //
+// Batches that wait on timeline values signaled by earlier batches in the queue
+// are run back-to-back within a single ProcessBatches call, so a chain of
+// dependent submissions can be kept in flight without per-submission fences
+// (the fence may be omitted by passing a null fence).
+//
 // Note that it's possible for HAL users to deadlock themselves; we don't try to
 // avoid that as in device backends it may not be possible and we want to have
 // some kind of warning in the host implementation that TSAN can catch.
@@ -105,13 +161,22 @@ class HostSubmissionQueue {
 
   // Processes all ready batches using the provided |execute_fn|.
   // The function may be called several times if new batches become ready due to
-  // prior batches in the sequence completing during processing.
+  // prior batches in the sequence completing during processing. Returns once
+  // the queue is empty or all remaining batches are blocked.
   //
   // Returns any errors returned by |execute_fn| (which will be the same as
   // permanent_error()). When an error occurs all in-flight submissions are
   // aborted, the permanent_error() is set, and the queue is shutdown.
   Status ProcessBatches(ExecuteFn execute_fn);
 
+  // Appends WaitHandles for the timeline semaphore values that pending batches
+  // are blocked on to |out_wait_handles| so that the caller can sleep until
+  // one of them may have become ready.
+  //
+  // Returns false if a pending batch is blocked on a binary semaphore, which
+  // has no wait handle; callers must poll in that case.
+  bool GatherWaitHandles(std::vector<WaitHandle>* out_wait_handles) const;
+
   // Marks the queue as having shutdown. All pending submissions will be allowed
   // to complete but future enqueues will fail.
   void SignalShutdown();
@@ -140,6 +205,11 @@ class HostSubmissionQueue {
   // Completes a submission by signaling the fence with the given |status|.
   Status CompleteSubmission(Submission* submission, Status status);
 
+  // Fails the timeline semaphores that |batch| would have signaled so that
+  // waiters on other queues or the host observe the failure.
+  static void FailSignalSemaphores(const PendingBatch& batch,
+                                   const Status& status);
+
   // Fails all pending submissions with the given status.
   // Errors that occur during this process are silently ignored.
   void FailAllPending(Status status);
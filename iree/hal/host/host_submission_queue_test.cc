@@ -14,15 +14,189 @@
 
 #include "iree/hal/host/host_submission_queue.h"
 
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/host/host_fence.h"
+#include "iree/hal/testing/mock_command_buffer.h"
 
 namespace iree {
 namespace hal {
 namespace {
 
-TEST(HostSubmissionQueueTest, TBD) {
-  // TODO(benvanik): test!
+using ::testing::ElementsAre;
+
+using testing::MockCommandBuffer;
+
+SemaphoreValue TimelineValue(HostTimelineSemaphore* semaphore,
+                             uint64_t value) {
+  return std::make_pair(static_cast<TimelineSemaphore*>(semaphore), value);
+}
+
+TEST(HostTimelineSemaphoreTest, SignalIsMonotonic) {
+  HostTimelineSemaphore semaphore(1u);
+  EXPECT_EQ(1u, semaphore.value());
+  EXPECT_OK(semaphore.Signal(5u));
+  EXPECT_EQ(5u, semaphore.value());
+  EXPECT_OK(semaphore.Signal(3u));
+  EXPECT_EQ(5u, semaphore.value());
+}
+
+TEST(HostTimelineSemaphoreTest, WaitHandleSignaledOnValue) {
+  HostTimelineSemaphore semaphore(0u);
+  auto wait_handle = semaphore.OnValue(2u);
+  ASSERT_OK_AND_ASSIGN(bool signaled, wait_handle.TryWait());
+  EXPECT_FALSE(signaled);
+  ASSERT_OK(semaphore.Signal(1u));
+  ASSERT_OK_AND_ASSIGN(signaled, wait_handle.TryWait());
+  EXPECT_FALSE(signaled);
+  ASSERT_OK(semaphore.Signal(2u));
+  ASSERT_OK_AND_ASSIGN(signaled, wait_handle.TryWait());
+  EXPECT_TRUE(signaled);
+
+  // Values already reached return handles that are signaled.
+  auto reached_handle = semaphore.OnValue(1u);
+  ASSERT_OK_AND_ASSIGN(signaled, reached_handle.TryWait());
+  EXPECT_TRUE(signaled);
+}
+
+TEST(HostTimelineSemaphoreTest, WaitUntilSignaled) {
+  HostTimelineSemaphore semaphore(0u);
+  EXPECT_TRUE(IsDeadlineExceeded(
+      semaphore.Wait(1u, absl::Now() + absl::Milliseconds(1))));
+
+  std::thread thread([&]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    CHECK_OK(semaphore.Signal(1u));
+  });
+  EXPECT_OK(semaphore.Wait(1u, absl::InfiniteFuture()));
+  thread.join();
+}
+
+TEST(HostTimelineSemaphoreTest, FailWakesWaiters) {
+  HostTimelineSemaphore semaphore(0u);
+  auto wait_handle = semaphore.OnValue(10u);
+  semaphore.Fail(DataLossErrorBuilder(IREE_LOC));
+  ASSERT_OK_AND_ASSIGN(bool signaled, wait_handle.TryWait());
+  EXPECT_TRUE(signaled);
+  EXPECT_TRUE(IsDataLoss(semaphore.Wait(10u, absl::InfiniteFuture())));
+  EXPECT_TRUE(IsDataLoss(semaphore.Signal(11u)));
+}
+
+// Tests that batches depending on timeline values signaled by batches enqueued
+// after them are all run by a single ProcessBatches call.
+TEST(HostSubmissionQueueTest, PipelinesTimelineDependencies) {
+  auto cmd_buffer_0 = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  auto cmd_buffer_1 = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  auto cmd_buffer_2 = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  HostTimelineSemaphore semaphore(0u);
+
+  HostSubmissionQueue queue;
+  SemaphoreValue wait_2 = TimelineValue(&semaphore, 2u);
+  SemaphoreValue signal_3 = TimelineValue(&semaphore, 3u);
+  CommandBuffer* cmd_buffer_2_ptr = cmd_buffer_2.get();
+  ASSERT_OK(queue.Enqueue({{{wait_2}, {cmd_buffer_2_ptr}, {signal_3}}},
+                          {nullptr, 0u}));
+  SemaphoreValue wait_1 = TimelineValue(&semaphore, 1u);
+  SemaphoreValue signal_2 = TimelineValue(&semaphore, 2u);
+  CommandBuffer* cmd_buffer_1_ptr = cmd_buffer_1.get();
+  ASSERT_OK(queue.Enqueue({{{wait_1}, {cmd_buffer_1_ptr}, {signal_2}}},
+                          {nullptr, 0u}));
+  SemaphoreValue signal_1 = TimelineValue(&semaphore, 1u);
+  CommandBuffer* cmd_buffer_0_ptr = cmd_buffer_0.get();
+  HostFence fence(0u);
+  ASSERT_OK(
+      queue.Enqueue({{{}, {cmd_buffer_0_ptr}, {signal_1}}}, {&fence, 1u}));
+
+  std::vector<CommandBuffer*> executed;
+  ASSERT_OK(queue.ProcessBatches(
+      [&](absl::Span<CommandBuffer* const> command_buffers) {
+        executed.insert(executed.end(), command_buffers.begin(),
+                        command_buffers.end());
+        return OkStatus();
+      }));
+  EXPECT_THAT(executed,
+              ElementsAre(cmd_buffer_0_ptr, cmd_buffer_1_ptr, cmd_buffer_2_ptr));
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(3u, semaphore.value());
+  ASSERT_OK_AND_ASSIGN(uint64_t fence_value, fence.QueryValue());
+  EXPECT_EQ(1u, fence_value);
+}
+
+// Tests that batches blocked on a host-signaled value are left pending and
+// expose a wait handle for the value.
+TEST(HostSubmissionQueueTest, BlocksOnHostSignal) {
+  auto cmd_buffer = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  HostTimelineSemaphore semaphore(0u);
+
+  HostSubmissionQueue queue;
+  SemaphoreValue wait_1 = TimelineValue(&semaphore, 1u);
+  CommandBuffer* cmd_buffer_ptr = cmd_buffer.get();
+  ASSERT_OK(queue.Enqueue({{{wait_1}, {cmd_buffer_ptr}, {}}}, {nullptr, 0u}));
+
+  int execute_count = 0;
+  auto execute_fn = [&](absl::Span<CommandBuffer* const> command_buffers) {
+    ++execute_count;
+    return OkStatus();
+  };
+  ASSERT_OK(queue.ProcessBatches(execute_fn));
+  EXPECT_EQ(0, execute_count);
+  EXPECT_FALSE(queue.empty());
+
+  std::vector<WaitHandle> wait_handles;
+  EXPECT_TRUE(queue.GatherWaitHandles(&wait_handles));
+  ASSERT_EQ(1, wait_handles.size());
+  ASSERT_OK_AND_ASSIGN(bool signaled, wait_handles[0].TryWait());
+  EXPECT_FALSE(signaled);
+
+  ASSERT_OK(semaphore.Signal(1u));
+  ASSERT_OK_AND_ASSIGN(signaled, wait_handles[0].TryWait());
+  EXPECT_TRUE(signaled);
+  ASSERT_OK(queue.ProcessBatches(execute_fn));
+  EXPECT_EQ(1, execute_count);
+  EXPECT_TRUE(queue.empty());
+}
+
+// Tests that a failed batch fails the timeline semaphores it would have
+// signaled so that other waiters do not hang.
+TEST(HostSubmissionQueueTest, FailuresPropagateToTimelineSemaphores) {
+  auto cmd_buffer = make_ref<MockCommandBuffer>(
+      nullptr, CommandBufferMode::kOneShot, CommandCategory::kTransfer);
+  HostTimelineSemaphore semaphore(0u);
+  HostTimelineSemaphore pending_semaphore(0u);
+
+  HostSubmissionQueue queue;
+  SemaphoreValue signal_1 = TimelineValue(&semaphore, 1u);
+  CommandBuffer* cmd_buffer_ptr = cmd_buffer.get();
+  HostFence fence_0(0u);
+  ASSERT_OK(queue.Enqueue({{{}, {cmd_buffer_ptr}, {signal_1}}},
+                          {&fence_0, 1u}));
+  SemaphoreValue wait_1 = TimelineValue(&semaphore, 1u);
+  SemaphoreValue pending_signal_1 = TimelineValue(&pending_semaphore, 1u);
+  HostFence fence_1(0u);
+  ASSERT_OK(queue.Enqueue(
+      {{{wait_1}, {cmd_buffer_ptr}, {pending_signal_1}}}, {&fence_1, 1u}));
+
+  EXPECT_TRUE(IsDataLoss(
+      queue.ProcessBatches([](absl::Span<CommandBuffer* const>) -> Status {
+        return DataLossErrorBuilder(IREE_LOC);
+      })));
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(IsDataLoss(semaphore.status()));
+  EXPECT_TRUE(IsDataLoss(pending_semaphore.status()));
+  EXPECT_TRUE(IsDataLoss(fence_0.status()));
+  EXPECT_TRUE(IsDataLoss(fence_1.status()));
 }
 
 }  // namespace
@@ -0,0 +1,173 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "iree/hal/host/host_thread_pool.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "iree/base/tracing.h"
+
+namespace iree {
+namespace hal {
+
+// State shared by all tasks issued from a single ParallelFor call.
+struct HostThreadPool::Job {
+  const std::function<Status(int)>* fn = nullptr;
+
+  absl::Mutex mutex;
+  int remaining_count ABSL_GUARDED_BY(mutex) = 0;
+  Status status ABSL_GUARDED_BY(mutex);
+};
+
+// static
+int HostThreadPool::DefaultWorkerCount() {
+  int hardware_concurrency =
+      static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(0, hardware_concurrency - 1);
+}
+
+HostThreadPool::HostThreadPool(int worker_count) {
+  IREE_TRACE_SCOPE0("HostThreadPool::ctor");
+  workers_.reserve(worker_count);
+  for (int i = 0; i < worker_count; ++i) {
+    workers_.push_back(absl::make_unique<Worker>());
+  }
+  for (int i = 0; i < worker_count; ++i) {
+    workers_[i]->thread = std::thread([this, i]() { ThreadMain(i); });
+  }
+}
+
+HostThreadPool::~HostThreadPool() {
+  IREE_TRACE_SCOPE0("HostThreadPool::dtor");
+  {
+    absl::MutexLock lock(&wake_mutex_);
+    shutdown_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void HostThreadPool::ThreadMain(int worker_index) {
+  IREE_TRACE_THREAD_ENABLE("HostThreadPool::Worker");
+  while (true) {
+    {
+      absl::MutexLock lock(&wake_mutex_);
+      wake_mutex_.Await(absl::Condition(
+          +[](HostThreadPool* pool) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+            return pool->shutdown_ || pool->pending_task_count_ > 0;
+          },
+          this));
+      if (shutdown_) return;
+    }
+    // Drain until there is no more work available anywhere in the pool.
+    while (TryRunTask(worker_index)) {
+    }
+  }
+}
+
+bool HostThreadPool::TryRunTask(int worker_index) {
+  Task task;
+  bool found = false;
+  if (worker_index >= 0) {
+    // Pop the most recently queued task from our own deque.
+    auto* worker = workers_[worker_index].get();
+    absl::MutexLock lock(&worker->mutex);
+    if (!worker->tasks.empty()) {
+      task = worker->tasks.back();
+      worker->tasks.pop_back();
+      found = true;
+    }
+  }
+  for (int i = 1; !found && i <= workers_.size(); ++i) {
+    // Steal the oldest task from the next worker with queued work.
+    auto* victim =
+        workers_[(std::max(worker_index, 0) + i) % workers_.size()].get();
+    absl::MutexLock lock(&victim->mutex);
+    if (!victim->tasks.empty()) {
+      task = victim->tasks.front();
+      victim->tasks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) return false;
+
+  {
+    absl::MutexLock lock(&wake_mutex_);
+    --pending_task_count_;
+  }
+  RunTask(task);
+  return true;
+}
+
+// static
+void HostThreadPool::RunTask(const Task& task) {
+  auto status = (*task.job->fn)(task.index);
+  absl::MutexLock lock(&task.job->mutex);
+  if (!status.ok() && task.job->status.ok()) {
+    task.job->status = std::move(status);
+  }
+  --task.job->remaining_count;
+}
+
+Status HostThreadPool::ParallelFor(int count,
+                                   const std::function<Status(int)>& fn) {
+  IREE_TRACE_SCOPE0("HostThreadPool::ParallelFor");
+  if (count <= 0) return OkStatus();
+  if (workers_.empty() || count == 1) {
+    // Nothing to distribute; run inline.
+    Status result;
+    for (int i = 0; i < count; ++i) {
+      auto status = fn(i);
+      if (!status.ok() && result.ok()) result = std::move(status);
+    }
+    return result;
+  }
+
+  Job job;
+  job.fn = &fn;
+  {
+    absl::MutexLock lock(&job.mutex);
+    job.remaining_count = count;
+  }
+
+  // Distribute the tasks across all worker deques. Workers will steal from
+  // each other to balance out any unevenness in task cost.
+  for (int i = 0; i < count; ++i) {
+    auto* worker = workers_[i % workers_.size()].get();
+    absl::MutexLock lock(&worker->mutex);
+    worker->tasks.push_back({&job, i});
+  }
+  {
+    absl::MutexLock lock(&wake_mutex_);
+    pending_task_count_ += count;
+  }
+
+  // Help out until there's nothing left to steal and then wait for any tasks
+  // still in-flight on the workers.
+  while (TryRunTask(-1)) {
+  }
+  absl::MutexLock lock(&job.mutex);
+  job.mutex.Await(absl::Condition(
+      +[](Job* job) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+        return job->remaining_count == 0;
+      },
+      &job));
+  return std::move(job.status);
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,98 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef IREE_HAL_HOST_HOST_THREAD_POOL_H_
+#define IREE_HAL_HOST_HOST_THREAD_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/status.h"
+
+namespace iree {
+namespace hal {
+
+// A pool of host worker threads used to execute data-parallel work such as the
+// workgroups of a dispatch.
+//
+// Each worker owns a deque of pending tasks. Work submitted by ParallelFor is
+// distributed round-robin across the worker deques; workers pop from the back
+// of their own deque and steal from the front of other deques when they run
+// dry. The thread calling ParallelFor participates in execution so a pool with
+// zero workers degenerates to running everything inline.
+//
+// Thread-safe. Multiple threads may issue ParallelFor concurrently.
+class HostThreadPool final {
+ public:
+  // Returns the number of workers to use when none is specified, based on the
+  // hardware concurrency of the host.
+  static int DefaultWorkerCount();
+
+  // Creates a pool with |worker_count| worker threads. The calling thread of
+  // ParallelFor also executes work, so |worker_count| = N - 1 will keep N
+  // cores busy.
+  explicit HostThreadPool(int worker_count);
+  HostThreadPool(const HostThreadPool&) = delete;
+  HostThreadPool& operator=(const HostThreadPool&) = delete;
+  ~HostThreadPool();
+
+  // Total number of threads that may be executing work for a ParallelFor,
+  // including the calling thread.
+  int concurrency() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls |fn| once for each index in [0, count) and blocks until all calls
+  // have completed. Calls may happen in any order and on any thread.
+  // Returns the first failing status, if any; all indices are still executed.
+  Status ParallelFor(int count, const std::function<Status(int)>& fn);
+
+ private:
+  struct Job;
+  struct Task {
+    Job* job;
+    int index;
+  };
+  struct Worker {
+    absl::Mutex mutex;
+    std::deque<Task> tasks ABSL_GUARDED_BY(mutex);
+    std::thread thread;
+  };
+
+  // Thread entry point for worker |worker_index|.
+  void ThreadMain(int worker_index);
+
+  // Attempts to pop a task from |worker_index|'s deque (if >= 0) and then
+  // steals from the other workers. Returns false if no task was available.
+  bool TryRunTask(int worker_index);
+
+  // Runs a single task and records its completion on its job.
+  static void RunTask(const Task& task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Tracks the total number of queued tasks so idle workers can sleep.
+  absl::Mutex wake_mutex_;
+  int pending_task_count_ ABSL_GUARDED_BY(wake_mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(wake_mutex_) = false;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_HOST_THREAD_POOL_H_
@@ -0,0 +1,99 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "iree/hal/host/host_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Tests that a pool can be created and destroyed without doing any work.
+TEST(HostThreadPoolTest, NoOp) {
+  HostThreadPool pool(4);
+  EXPECT_EQ(5, pool.concurrency());
+}
+
+// Tests that an empty range does not call the function.
+TEST(HostThreadPoolTest, EmptyRange) {
+  HostThreadPool pool(2);
+  EXPECT_OK(pool.ParallelFor(0, [](int index) -> Status {
+    ADD_FAILURE() << "Should not be called";
+    return OkStatus();
+  }));
+}
+
+// Tests that a pool with no workers runs everything on the calling thread.
+TEST(HostThreadPoolTest, InlineExecution) {
+  HostThreadPool pool(0);
+  std::vector<int> hits(16, 0);
+  EXPECT_OK(pool.ParallelFor(16, [&](int index) {
+    ++hits[index];
+    return OkStatus();
+  }));
+  EXPECT_THAT(hits, ::testing::Each(1));
+}
+
+// Tests that each index is executed exactly once across the workers.
+TEST(HostThreadPoolTest, EachIndexOnce) {
+  HostThreadPool pool(4);
+  std::vector<std::atomic<int>> hits(1000);
+  for (auto& hit : hits) hit = 0;
+  EXPECT_OK(pool.ParallelFor(1000, [&](int index) {
+    ++hits[index];
+    return OkStatus();
+  }));
+  for (auto& hit : hits) {
+    EXPECT_EQ(1, hit.load());
+  }
+}
+
+// Tests that the pool can be reused for many back-to-back jobs.
+TEST(HostThreadPoolTest, RepeatedJobs) {
+  HostThreadPool pool(3);
+  std::atomic<int> total{0};
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_OK(pool.ParallelFor(7, [&](int index) {
+      total += index;
+      return OkStatus();
+    }));
+  }
+  EXPECT_EQ(100 * (0 + 1 + 2 + 3 + 4 + 5 + 6), total.load());
+}
+
+// Tests that failures are propagated and do not prevent other indices from
+// running.
+TEST(HostThreadPoolTest, ErrorPropagation) {
+  HostThreadPool pool(2);
+  std::atomic<int> count{0};
+  auto status = pool.ParallelFor(10, [&](int index) -> Status {
+    ++count;
+    if (index == 3) return UnknownErrorBuilder(IREE_LOC) << "index 3";
+    return OkStatus();
+  });
+  EXPECT_TRUE(IsUnknown(status));
+  EXPECT_EQ(10, count.load());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
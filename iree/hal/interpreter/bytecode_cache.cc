@@ -23,8 +23,9 @@
 namespace iree {
 namespace hal {
 
-BytecodeCache::BytecodeCache(hal::Allocator* allocator)
-    : allocator_(allocator) {}
+BytecodeCache::BytecodeCache(hal::Allocator* allocator,
+                             kernels::RuntimeState* kernel_runtime_state)
+    : allocator_(allocator), kernel_runtime_state_(kernel_runtime_state) {}
 
 BytecodeCache::~BytecodeCache() = default;
 
@@ -43,9 +44,9 @@ StatusOr<ref_ptr<Executable>> BytecodeCache::PrepareExecutable(
   // Wrap the data (or copy it).
   bool allow_aliasing_data =
       AllBitsSet(mode, ExecutableCachingMode::kAliasProvidedData);
-  ASSIGN_OR_RETURN(
-      auto executable,
-      BytecodeExecutable::Load(allocator_, spec, !allow_aliasing_data));
+  ASSIGN_OR_RETURN(auto executable,
+                   BytecodeExecutable::Load(allocator_, kernel_runtime_state_,
+                                            spec, !allow_aliasing_data));
 
   return executable;
 }
@@ -18,13 +18,15 @@
 #include "iree/hal/allocator.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_cache.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
 
 namespace iree {
 namespace hal {
 
 class BytecodeCache final : public ExecutableCache {
  public:
-  explicit BytecodeCache(hal::Allocator* allocator);
+  BytecodeCache(hal::Allocator* allocator,
+                kernels::RuntimeState* kernel_runtime_state);
   ~BytecodeCache() override;
 
   bool CanPrepareFormat(ExecutableFormat format) const override;
@@ -34,6 +36,7 @@ class BytecodeCache final : public ExecutableCache {
 
  private:
   hal::Allocator* allocator_;
+  kernels::RuntimeState* kernel_runtime_state_;
 };
 
 }  // namespace hal
@@ -23,6 +23,7 @@
 #include <algorithm>
 
 #include "absl/base/attributes.h"
+#include "absl/base/optimization.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/logging.h"
@@ -79,12 +80,21 @@ Status Dispatch(hal::Allocator* allocator,
   // We hope that LLVM decides to keep these in registers (as they are touched
   // for every instruction executed). The stack_frame will change as we call
   // into different functions.
-  BytecodeReader reader(stack);
+  BytecodeReader reader(stack, vm::interpreter_opcode_table());
   RETURN_IF_ERROR(reader.SwitchStackFrame(entry_stack_frame));
 
+  // Functions are validated before they execute so opcodes and operands are
+  // decoded without checks. Only functions with breakpoints take the slower
+  // AdvanceOffset path.
 #define DISPATCH_NEXT()                                                    \
   {                                                                        \
-    uint8_t opcode = *reader.AdvanceOffset().ValueOrDie();                 \
+    uint8_t opcode;                                                        \
+    if (ABSL_PREDICT_FALSE(reader.has_breakpoints())) {                    \
+      ASSIGN_OR_RETURN(const uint8_t* opcode_ptr, reader.AdvanceOffset()); \
+      opcode = *opcode_ptr;                                                \
+    } else {                                                               \
+      opcode = reader.ReadOpcode();                                        \
+    }                                                                      \
     DVLOG(1)                                                               \
         << "Interpreter dispatching op code: "                             \
         << GetOpcodeInfo(vm::interpreter_opcode_table(), opcode).mnemonic; \
@@ -103,8 +113,8 @@ Status Dispatch(hal::Allocator* allocator,
   DISPATCH_NEXT();
 
   DISPATCH_CORE_OPCODE(kConstant, {
-    ASSIGN_OR_RETURN(auto value, reader.ReadConstant());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto value = reader.ReadConstant();
+    auto* dst_local = reader.ReadLocal();
     *dst_local = std::move(value);
   });
 
@@ -154,10 +164,9 @@ Status Dispatch(hal::Allocator* allocator,
     auto* new_stack_frame = stack->caller_frame();
     if (old_stack_frame == entry_stack_frame) {
       // Returning from entry function. Marshal results from the return stmt.
-      ASSIGN_OR_RETURN(int32_t src_count, reader.ReadCount());
+      int32_t src_count = reader.ReadCount();
       for (int i = 0; i < src_count; ++i) {
-        ASSIGN_OR_RETURN(auto* src_local,
-                         reader.ReadLocal(old_stack_frame->mutable_locals()));
+        auto* src_local = reader.ReadLocal(old_stack_frame->mutable_locals());
         entry_results[i] = std::move(*src_local);
       }
       DVLOG(1) << "Returning to entry";
@@ -165,41 +174,41 @@ Status Dispatch(hal::Allocator* allocator,
     } else if (!new_stack_frame) {
       return FailedPreconditionErrorBuilder(IREE_LOC) << "Stack underflow";
     }
-    RETURN_IF_ERROR(reader.CopyResultsAndSwitchStackFrame(old_stack_frame,
+    RETURN_IF_ERROR(reader.MoveResultsAndSwitchStackFrame(old_stack_frame,
                                                           new_stack_frame));
     RETURN_IF_ERROR(stack->PopFrame());
     DVLOG(1) << "Return; stack now: " << stack->DebugString();
   });
 
   DISPATCH_CORE_OPCODE(kBranch, {
-    ASSIGN_OR_RETURN(int32_t offset, reader.ReadBlockOffset());
-    RETURN_IF_ERROR(reader.CopySlots());
-    RETURN_IF_ERROR(reader.BranchToOffset(offset));
+    int32_t offset = reader.ReadBlockOffset();
+    reader.CopySlots();
+    reader.BranchToOffset(offset);
   });
 
   DISPATCH_CORE_OPCODE(kCondBranch, {
     // Evaluate condition first so we can do the copies as we read them for
     // which side of the branch we take.
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
     bool cond_value = BufferViewIsTrue(*cond_local);
-    ASSIGN_OR_RETURN(int32_t true_offset, reader.ReadBlockOffset());
+    int32_t true_offset = reader.ReadBlockOffset();
     if (cond_value) {
-      RETURN_IF_ERROR(reader.CopySlots());
-      RETURN_IF_ERROR(reader.BranchToOffset(true_offset));
+      reader.CopySlots();
+      reader.BranchToOffset(true_offset);
     } else {
-      ASSIGN_OR_RETURN(int32_t true_op_count, reader.ReadCount());
-      RETURN_IF_ERROR(reader.SkipLocals(2 * true_op_count));
-      ASSIGN_OR_RETURN(int32_t false_offset, reader.ReadBlockOffset());
-      RETURN_IF_ERROR(reader.CopySlots());
-      RETURN_IF_ERROR(reader.BranchToOffset(false_offset));
+      int32_t true_op_count = reader.ReadCount();
+      reader.SkipLocals(2 * true_op_count);
+      int32_t false_offset = reader.ReadBlockOffset();
+      reader.CopySlots();
+      reader.BranchToOffset(false_offset);
     }
   });
 
   DISPATCH_CORE_OPCODE(kCmpI, {
-    ASSIGN_OR_RETURN(uint8_t predicate, reader.ReadUint8_t());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    uint8_t predicate = reader.ReadUint8_t();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
 
     switch (static_cast<CmpIPredicate>(predicate)) {
       case CmpIPredicate::kEq:
@@ -246,10 +255,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kCmpF, {
-    ASSIGN_OR_RETURN(uint8_t p, reader.ReadUint8_t());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    uint8_t p = reader.ReadUint8_t();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
 
     auto predicate = static_cast<CmpFPredicate>(p);
     switch (predicate) {
@@ -309,7 +318,7 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kAllocHeap, {
-    ASSIGN_OR_RETURN(auto heap_type, reader.ReadInt32());
+    auto heap_type = reader.ReadInt32();
     ASSIGN_OR_RETURN(auto type, reader.ReadType());
     size_t element_size = type.element_size();
 
@@ -318,7 +327,7 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto shape, reader.ReadShapePieces(&element_count));
     size_t allocation_size = element_size * element_count;
 
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->element_size = element_size;
     dst_local->shape = shape;
 
@@ -332,60 +341,60 @@ Status Dispatch(hal::Allocator* allocator,
 
   DISPATCH_CORE_OPCODE(kDiscard, {
     // NOTE: if we were an encoder we would actually discard the buffer.
-    ASSIGN_OR_RETURN(auto* local, reader.ReadLocal());
+    auto* local = reader.ReadLocal();
     *local = {};
   });
 
   DISPATCH_CORE_OPCODE(kRank, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     int32_t rank = src_local->shape.size();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &rank, sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kDim, {
-    ASSIGN_OR_RETURN(int32_t axis, reader.ReadUint8_t());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    int32_t axis = reader.ReadUint8_t();
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(int32_t dim, src_local->shape.ResolveAxis(axis));
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &dim, sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kShape, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(
         0, src_local->shape.subspan().data(),
         src_local->shape.subspan().size() * sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kLength, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     int32_t length = src_local->shape.element_count();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &length, sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kDynamicSlice, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto indices, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(*dst_local, src_local->Slice(indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kStaticSlice, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto indices, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto lengths, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto indices = reader.ReadIndexList();
+    auto lengths = reader.ReadIndexList();
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(*dst_local, src_local->Slice(indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kDynamicCopy, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto src_indices, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_indices, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadSlotElements<int32_t>());
     RETURN_IF_ERROR(
@@ -393,18 +402,18 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kStaticCopy, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto src_indices, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_indices, reader.ReadIndexList());
-    ASSIGN_OR_RETURN(auto lengths, reader.ReadIndexList());
+    auto* src_local = reader.ReadLocal();
+    auto src_indices = reader.ReadIndexList();
+    auto* dst_local = reader.ReadLocal();
+    auto dst_indices = reader.ReadIndexList();
+    auto lengths = reader.ReadIndexList();
     RETURN_IF_ERROR(
         ApplyCopy(src_local, src_indices, dst_local, dst_indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kClone, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     dst_local->element_size = src_local->element_size;
     dst_local->shape = src_local->shape;
     dst_local->buffer = HeapBuffer::Allocate(src_local->buffer->usage(),
@@ -417,24 +426,24 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kAssign, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     *dst_local = *src_local;
   });
 
   DISPATCH_CORE_OPCODE(kCondAssign, {
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     *dst_local = BufferViewIsTrue(*cond_local) ? *lhs_local : *rhs_local;
   });
 
   DISPATCH_CORE_OPCODE(kReshape, {
     // TODO(benvanik): more logic required if strides differ.
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     Shape new_shape = Shape{shape_data};
     if (src_local->shape.element_count() != new_shape.element_count()) {
       return InvalidArgumentErrorBuilder(IREE_LOC)
@@ -447,18 +456,18 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kSelect, {
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto cond_buffer, cond_local->buffer->MapMemory<uint8_t>(
-                                           MemoryAccess::kRead));
-    ASSIGN_OR_RETURN(auto lhs_buffer, lhs_local->buffer->MapMemory<uint8_t>(
-                                          MemoryAccess::kRead));
-    ASSIGN_OR_RETURN(auto rhs_buffer, rhs_local->buffer->MapMemory<uint8_t>(
-                                          MemoryAccess::kRead));
-    ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<uint8_t>(
-                                          MemoryAccess::kDiscardWrite));
+    auto* cond_local = reader.ReadLocal();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
+    ASSIGN_OR_RETURN(auto cond_buffer,
+                     MapLocal<uint8_t>(cond_local, MemoryAccess::kRead));
+    ASSIGN_OR_RETURN(auto lhs_buffer,
+                     MapLocal<uint8_t>(lhs_local, MemoryAccess::kRead));
+    ASSIGN_OR_RETURN(auto rhs_buffer,
+                     MapLocal<uint8_t>(rhs_local, MemoryAccess::kRead));
+    ASSIGN_OR_RETURN(auto dst_buffer,
+                     MapLocal<uint8_t>(dst_local, MemoryAccess::kDiscardWrite));
     if (cond_local->element_size != 1) {
       return InvalidArgumentErrorBuilder(IREE_LOC) << "Select cond must be i8";
     } else if (lhs_buffer.size() != rhs_buffer.size()) {
@@ -504,31 +513,31 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kTranspose, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto perm_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Transpose>(
         src_local, dst_local, src_local->shape,
         absl::MakeConstSpan(perm_data)));
   });
 
   DISPATCH_CORE_OPCODE(kReverse, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto perm_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyUnaryOpIU<kernels::Reverse>(src_local, dst_local, src_local->shape,
                                          absl::MakeConstSpan(perm_data)));
   });
 
   DISPATCH_CORE_OPCODE(kPad, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* padding_value, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* padding_value = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto edge_padding_low, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto edge_padding_high,
                      reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto interior_padding, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
 
     RETURN_IF_ERROR(ApplyBinaryOpIU<kernels::Pad>(
         src_local, padding_value, dst_local, src_local->shape, dst_local->shape,
@@ -538,17 +547,17 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kBroadcast, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->shape = Shape{shape_data};
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Broadcast>(src_local, dst_local));
   });
 
   DISPATCH_CORE_OPCODE(kTile, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->shape = Shape{shape_data};
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Tile>(
         src_local, dst_local, src_local->shape, dst_local->shape));
@@ -631,6 +640,9 @@ Status Dispatch(hal::Allocator* allocator,
   DISPATCH_FLOAT_OPCODE(kRsqrtF, {
     RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Rsqrt>(&reader));
   });
+  DISPATCH_FLOAT_OPCODE(kElementwiseF, {
+    RETURN_IF_ERROR(DispatchElementwiseProgramF(&reader));
+  });
   DISPATCH_FLOAT_OPCODE(kCosF, {
     RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Cos>(&reader));
   });
@@ -683,70 +695,71 @@ Status Dispatch(hal::Allocator* allocator,
 
   DISPATCH_CORE_OPCODE(kConvertSS, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertSS::Apply(src_type, src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertUU, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertUU::Apply(src_type, src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertSU, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertSU::Apply(src_type, src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertUS, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ApplyConvertUS::Apply(src_type, src_local, dst_type, dst_local));
   });
 
   DISPATCH_CORE_OPCODE(kMatMulI, {
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
     // TODO(benvanik): add fused matmul-with-bias op in MLIR and lower to this.
     BufferView* bias_local = nullptr;
-    ASSIGN_OR_RETURN(auto* multiplier_mantissa_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* multiplier_exponent_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* multiplier_mantissa_local = reader.ReadLocal();
+    auto* multiplier_exponent_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(ValidateMatMulOpI(lhs_local, rhs_local, bias_local,
                                       multiplier_mantissa_local,
                                       multiplier_exponent_local, dst_local));
     auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
+    const void* constant_owner = &stack->current_frame()->module();
     // TODO(benvanik): define as a matrix of supported types to enable 8*8=16,
     // accumulator options, and other precision modes.
     switch (lhs_local->element_size) {
       case 1:
         RETURN_IF_ERROR(ApplyMatMulOpI<int8_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       case 2:
         RETURN_IF_ERROR(ApplyMatMulOpI<int16_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       case 4:
         RETURN_IF_ERROR(ApplyMatMulOpI<int32_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       case 8:
         RETURN_IF_ERROR(ApplyMatMulOpI<int64_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       default:
@@ -756,21 +769,60 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kMatMulF, {
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
     BufferView* bias_local = nullptr;
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(
+        ValidateMatMulOpF(lhs_local, rhs_local, bias_local, dst_local));
+    auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
+    const void* constant_owner = &stack->current_frame()->module();
+    switch (lhs_local->element_size) {
+      case 4:
+        RETURN_IF_ERROR(ApplyMatMulOpF<float>(
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
+            dst_local));
+        break;
+      case 8:
+        RETURN_IF_ERROR(ApplyMatMulOpF<double>(
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
+            dst_local));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << lhs_local->element_size;
+    }
+  });
+
+  DISPATCH_FLOAT_OPCODE(kMatMulBiasF, {
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* bias_local = reader.ReadLocal();
+    int clamp_bound_count = reader.ReadCount();
+    BufferView* clamp_min_local = nullptr;
+    BufferView* clamp_max_local = nullptr;
+    if (clamp_bound_count == 2) {
+      clamp_min_local = reader.ReadLocal();
+      clamp_max_local = reader.ReadLocal();
+    } else if (clamp_bound_count != 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Expected 0 or 2 clamp bounds, got " << clamp_bound_count;
+    }
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(
         ValidateMatMulOpF(lhs_local, rhs_local, bias_local, dst_local));
     auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
+    const void* constant_owner = &stack->current_frame()->module();
     switch (lhs_local->element_size) {
       case 4:
         RETURN_IF_ERROR(ApplyMatMulOpF<float>(
-            mat_mul_state, lhs_local, rhs_local, bias_local, dst_local));
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
+            dst_local, clamp_min_local, clamp_max_local));
         break;
       case 8:
         RETURN_IF_ERROR(ApplyMatMulOpF<double>(
-            mat_mul_state, lhs_local, rhs_local, bias_local, dst_local));
+            mat_mul_state, constant_owner, lhs_local, rhs_local, bias_local,
+            dst_local, clamp_min_local, clamp_max_local));
         break;
       default:
         return UnimplementedErrorBuilder(IREE_LOC)
@@ -778,22 +830,141 @@ Status Dispatch(hal::Allocator* allocator,
     }
   });
 
+  DISPATCH_FLOAT_OPCODE(kConvF, {
+    auto* src_local = reader.ReadLocal();
+    auto* filter_local = reader.ReadLocal();
+    auto strides = reader.ReadIndexList();
+    auto padding = reader.ReadIndexList();
+    auto dilation = reader.ReadIndexList();
+    int32_t feature_group_count = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
+    if (strides.size() != 2 || padding.size() != 4 || dilation.size() != 2) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Expected 2 strides, 4 padding values and 2 dilations; got "
+             << strides.size() << ", " << padding.size() << " and "
+             << dilation.size();
+    }
+    kernels::Conv2D::Params params;
+    std::copy(strides.begin(), strides.end(), params.strides.begin());
+    std::copy(padding.begin(), padding.end(), params.padding.begin());
+    std::copy(dilation.begin(), dilation.end(), params.dilation.begin());
+    params.feature_group_count = feature_group_count;
+    auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
+    const void* constant_owner = &stack->current_frame()->module();
+    switch (src_local->element_size) {
+      case 4:
+        RETURN_IF_ERROR(ApplyConvOpF<float>(mat_mul_state, constant_owner,
+                                            src_local, filter_local, dst_local,
+                                            params));
+        break;
+      case 8:
+        RETURN_IF_ERROR(ApplyConvOpF<double>(mat_mul_state, constant_owner,
+                                             src_local, filter_local, dst_local,
+                                             params));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << src_local->element_size;
+    }
+  });
+
+  DISPATCH_CORE_OPCODE(kRequantize, {
+    auto* src_local = reader.ReadLocal();
+    auto* mantissa_local = reader.ReadLocal();
+    auto* exponent_local = reader.ReadLocal();
+    auto* zero_point_local = reader.ReadLocal();
+    auto rounding_mode = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(ValidateRoundingMode(rounding_mode));
+    switch (src_local->element_size) {
+      case 1:
+        RETURN_IF_ERROR(ApplyRequantizeOpIS<int8_t>(
+            src_local, mantissa_local, exponent_local, zero_point_local,
+            static_cast<RoundingMode>(rounding_mode), dst_local));
+        break;
+      case 2:
+        RETURN_IF_ERROR(ApplyRequantizeOpIS<int16_t>(
+            src_local, mantissa_local, exponent_local, zero_point_local,
+            static_cast<RoundingMode>(rounding_mode), dst_local));
+        break;
+      case 4:
+        RETURN_IF_ERROR(ApplyRequantizeOpIS<int32_t>(
+            src_local, mantissa_local, exponent_local, zero_point_local,
+            static_cast<RoundingMode>(rounding_mode), dst_local));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << src_local->element_size;
+    }
+  });
+
+  DISPATCH_CORE_OPCODE(kAddQ, {
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* mantissa_local = reader.ReadLocal();
+    auto* exponent_local = reader.ReadLocal();
+    auto* zero_point_local = reader.ReadLocal();
+    auto rounding_mode = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(ValidateRoundingMode(rounding_mode));
+    RETURN_IF_ERROR(ApplyQuantizedBinaryOpIS<kernels::AddQ>(
+        lhs_local, rhs_local, mantissa_local, exponent_local, zero_point_local,
+        static_cast<RoundingMode>(rounding_mode), dst_local));
+  });
+
+  DISPATCH_CORE_OPCODE(kMulQ, {
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* mantissa_local = reader.ReadLocal();
+    auto* exponent_local = reader.ReadLocal();
+    auto* zero_point_local = reader.ReadLocal();
+    auto rounding_mode = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(ValidateRoundingMode(rounding_mode));
+    RETURN_IF_ERROR(ApplyQuantizedBinaryOpIS<kernels::MulQ>(
+        lhs_local, rhs_local, mantissa_local, exponent_local, zero_point_local,
+        static_cast<RoundingMode>(rounding_mode), dst_local));
+  });
+
   DISPATCH_CORE_OPCODE(kReduceSumI, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
-    RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceSum>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+    if (dst_local->element_size != src_local->element_size) {
+      // Narrow values (such as quantized int8) accumulated in int32.
+      if (dst_local->element_size != 4 || init_local->element_size != 4) {
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented widening reduction from element size "
+               << src_local->element_size << " to "
+               << dst_local->element_size;
+      }
+      switch (src_local->element_size) {
+        case 1:
+          RETURN_IF_ERROR((ApplyReduceSumWideningOp<int8_t, int32_t>(
+              src_local, init_local, dst_local, dimension)));
+          break;
+        case 2:
+          RETURN_IF_ERROR((ApplyReduceSumWideningOp<int16_t, int32_t>(
+              src_local, init_local, dst_local, dimension)));
+          break;
+        default:
+          return UnimplementedErrorBuilder(IREE_LOC)
+                 << "Unimplemented element size: " << src_local->element_size;
+      }
+    } else {
+      RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceSum>(
+          src_local, init_local, dst_local, dimension, src_local->shape,
+          dst_local->shape));
+    }
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceSumF, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceSum>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -801,10 +972,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kReduceMinI, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceMin>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -812,10 +983,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceMinF, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceMin>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -823,10 +994,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kReduceMaxI, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceMax>(
         src_local, init_local, dst_local, dimension, src_local->shape,
@@ -834,10 +1005,10 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceMaxF, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dimension, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* init_local = reader.ReadLocal();
+    auto dimension = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceMax>(
         src_local, init_local, dst_local, dimension, src_local->shape,
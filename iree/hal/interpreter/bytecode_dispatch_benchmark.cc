@@ -0,0 +1,172 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the per-opcode overhead of the interpreter dispatch loop.
+//
+// Each benchmark builds a function that executes a single opcode
+// kOpsPerInvocation times on tiny buffers and then returns, so the reported
+// time per item is dominated by operand decoding, buffer mapping and dispatch
+// instead of kernel math. BM_Return measures the cost of an invocation that
+// executes no other ops and can be subtracted to isolate the loop overhead.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "flatbuffers/flatbuffers.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/host/host_local_allocator.h"
+#include "iree/hal/interpreter/interpreter_context.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+#include "iree/schemas/module_def_generated.h"
+#include "iree/vm/bytecode_reader.h"
+#include "iree/vm/bytecode_tables_interpreter.h"
+#include "iree/vm/function.h"
+#include "iree/vm/module.h"
+#include "iree/vm/stack.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+constexpr int kOpsPerInvocation = 64;
+
+// Builds a module containing a single function that takes |operand_count|
+// f32 buffers and executes |opcode| on them (with the last operand as the
+// output) |op_count| times before returning.
+StatusOr<std::unique_ptr<vm::Module>> BuildOpcodeModule(
+    InterpreterOpcode opcode, int operand_count, int op_count) {
+  std::vector<int8_t> bytecode;
+  auto append_local = [&bytecode](uint16_t ordinal) {
+    bytecode.push_back(static_cast<int8_t>(ordinal & 0xFF));
+    bytecode.push_back(static_cast<int8_t>(ordinal >> 8));
+  };
+  for (int i = 0; i < op_count; ++i) {
+    bytecode.push_back(static_cast<int8_t>(opcode));
+    for (int j = 0; j < operand_count; ++j) {
+      append_local(j);
+    }
+  }
+  bytecode.push_back(static_cast<int8_t>(InterpreterOpcode::kReturn));
+  bytecode.push_back(0);  // result count
+
+  ::flatbuffers::FlatBufferBuilder fbb;
+  std::vector<::flatbuffers::Offset<TypeDef>> input_types;
+  for (int i = 0; i < operand_count; ++i) {
+    auto element_type = CreateElementTypeDef(
+        fbb, ElementTypeDefUnion::FloatTypeDef,
+        CreateFloatTypeDef(fbb, /*width=*/32).Union());
+    auto memref_type =
+        CreateMemRefTypeDef(fbb, element_type, fbb.CreateVector<int>({-1}));
+    input_types.push_back(
+        CreateTypeDef(fbb, TypeDefUnion::MemRefTypeDef, memref_type.Union()));
+  }
+  auto function_type =
+      CreateFunctionTypeDef(fbb, fbb.CreateVector(input_types));
+  auto bytecode_def =
+      CreateBytecodeDef(fbb, operand_count, fbb.CreateVector(bytecode));
+  auto function_def = CreateFunctionDef(fbb, fbb.CreateString("main"),
+                                        function_type, 0, bytecode_def);
+  auto function_table = CreateFunctionTableDef(
+      fbb, fbb.CreateVector(std::vector<decltype(function_def)>{function_def}),
+      0, fbb.CreateVector<int>({0}));
+  auto executable_table = CreateExecutableTableDef(fbb);
+  auto module_def = CreateModuleDef(fbb, fbb.CreateString("benchmark"), 0,
+                                    function_table, executable_table);
+  FinishModuleDefBuffer(fbb, module_def);
+
+  ASSIGN_OR_RETURN(
+      auto module_file,
+      vm::ModuleFile::FromString(
+          ModuleDefIdentifier(),
+          std::string(reinterpret_cast<const char*>(fbb.GetBufferPointer()),
+                      fbb.GetSize())));
+  return vm::Module::FromFile(std::move(module_file));
+}
+
+void BM_Opcode(benchmark::State& state, InterpreterOpcode opcode,
+               int operand_count, int op_count) {
+  auto module_or = BuildOpcodeModule(opcode, operand_count, op_count);
+  if (!module_or.ok()) {
+    state.SkipWithError(module_or.status().ToString().c_str());
+    return;
+  }
+  auto module = std::move(module_or).ValueOrDie();
+  auto function = module->function_table().LookupFunction(0).ValueOrDie();
+
+  // Prepare up front as executable loading does so that only dispatch is
+  // measured.
+  auto status = vm::BytecodeReader::PrepareFunction(
+                    vm::interpreter_opcode_table(), function, 0)
+                    .status();
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+
+  HostLocalAllocator allocator;
+  InterpreterContext context(&allocator);
+  vm::Stack stack;
+
+  int element_count = state.range(0);
+  std::vector<BufferView> operands;
+  for (int i = 0; i < operand_count; ++i) {
+    operands.emplace_back(
+        HeapBuffer::Allocate(BufferUsage::kAll, element_count * sizeof(float)),
+        Shape{element_count}, sizeof(float));
+  }
+
+  for (auto _ : state) {
+    // Invocation consumes the arguments so we pass copies (which only retain
+    // the underlying buffers).
+    std::vector<BufferView> args = operands;
+    status = context.Invoke(&stack, function, absl::MakeSpan(args), {});
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * op_count);
+}
+
+void BM_Return(benchmark::State& state) {
+  BM_Opcode(state, InterpreterOpcode::kReturn, 0, 0);
+}
+BENCHMARK(BM_Return)->Arg(1);
+
+#define OPCODE_BENCHMARK(opcode, operand_count)                            \
+  void BM_##opcode(benchmark::State& state) {                              \
+    BM_Opcode(state, InterpreterOpcode::opcode, operand_count,             \
+              kOpsPerInvocation);                                          \
+  }                                                                        \
+  BENCHMARK(BM_##opcode)->Arg(1)->Arg(1024)
+
+OPCODE_BENCHMARK(kAbsF, 2);
+OPCODE_BENCHMARK(kExpF, 2);
+OPCODE_BENCHMARK(kTanhF, 2);
+OPCODE_BENCHMARK(kAddI, 3);
+OPCODE_BENCHMARK(kAddF, 3);
+OPCODE_BENCHMARK(kMulF, 3);
+OPCODE_BENCHMARK(kMaxF, 3);
+OPCODE_BENCHMARK(kMulAddF, 4);
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
+
+BENCHMARK_MAIN();
@@ -337,9 +337,9 @@ struct ApplyConversionOp {
     static Status Apply(BufferView* src_local, BufferView* dst_local,
                         ARGS... args) {
       ASSIGN_OR_RETURN(auto src_buffer,
-                       src_local->buffer->MapMemory<SRC>(MemoryAccess::kRead));
-      ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<DST>(
-                                            MemoryAccess::kDiscardWrite));
+                       MapLocal<SRC>(src_local, MemoryAccess::kRead));
+      ASSIGN_OR_RETURN(auto dst_buffer,
+                       MapLocal<DST>(dst_local, MemoryAccess::kDiscardWrite));
       return KERNEL::Execute(src_buffer.contents(),
                              dst_buffer.mutable_contents(), args...);
     }
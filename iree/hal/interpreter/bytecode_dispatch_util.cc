@@ -23,8 +23,7 @@ bool BufferViewIsTrue(const BufferView& buffer_view) {
     return false;
   }
   // TODO(benvanik): map more efficiently (based on element size?).
-  auto mapping =
-      buffer_view.buffer->MapMemory<uint8_t>(hal::MemoryAccess::kRead);
+  auto mapping = MapLocal<uint8_t>(&buffer_view, MemoryAccess::kRead);
   if (!mapping.ok()) {
     return false;
   }
@@ -46,6 +45,32 @@ Status CallNativeFunction(vm::Stack* stack,
   return fn(stack, args, results);
 }
 
+Status DispatchElementwiseProgramF(vm::BytecodeReader* reader) {
+  int src_count = reader->ReadCount();
+  absl::InlinedVector<BufferView*, 8> src_locals(src_count);
+  for (int i = 0; i < src_count; ++i) {
+    src_locals[i] = reader->ReadLocal();
+  }
+  auto program = reader->ReadIndexList();
+  auto* dst_local = reader->ReadLocal();
+  for (auto* src_local : src_locals) {
+    RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
+  }
+  switch (dst_local->element_size) {
+#if defined(IREE_SUPPORT_F32)
+    case 4:
+      return ApplyElementwiseProgram<float>(src_locals, program, dst_local);
+#endif  // IREE_SUPPORT_F32
+#if defined(IREE_SUPPORT_F64)
+    case 8:
+      return ApplyElementwiseProgram<double>(src_locals, program, dst_local);
+#endif  // IREE_SUPPORT_F64
+    default:
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unimplemented element size: " << dst_local->element_size;
+  }
+}
+
 Status ValidateElementwiseUnaryOp(BufferView* src_local,
                                   BufferView* dst_local) {
   // TODO(benvanik): validate shapes.
@@ -80,14 +105,24 @@ Status ValidateMatMulOpF(BufferView* lhs_local, BufferView* rhs_local,
   return OkStatus();
 }
 
+Status ValidateRoundingMode(int32_t rounding_mode) {
+  switch (static_cast<RoundingMode>(rounding_mode)) {
+    case RoundingMode::kToNearest:
+    case RoundingMode::kTowardZero:
+      return OkStatus();
+  }
+  return InvalidArgumentErrorBuilder(IREE_LOC)
+         << "Unknown rounding mode " << rounding_mode;
+}
+
 Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
                  BufferView* dst_local, absl::Span<const int32_t> dst_indices,
                  absl::Span<const int32_t> lengths) {
   ASSIGN_OR_RETURN(auto src_buffer,
-                   src_local->buffer->MapMemory<uint8_t>(MemoryAccess::kRead));
+                   MapLocal<uint8_t>(src_local, MemoryAccess::kRead));
   // TODO(benvanik): discard if overwriting the entire buffer.
   ASSIGN_OR_RETURN(auto dst_buffer,
-                   dst_local->buffer->MapMemory<uint8_t>(MemoryAccess::kWrite));
+                   MapLocal<uint8_t>(dst_local, MemoryAccess::kWrite));
   switch (src_local->element_size) {
     case 1:
       return kernels::Copy::Execute<1>(src_buffer.contents(), src_local->shape,
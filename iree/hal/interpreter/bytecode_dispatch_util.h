@@ -56,15 +56,56 @@ Status ValidateMatMulOpI(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* dst_local);
 Status ValidateMatMulOpF(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local, BufferView* dst_local);
+// Returns an error if |rounding_mode| is not a RoundingMode value.
+Status ValidateRoundingMode(int32_t rounding_mode);
+
+// The contents of a local for the duration of a kernel. Buffers in host
+// memory (the common case in the interpreter) are accessed directly; others
+// are mapped and unmapped when this goes out of scope.
+template <typename T>
+class LocalMemory {
+ public:
+  size_t size() const { return size_; }
+  absl::Span<const T> contents() const { return {data_, size_}; }
+  absl::Span<T> mutable_contents() { return {data_, size_}; }
+
+ private:
+  template <typename U>
+  friend StatusOr<LocalMemory<U>> MapLocal(const BufferView* local,
+                                           MemoryAccessBitfield memory_access);
+
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  MappedMemory<T> mapping_;
+};
+
+// Maps the whole buffer of |local| for |memory_access|. Equivalent to
+// Buffer::MapMemory<T> but without any overhead for host buffers.
+template <typename T>
+inline StatusOr<LocalMemory<T>> MapLocal(const BufferView* local,
+                                         MemoryAccessBitfield memory_access) {
+  LocalMemory<T> memory;
+  Buffer* buffer = local->buffer.get();
+  if (void* host_data = buffer->host_data(memory_access)) {
+    memory.data_ = static_cast<T*>(host_data);
+    memory.size_ = buffer->byte_length() / sizeof(T);
+    return memory;
+  }
+  ASSIGN_OR_RETURN(memory.mapping_, buffer->MapMemory<T>(memory_access));
+  memory.data_ = AnyBitSet(memory_access & MemoryAccess::kWrite)
+                     ? memory.mapping_.mutable_data()
+                     : const_cast<T*>(memory.mapping_.data());
+  memory.size_ = memory.mapping_.size();
+  return memory;
+}
 
 template <typename KERNEL, typename T, typename... ARGS>
 Status ApplyUnaryOp(BufferView* src_local, BufferView* dst_local,
                     ARGS... args) {
-  // TODO(benvanik): avoid mapping by changing buffer type?
   ASSIGN_OR_RETURN(auto src_buffer,
-                   src_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
+                   MapLocal<T>(src_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
   return KERNEL::Execute(src_buffer.contents(), dst_buffer.mutable_contents(),
                          args...);
 }
@@ -73,11 +114,11 @@ template <typename KERNEL, typename T, typename... ARGS>
 Status ApplyBinaryOp(BufferView* lhs_local, BufferView* rhs_local,
                      BufferView* dst_local, ARGS... args) {
   ASSIGN_OR_RETURN(auto lhs_buffer,
-                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                   MapLocal<T>(lhs_local, MemoryAccess::kRead));
   ASSIGN_OR_RETURN(auto rhs_buffer,
-                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
+                   MapLocal<T>(rhs_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
   return KERNEL::Execute(lhs_buffer.contents(), rhs_buffer.contents(),
                          dst_buffer.mutable_contents(), args...);
 }
@@ -86,14 +127,11 @@ template <typename KERNEL, typename T, typename... ARGS>
 Status ApplyTernaryOp(BufferView* a_local, BufferView* b_local,
                       BufferView* c_local, BufferView* dst_local,
                       ARGS... args) {
-  ASSIGN_OR_RETURN(auto a_buffer,
-                   a_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto b_buffer,
-                   b_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto c_buffer,
-                   c_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
+  ASSIGN_OR_RETURN(auto a_buffer, MapLocal<T>(a_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto b_buffer, MapLocal<T>(b_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto c_buffer, MapLocal<T>(c_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
   return KERNEL::Execute(a_buffer.contents(), b_buffer.contents(),
                          c_buffer.contents(), dst_buffer.mutable_contents(),
                          args...);
@@ -103,11 +141,11 @@ template <typename KERNEL, typename T>
 Status ApplyComparisonOp(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* dst_local) {
   ASSIGN_OR_RETURN(auto lhs_buffer,
-                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                   MapLocal<T>(lhs_local, MemoryAccess::kRead));
   ASSIGN_OR_RETURN(auto rhs_buffer,
-                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<uint8_t>(
-                                        MemoryAccess::kDiscardWrite));
+                   MapLocal<T>(rhs_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<uint8_t>(dst_local, MemoryAccess::kDiscardWrite));
   return KERNEL::Execute(lhs_buffer.contents(), rhs_buffer.contents(),
                          dst_buffer.mutable_contents());
 }
@@ -354,8 +392,11 @@ Status ApplyComparisonOpF(BufferView* lhs_local, BufferView* rhs_local,
   }
 }
 
+// |constant_owner| identifies the module owning any constant RHS/filter
+// buffers so that their cached packed form can be evicted with it.
 template <typename T, typename ACC = int32_t>
 Status ApplyMatMulOpI(kernels::MatMul::RuntimeState* runtime_state,
+                      const void* constant_owner,
                       BufferView* lhs_local, BufferView* rhs_local,
                       BufferView* bias_local,
                       BufferView* multiplier_mantissa_local,
@@ -363,121 +404,277 @@ Status ApplyMatMulOpI(kernels::MatMul::RuntimeState* runtime_state,
                       BufferView* dst_local) {
   kernels::MatMul::Buffers<T, ACC> buffers;
   ASSIGN_OR_RETURN(auto lhs_buffer,
-                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                   MapLocal<T>(lhs_local, MemoryAccess::kRead));
   buffers.lhs_buffer = lhs_buffer.contents();
   buffers.lhs_shape = lhs_local->shape;
   ASSIGN_OR_RETURN(auto rhs_buffer,
-                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                   MapLocal<T>(rhs_local, MemoryAccess::kRead));
   buffers.rhs_buffer = rhs_buffer.contents();
   buffers.rhs_shape = rhs_local->shape;
-  MappedMemory<ACC> bias_buffer;
+  if (AllBitsSet(rhs_local->buffer->usage(), BufferUsage::kConstant)) {
+    buffers.rhs_constant_buffer = rhs_local->buffer.get();
+    buffers.rhs_constant_owner = constant_owner;
+  }
+  LocalMemory<ACC> bias_buffer;
   if (bias_local && bias_local->buffer && !bias_local->shape.empty()) {
     if (bias_local->element_size != sizeof(ACC)) {
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Only " << sizeof(ACC) << "b biases are supported right now";
     }
     ASSIGN_OR_RETURN(bias_buffer,
-                     bias_local->buffer->MapMemory<ACC>(MemoryAccess::kRead));
+                     MapLocal<ACC>(bias_local, MemoryAccess::kRead));
     buffers.bias_buffer = bias_buffer.contents();
   }
-  ASSIGN_OR_RETURN(
-      auto multiplier_mantissa_buffer,
-      multiplier_mantissa_local->buffer->MapMemory<ACC>(MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto multiplier_mantissa_buffer,
+                   MapLocal<ACC>(multiplier_mantissa_local,
+                                 MemoryAccess::kRead));
   buffers.multiplier_mantissa_buffer = multiplier_mantissa_buffer.contents();
   ASSIGN_OR_RETURN(auto multiplier_exponent_buffer,
-                   multiplier_exponent_local->buffer->MapMemory<int32_t>(
-                       MemoryAccess::kRead));
+                   MapLocal<int32_t>(multiplier_exponent_local,
+                                     MemoryAccess::kRead));
   buffers.multiplier_exponent_buffer = multiplier_exponent_buffer.contents();
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
   buffers.dst_buffer = dst_buffer.mutable_contents();
   buffers.dst_shape = dst_local->shape;
   return kernels::MatMul::Execute(runtime_state, buffers);
 }
 
+// |clamp_min_local| and |clamp_max_local| are optional scalars bounding the
+// result after the bias is added, such as [0, inf] for a fused relu.
 template <typename T>
 Status ApplyMatMulOpF(kernels::MatMul::RuntimeState* runtime_state,
+                      const void* constant_owner,
                       BufferView* lhs_local, BufferView* rhs_local,
-                      BufferView* bias_local, BufferView* dst_local) {
+                      BufferView* bias_local, BufferView* dst_local,
+                      BufferView* clamp_min_local = nullptr,
+                      BufferView* clamp_max_local = nullptr) {
   kernels::MatMul::Buffers<T, T> buffers;
   ASSIGN_OR_RETURN(auto lhs_buffer,
-                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                   MapLocal<T>(lhs_local, MemoryAccess::kRead));
   buffers.lhs_buffer = lhs_buffer.contents();
   buffers.lhs_shape = lhs_local->shape;
   ASSIGN_OR_RETURN(auto rhs_buffer,
-                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                   MapLocal<T>(rhs_local, MemoryAccess::kRead));
   buffers.rhs_buffer = rhs_buffer.contents();
   buffers.rhs_shape = rhs_local->shape;
-  MappedMemory<T> bias_buffer;
+  if (AllBitsSet(rhs_local->buffer->usage(), BufferUsage::kConstant)) {
+    buffers.rhs_constant_buffer = rhs_local->buffer.get();
+    buffers.rhs_constant_owner = constant_owner;
+  }
+  LocalMemory<T> bias_buffer;
   if (bias_local && bias_local->buffer && !bias_local->shape.empty()) {
     ASSIGN_OR_RETURN(bias_buffer,
-                     bias_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+                     MapLocal<T>(bias_local, MemoryAccess::kRead));
     buffers.bias_buffer = bias_buffer.contents();
   }
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
+  if (clamp_min_local) {
+    ASSIGN_OR_RETURN(auto clamp_min_buffer,
+                     MapLocal<T>(clamp_min_local, MemoryAccess::kRead));
+    buffers.clamp_min = clamp_min_buffer.contents()[0];
+  }
+  if (clamp_max_local) {
+    ASSIGN_OR_RETURN(auto clamp_max_buffer,
+                     MapLocal<T>(clamp_max_local, MemoryAccess::kRead));
+    buffers.clamp_max = clamp_max_buffer.contents()[0];
+  }
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
   buffers.dst_buffer = dst_buffer.mutable_contents();
   buffers.dst_shape = dst_local->shape;
   return kernels::MatMul::Execute(runtime_state, buffers);
 }
 
+template <typename T>
+Status ApplyConvOpF(kernels::MatMul::RuntimeState* runtime_state,
+                    const void* constant_owner,
+                    BufferView* src_local, BufferView* filter_local,
+                    BufferView* dst_local,
+                    const kernels::Conv2D::Params& params) {
+  kernels::Conv2D::Buffers<T> buffers;
+  ASSIGN_OR_RETURN(auto src_buffer,
+                   MapLocal<T>(src_local, MemoryAccess::kRead));
+  buffers.src_buffer = src_buffer.contents();
+  buffers.src_shape = src_local->shape;
+  ASSIGN_OR_RETURN(auto filter_buffer,
+                   MapLocal<T>(filter_local, MemoryAccess::kRead));
+  buffers.filter_buffer = filter_buffer.contents();
+  buffers.filter_shape = filter_local->shape;
+  if (AllBitsSet(filter_local->buffer->usage(), BufferUsage::kConstant)) {
+    buffers.filter_constant_buffer = filter_local->buffer.get();
+    buffers.filter_constant_owner = constant_owner;
+  }
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
+  buffers.dst_buffer = dst_buffer.mutable_contents();
+  buffers.dst_shape = dst_local->shape;
+  return kernels::Conv2D::Execute(runtime_state, buffers, params);
+}
+
+template <typename SRC, typename DST>
+Status ApplyRequantizeOp(BufferView* src_local, BufferView* mantissa_local,
+                         BufferView* exponent_local,
+                         BufferView* zero_point_local,
+                         RoundingMode rounding_mode, BufferView* dst_local) {
+  ASSIGN_OR_RETURN(auto src_buffer,
+                   MapLocal<SRC>(src_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto mantissa_buffer,
+                   MapLocal<int32_t>(mantissa_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto exponent_buffer,
+                   MapLocal<int32_t>(exponent_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto zero_point_buffer,
+                   MapLocal<int32_t>(zero_point_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<DST>(dst_local, MemoryAccess::kDiscardWrite));
+  return kernels::Requantize::Execute(
+      src_buffer.contents(), mantissa_buffer.contents(),
+      exponent_buffer.contents(), zero_point_buffer.contents(),
+      dst_buffer.mutable_contents(), dst_local->shape, rounding_mode);
+}
+
+template <typename SRC>
+Status ApplyRequantizeOpIS(BufferView* src_local, BufferView* mantissa_local,
+                           BufferView* exponent_local,
+                           BufferView* zero_point_local,
+                           RoundingMode rounding_mode, BufferView* dst_local) {
+  switch (dst_local->element_size) {
+    case 1:
+      return ApplyRequantizeOp<SRC, int8_t>(src_local, mantissa_local,
+                                            exponent_local, zero_point_local,
+                                            rounding_mode, dst_local);
+    case 2:
+      return ApplyRequantizeOp<SRC, int16_t>(src_local, mantissa_local,
+                                             exponent_local, zero_point_local,
+                                             rounding_mode, dst_local);
+    case 4:
+      return ApplyRequantizeOp<SRC, int32_t>(src_local, mantissa_local,
+                                             exponent_local, zero_point_local,
+                                             rounding_mode, dst_local);
+    default:
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unimplemented element size: " << dst_local->element_size;
+  }
+}
+
+template <typename KERNEL, typename T>
+Status ApplyQuantizedBinaryOp(BufferView* lhs_local, BufferView* rhs_local,
+                              BufferView* mantissa_local,
+                              BufferView* exponent_local,
+                              BufferView* zero_point_local,
+                              RoundingMode rounding_mode,
+                              BufferView* dst_local) {
+  ASSIGN_OR_RETURN(auto lhs_buffer,
+                   MapLocal<T>(lhs_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto rhs_buffer,
+                   MapLocal<T>(rhs_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto mantissa_buffer,
+                   MapLocal<int32_t>(mantissa_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto exponent_buffer,
+                   MapLocal<int32_t>(exponent_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto zero_point_buffer,
+                   MapLocal<int32_t>(zero_point_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
+  return KERNEL::Execute(lhs_buffer.contents(), rhs_buffer.contents(),
+                         mantissa_buffer.contents(), exponent_buffer.contents(),
+                         zero_point_buffer.contents(),
+                         dst_buffer.mutable_contents(), rounding_mode);
+}
+
+template <typename KERNEL>
+Status ApplyQuantizedBinaryOpIS(BufferView* lhs_local, BufferView* rhs_local,
+                                BufferView* mantissa_local,
+                                BufferView* exponent_local,
+                                BufferView* zero_point_local,
+                                RoundingMode rounding_mode,
+                                BufferView* dst_local) {
+  switch (lhs_local->element_size) {
+    case 1:
+      return ApplyQuantizedBinaryOp<KERNEL, int8_t>(
+          lhs_local, rhs_local, mantissa_local, exponent_local,
+          zero_point_local, rounding_mode, dst_local);
+    case 2:
+      return ApplyQuantizedBinaryOp<KERNEL, int16_t>(
+          lhs_local, rhs_local, mantissa_local, exponent_local,
+          zero_point_local, rounding_mode, dst_local);
+    default:
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unimplemented element size: " << lhs_local->element_size;
+  }
+}
+
+template <typename T, typename ACC>
+Status ApplyReduceSumWideningOp(BufferView* src_local, BufferView* init_local,
+                                BufferView* dst_local, int32_t dimension) {
+  ASSIGN_OR_RETURN(auto src_buffer,
+                   MapLocal<T>(src_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto init_buffer,
+                   MapLocal<ACC>(init_local, MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<ACC>(dst_local, MemoryAccess::kDiscardWrite));
+  return kernels::ReduceSumWidening::Execute(
+      src_buffer.contents(), init_buffer.contents(),
+      dst_buffer.mutable_contents(), dimension, src_local->shape,
+      dst_local->shape);
+}
+
 template <typename KERNEL>
 Status DispatchElementwiseUnaryOpIS(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* src_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
   return ApplyUnaryOpIS<KERNEL>(src_local, dst_local);
 }
 
 template <typename KERNEL>
 Status DispatchElementwiseUnaryOpIU(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* src_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
   return ApplyUnaryOpIU<KERNEL>(src_local, dst_local);
 }
 
 template <typename KERNEL>
 Status DispatchElementwiseUnaryOpF(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* src_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
   return ApplyUnaryOpF<KERNEL>(src_local, dst_local);
 }
 
 template <typename KERNEL>
 Status DispatchElementwiseBinaryOpIS(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* lhs_local = reader->ReadLocal();
+  auto* rhs_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
   return ApplyBinaryOpIS<KERNEL>(lhs_local, rhs_local, dst_local);
 }
 
 template <typename KERNEL>
 Status DispatchElementwiseBinaryOpIU(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* lhs_local = reader->ReadLocal();
+  auto* rhs_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
   return ApplyBinaryOpIU<KERNEL>(lhs_local, rhs_local, dst_local);
 }
 
 template <typename KERNEL>
 Status DispatchElementwiseBinaryOpF(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* lhs_local = reader->ReadLocal();
+  auto* rhs_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
   return ApplyBinaryOpF<KERNEL>(lhs_local, rhs_local, dst_local);
 }
 
 template <typename KERNEL>
 Status DispatchElementwiseTernaryOpIS(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* a_local = reader->ReadLocal();
+  auto* b_local = reader->ReadLocal();
+  auto* c_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
   return ApplyTernaryOpIS<KERNEL>(a_local, b_local, c_local, dst_local);
@@ -485,10 +682,10 @@ Status DispatchElementwiseTernaryOpIS(vm::BytecodeReader* reader) {
 
 template <typename KERNEL>
 Status DispatchElementwiseTernaryOpIU(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* a_local = reader->ReadLocal();
+  auto* b_local = reader->ReadLocal();
+  auto* c_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
   return ApplyTernaryOpIU<KERNEL>(a_local, b_local, c_local, dst_local);
@@ -496,15 +693,37 @@ Status DispatchElementwiseTernaryOpIU(vm::BytecodeReader* reader) {
 
 template <typename KERNEL>
 Status DispatchElementwiseTernaryOpF(vm::BytecodeReader* reader) {
-  ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
-  ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
+  auto* a_local = reader->ReadLocal();
+  auto* b_local = reader->ReadLocal();
+  auto* c_local = reader->ReadLocal();
+  auto* dst_local = reader->ReadLocal();
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
   return ApplyTernaryOpF<KERNEL>(a_local, b_local, c_local, dst_local);
 }
 
+template <typename T>
+Status ApplyElementwiseProgram(absl::Span<BufferView* const> src_locals,
+                               absl::Span<const int32_t> program,
+                               BufferView* dst_local) {
+  absl::InlinedVector<LocalMemory<T>, 8> src_mappings;
+  absl::InlinedVector<absl::Span<const T>, 8> src_buffers;
+  src_mappings.reserve(src_locals.size());
+  for (auto* src_local : src_locals) {
+    ASSIGN_OR_RETURN(auto src_mapping,
+                     MapLocal<T>(src_local, MemoryAccess::kRead));
+    src_mappings.push_back(std::move(src_mapping));
+    src_buffers.push_back(src_mappings.back().contents());
+  }
+  ASSIGN_OR_RETURN(auto dst_buffer,
+                   MapLocal<T>(dst_local, MemoryAccess::kDiscardWrite));
+  return kernels::ElementwiseProgram::Execute<T>(
+      src_buffers, program, dst_buffer.mutable_contents());
+}
+
+// Dispatches a fused kElementwiseF op: srcs..., program, dst.
+Status DispatchElementwiseProgramF(vm::BytecodeReader* reader);
+
 Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
                  BufferView* dst_local, absl::Span<const int32_t> dst_indices,
                  absl::Span<const int32_t> lengths);
@@ -16,8 +16,8 @@
 
 #include <iostream>
 
+#include "iree/vm/bytecode_reader.h"
 #include "iree/vm/bytecode_tables_interpreter.h"
-#include "iree/vm/bytecode_validator.h"
 #include "iree/vm/module.h"
 #include "iree/vm/module_printer.h"
 
@@ -31,12 +31,13 @@ const bool kEnableExecutablePrinting = false;
 
 // static
 StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::Load(
-    hal::Allocator* allocator, ExecutableSpec spec, bool allow_aliasing_data) {
+    hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state,
+    ExecutableSpec spec, bool allow_aliasing_data) {
   // Allocate the executable now.
   // We do this here so that if we need to clone the data we are passing that
   // to the VM loader instead of the data we may not have access to later.
-  auto executable =
-      make_ref<BytecodeExecutable>(allocator, spec, allow_aliasing_data);
+  auto executable = make_ref<BytecodeExecutable>(
+      allocator, kernel_runtime_state, spec, allow_aliasing_data);
   auto* context = executable->mutable_context();
 
   // Create the executable module.
@@ -50,10 +51,26 @@ StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::Load(
   // We do this here so that we get a good stack immediately when the bytecode
   // is provided instead of when we go to run it. This more closely mirrors how
   // a backend that performed compilation (such as SPIR-V) would fail.
-  for (auto* function_def :
-       *executable->module().function_table().def().functions()) {
-    RETURN_IF_ERROR(vm::BytecodeValidator::Validate(
-        *context, executable->module(), *function_def->bytecode()));
+  // Prepared functions are cached in the function table so that dispatch can
+  // decode their bytecode without further checks and reuse their constants.
+  const auto& function_table = executable->module().function_table();
+  for (int i = 0; i < function_table.def().functions()->size(); ++i) {
+    ASSIGN_OR_RETURN(auto function, function_table.LookupFunction(i));
+    RETURN_IF_ERROR(vm::BytecodeReader::PrepareFunction(
+                        vm::interpreter_opcode_table(), function, i)
+                        .status());
+  }
+
+  // Determine which exports may be split into independent tiles.
+  // We do this once here as it requires a full walk of the bytecode.
+  const auto* exports = executable->module().function_table().def().exports();
+  int export_count = exports ? exports->size() : 0;
+  executable->export_tilings_.reserve(export_count);
+  for (int i = 0; i < export_count; ++i) {
+    ASSIGN_OR_RETURN(auto function,
+                     executable->module().function_table().LookupExport(i));
+    ASSIGN_OR_RETURN(auto tiling, BytecodeTiling::Analyze(function));
+    executable->export_tilings_.push_back(std::move(tiling));
   }
 
   // Print the bytecode.
@@ -69,10 +86,10 @@ StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::Load(
   return executable;
 }
 
-BytecodeExecutable::BytecodeExecutable(hal::Allocator* allocator,
-                                       ExecutableSpec spec,
-                                       bool allow_aliasing_data)
-    : spec_(spec), context_(allocator) {
+BytecodeExecutable::BytecodeExecutable(
+    hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state,
+    ExecutableSpec spec, bool allow_aliasing_data)
+    : spec_(spec), context_(allocator, kernel_runtime_state) {
   if (!allow_aliasing_data) {
     // Clone data.
     cloned_executable_data_ = {spec.executable_data.begin(),
@@ -81,7 +98,14 @@ BytecodeExecutable::BytecodeExecutable(hal::Allocator* allocator,
   }
 }
 
-BytecodeExecutable::~BytecodeExecutable() = default;
+BytecodeExecutable::~BytecodeExecutable() {
+  // The kernel runtime state is shared by the device and outlives us; drop any
+  // constants it has packed from our modules so their buffers are released.
+  auto* mat_mul_state = context_.kernel_runtime_state()->mat_mul_state.get();
+  for (const auto& module : context_.modules()) {
+    mat_mul_state->EvictPrepackedRhs(module.get());
+  }
+}
 
 }  // namespace hal
 }  // namespace iree
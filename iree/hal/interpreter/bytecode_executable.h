@@ -22,6 +22,8 @@
 #include "iree/hal/allocator.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_spec.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+#include "iree/hal/interpreter/bytecode_tiling.h"
 #include "iree/hal/interpreter/interpreter_context.h"
 #include "iree/vm/context.h"
 
@@ -30,12 +32,15 @@ namespace hal {
 
 class BytecodeExecutable final : public Executable {
  public:
-  static StatusOr<ref_ptr<BytecodeExecutable>> Load(hal::Allocator* allocator,
-                                                    ExecutableSpec spec,
-                                                    bool allow_aliasing_data);
+  // |kernel_runtime_state| is shared with all other executables on the device
+  // and must outlive the executable.
+  static StatusOr<ref_ptr<BytecodeExecutable>> Load(
+      hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state,
+      ExecutableSpec spec, bool allow_aliasing_data);
 
-  BytecodeExecutable(hal::Allocator* allocator, ExecutableSpec spec,
-                     bool allow_aliasing_data);
+  BytecodeExecutable(hal::Allocator* allocator,
+                     kernels::RuntimeState* kernel_runtime_state,
+                     ExecutableSpec spec, bool allow_aliasing_data);
   ~BytecodeExecutable() override;
 
   bool supports_debugging() const override { return false; }
@@ -54,12 +59,23 @@ class BytecodeExecutable final : public Executable {
   // module can be used to lookup executable exports.
   const vm::Module& module() const { return *module_; }
 
+  // Tiling description of the exported function with the given ordinal.
+  // Returns an untileable description if the ordinal is out of range.
+  const BytecodeTiling& export_tiling(int export_ordinal) const {
+    static const BytecodeTiling kUntileable;
+    return export_ordinal >= 0 && export_ordinal < export_tilings_.size()
+               ? export_tilings_[export_ordinal]
+               : kUntileable;
+  }
+
  private:
   ExecutableSpec spec_;
   std::vector<uint8_t> cloned_executable_data_;
 
   InterpreterContext context_;
   vm::Module* module_ = nullptr;
+
+  std::vector<BytecodeTiling> export_tilings_;
 };
 
 }  // namespace hal
@@ -21,24 +21,30 @@
 // and attributes.
 //
 // Kernels may optionally have runtime state. This is state that is allocated
-// once for the entire Runtime (and stored on RuntimeState) and shared across
-// all fibers. This enables kernels that may require thread pools or device
-// handles to be shared while kernels that require transient storage to be safe
-// to use from multiple fibers concurrently.
+// once per device (and stored on RuntimeState) and shared across all
+// executables and fibers. This enables kernels that may require thread pools or
+// device handles to be shared while kernels that require transient storage to
+// be safe to use from multiple fibers concurrently.
 //
 // All kernels are templated to enable specialization of particular types or
 // type combinations. By default the bytecode_kernels_generic.h will provide C++
 // semantics as reference and platform-specific versions can be implemented
-// as needed.
+// as needed. bytecode_kernels_simd.h provides vectorized versions of the
+// elementwise kernels unless IREE_HAL_INTERPRETER_GENERIC_KERNELS_ONLY is
+// defined.
 
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_H_
 
+#include <array>
 #include <cstdint>
+#include <limits>
 
 #include "absl/types/span.h"
 #include "iree/base/shape.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
 
 namespace iree {
 namespace hal {
@@ -297,16 +303,87 @@ struct Ceil {
                         absl::Span<T> dst_buffer);
 };
 
+// Evaluates a fused chain of elementwise ops (see IREE_ELEMENTWISE_OP_LIST)
+// over all elements of |dst_buffer|. Elements are processed in small tiles
+// such that intermediate values stay in cache instead of being materialized
+// for the entire buffer.
+struct ElementwiseProgram {
+  // Maximum number of elements processed per tile.
+  static constexpr size_t kTileSize = 512;
+  // Bytes of stack used for the intermediate tiles. Long programs use smaller
+  // tiles such that all intermediates fit.
+  static constexpr size_t kScratchSize = 32 * 1024;
+
+  template <typename T>
+  static Status Execute(absl::Span<const absl::Span<const T>> src_buffers,
+                        absl::Span<const int32_t> program,
+                        absl::Span<T> dst_buffer);
+};
+
 struct Convert {
   template <typename SRC, typename DST>
   static Status Execute(absl::Span<const SRC> src_buffer,
                         absl::Span<DST> dst_buffer);
 };
 
+// Quantized kernels operate on affine quantized integers and express
+// real-valued scale ratios as fixed-point multipliers with the same encoding as
+// MatMul: a Q0.31 int32 mantissa in [2^30, 2^31) and a power-of-two exponent
+// (positive exponents shift left). Results are rounded per |rounding_mode| and
+// saturated to the range of the destination type. kTowardZero matches
+// dequantizing, computing in float and converting back (AddQ sums its rescaled
+// operands with 40 fractional bits).
+
+// Rescales each element of |src_buffer| by the multiplier and stores it as
+// DST, such as when narrowing int32 accumulators to int8. The multiplier
+// buffers may hold a single value or, for values of rank >= 2, one value per
+// index of the innermost dimension (per-channel). |zero_point_buffer| holds
+// the [src, dst] zero points: the src zero point is subtracted before scaling
+// and the dst zero point added after.
+struct Requantize {
+  template <typename SRC, typename DST>
+  static Status Execute(absl::Span<const SRC> src_buffer,
+                        absl::Span<const int32_t> multiplier_mantissa_buffer,
+                        absl::Span<const int32_t> multiplier_exponent_buffer,
+                        absl::Span<const int32_t> zero_point_buffer,
+                        absl::Span<DST> dst_buffer, const Shape& dst_shape,
+                        RoundingMode rounding_mode);
+};
+
+// Adds two quantized tensors with different scales. The two multipliers
+// rescale lhs and rhs respectively into the scale of dst.
+// |zero_point_buffer| holds the [lhs, rhs, dst] zero points.
+struct AddQ {
+  template <typename T>
+  static Status Execute(absl::Span<const T> lhs_buffer,
+                        absl::Span<const T> rhs_buffer,
+                        absl::Span<const int32_t> multiplier_mantissa_buffer,
+                        absl::Span<const int32_t> multiplier_exponent_buffer,
+                        absl::Span<const int32_t> zero_point_buffer,
+                        absl::Span<T> dst_buffer, RoundingMode rounding_mode);
+};
+
+// Multiplies two quantized tensors. The single multiplier is
+// lhs_scale * rhs_scale / dst_scale. |zero_point_buffer| holds the
+// [lhs, rhs, dst] zero points.
+struct MulQ {
+  template <typename T>
+  static Status Execute(absl::Span<const T> lhs_buffer,
+                        absl::Span<const T> rhs_buffer,
+                        absl::Span<const int32_t> multiplier_mantissa_buffer,
+                        absl::Span<const int32_t> multiplier_exponent_buffer,
+                        absl::Span<const int32_t> zero_point_buffer,
+                        absl::Span<T> dst_buffer, RoundingMode rounding_mode);
+};
+
 struct MatMul {
+  // Thread-safe; may be used by any number of concurrent executions.
   struct RuntimeState;
 
-  static std::unique_ptr<RuntimeState> CreateRuntimeState();
+  // |max_thread_count| bounds the number of threads used by all matmuls and
+  // is divided between up to |context_count| concurrently executing matmuls.
+  static std::unique_ptr<RuntimeState> CreateRuntimeState(
+      int max_thread_count = 1, int context_count = 1);
 
   template <typename T, typename ACC>
   struct Buffers {
@@ -314,17 +391,35 @@ struct MatMul {
     absl::Span<const T> lhs_buffer;
     Shape rhs_shape;
     absl::Span<const T> rhs_buffer;
+    // Optional buffer backing |rhs_buffer| when its contents are immutable
+    // (such as module constants). The RHS is then packed once and the packed
+    // form reused by all subsequent executions with the same buffer.
+    Buffer* rhs_constant_buffer = nullptr;
+    // Identifies what owns |rhs_constant_buffer| (such as the executable
+    // module). The packed form is cached until the owner is released with
+    // RuntimeState::EvictPrepackedRhs.
+    const void* rhs_constant_owner = nullptr;
     Shape dst_shape;
     absl::Span<T> dst_buffer;
 
-    // Optional bias buffer.
+    // Optional bias buffer with one element per column of the destination
+    // matrix, added to each row.
     absl::Span<const ACC> bias_buffer;
 
     // Fixed-point multiplier mantissa/exponent. May be a single value (for
-    // uniform quantization) or one element per row of the destination matrix
-    // for per-channel.
+    // uniform quantization) or one element per column of the destination
+    // matrix for per-channel.
     absl::Span<const ACC> multiplier_mantissa_buffer;
     absl::Span<const int32_t> multiplier_exponent_buffer;
+
+    // Bounds each destination element is clamped to after the bias is added.
+    // Defaults to the full range of T such that no clamping is performed.
+    T clamp_min = std::numeric_limits<T>::has_infinity
+                      ? -std::numeric_limits<T>::infinity()
+                      : std::numeric_limits<T>::lowest();
+    T clamp_max = std::numeric_limits<T>::has_infinity
+                      ? std::numeric_limits<T>::infinity()
+                      : std::numeric_limits<T>::max();
   };
 
   template <typename T, typename ACC>
@@ -332,9 +427,60 @@ struct MatMul {
                         const Buffers<T, ACC>& buffers);
 };
 
+// Runtime state of all kernels, shared by all executables on a device.
 struct RuntimeState {
-  std::unique_ptr<MatMul::RuntimeState> mat_mul_state =
-      MatMul::CreateRuntimeState();
+  struct Options {
+    // Maximum number of threads used by all matmuls.
+    int mat_mul_max_thread_count = 1;
+    // Number of matmuls that may execute concurrently, each with an equal
+    // share of |mat_mul_max_thread_count|.
+    int mat_mul_context_count = 1;
+  };
+
+  RuntimeState() : RuntimeState(Options{}) {}
+  explicit RuntimeState(Options options)
+      : mat_mul_state(
+            MatMul::CreateRuntimeState(options.mat_mul_max_thread_count,
+                                       options.mat_mul_context_count)) {}
+
+  std::unique_ptr<MatMul::RuntimeState> mat_mul_state;
+};
+
+// 2D convolution of an NHWC input with an HWIO filter into an NHWC output
+// (the TensorFlow default dimension numbers of xla_hlo.conv). The filter input
+// feature dimension is the input feature count divided by the
+// feature_group_count; depthwise convolutions have one group per input
+// feature.
+struct Conv2D {
+  struct Params {
+    // [height, width]
+    std::array<int32_t, 2> strides = {{1, 1}};
+    // Implicit zero padding: [top, bottom, left, right]
+    std::array<int32_t, 4> padding = {{0, 0, 0, 0}};
+    // Filter dilation: [height, width]
+    std::array<int32_t, 2> dilation = {{1, 1}};
+    int32_t feature_group_count = 1;
+  };
+
+  template <typename T>
+  struct Buffers {
+    Shape src_shape;
+    absl::Span<const T> src_buffer;
+    Shape filter_shape;
+    absl::Span<const T> filter_buffer;
+    // Optional buffer backing |filter_buffer| when its contents are
+    // immutable. See MatMul::Buffers::rhs_constant_buffer and _owner.
+    Buffer* filter_constant_buffer = nullptr;
+    const void* filter_constant_owner = nullptr;
+    Shape dst_shape;
+    absl::Span<T> dst_buffer;
+  };
+
+  // Convolutions that map onto a single matrix multiplication use the matmul
+  // kernel and its |runtime_state|.
+  template <typename T>
+  static Status Execute(MatMul::RuntimeState* runtime_state,
+                        const Buffers<T>& buffers, const Params& params);
 };
 
 struct ReduceSum {
@@ -345,6 +491,16 @@ struct ReduceSum {
                         const Shape& src_shape, const Shape& dst_shape);
 };
 
+// Sums a narrow integer type into a wider accumulator type (such as int8 into
+// int32) without widening the source in memory.
+struct ReduceSumWidening {
+  template <typename T, typename ACC>
+  static Status Execute(absl::Span<const T> src_buffer,
+                        absl::Span<const ACC> init_buffer,
+                        absl::Span<ACC> dst_buffer, int32_t dimension,
+                        const Shape& src_shape, const Shape& dst_shape);
+};
+
 struct ReduceMin {
   template <typename T>
   static Status Execute(absl::Span<const T> src_buffer,
@@ -367,5 +523,8 @@ struct ReduceMax {
 
 #include "iree/hal/interpreter/bytecode_kernels_generic.h"  // IWYU pragma: export
 #include "iree/hal/interpreter/bytecode_kernels_ruy.h"  // IWYU pragma: export
+#if !defined(IREE_HAL_INTERPRETER_GENERIC_KERNELS_ONLY)
+#include "iree/hal/interpreter/bytecode_kernels_simd.h"  // IWYU pragma: export
+#endif  // !IREE_HAL_INTERPRETER_GENERIC_KERNELS_ONLY
 
 #endif  // IREE_HAL_INTERPRETER_BYTECODE_KERNELS_H_
@@ -0,0 +1,516 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures kernel throughput for the kernel implementation this binary was
+// built with. bytecode_kernels_benchmark uses the SIMD kernels
+// where available while bytecode_kernels_generic_benchmark is built with
+// IREE_HAL_INTERPRETER_GENERIC_KERNELS_ONLY; run both with
+// --benchmark_format=json to compare them. Convolutions are additionally
+// measured against the reference convolution kernel within each binary.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/shape.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+
+namespace iree {
+namespace hal {
+namespace kernels {
+namespace {
+
+#if defined(IREE_KERNELS_SIMD_VECTOR_BYTES)
+constexpr char kKernelsLabel[] = "simd";
+#else
+constexpr char kKernelsLabel[] = "generic";
+#endif  // IREE_KERNELS_SIMD_VECTOR_BYTES
+
+// Values in [0.5, 2.5) are in the domain of all of the kernels measured.
+template <typename T>
+std::vector<T> MakeValues(int count) {
+  std::vector<T> values(count);
+  for (int i = 0; i < count; ++i) {
+    values[i] = static_cast<T>(0.5 + (i % 64) / 32.0);
+  }
+  return values;
+}
+
+template <typename T>
+void SetThroughput(benchmark::State& state, int64_t element_count,
+                   int buffer_count) {
+  state.SetItemsProcessed(state.iterations() * element_count);
+  state.SetBytesProcessed(state.iterations() * element_count * sizeof(T) *
+                          buffer_count);
+  state.SetLabel(kKernelsLabel);
+}
+
+template <typename T>
+void SetThroughput(benchmark::State& state, int buffer_count) {
+  SetThroughput<T>(state, state.range(0), buffer_count);
+}
+
+template <typename KERNEL, typename T>
+void BM_UnaryKernel(benchmark::State& state) {
+  auto src_buffer = MakeValues<T>(state.range(0));
+  std::vector<T> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(KERNEL::template Execute<T>(
+        src_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 2);
+}
+
+template <typename KERNEL, typename T>
+void BM_BinaryKernel(benchmark::State& state) {
+  auto lhs_buffer = MakeValues<T>(state.range(0));
+  auto rhs_buffer = MakeValues<T>(state.range(0));
+  std::vector<T> dst_buffer(lhs_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(KERNEL::template Execute<T>(
+        lhs_buffer, rhs_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 3);
+}
+
+template <typename KERNEL, typename T>
+void BM_TernaryKernel(benchmark::State& state) {
+  auto a_buffer = MakeValues<T>(state.range(0));
+  auto b_buffer = MakeValues<T>(state.range(0));
+  auto c_buffer = MakeValues<T>(state.range(0));
+  std::vector<T> dst_buffer(a_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(KERNEL::template Execute<T>(
+        a_buffer, b_buffer, c_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 4);
+}
+
+template <typename KERNEL, typename T>
+void BM_CompareKernel(benchmark::State& state) {
+  auto lhs_buffer = MakeValues<T>(state.range(0));
+  std::vector<T> rhs_buffer(lhs_buffer.rbegin(), lhs_buffer.rend());
+  std::vector<uint8_t> dst_buffer(lhs_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(KERNEL::template Execute<T>(
+        lhs_buffer, rhs_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 2);
+}
+
+template <typename T>
+void BM_SelectKernel(benchmark::State& state) {
+  std::vector<uint8_t> cond_buffer(state.range(0));
+  for (int i = 0; i < cond_buffer.size(); ++i) cond_buffer[i] = i % 2;
+  auto lhs_buffer = MakeValues<T>(state.range(0));
+  auto rhs_buffer = MakeValues<T>(state.range(0));
+  std::vector<T> dst_buffer(lhs_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Select::Execute<T>(
+        cond_buffer, lhs_buffer, rhs_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 3);
+}
+
+template <typename SRC, typename DST>
+void BM_ConvertKernel(benchmark::State& state) {
+  auto src_buffer = MakeValues<SRC>(state.range(0));
+  std::vector<DST> dst_buffer(src_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Convert::Execute<SRC, DST>(src_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<DST>(state, 2);
+}
+
+// Evaluates tanh(a * b + c) with a fused program.
+template <typename T>
+void BM_ElementwiseProgram(benchmark::State& state) {
+  auto a_buffer = MakeValues<T>(state.range(0));
+  auto b_buffer = MakeValues<T>(state.range(0));
+  auto c_buffer = MakeValues<T>(state.range(0));
+  std::vector<T> dst_buffer(a_buffer.size());
+  std::vector<absl::Span<const T>> src_buffers = {a_buffer, b_buffer,
+                                                  c_buffer};
+  std::vector<int32_t> program = {
+      static_cast<int32_t>(ElementwiseOp::kMul) << 24 | 0 << 16 | 1 << 8,
+      static_cast<int32_t>(ElementwiseOp::kAdd) << 24 | 3 << 16 | 2 << 8,
+      static_cast<int32_t>(ElementwiseOp::kTanh) << 24 | 4 << 16,
+  };
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ElementwiseProgram::Execute<T>(
+        src_buffers, program, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 4);
+}
+
+// Copies the center quarter of a square matrix.
+template <int element_size>
+void BM_CopyKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  Shape src_shape = {dim, dim};
+  std::vector<uint8_t> src_buffer(dim * dim * element_size);
+  std::vector<int32_t> src_indices = {dim / 4, dim / 4};
+  Shape dst_shape = {dim / 2, dim / 2};
+  std::vector<uint8_t> dst_buffer(dim / 2 * dim / 2 * element_size);
+  std::vector<int32_t> dst_indices = {0, 0};
+  std::vector<int32_t> lengths = {dim / 2, dim / 2};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Copy::Execute<element_size>(
+        src_buffer, src_shape, src_indices, absl::MakeSpan(dst_buffer),
+        dst_shape, dst_indices, lengths));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<uint8_t>(state, dst_buffer.size(), 2);
+}
+
+template <typename T>
+void BM_TransposeKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  Shape src_shape = {dim, dim};
+  auto src_buffer = MakeValues<T>(dim * dim);
+  std::vector<T> dst_buffer(src_buffer.size());
+  std::vector<int32_t> perm = {1, 0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Transpose::Execute<T>(
+        src_buffer, absl::MakeSpan(dst_buffer), src_shape, perm));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, dst_buffer.size(), 2);
+}
+
+template <typename T>
+void BM_ReverseKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  Shape src_shape = {dim, dim};
+  auto src_buffer = MakeValues<T>(dim * dim);
+  std::vector<T> dst_buffer(src_buffer.size());
+  std::vector<int32_t> dimensions = {0, 1};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Reverse::Execute<T>(
+        src_buffer, absl::MakeSpan(dst_buffer), src_shape, dimensions));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, dst_buffer.size(), 2);
+}
+
+// Pads each edge of a square matrix with one element.
+template <typename T>
+void BM_PadKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  Shape src_shape = {dim, dim};
+  auto src_buffer = MakeValues<T>(dim * dim);
+  std::vector<T> padding_value = {0};
+  Shape dst_shape = {dim + 2, dim + 2};
+  std::vector<T> dst_buffer((dim + 2) * (dim + 2));
+  std::vector<int32_t> edge_padding = {1, 1};
+  std::vector<int32_t> interior_padding = {0, 0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Pad::Execute<T>(
+        src_buffer, padding_value, absl::MakeSpan(dst_buffer), src_shape,
+        dst_shape, edge_padding, edge_padding, interior_padding));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, dst_buffer.size(), 2);
+}
+
+// Tiles a square matrix 2x2.
+template <typename T>
+void BM_TileKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  Shape src_shape = {dim, dim};
+  auto src_buffer = MakeValues<T>(dim * dim);
+  Shape dst_shape = {dim * 2, dim * 2};
+  std::vector<T> dst_buffer(src_buffer.size() * 4);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Tile::Execute<T>(
+        src_buffer, absl::MakeSpan(dst_buffer), src_shape, dst_shape));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, dst_buffer.size(), 2);
+}
+
+template <typename T>
+void BM_BroadcastKernel(benchmark::State& state) {
+  auto src_buffer = MakeValues<T>(1);
+  std::vector<T> dst_buffer(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Broadcast::Execute<T>(src_buffer, absl::MakeSpan(dst_buffer)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 1);
+}
+
+// Reduces a square matrix along state.range(1).
+template <typename KERNEL, typename T>
+void BM_ReduceKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  int32_t dimension = state.range(1);
+  Shape src_shape = {dim, dim};
+  auto src_buffer = MakeValues<T>(dim * dim);
+  std::vector<T> init_buffer = {0};
+  Shape dst_shape = {dim};
+  std::vector<T> dst_buffer(dim);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(KERNEL::template Execute<T>(
+        src_buffer, init_buffer, absl::MakeSpan(dst_buffer), dimension,
+        src_shape, dst_shape));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, src_buffer.size(), 1);
+}
+
+// Reduces a square int8 matrix into int32 along state.range(1).
+void BM_ReduceSumWideningKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  int32_t dimension = state.range(1);
+  Shape src_shape = {dim, dim};
+  auto src_buffer = MakeValues<int8_t>(dim * dim);
+  std::vector<int32_t> init_buffer = {0};
+  Shape dst_shape = {dim};
+  std::vector<int32_t> dst_buffer(dim);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ReduceSumWidening::Execute<int8_t, int32_t>(
+        src_buffer, init_buffer, absl::MakeSpan(dst_buffer), dimension,
+        src_shape, dst_shape));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<int8_t>(state, src_buffer.size(), 1);
+}
+
+// Quantized binary ops with multipliers of 0.5.
+template <typename KERNEL, typename T>
+void BM_QuantizedBinaryKernel(benchmark::State& state) {
+  auto lhs_buffer = MakeValues<T>(state.range(0));
+  auto rhs_buffer = MakeValues<T>(state.range(0));
+  std::vector<int32_t> mantissa_buffer = {1 << 30, 1 << 30};
+  std::vector<int32_t> exponent_buffer = {0, 0};
+  std::vector<int32_t> zero_point_buffer = {1, -1, 0};
+  std::vector<T> dst_buffer(lhs_buffer.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(KERNEL::template Execute<T>(
+        lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+        zero_point_buffer, absl::MakeSpan(dst_buffer),
+        RoundingMode::kToNearest));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<T>(state, 3);
+}
+
+void BM_RequantizeKernel(benchmark::State& state) {
+  auto src_buffer = MakeValues<int32_t>(state.range(0));
+  std::vector<int32_t> mantissa_buffer = {1 << 30};
+  std::vector<int32_t> exponent_buffer = {0};
+  std::vector<int32_t> zero_point_buffer = {0, -1};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  Shape dst_shape = {static_cast<int>(dst_buffer.size())};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Requantize::Execute<int32_t, int8_t>(
+        src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+        absl::MakeSpan(dst_buffer), dst_shape, RoundingMode::kToNearest));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput<int8_t>(state, 5);
+}
+
+// Multiplies two square matrices.
+template <typename T>
+void BM_MatMulKernel(benchmark::State& state) {
+  int dim = state.range(0);
+  auto lhs_buffer = MakeValues<T>(dim * dim);
+  auto rhs_buffer = MakeValues<T>(dim * dim);
+  std::vector<T> dst_buffer(dim * dim);
+  MatMul::Buffers<T, T> buffers;
+  buffers.lhs_shape = {dim, dim};
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = {dim, dim};
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = {dim, dim};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  auto runtime_state = MatMul::CreateRuntimeState();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MatMul::Execute(runtime_state.get(), buffers));
+    benchmark::ClobberMemory();
+  }
+  // Items are multiply-accumulates.
+  state.SetItemsProcessed(state.iterations() * dim * dim * dim);
+  state.SetBytesProcessed(state.iterations() * dim * dim * sizeof(T) * 3);
+  state.SetLabel(kKernelsLabel);
+}
+
+// Convolves a [1, dim, dim, channels] image with a 3x3 filter and SAME
+// padding. With state.range(2) set the convolution is depthwise, otherwise it
+// produces |channels| output features.
+struct Conv2DBenchmarkBuffers {
+  explicit Conv2DBenchmarkBuffers(const benchmark::State& state) {
+    int dim = state.range(0);
+    int channels = state.range(1);
+    bool depthwise = state.range(2);
+    buffers.src_shape = {1, dim, dim, channels};
+    buffers.filter_shape = {3, 3, depthwise ? 1 : channels, channels};
+    src_buffer = MakeValues<float>(buffers.src_shape.element_count());
+    filter_buffer = MakeValues<float>(buffers.filter_shape.element_count());
+    dst_buffer.resize(dim * dim * channels);
+    buffers.src_buffer = src_buffer;
+    buffers.filter_buffer = filter_buffer;
+    buffers.dst_shape = {1, dim, dim, channels};
+    buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+    params.padding = {{1, 1, 1, 1}};
+    params.feature_group_count = depthwise ? channels : 1;
+    mac_count = int64_t{dim} * dim * channels * 3 * 3 *
+                buffers.filter_shape[2];
+  }
+
+  std::vector<float> src_buffer;
+  std::vector<float> filter_buffer;
+  std::vector<float> dst_buffer;
+  Conv2D::Buffers<float> buffers;
+  Conv2D::Params params;
+  int64_t mac_count;
+};
+
+void BM_Conv2DKernel(benchmark::State& state) {
+  Conv2DBenchmarkBuffers conv(state);
+  auto runtime_state = MatMul::CreateRuntimeState();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Conv2D::Execute(runtime_state.get(), conv.buffers, conv.params));
+    benchmark::ClobberMemory();
+  }
+  // Items are multiply-accumulates.
+  state.SetItemsProcessed(state.iterations() * conv.mac_count);
+  state.SetLabel(kKernelsLabel);
+}
+
+// The reference kernel accumulates each output directly from its window and
+// is the baseline for the matmul and depthwise paths of Conv2D::Execute.
+void BM_Conv2DReference(benchmark::State& state) {
+  Conv2DBenchmarkBuffers conv(state);
+  auto geometry = impl::ComputeConv2DGeometry(conv.buffers.src_shape,
+                                              conv.buffers.filter_shape,
+                                              conv.buffers.dst_shape,
+                                              conv.params)
+                      .ValueOrDie();
+  for (auto _ : state) {
+    impl::Conv2DReference(conv.src_buffer.data(), conv.filter_buffer.data(),
+                          conv.dst_buffer.data(), geometry, conv.params);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * conv.mac_count);
+  state.SetLabel("reference");
+}
+
+void Conv2DArgs(benchmark::internal::Benchmark* benchmark) {
+  // [dim, channels] of early and late layers of a MobileNet-like model.
+  const std::pair<int, int> kImageShapes[] = {{56, 32}, {14, 256}};
+  for (const auto& image_shape : kImageShapes) {
+    for (int depthwise : {0, 1}) {
+      benchmark->Args({image_shape.first, image_shape.second, depthwise});
+    }
+  }
+}
+
+void ReduceArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int dim : {64, 256, 1024}) {
+    for (int dimension : {0, 1}) {
+      benchmark->Args({dim, dimension});
+    }
+  }
+}
+
+#define ELEMENTWISE_ARGS Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20)
+#define MATRIX_ARGS Arg(64)->Arg(256)->Arg(1024)
+
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Exp, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Log, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Rsqrt, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Sin, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Cos, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Tanh, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Abs, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Floor, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Exp, double)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_UnaryKernel, Abs, int32_t)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Add, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Mul, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Div, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Max, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Add, uint32_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Max, int32_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Add, uint8_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Mul, uint8_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Max, int8_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Add, int16_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_BinaryKernel, Add, double)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_TernaryKernel, MulAdd, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_TernaryKernel, Clamp, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_TernaryKernel, Clamp, int32_t)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_CompareKernel, CompareLT, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_CompareKernel, CompareEQ, int32_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_CompareKernel, CompareGE, int8_t)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_SelectKernel, uint32_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_SelectKernel, uint8_t)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_ConvertKernel, int32_t, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_ConvertKernel, float, int32_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_ConvertKernel, int8_t, float)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_ConvertKernel, float, int8_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_ConvertKernel, int32_t, int8_t)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_ElementwiseProgram, float)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_QuantizedBinaryKernel, AddQ, int8_t)->ELEMENTWISE_ARGS;
+BENCHMARK_TEMPLATE(BM_QuantizedBinaryKernel, MulQ, int8_t)->ELEMENTWISE_ARGS;
+BENCHMARK(BM_RequantizeKernel)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_CopyKernel, 1)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_CopyKernel, 4)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_TransposeKernel, uint8_t)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_TransposeKernel, float)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_ReverseKernel, float)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_PadKernel, float)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_TileKernel, float)->MATRIX_ARGS;
+BENCHMARK_TEMPLATE(BM_BroadcastKernel, float)->ELEMENTWISE_ARGS;
+
+BENCHMARK_TEMPLATE(BM_ReduceKernel, ReduceSum, float)->Apply(ReduceArgs);
+BENCHMARK_TEMPLATE(BM_ReduceKernel, ReduceMax, float)->Apply(ReduceArgs);
+BENCHMARK_TEMPLATE(BM_ReduceKernel, ReduceSum, int32_t)->Apply(ReduceArgs);
+BENCHMARK(BM_ReduceSumWideningKernel)->Apply(ReduceArgs);
+
+BENCHMARK_TEMPLATE(BM_MatMulKernel, float)->Arg(16)->Arg(64)->Arg(256);
+
+BENCHMARK(BM_Conv2DKernel)->Apply(Conv2DArgs);
+BENCHMARK(BM_Conv2DReference)->Apply(Conv2DArgs);
+
+}  // namespace
+}  // namespace kernels
+}  // namespace hal
+}  // namespace iree
+
+BENCHMARK_MAIN();
@@ -15,10 +15,17 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_GENERIC_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_GENERIC_H_
 
-#include "absl/container/flat_hash_set.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/status.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
 
 namespace iree {
 namespace hal {
@@ -154,60 +161,182 @@ Status Select::Execute(absl::Span<const uint8_t> cond_buffer,
   return OkStatus();
 }
 
-template <typename T>
-Status Transpose::Execute(absl::Span<const T> src_buffer,
-                          absl::Span<T> dst_buffer, const Shape& src_shape,
-                          absl::Span<const int32_t> perm) {
-  // This implementation is .... not fast.
+namespace impl {
+// Edge length (in elements) below which a 2-D transpose block is copied
+// directly. 16x16 blocks of 4-byte elements keep both the source and
+// destination lines of a block resident in L1.
+constexpr size_t kTransposeBlockSize = 16;
+
+// Signed element strides as the outer-dimension walkers below also step
+// backwards through reversed dimensions.
+using ElementStrides = absl::InlinedVector<ptrdiff_t, 8>;
+
+// Invokes |fn(src_offset, dst_offset)| for every index of the |extents|
+// dimensions, with the offsets advanced by the per-dimension strides.
+template <typename FN>
+void ForEachOffset(absl::Span<const size_t> extents,
+                   absl::Span<const ptrdiff_t> src_strides,
+                   absl::Span<const ptrdiff_t> dst_strides,
+                   ptrdiff_t src_offset, ptrdiff_t dst_offset, const FN& fn) {
+  if (extents.empty()) {
+    fn(src_offset, dst_offset);
+    return;
+  }
+  for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(extents[0]); ++i) {
+    ForEachOffset(extents.subspan(1), src_strides.subspan(1),
+                  dst_strides.subspan(1), src_offset + i * src_strides[0],
+                  dst_offset + i * dst_strides[0], fn);
+  }
+}
+
+// Reduces a transpose to its minimal form by dropping unit dimensions and
+// merging runs of source dimensions that remain adjacent and in order in the
+// destination. For example NHWC->NCHW ({0, 3, 1, 2}) becomes a batched 2-D
+// transpose of [N, H*W, C] with perm {0, 2, 1}.
+inline void CoalesceTranspose(const Shape& src_shape,
+                              absl::Span<const int32_t> perm,
+                              absl::InlinedVector<size_t, 8>* out_shape,
+                              absl::InlinedVector<int, 8>* out_perm) {
   int rank = src_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
-  absl::InlinedVector<int, 8> dst_strides(rank);
-  size_t src_stride = 1;
-  size_t dst_stride = 1;
-  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    src_strides[dim_i] = src_stride;
-    dst_strides[dim_i] = dst_stride;
-    src_stride *= src_shape[dim_i];
-    dst_stride *= src_shape[perm[dim_i]];
+  absl::InlinedVector<int, 8> squeezed_dims(rank, -1);
+  int squeezed_rank = 0;
+  for (int i = 0; i < rank; ++i) {
+    if (src_shape[i] != 1) squeezed_dims[i] = squeezed_rank++;
   }
-  for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
-    size_t src_i = 0;
-    size_t t = dst_i;
-    for (int dim_i = 0; dim_i < rank; ++dim_i) {
-      size_t ratio = t / dst_strides[dim_i];
-      t -= ratio * dst_strides[dim_i];
-      src_i += ratio * src_strides[perm[dim_i]];
+  absl::InlinedVector<int, 8> squeezed_perm;
+  absl::InlinedVector<size_t, 8> squeezed_shape(squeezed_rank);
+  for (int i = 0; i < rank; ++i) {
+    if (squeezed_dims[perm[i]] == -1) continue;
+    squeezed_perm.push_back(squeezed_dims[perm[i]]);
+    squeezed_shape[squeezed_dims[perm[i]]] = src_shape[perm[i]];
+  }
+
+  // Assign each source dimension to a group; a group starts at every
+  // destination position whose source dimension does not directly follow the
+  // previous one.
+  absl::InlinedVector<int, 8> group_of_dim(squeezed_rank);
+  absl::InlinedVector<bool, 8> starts_group(squeezed_rank, false);
+  for (int i = 0; i < squeezed_rank; ++i) {
+    if (i == 0 || squeezed_perm[i] != squeezed_perm[i - 1] + 1) {
+      starts_group[squeezed_perm[i]] = true;
+    }
+  }
+  int group_count = 0;
+  out_shape->clear();
+  for (int dim = 0; dim < squeezed_rank; ++dim) {
+    if (starts_group[dim]) {
+      ++group_count;
+      out_shape->push_back(1);
+    }
+    group_of_dim[dim] = group_count - 1;
+    out_shape->back() *= squeezed_shape[dim];
+  }
+  out_perm->clear();
+  for (int i = 0; i < squeezed_rank; ++i) {
+    if (i == 0 || squeezed_perm[i] != squeezed_perm[i - 1] + 1) {
+      out_perm->push_back(group_of_dim[squeezed_perm[i]]);
     }
-    dst_buffer[dst_i] = src_buffer[src_i];
   }
-  return OkStatus();
 }
 
-namespace impl {
-inline void IncrementShapeIndex(absl::Span<int32_t> indices,
-                                const Shape& shape) {
-  for (int i = indices.size() - 1; i >= 0; --i) {
-    if (++indices[i] < shape[i]) return;
-    indices[i] = 0;
+// Cache-oblivious 2-D transpose: dst[c * dst_stride + r] =
+// src[r * src_stride + c] for r < rows, c < cols. The larger side is halved
+// until the block fits kTransposeBlockSize, so every level of the cache
+// hierarchy sees blocks that fit it without tuning for its size.
+template <typename T>
+void TransposeBlock(const T* src, size_t src_stride, T* dst, size_t dst_stride,
+                    size_t rows, size_t cols) {
+  if (rows <= kTransposeBlockSize && cols <= kTransposeBlockSize) {
+    for (size_t c = 0; c < cols; ++c) {
+      for (size_t r = 0; r < rows; ++r) {
+        dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
+  } else if (rows >= cols) {
+    size_t half = rows / 2;
+    TransposeBlock(src, src_stride, dst, dst_stride, half, cols);
+    TransposeBlock(src + half * src_stride, src_stride, dst + half, dst_stride,
+                   rows - half, cols);
+  } else {
+    size_t half = cols / 2;
+    TransposeBlock(src, src_stride, dst, dst_stride, rows, half);
+    TransposeBlock(src + half, src_stride, dst + half * dst_stride, dst_stride,
+                   rows, cols - half);
   }
 }
+}  // namespace impl
 
-inline bool IsPadding(absl::Span<const int32_t> indices, const Shape& shape,
-                      absl::Span<const int32_t> edge_padding_low,
-                      absl::Span<const int32_t> edge_padding_high,
-                      absl::Span<const int32_t> interior_padding) {
-  for (int i = 0; i < indices.size(); ++i) {
-    auto index = indices[i];
-    if (index < edge_padding_low[i] ||
-        index >= shape[i] - edge_padding_high[i] ||
-        (index - edge_padding_low[i]) % (interior_padding[i] + 1) != 0) {
-      return true;
-    }
+template <typename T>
+Status Transpose::Execute(absl::Span<const T> src_buffer,
+                          absl::Span<T> dst_buffer, const Shape& src_shape,
+                          absl::Span<const int32_t> perm) {
+  absl::InlinedVector<size_t, 8> shape;
+  absl::InlinedVector<int, 8> dims;
+  impl::CoalesceTranspose(src_shape, perm, &shape, &dims);
+  int rank = shape.size();
+  if (rank <= 1) {
+    // Identity permutation (after coalescing); just a copy.
+    std::copy_n(src_buffer.data(), dst_buffer.size(), dst_buffer.data());
+    return OkStatus();
+  }
+
+  // Per destination dimension extents and strides into both buffers.
+  absl::InlinedVector<size_t, 8> src_strides(rank);
+  src_strides[rank - 1] = 1;
+  for (int i = rank - 2; i >= 0; --i) {
+    src_strides[i] = src_strides[i + 1] * shape[i + 1];
+  }
+  absl::InlinedVector<size_t, 8> extents(rank);
+  impl::ElementStrides dst_src_strides(rank);
+  impl::ElementStrides dst_strides(rank);
+  ptrdiff_t dst_stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    extents[i] = shape[dims[i]];
+    dst_src_strides[i] = src_strides[dims[i]];
+    dst_strides[i] = dst_stride;
+    dst_stride *= extents[i];
   }
 
-  return false;
+  const T* src = src_buffer.data();
+  T* dst = dst_buffer.data();
+  if (dims[rank - 1] == rank - 1) {
+    // The innermost dimension is unchanged: move whole contiguous runs.
+    size_t run_length = extents[rank - 1];
+    impl::ForEachOffset(
+        absl::MakeConstSpan(extents).first(rank - 1), dst_src_strides,
+        dst_strides, 0, 0, [&](ptrdiff_t src_offset, ptrdiff_t dst_offset) {
+          std::memcpy(dst + dst_offset, src + src_offset,
+                      run_length * sizeof(T));
+        });
+    return OkStatus();
+  }
+
+  // Transpose the plane formed by the source and destination innermost
+  // dimensions block-wise for each index of the remaining dimensions. This
+  // covers 2-D transposes, swapping the last two axes and NHWC<->NCHW as a
+  // batch of 2-D transposes.
+  int src_inner = std::find(dims.begin(), dims.end(), rank - 1) - dims.begin();
+  size_t rows = extents[rank - 1];
+  size_t cols = extents[src_inner];
+  size_t row_stride = dst_src_strides[rank - 1];
+  size_t col_stride = dst_strides[src_inner];
+  absl::InlinedVector<size_t, 8> outer_extents;
+  impl::ElementStrides outer_src_strides;
+  impl::ElementStrides outer_dst_strides;
+  for (int i = 0; i < rank - 1; ++i) {
+    if (i == src_inner) continue;
+    outer_extents.push_back(extents[i]);
+    outer_src_strides.push_back(dst_src_strides[i]);
+    outer_dst_strides.push_back(dst_strides[i]);
+  }
+  impl::ForEachOffset(
+      outer_extents, outer_src_strides, outer_dst_strides, 0, 0,
+      [&](ptrdiff_t src_offset, ptrdiff_t dst_offset) {
+        impl::TransposeBlock(src + src_offset, row_stride, dst + dst_offset,
+                             col_stride, rows, cols);
+      });
+  return OkStatus();
 }
-}  // namespace impl
 
 template <typename T>
 Status Pad::Execute(absl::Span<const T> src_buffer,
@@ -217,37 +346,63 @@ Status Pad::Execute(absl::Span<const T> src_buffer,
                     absl::Span<const int32_t> edge_padding_low,
                     absl::Span<const int32_t> edge_padding_high,
                     absl::Span<const int32_t> interior_padding) {
-  // This implementation is not at all fast, as it iterates every index in the
-  // destination buffer individually. Potential improvements:
-  // 1. Fill the dst buffer with padded value initially. Only need to iterate
-  //    through source buffer and can exit early.
-  // 2. Use striding to advance through larger swaths of the buffer with a
-  //    memcpy from src and filling (or skipping) padded incides. Especially
-  //    useful when e.g. entire rows are padded.
-
   // TODO(b/140836672) support negative padding
-
   if (padding_value_buffer.size() != 1) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Padding value buffer is larger than one element.";
   }
-  auto padding_value = padding_value_buffer.front();
-
-  absl::InlinedVector<int, 8> dst_indices(src_shape.size(), 0);
-
-  const T* src_ptr = src_buffer.begin();
-  T* dst_ptr = dst_buffer.begin();
-  while (dst_ptr != dst_buffer.end()) {
-    if (impl::IsPadding(dst_indices, dst_shape, edge_padding_low,
-                        edge_padding_high, interior_padding)) {
-      *dst_ptr++ = padding_value;
-    } else {
-      DCHECK(src_ptr != src_buffer.end());
-      *dst_ptr++ = *src_ptr++;
+  for (int i = 0; i < src_shape.size(); ++i) {
+    if (edge_padding_low[i] < 0 || edge_padding_high[i] < 0) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Negative padding is not supported.";
     }
-    impl::IncrementShapeIndex(absl::MakeSpan(dst_indices), dst_shape);
   }
+  std::fill(dst_buffer.begin(), dst_buffer.end(), padding_value_buffer[0]);
+  if (src_buffer.empty()) return OkStatus();
 
+  // Scatter contiguous source rows into the destination; padding is already
+  // in place so only the interior padding of the innermost dimension needs a
+  // strided copy.
+  int rank = src_shape.size();
+  if (rank == 0) {
+    dst_buffer[0] = src_buffer[0];
+    return OkStatus();
+  }
+  absl::InlinedVector<size_t, 8> extents(rank);
+  impl::ElementStrides src_strides(rank);
+  impl::ElementStrides dst_strides(rank);
+  ptrdiff_t dst_origin = 0;
+  ptrdiff_t src_stride = 1;
+  ptrdiff_t dst_stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    extents[i] = src_shape[i];
+    src_strides[i] = src_stride;
+    dst_strides[i] = dst_stride * (interior_padding[i] + 1);
+    dst_origin += dst_stride * edge_padding_low[i];
+    src_stride *= src_shape[i];
+    dst_stride *= dst_shape[i];
+  }
+
+  const T* src = src_buffer.data();
+  T* dst = dst_buffer.data();
+  size_t run_length = extents[rank - 1];
+  ptrdiff_t run_stride = dst_strides[rank - 1];
+  auto outer_extents = absl::MakeConstSpan(extents).first(rank - 1);
+  if (run_stride == 1) {
+    impl::ForEachOffset(outer_extents, src_strides, dst_strides, 0, dst_origin,
+                        [&](ptrdiff_t src_offset, ptrdiff_t dst_offset) {
+                          std::memcpy(dst + dst_offset, src + src_offset,
+                                      run_length * sizeof(T));
+                        });
+  } else {
+    impl::ForEachOffset(outer_extents, src_strides, dst_strides, 0, dst_origin,
+                        [&](ptrdiff_t src_offset, ptrdiff_t dst_offset) {
+                          for (size_t i = 0; i < run_length; ++i) {
+                            dst[dst_offset + i * run_stride] =
+                                src[src_offset + i];
+                          }
+                        });
+  }
   return OkStatus();
 }
 
@@ -255,26 +410,70 @@ template <typename T>
 Status Reverse::Execute(absl::Span<const T> src_buffer,
                         absl::Span<T> dst_buffer, const Shape& src_shape,
                         absl::Span<const int32_t> dimensions) {
-  // This implementation is not fast either
   int rank = src_shape.size();
-  absl::InlinedVector<int, 8> strides(rank);
-  size_t stride = 1;
-  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    strides[dim_i] = stride;
-    stride *= src_shape[dim_i];
+  absl::InlinedVector<bool, 8> reversed(rank, false);
+  for (int32_t dimension : dimensions) {
+    if (dimension < 0 || dimension >= rank) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Reverse dimension " << dimension << " out of range for rank "
+             << rank;
+    }
+    reversed[dimension] = true;
+  }
+
+  // Merge adjacent dimensions that are either both or neither reversed (and
+  // drop unit dimensions) so that the innermost run is as long as possible.
+  absl::InlinedVector<size_t, 8> extents;
+  absl::InlinedVector<bool, 8> merged_reversed;
+  for (int i = 0; i < rank; ++i) {
+    if (src_shape[i] == 1) continue;
+    if (!extents.empty() && merged_reversed.back() == reversed[i]) {
+      extents.back() *= src_shape[i];
+    } else {
+      extents.push_back(src_shape[i]);
+      merged_reversed.push_back(reversed[i]);
+    }
   }
-  absl::flat_hash_set<int32_t> dims_set(dimensions.begin(), dimensions.end());
-  for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
-    size_t src_i = 0;
-    size_t t = dst_i;
-    for (int dim_i = 0; dim_i < rank; ++dim_i) {
-      size_t ratio = t / strides[dim_i];
-      t -= ratio * strides[dim_i];
-      bool do_reverse = dims_set.contains(dim_i);
-      src_i += (do_reverse ? (src_shape[dim_i] - 1 - ratio) : ratio) *
-               strides[dim_i];
+  if (extents.empty() || (extents.size() == 1 && !merged_reversed[0])) {
+    std::copy_n(src_buffer.data(), dst_buffer.size(), dst_buffer.data());
+    return OkStatus();
+  }
+
+  // Reversed dimensions walk the source backwards from their last index.
+  int merged_rank = extents.size();
+  impl::ElementStrides src_strides(merged_rank);
+  impl::ElementStrides dst_strides(merged_rank);
+  ptrdiff_t src_origin = 0;
+  ptrdiff_t stride = 1;
+  for (int i = merged_rank - 1; i >= 0; --i) {
+    dst_strides[i] = stride;
+    if (merged_reversed[i]) {
+      src_origin += static_cast<ptrdiff_t>(extents[i] - 1) * stride;
+      src_strides[i] = -stride;
+    } else {
+      src_strides[i] = stride;
     }
-    dst_buffer[dst_i] = src_buffer[src_i];
+    stride *= extents[i];
+  }
+
+  const T* src = src_buffer.data();
+  T* dst = dst_buffer.data();
+  size_t run_length = extents[merged_rank - 1];
+  auto outer_extents = absl::MakeConstSpan(extents).first(merged_rank - 1);
+  if (merged_reversed[merged_rank - 1]) {
+    // Reversed runs start at their last element.
+    impl::ForEachOffset(outer_extents, src_strides, dst_strides, src_origin, 0,
+                        [&](ptrdiff_t src_offset, ptrdiff_t dst_offset) {
+                          const T* run = src + src_offset - (run_length - 1);
+                          std::reverse_copy(run, run + run_length,
+                                            dst + dst_offset);
+                        });
+  } else {
+    impl::ForEachOffset(outer_extents, src_strides, dst_strides, src_origin, 0,
+                        [&](ptrdiff_t src_offset, ptrdiff_t dst_offset) {
+                          std::memcpy(dst + dst_offset, src + src_offset,
+                                      run_length * sizeof(T));
+                        });
   }
   return OkStatus();
 }
@@ -288,13 +487,49 @@ Status Broadcast::Execute(absl::Span<const T> src_buffer,
   return OkStatus();
 }
 
+namespace impl {
+// Fills the |dim| slab of |dst| by copying the source rows once and then
+// doubling the already-written prefix until the slab is full.
+template <typename T>
+void TileDimension(const T* src, T* dst, const Shape& src_shape,
+                   const Shape& dst_shape, absl::Span<const size_t> src_strides,
+                   absl::Span<const size_t> dst_strides, int dim) {
+  size_t src_extent = std::min(src_shape[dim], dst_shape[dim]);
+  size_t dst_extent = dst_shape[dim];
+  if (dim + 1 == src_shape.size()) {
+    std::memcpy(dst, src, src_extent * sizeof(T));
+  } else {
+    for (size_t i = 0; i < src_extent; ++i) {
+      TileDimension(src + i * src_strides[dim], dst + i * dst_strides[dim],
+                    src_shape, dst_shape, src_strides, dst_strides, dim + 1);
+    }
+  }
+  // The filled prefix is always a whole number of source periods so copying
+  // it forward preserves the tiling.
+  size_t filled = src_extent;
+  while (filled < dst_extent) {
+    size_t count = std::min(filled, dst_extent - filled);
+    std::memcpy(dst + filled * dst_strides[dim], dst,
+                count * dst_strides[dim] * sizeof(T));
+    filled += count;
+  }
+}
+}  // namespace impl
+
 template <typename T>
 Status Tile::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
                      const Shape& src_shape, const Shape& dst_shape) {
-  // This implementation is .... not fast.
   int rank = dst_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
-  absl::InlinedVector<int, 8> dst_strides(rank);
+  if (rank == 0 || dst_buffer.empty()) {
+    std::copy_n(src_buffer.data(), dst_buffer.size(), dst_buffer.data());
+    return OkStatus();
+  }
+  if (src_buffer.empty()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Cannot tile an empty source into a non-empty destination";
+  }
+  absl::InlinedVector<size_t, 8> src_strides(rank);
+  absl::InlinedVector<size_t, 8> dst_strides(rank);
   size_t src_stride = 1;
   size_t dst_stride = 1;
   for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
@@ -303,15 +538,8 @@ Status Tile::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
     src_stride *= src_shape[dim_i];
     dst_stride *= dst_shape[dim_i];
   }
-  for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
-    size_t src_i = 0;
-    size_t t = dst_i;
-    for (int dim_i = 0; dim_i < rank; ++dim_i) {
-      src_i += t / dst_strides[dim_i] % src_shape[dim_i] * src_strides[dim_i];
-      t %= dst_strides[dim_i];
-    }
-    dst_buffer[dst_i] = src_buffer[src_i];
-  }
+  impl::TileDimension(src_buffer.data(), dst_buffer.data(), src_shape,
+                      dst_shape, src_strides, dst_strides, 0);
   return OkStatus();
 }
 
@@ -532,6 +760,142 @@ Status Ceil::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer) {
   return OkStatus();
 }
 
+namespace impl {
+
+// Returns the number of operands read by |op| or 0 if |op| is unknown.
+inline int ElementwiseOpArity(ElementwiseOp op) {
+  switch (op) {
+#define ELEMENTWISE_OP_ARITY(ordinal, enum_name, name, arity) \
+  case ElementwiseOp::enum_name:                              \
+    return arity;
+    IREE_ELEMENTWISE_OP_LIST(ELEMENTWISE_OP_ARITY)
+#undef ELEMENTWISE_OP_ARITY
+    default:
+      return 0;
+  }
+}
+
+template <typename T>
+Status ExecuteElementwiseOp(ElementwiseOp op, absl::Span<const T> a,
+                            absl::Span<const T> b, absl::Span<const T> c,
+                            absl::Span<T> dst) {
+  switch (op) {
+    case ElementwiseOp::kAbs:
+      return Abs::Execute<T>(a, dst);
+    case ElementwiseOp::kExp:
+      return Exp::Execute<T>(a, dst);
+    case ElementwiseOp::kLog:
+      return Log::Execute<T>(a, dst);
+    case ElementwiseOp::kRsqrt:
+      return Rsqrt::Execute<T>(a, dst);
+    case ElementwiseOp::kCos:
+      return Cos::Execute<T>(a, dst);
+    case ElementwiseOp::kSin:
+      return Sin::Execute<T>(a, dst);
+    case ElementwiseOp::kTanh:
+      return Tanh::Execute<T>(a, dst);
+    case ElementwiseOp::kFloor:
+      return Floor::Execute<T>(a, dst);
+    case ElementwiseOp::kCeil:
+      return Ceil::Execute<T>(a, dst);
+    case ElementwiseOp::kAdd:
+      return Add::Execute<T>(a, b, dst);
+    case ElementwiseOp::kSub:
+      return Sub::Execute<T>(a, b, dst);
+    case ElementwiseOp::kMul:
+      return Mul::Execute<T>(a, b, dst);
+    case ElementwiseOp::kDiv:
+      return Div::Execute<T>(a, b, dst);
+    case ElementwiseOp::kMin:
+      return Min::Execute<T>(a, b, dst);
+    case ElementwiseOp::kMax:
+      return Max::Execute<T>(a, b, dst);
+    case ElementwiseOp::kAtan2:
+      return Atan2::Execute<T>(a, b, dst);
+    case ElementwiseOp::kMulAdd:
+      return MulAdd::Execute<T>(a, b, c, dst);
+    case ElementwiseOp::kClamp:
+      return Clamp::Execute<T>(a, b, c, dst);
+    default:
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Unknown elementwise op " << static_cast<int>(op);
+  }
+}
+
+}  // namespace impl
+
+template <typename T>
+Status ElementwiseProgram::Execute(
+    absl::Span<const absl::Span<const T>> src_buffers,
+    absl::Span<const int32_t> program, absl::Span<T> dst_buffer) {
+  int src_count = src_buffers.size();
+  if (src_buffers.empty() || program.empty()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Programs require at least one input and instruction";
+  }
+  for (const auto& src_buffer : src_buffers) {
+    if (src_buffer.size() != dst_buffer.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Input length " << src_buffer.size()
+             << " does not match output length " << dst_buffer.size();
+    }
+  }
+
+  // Validate the program up front so that the inner loop need not.
+  for (int i = 0; i < program.size(); ++i) {
+    uint32_t instruction = static_cast<uint32_t>(program[i]);
+    auto op = static_cast<ElementwiseOp>(instruction >> 24);
+    int arity = impl::ElementwiseOpArity(op);
+    if (arity == 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Unknown elementwise op " << static_cast<int>(op)
+             << " at instruction " << i;
+    }
+    for (int j = 0; j < 3; ++j) {
+      // Unused operands must be register 0 (which always exists).
+      int reg = (instruction >> (16 - j * 8)) & 0xFF;
+      if ((j < arity && reg >= src_count + i) || (j >= arity && reg != 0)) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Instruction " << i << " has invalid register " << reg;
+      }
+    }
+  }
+
+  // Each instruction but the last writes its own scratch tile; the last
+  // writes directly to the output. Scratch lives on the stack so that
+  // executing a program performs no allocations.
+  alignas(16) uint8_t scratch_storage[kScratchSize];
+  T* scratch = reinterpret_cast<T*>(scratch_storage);
+  const size_t tile_size =
+      program.size() > 1
+          ? std::max<size_t>(
+                1, std::min(kTileSize,
+                            kScratchSize / sizeof(T) / (program.size() - 1)))
+          : kTileSize;
+  absl::InlinedVector<absl::Span<const T>, 16> registers(src_count +
+                                                         program.size());
+  for (size_t offset = 0; offset < dst_buffer.size(); offset += tile_size) {
+    size_t length = std::min(tile_size, dst_buffer.size() - offset);
+    for (int i = 0; i < src_count; ++i) {
+      registers[i] = src_buffers[i].subspan(offset, length);
+    }
+    for (int i = 0; i < program.size(); ++i) {
+      uint32_t instruction = static_cast<uint32_t>(program[i]);
+      auto result =
+          i == program.size() - 1
+              ? dst_buffer.subspan(offset, length)
+              : absl::MakeSpan(scratch + i * tile_size, length);
+      RETURN_IF_ERROR(impl::ExecuteElementwiseOp<T>(
+          static_cast<ElementwiseOp>(instruction >> 24),
+          registers[(instruction >> 16) & 0xFF],
+          registers[(instruction >> 8) & 0xFF], registers[instruction & 0xFF],
+          result));
+      registers[src_count + i] = result;
+    }
+  }
+  return OkStatus();
+}
+
 template <typename SRC, typename DST>
 Status Convert::Execute(absl::Span<const SRC> src_buffer,
                         absl::Span<DST> dst_buffer) {
@@ -544,119 +908,472 @@ Status Convert::Execute(absl::Span<const SRC> src_buffer,
 
 namespace impl {
 
-struct SumKernel {
+// Returns the high 32 bits of the doubled product a * b, rounded to nearest.
+// This is a Q0.31 fixed-point multiply; the only overflowing input
+// (INT32_MIN * INT32_MIN) saturates.
+inline int32_t SaturatingRoundingDoublingHighMul(int32_t a, int32_t b) {
+  if (a == b && a == std::numeric_limits<int32_t>::min()) {
+    return std::numeric_limits<int32_t>::max();
+  }
+  int64_t ab = static_cast<int64_t>(a) * static_cast<int64_t>(b);
+  int64_t nudge = ab >= 0 ? (1ll << 30) : (1 - (1ll << 30));
+  return static_cast<int32_t>((ab + nudge) / (1ll << 31));
+}
+
+// Divides |x| by 2^|exponent|, rounding to nearest with ties away from zero.
+template <typename T>
+inline T RoundingDivideByPOT(T x, int exponent) {
+  if (exponent <= 0) return x;
+  const T mask = (T(1) << exponent) - 1;
+  const T remainder = x & mask;
+  const T threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+// Returns x * mantissa * 2^exponent with mantissa interpreted as Q0.31.
+inline int32_t MultiplyByQuantizedMultiplier(int32_t x, int32_t mantissa,
+                                             int32_t exponent) {
+  // Shifting further than 31 bits saturates any nonzero x anyway.
+  int left_shift = exponent > 0 ? std::min<int32_t>(exponent, 31) : 0;
+  int right_shift = exponent > 0 ? 0 : std::min<int32_t>(-exponent, 31);
+  int64_t shifted = static_cast<int64_t>(x) * (int64_t(1) << left_shift);
+  shifted = std::max<int64_t>(
+      std::min<int64_t>(shifted, std::numeric_limits<int32_t>::max()),
+      std::numeric_limits<int32_t>::min());
+  return RoundingDivideByPOT(
+      SaturatingRoundingDoublingHighMul(static_cast<int32_t>(shifted),
+                                        mantissa),
+      right_shift);
+}
+
+// Returns x / 2^exponent + addend truncated toward zero. The (integral) addend
+// is applied before truncating as it may have the opposite sign of x.
+inline int64_t TruncatingDivideByPOT(int64_t x, int exponent,
+                                     int64_t addend) {
+  int64_t floor = x < 0 ? -1 : 0;
+  int64_t ceil = x > 0 ? 1 : 0;
+  if (exponent < 63) {
+    floor = x >> exponent;
+    ceil = -(-x >> exponent);
+  }
+  return floor + addend >= 0 ? floor + addend : ceil + addend;
+}
+
+// Returns x * mantissa * 2^exponent + addend truncated toward zero, with
+// mantissa interpreted as Q0.31. The product is exact so that values just
+// below an integer are not rounded up to it.
+inline int64_t MultiplyByQuantizedMultiplierTowardZero(int32_t x,
+                                                       int32_t mantissa,
+                                                       int32_t exponent,
+                                                       int64_t addend) {
+  // Shifting further than 31 bits saturates any nonzero x anyway.
+  exponent = std::max<int32_t>(std::min<int32_t>(exponent, 31), -32);
+  return TruncatingDivideByPOT(static_cast<int64_t>(x) * mantissa,
+                               31 - exponent, addend);
+}
+
+// Returns x * mantissa * 2^exponent in fixed-point with |fraction_bits|
+// fractional bits, rounded toward negative infinity. Magnitudes beyond 2^62
+// saturate so that two results may be summed without overflowing.
+inline int64_t MultiplyByQuantizedMultiplierFixedPoint(int32_t x,
+                                                       int32_t mantissa,
+                                                       int32_t exponent,
+                                                       int fraction_bits) {
+  constexpr int64_t kLimit = int64_t(1) << 62;
+  int64_t product = static_cast<int64_t>(x) * mantissa;
+  int64_t right_shift = int64_t(31) - exponent - fraction_bits;
+  if (right_shift >= 63) return product < 0 ? -1 : 0;
+  if (right_shift >= 0) return product >> right_shift;
+  int left_shift = static_cast<int>(std::min<int64_t>(-right_shift, 62));
+  if (product >= (kLimit >> left_shift)) return kLimit;
+  if (product <= -(kLimit >> left_shift)) return -kLimit;
+  return product * (int64_t(1) << left_shift);
+}
+
+template <typename T, typename V>
+inline T SaturateCast(V value) {
+  using Limits = std::numeric_limits<T>;
+  if (value < static_cast<V>(Limits::min())) return Limits::min();
+  if (value > static_cast<V>(Limits::max())) return Limits::max();
+  return static_cast<T>(value);
+}
+
+inline Status ValidateQuantizedMultiplier(
+    absl::Span<const int32_t> mantissa_buffer,
+    absl::Span<const int32_t> exponent_buffer, size_t expected_count) {
+  if (mantissa_buffer.size() != exponent_buffer.size() ||
+      mantissa_buffer.size() < expected_count) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Expected " << expected_count
+           << " quantized multiplier(s) but got " << mantissa_buffer.size()
+           << " mantissa(s) and " << exponent_buffer.size()
+           << " exponent(s)";
+  }
+  return OkStatus();
+}
+
+inline Status ValidateZeroPoints(absl::Span<const int32_t> zero_point_buffer,
+                                 size_t expected_count) {
+  if (zero_point_buffer.size() != expected_count) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Expected " << expected_count << " zero points but got "
+           << zero_point_buffer.size();
+  }
+  return OkStatus();
+}
+
+}  // namespace impl
+
+template <typename SRC, typename DST>
+Status Requantize::Execute(absl::Span<const SRC> src_buffer,
+                           absl::Span<const int32_t> multiplier_mantissa_buffer,
+                           absl::Span<const int32_t> multiplier_exponent_buffer,
+                           absl::Span<const int32_t> zero_point_buffer,
+                           absl::Span<DST> dst_buffer,
+                           const Shape& dst_shape,
+                           RoundingMode rounding_mode) {
+  RETURN_IF_ERROR(impl::ValidateQuantizedMultiplier(
+      multiplier_mantissa_buffer, multiplier_exponent_buffer, 1));
+  RETURN_IF_ERROR(impl::ValidateZeroPoints(zero_point_buffer, 2));
+  const size_t channel_count = multiplier_mantissa_buffer.size();
+  // Rank-1 values are rejected as their only dimension may be sliced.
+  if (channel_count != 1 &&
+      (dst_shape.size() < 2 || dst_shape[dst_shape.size() - 1] !=
+                                   static_cast<int>(channel_count))) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Per-channel multiplier count " << channel_count
+           << " does not match the innermost dimension of " << dst_shape;
+  }
+  const int64_t src_zero_point = zero_point_buffer[0];
+  const int64_t dst_zero_point = zero_point_buffer[1];
+  // Offsetting a full-range int32 src may overflow so it saturates first.
+  auto requantize = [&](SRC value, int32_t mantissa, int32_t exponent) {
+    int32_t offset_value = impl::SaturateCast<int32_t>(
+        static_cast<int64_t>(value) - src_zero_point);
+    if (rounding_mode == RoundingMode::kTowardZero) {
+      return impl::SaturateCast<DST>(
+          impl::MultiplyByQuantizedMultiplierTowardZero(
+              offset_value, mantissa, exponent, dst_zero_point));
+    }
+    return impl::SaturateCast<DST>(
+        impl::MultiplyByQuantizedMultiplier(offset_value, mantissa,
+                                            exponent) +
+        dst_zero_point);
+  };
+  if (channel_count == 1) {
+    const int32_t mantissa = multiplier_mantissa_buffer[0];
+    const int32_t exponent = multiplier_exponent_buffer[0];
+    for (size_t i = 0; i < dst_buffer.size(); ++i) {
+      dst_buffer[i] = requantize(src_buffer[i], mantissa, exponent);
+    }
+    return OkStatus();
+  }
+  for (size_t i = 0; i < dst_buffer.size(); i += channel_count) {
+    for (size_t c = 0; c < channel_count; ++c) {
+      dst_buffer[i + c] =
+          requantize(src_buffer[i + c], multiplier_mantissa_buffer[c],
+                     multiplier_exponent_buffer[c]);
+    }
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status AddQ::Execute(absl::Span<const T> lhs_buffer,
+                     absl::Span<const T> rhs_buffer,
+                     absl::Span<const int32_t> multiplier_mantissa_buffer,
+                     absl::Span<const int32_t> multiplier_exponent_buffer,
+                     absl::Span<const int32_t> zero_point_buffer,
+                     absl::Span<T> dst_buffer, RoundingMode rounding_mode) {
+  static_assert(sizeof(T) <= 2, "AddQ requires 8- or 16-bit operands");
+  RETURN_IF_ERROR(impl::ValidateQuantizedMultiplier(
+      multiplier_mantissa_buffer, multiplier_exponent_buffer, 2));
+  RETURN_IF_ERROR(impl::ValidateZeroPoints(zero_point_buffer, 3));
+  // Operands are shifted up before rescaling so that the multipliers (which
+  // are usually < 1) keep enough fractional precision for the sum to round
+  // correctly once shifted back down. Offset operands span at most 9 (or 17)
+  // bits so multipliers below 8 cannot saturate.
+  constexpr int kLeftShift = 28 - 8 * sizeof(T);
+  const int32_t lhs_mantissa = multiplier_mantissa_buffer[0];
+  const int32_t lhs_exponent = multiplier_exponent_buffer[0];
+  const int32_t rhs_mantissa = multiplier_mantissa_buffer[1];
+  const int32_t rhs_exponent = multiplier_exponent_buffer[1];
+  const int32_t lhs_zero_point = zero_point_buffer[0];
+  const int32_t rhs_zero_point = zero_point_buffer[1];
+  const int64_t dst_zero_point = zero_point_buffer[2];
+  if (rounding_mode == RoundingMode::kTowardZero) {
+    // Both operands are rescaled to a common fixed-point precision and summed
+    // before truncating so that fractional parts carry into the result.
+    constexpr int kFractionBits = 40;
+    for (size_t i = 0; i < dst_buffer.size(); ++i) {
+      int32_t lhs_value = impl::SaturateCast<int32_t>(
+          static_cast<int64_t>(lhs_buffer[i]) - lhs_zero_point);
+      int32_t rhs_value = impl::SaturateCast<int32_t>(
+          static_cast<int64_t>(rhs_buffer[i]) - rhs_zero_point);
+      int64_t sum = impl::MultiplyByQuantizedMultiplierFixedPoint(
+                        lhs_value, lhs_mantissa, lhs_exponent, kFractionBits) +
+                    impl::MultiplyByQuantizedMultiplierFixedPoint(
+                        rhs_value, rhs_mantissa, rhs_exponent, kFractionBits);
+      dst_buffer[i] = impl::SaturateCast<T>(
+          impl::TruncatingDivideByPOT(sum, kFractionBits, dst_zero_point));
+    }
+    return OkStatus();
+  }
+  for (size_t i = 0; i < dst_buffer.size(); ++i) {
+    int32_t lhs_value = impl::SaturateCast<int32_t>(
+        (static_cast<int64_t>(lhs_buffer[i]) - lhs_zero_point) *
+        (1 << kLeftShift));
+    int32_t rhs_value = impl::SaturateCast<int32_t>(
+        (static_cast<int64_t>(rhs_buffer[i]) - rhs_zero_point) *
+        (1 << kLeftShift));
+    int64_t lhs = impl::MultiplyByQuantizedMultiplier(lhs_value, lhs_mantissa,
+                                                      lhs_exponent);
+    int64_t rhs = impl::MultiplyByQuantizedMultiplier(rhs_value, rhs_mantissa,
+                                                      rhs_exponent);
+    dst_buffer[i] = impl::SaturateCast<T>(
+        impl::RoundingDivideByPOT<int64_t>(lhs + rhs, kLeftShift) +
+        dst_zero_point);
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status MulQ::Execute(absl::Span<const T> lhs_buffer,
+                     absl::Span<const T> rhs_buffer,
+                     absl::Span<const int32_t> multiplier_mantissa_buffer,
+                     absl::Span<const int32_t> multiplier_exponent_buffer,
+                     absl::Span<const int32_t> zero_point_buffer,
+                     absl::Span<T> dst_buffer, RoundingMode rounding_mode) {
+  static_assert(sizeof(T) <= 2, "MulQ requires 8- or 16-bit operands");
+  RETURN_IF_ERROR(impl::ValidateQuantizedMultiplier(
+      multiplier_mantissa_buffer, multiplier_exponent_buffer, 1));
+  RETURN_IF_ERROR(impl::ValidateZeroPoints(zero_point_buffer, 3));
+  const int32_t mantissa = multiplier_mantissa_buffer[0];
+  const int32_t exponent = multiplier_exponent_buffer[0];
+  const int64_t lhs_zero_point = zero_point_buffer[0];
+  const int64_t rhs_zero_point = zero_point_buffer[1];
+  const int64_t dst_zero_point = zero_point_buffer[2];
+  for (size_t i = 0; i < dst_buffer.size(); ++i) {
+    // Offset 16-bit operands may overflow int32 when multiplied.
+    int32_t product = impl::SaturateCast<int32_t>(
+        (static_cast<int64_t>(lhs_buffer[i]) - lhs_zero_point) *
+        (static_cast<int64_t>(rhs_buffer[i]) - rhs_zero_point));
+    dst_buffer[i] =
+        rounding_mode == RoundingMode::kTowardZero
+            ? impl::SaturateCast<T>(
+                  impl::MultiplyByQuantizedMultiplierTowardZero(
+                      product, mantissa, exponent, dst_zero_point))
+            : impl::SaturateCast<T>(
+                  impl::MultiplyByQuantizedMultiplier(product, mantissa,
+                                                      exponent) +
+                  dst_zero_point);
+  }
+  return OkStatus();
+}
+
+namespace impl {
+
+// A reduction over a single dimension collapsed to three extents: |outer|
+// independent slices of |reduced| rows, each row holding |inner| contiguous
+// elements. The destination holds |outer| * |inner| elements.
+struct ReductionExtents {
+  size_t outer = 1;
+  size_t reduced = 1;
+  size_t inner = 1;
+};
+
+inline StatusOr<ReductionExtents> CollapseReductionShape(const Shape& src_shape,
+                                                         int32_t dimension) {
+  if (dimension < 0 || dimension >= src_shape.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Reduction dimension " << dimension << " out of range for shape "
+           << src_shape;
+  }
+  ReductionExtents extents;
+  for (int i = 0; i < dimension; ++i) {
+    extents.outer *= src_shape[i];
+  }
+  extents.reduced = src_shape[dimension];
+  for (int i = dimension + 1; i < src_shape.size(); ++i) {
+    extents.inner *= src_shape[i];
+  }
+  return extents;
+}
+
+// Number of destination elements accumulated together when reducing across
+// rows. Rows are walked one tile at a time so that the partial results stay
+// in L1 while the source rows stream through.
+constexpr size_t kReduceTileSize = 256;
+
+// Number of elements summed sequentially at the leaves of a pairwise sum. The
+// error of the pairwise sum grows with log2(count / kPairwiseSumBlockSize).
+constexpr size_t kPairwiseSumBlockSize = 128;
+
+struct SumOp {
   template <typename T>
-  inline void operator()(T* value0, const T value1) {
-    *value0 += value1;
+  static inline T Apply(T a, T b) {
+    return a + b;
   }
 };
 
-struct MinKernel {
+struct MinOp {
   template <typename T>
-  inline void operator()(T* value0, const T value1) {
-    *value0 = std::min(*value0, value1);
+  static inline T Apply(T a, T b) {
+    return std::min(a, b);
   }
 };
 
-struct MaxKernel {
+struct MaxOp {
   template <typename T>
-  inline void operator()(T* value0, const T value1) {
-    *value0 = std::max(*value0, value1);
+  static inline T Apply(T a, T b) {
+    return std::max(a, b);
   }
 };
 
-template <typename T, typename KernelImpl>
-inline void ReduceDimension(absl::Span<const T> src_buffer,
-                            absl::Span<T> dst_buffer, const Shape& src_shape,
-                            absl::Span<const int32_t> reduce_dims,
-                            absl::Span<const int> dst_strides, int dim,
-                            absl::Span<int> src_indices, size_t flat_src_i,
-                            size_t src_stride) {
-  if (dim < 0) {
-    // Base case of the recursion - figure out which elements should be acted
-    // upon and apply the reduction kernel to them.
-
-    // Derive destination indices from source indices.
-    // For example,
-    //     reduce_dims: [1, 2]
-    //     src_indices: [2, 1, 3, 0]
-    //                      ^  ^
-    //                      |  |
-    //                      |----- remove these dimensions
-    //     dst_indices: [2, 0]
-    //
-    // TODO(scotttodd): Clean this up somehow, share across recursion levels?
-    size_t dst_size = src_shape.size() - reduce_dims.size();
-    absl::InlinedVector<int, 8> dst_indices;
-    for (size_t i = 0; i < src_indices.size(); ++i) {
-      if (std::find(std::begin(reduce_dims), std::end(reduce_dims), i) ==
-          std::end(reduce_dims)) {
-        dst_indices.push_back(src_indices[i]);
+// Reduces a contiguous run of |count| elements into |init|. Independent
+// accumulators avoid a loop-carried dependency between adjacent elements so
+// that the compiler can vectorize the loop.
+template <typename T, typename OP>
+inline T ReduceRun(const T* src, size_t count, T init) {
+  constexpr size_t kLanes = 8;
+  size_t i = 0;
+  if (count >= kLanes) {
+    T lanes[kLanes];
+    std::copy_n(src, kLanes, lanes);
+    for (i = kLanes; i + kLanes <= count; i += kLanes) {
+      for (size_t j = 0; j < kLanes; ++j) {
+        lanes[j] = OP::Apply(lanes[j], src[i + j]);
       }
     }
-    // Compute the flattened index into dst_buffer at [dst_indices].
-    size_t dst_i = 0;
-    for (size_t i = 0; i < dst_indices.size(); ++i) {
-      dst_i += dst_indices[i] * dst_strides[dst_size - 1 - i];
+    for (size_t j = 0; j < kLanes; ++j) {
+      init = OP::Apply(init, lanes[j]);
     }
+  }
+  for (; i < count; ++i) {
+    init = OP::Apply(init, src[i]);
+  }
+  return init;
+}
 
-    // Flattened src and dst indices have been computed, invoke the kernel.
-    KernelImpl()(&dst_buffer[dst_i], src_buffer[flat_src_i]);
-    return;
+// Sums a contiguous run of |count| elements by recursively splitting it in
+// half.
+template <typename T>
+inline T PairwiseSum(const T* src, size_t count) {
+  if (count <= kPairwiseSumBlockSize) {
+    return ReduceRun<T, SumOp>(src, count, T(0));
   }
+  size_t half = count / 2;
+  return PairwiseSum(src, half) + PairwiseSum(src + half, count - half);
+}
 
-  // Iterate through the current dimension in the source shape, recursing
-  // down one dimension at a time.
-  //
-  // This touches each element in the source buffer once, tracking complete
-  // dimensions within the shaped source buffer and using them to compute
-  // the corresponding indices (shaped and flattened) within the destination
-  // buffer. Each element in the destination buffer will be touched multiple
-  // times.
-  //
-  // Note that cache coherency isn't considered here, and some computations
-  // are redundant, so this could be optimized substantially.
-  for (size_t dim_i = 0; dim_i < src_shape[dim]; ++dim_i) {
-    src_indices[dim] = dim_i;
+// Applies OP between each of the |reduced| rows of |inner| elements in |src|
+// and the |inner| elements of |dst|.
+template <typename T, typename OP>
+inline void AccumulateRows(const T* src, size_t reduced, size_t inner, T* dst) {
+  for (size_t tile = 0; tile < inner; tile += kReduceTileSize) {
+    size_t tile_size = std::min(kReduceTileSize, inner - tile);
+    T* dst_tile = dst + tile;
+    for (size_t r = 0; r < reduced; ++r) {
+      const T* src_tile = src + r * inner + tile;
+      for (size_t i = 0; i < tile_size; ++i) {
+        dst_tile[i] = OP::Apply(dst_tile[i], src_tile[i]);
+      }
+    }
+  }
+}
 
-    // Recurse down to the next dimension (e.g. 2 -> 1 -> 0 -> base case)
-    //   * Add the current stride to flat_src_i
-    //   * Multiply src_stride by this dimension's shape
-    ReduceDimension<T, KernelImpl>(src_buffer, dst_buffer, src_shape,
-                                   reduce_dims, dst_strides, dim - 1,
-                                   src_indices, flat_src_i + dim_i * src_stride,
-                                   src_stride * src_shape[dim]);
+// Sums each of the |reduced| rows of |inner| elements in |src| into |dst|
+// with Kahan summation, carrying a compensation term per destination element.
+template <typename T>
+inline void KahanAccumulateRows(const T* src, size_t reduced, size_t inner,
+                                T* dst) {
+  T compensation[kReduceTileSize];
+  for (size_t tile = 0; tile < inner; tile += kReduceTileSize) {
+    size_t tile_size = std::min(kReduceTileSize, inner - tile);
+    T* dst_tile = dst + tile;
+    std::fill_n(compensation, tile_size, T(0));
+    for (size_t r = 0; r < reduced; ++r) {
+      const T* src_tile = src + r * inner + tile;
+      for (size_t i = 0; i < tile_size; ++i) {
+        T y = src_tile[i] - compensation[i];
+        T t = dst_tile[i] + y;
+        compensation[i] = (t - dst_tile[i]) - y;
+        dst_tile[i] = t;
+      }
+    }
   }
 }
 
+// Reduction kernels provide:
+//   ReduceRun: reduces a contiguous run of elements into a scalar.
+//   AccumulateRows: reduces rows of contiguous elements into a row.
+// Floating-point sums use pairwise summation for contiguous runs and Kahan
+// summation across rows to bound the accumulated rounding error.
+struct SumKernel {
+  template <typename T>
+  static T ReduceRun(const T* src, size_t count, T init) {
+    if (std::is_floating_point<T>::value) {
+      return init + PairwiseSum(src, count);
+    }
+    return impl::ReduceRun<T, SumOp>(src, count, init);
+  }
+  template <typename T>
+  static void AccumulateRows(const T* src, size_t reduced, size_t inner,
+                             T* dst) {
+    if (std::is_floating_point<T>::value) {
+      KahanAccumulateRows(src, reduced, inner, dst);
+    } else {
+      impl::AccumulateRows<T, SumOp>(src, reduced, inner, dst);
+    }
+  }
+};
+
+template <typename OP>
+struct OrderedKernel {
+  template <typename T>
+  static T ReduceRun(const T* src, size_t count, T init) {
+    return impl::ReduceRun<T, OP>(src, count, init);
+  }
+  template <typename T>
+  static void AccumulateRows(const T* src, size_t reduced, size_t inner,
+                             T* dst) {
+    impl::AccumulateRows<T, OP>(src, reduced, inner, dst);
+  }
+};
+using MinKernel = OrderedKernel<MinOp>;
+using MaxKernel = OrderedKernel<MaxOp>;
+
 template <typename T, typename KernelImpl>
 Status GenericReduce(absl::Span<const T> src_buffer,
                      absl::Span<const T> init_buffer, absl::Span<T> dst_buffer,
                      int32_t dimension, const Shape& src_shape,
                      const Shape& dst_shape) {
+  ASSIGN_OR_RETURN(auto extents, CollapseReductionShape(src_shape, dimension));
+  if (dst_buffer.size() < extents.outer * extents.inner ||
+      src_buffer.size() < extents.outer * extents.reduced * extents.inner) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Reduction of " << src_shape << " along dimension " << dimension
+           << " does not match destination shape " << dst_shape;
+  }
+
   // Initialize using init_buffer, which is expected to be a scalar.
   std::fill_n(dst_buffer.data(), dst_buffer.size(), init_buffer[0]);
 
-  // Precompute destination strides.
-  int dst_rank = dst_shape.size();
-  absl::InlinedVector<int, 8> dst_strides;
-  size_t dst_stride = 1;
-  for (int dim_i = dst_rank - 1; dim_i >= 0; --dim_i) {
-    dst_strides.push_back(dst_stride);
-    dst_stride *= dst_shape[dim_i];
+  const size_t slice_size = extents.reduced * extents.inner;
+  if (extents.inner == 1) {
+    // Reducing the innermost dimension: each destination element is the
+    // reduction of a contiguous run of the source.
+    for (size_t o = 0; o < extents.outer; ++o) {
+      dst_buffer[o] = KernelImpl::ReduceRun(src_buffer.data() + o * slice_size,
+                                            extents.reduced, dst_buffer[o]);
+    }
+  } else {
+    for (size_t o = 0; o < extents.outer; ++o) {
+      KernelImpl::AccumulateRows(src_buffer.data() + o * slice_size,
+                                 extents.reduced, extents.inner,
+                                 dst_buffer.data() + o * extents.inner);
+    }
   }
-
-  // Call the helper (recursive) function, starting with:
-  //   * source index [0, 0, ..., 0]
-  //   * the innermost dimension (last in the shape)
-  //   * flat_src_i of 0 (corresponds to [0, 0, ..., 0] above)
-  //   * source stride 1
-  absl::InlinedVector<int, 8> src_indices(src_shape.size(), 0);
-  ReduceDimension<T, KernelImpl>(src_buffer, dst_buffer, src_shape, {dimension},
-                                 absl::MakeSpan(dst_strides),
-                                 src_shape.size() - 1,
-                                 absl::MakeSpan(src_indices), 0, 1);
-
   return OkStatus();
 }
 
@@ -689,6 +1406,255 @@ Status ReduceMax::Execute(absl::Span<const T> src_buffer,
       src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
 }
 
+template <typename T, typename ACC>
+Status ReduceSumWidening::Execute(absl::Span<const T> src_buffer,
+                                  absl::Span<const ACC> init_buffer,
+                                  absl::Span<ACC> dst_buffer,
+                                  int32_t dimension, const Shape& src_shape,
+                                  const Shape& dst_shape) {
+  ASSIGN_OR_RETURN(auto extents,
+                   impl::CollapseReductionShape(src_shape, dimension));
+  if (dst_buffer.size() < extents.outer * extents.inner ||
+      src_buffer.size() < extents.outer * extents.reduced * extents.inner) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Reduction of " << src_shape << " along dimension " << dimension
+           << " does not match destination shape " << dst_shape;
+  }
+
+  std::fill_n(dst_buffer.data(), dst_buffer.size(), init_buffer[0]);
+
+  const size_t slice_size = extents.reduced * extents.inner;
+  for (size_t o = 0; o < extents.outer; ++o) {
+    const T* src = src_buffer.data() + o * slice_size;
+    ACC* dst = dst_buffer.data() + o * extents.inner;
+    if (extents.inner == 1) {
+      ACC sum = 0;
+      for (size_t r = 0; r < extents.reduced; ++r) {
+        sum += static_cast<ACC>(src[r]);
+      }
+      dst[0] += sum;
+      continue;
+    }
+    for (size_t r = 0; r < extents.reduced; ++r) {
+      const T* row = src + r * extents.inner;
+      for (size_t i = 0; i < extents.inner; ++i) {
+        dst[i] += static_cast<ACC>(row[i]);
+      }
+    }
+  }
+  return OkStatus();
+}
+
+namespace impl {
+
+// Extents of a Conv2D, derived from its buffer shapes.
+struct Conv2DGeometry {
+  int batch;
+  int src_height;
+  int src_width;
+  int src_channels;
+  int filter_height;
+  int filter_width;
+  // Input features per group (the filter input feature dimension).
+  int group_src_channels;
+  // Output features per group.
+  int group_dst_channels;
+  int dst_height;
+  int dst_width;
+  int dst_channels;
+};
+
+inline StatusOr<Conv2DGeometry> ComputeConv2DGeometry(
+    const Shape& src_shape, const Shape& filter_shape, const Shape& dst_shape,
+    const Conv2D::Params& params) {
+  if (src_shape.size() != 4 || filter_shape.size() != 4 ||
+      dst_shape.size() != 4) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Conv2D requires rank 4 operands; got " << src_shape << ", "
+           << filter_shape << " -> " << dst_shape;
+  }
+  const auto& strides = params.strides;
+  const auto& padding = params.padding;
+  const auto& dilation = params.dilation;
+  int groups = params.feature_group_count;
+  if (strides[0] < 1 || strides[1] < 1 || dilation[0] < 1 ||
+      dilation[1] < 1 || groups < 1) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid Conv2D strides, dilation, or feature_group_count";
+  }
+
+  Conv2DGeometry geometry;
+  geometry.batch = src_shape[0];
+  geometry.src_height = src_shape[1];
+  geometry.src_width = src_shape[2];
+  geometry.src_channels = src_shape[3];
+  geometry.filter_height = filter_shape[0];
+  geometry.filter_width = filter_shape[1];
+  geometry.group_src_channels = filter_shape[2];
+  geometry.dst_channels = filter_shape[3];
+  geometry.group_dst_channels = geometry.dst_channels / groups;
+  int padded_height = geometry.src_height + padding[0] + padding[1];
+  int padded_width = geometry.src_width + padding[2] + padding[3];
+  int window_height = (geometry.filter_height - 1) * dilation[0] + 1;
+  int window_width = (geometry.filter_width - 1) * dilation[1] + 1;
+  // A window larger than the padded input produces no outputs. Checked before
+  // dividing as truncation would round small negative differences up to 1.
+  auto dst_extent = [](int padded, int window, int stride) {
+    return padded < window ? 0 : (padded - window) / stride + 1;
+  };
+  geometry.dst_height = dst_extent(padded_height, window_height, strides[0]);
+  geometry.dst_width = dst_extent(padded_width, window_width, strides[1]);
+
+  if (geometry.group_src_channels * groups != geometry.src_channels ||
+      geometry.dst_channels % groups != 0 || dst_shape[0] != geometry.batch ||
+      dst_shape[1] != geometry.dst_height ||
+      dst_shape[2] != geometry.dst_width ||
+      dst_shape[3] != geometry.dst_channels) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Conv2D of " << src_shape << " with filter " << filter_shape
+           << " and " << groups << " groups does not match destination shape "
+           << dst_shape;
+  }
+  return geometry;
+}
+
+// Returns the input row (or column) read by filter tap |k| of output row (or
+// column) |o|. The result may lie within the padding.
+inline int ConvSourceIndex(int o, int k, int stride, int pad_before,
+                           int dilation) {
+  return o * stride - pad_before + k * dilation;
+}
+
+// Reference convolution that accumulates each output element directly from
+// its input window. Supports all strides, padding, dilations, and groups.
+template <typename T>
+void Conv2DReference(const T* src, const T* filter, T* dst,
+                     const Conv2DGeometry& geometry,
+                     const Conv2D::Params& params) {
+  const auto& g = geometry;
+  int groups = params.feature_group_count;
+  for (int n = 0; n < g.batch; ++n) {
+    for (int oh = 0; oh < g.dst_height; ++oh) {
+      for (int ow = 0; ow < g.dst_width; ++ow) {
+        T* dst_pixel =
+            dst + ((n * g.dst_height + oh) * g.dst_width + ow) * g.dst_channels;
+        for (int group = 0; group < groups; ++group) {
+          for (int oc = 0; oc < g.group_dst_channels; ++oc) {
+            int dst_channel = group * g.group_dst_channels + oc;
+            T accumulator = T(0);
+            for (int kh = 0; kh < g.filter_height; ++kh) {
+              int ih = ConvSourceIndex(oh, kh, params.strides[0],
+                                       params.padding[0], params.dilation[0]);
+              if (ih < 0 || ih >= g.src_height) continue;
+              for (int kw = 0; kw < g.filter_width; ++kw) {
+                int iw = ConvSourceIndex(ow, kw, params.strides[1],
+                                         params.padding[2], params.dilation[1]);
+                if (iw < 0 || iw >= g.src_width) continue;
+                const T* src_pixel =
+                    src +
+                    ((n * g.src_height + ih) * g.src_width + iw) *
+                        g.src_channels +
+                    group * g.group_src_channels;
+                const T* filter_tap =
+                    filter +
+                    (kh * g.filter_width + kw) * g.group_src_channels *
+                        g.dst_channels +
+                    dst_channel;
+                for (int ic = 0; ic < g.group_src_channels; ++ic) {
+                  accumulator +=
+                      src_pixel[ic] * filter_tap[ic * g.dst_channels];
+                }
+              }
+            }
+            dst_pixel[dst_channel] = accumulator;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Depthwise convolution (one group per input feature) with |multiplier|
+// output features per input feature. Each filter tap is applied to an entire
+// pixel at once such that the innermost loop runs over contiguous channels.
+template <typename T>
+void DepthwiseConv2D(const T* src, const T* filter, T* dst,
+                     const Conv2DGeometry& geometry,
+                     const Conv2D::Params& params) {
+  const auto& g = geometry;
+  int multiplier = g.group_dst_channels;
+  for (int n = 0; n < g.batch; ++n) {
+    for (int oh = 0; oh < g.dst_height; ++oh) {
+      for (int ow = 0; ow < g.dst_width; ++ow) {
+        T* dst_pixel =
+            dst + ((n * g.dst_height + oh) * g.dst_width + ow) * g.dst_channels;
+        std::fill_n(dst_pixel, g.dst_channels, T(0));
+        for (int kh = 0; kh < g.filter_height; ++kh) {
+          int ih = ConvSourceIndex(oh, kh, params.strides[0],
+                                   params.padding[0], params.dilation[0]);
+          if (ih < 0 || ih >= g.src_height) continue;
+          for (int kw = 0; kw < g.filter_width; ++kw) {
+            int iw = ConvSourceIndex(ow, kw, params.strides[1],
+                                     params.padding[2], params.dilation[1]);
+            if (iw < 0 || iw >= g.src_width) continue;
+            const T* src_pixel =
+                src + ((n * g.src_height + ih) * g.src_width + iw) *
+                          g.src_channels;
+            const T* filter_tap =
+                filter + (kh * g.filter_width + kw) * g.dst_channels;
+            if (multiplier == 1) {
+              for (int c = 0; c < g.src_channels; ++c) {
+                dst_pixel[c] += src_pixel[c] * filter_tap[c];
+              }
+            } else {
+              for (int c = 0; c < g.src_channels; ++c) {
+                for (int m = 0; m < multiplier; ++m) {
+                  dst_pixel[c * multiplier + m] +=
+                      src_pixel[c] * filter_tap[c * multiplier + m];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Gathers the input windows of one image of an ungrouped convolution into the
+// rows of a [dst_height * dst_width, filter_height * filter_width *
+// src_channels] matrix, zero-filling taps that lie within the padding. The
+// column order matches the HWIO filter viewed as a matrix with one row per
+// filter tap and input feature such that the convolution is then the product
+// of the two.
+template <typename T>
+void Im2Col(const T* src, T* columns, const Conv2DGeometry& geometry,
+            const Conv2D::Params& params) {
+  const auto& g = geometry;
+  for (int oh = 0; oh < g.dst_height; ++oh) {
+    for (int ow = 0; ow < g.dst_width; ++ow) {
+      for (int kh = 0; kh < g.filter_height; ++kh) {
+        int ih = ConvSourceIndex(oh, kh, params.strides[0], params.padding[0],
+                                 params.dilation[0]);
+        for (int kw = 0; kw < g.filter_width; ++kw) {
+          int iw = ConvSourceIndex(ow, kw, params.strides[1],
+                                   params.padding[2], params.dilation[1]);
+          if (ih < 0 || ih >= g.src_height || iw < 0 || iw >= g.src_width) {
+            std::fill_n(columns, g.src_channels, T(0));
+          } else {
+            std::memcpy(columns,
+                        src + (ih * g.src_width + iw) * g.src_channels,
+                        g.src_channels * sizeof(T));
+          }
+          columns += g.src_channels;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace impl
+
 }  // namespace kernels
 }  // namespace hal
 }  // namespace iree
@@ -15,48 +15,168 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_RUY_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_RUY_H_
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <tuple>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer.h"
 #include "iree/hal/buffer_view.h"
+#include "tensorflow/lite/experimental/ruy/allocator.h"
 #include "tensorflow/lite/experimental/ruy/context.h"
 #include "tensorflow/lite/experimental/ruy/ruy.h"
+#include "tensorflow/lite/experimental/ruy/ruy_advanced.h"
 
 namespace iree {
 namespace hal {
 namespace kernels {
 
-// TODO(benvanik): something more clever for making this shareable.
-// Maybe a factory fn based on the impl selected?
+// ruy::Context owns its worker threads and packing scratch space and is not
+// safe to use from multiple threads at once. A fixed number of contexts is
+// shared by all executables on the device and |max_thread_count| is divided
+// between them, bounding the matmul threads of the whole device. Matmuls wait
+// for a free context when all are in use.
 struct MatMul::RuntimeState {
-  // TODO(benvanik): share the thread pool but keep context per-fiber?
-  ruy::Context context;
+  RuntimeState(int max_thread_count, int max_context_count)
+      : context_count(std::max(1, max_context_count)),
+        threads_per_context(std::max(1, max_thread_count / context_count)) {}
+
+  std::unique_ptr<ruy::Context> AcquireContext() {
+    absl::MutexLock lock(&mutex);
+    mutex.Await(absl::Condition(this, &RuntimeState::CanAcquireContext));
+    if (!free_contexts.empty()) {
+      auto context = std::move(free_contexts.back());
+      free_contexts.pop_back();
+      return context;
+    }
+    ++created_context_count;
+    auto context = absl::make_unique<ruy::Context>();
+    context->max_num_threads = threads_per_context;
+    return context;
+  }
+
+  void ReleaseContext(std::unique_ptr<ruy::Context> context) {
+    absl::MutexLock lock(&mutex);
+    free_contexts.push_back(std::move(context));
+  }
+
+  bool CanAcquireContext() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return !free_contexts.empty() || created_context_count < context_count;
+  }
+
+  // An RHS matrix packed into the ruy kernel layout.
+  // The entry retains the source buffer so that the buffer pointer used as
+  // the cache key cannot be reused by another buffer while cached.
+  struct PrepackedRhs {
+    ref_ptr<Buffer> buffer;
+    ruy::Allocator allocator;
+    ruy::PrepackedMatrix matrix;
+  };
+  using PrepackedRhsKey = std::tuple<const void*, const Buffer*, int, int, int>;
+
+  // Returns the transposed |rhs_buffer| (passed to ruy as |ruy_lhs_matrix|,
+  // see MatMul::Execute) packed for multiplication, packing it with |context|
+  // the first time |rhs_buffer| is used with the given shape. The packed
+  // matrix is cached until |owner| is passed to EvictPrepackedRhs.
+  template <typename T, typename Spec>
+  ruy::PrepackedMatrix* LookupOrPrepackRhs(const void* owner,
+                                           Buffer* rhs_buffer,
+                                           const ruy::Matrix<T>& ruy_lhs_matrix,
+                                           const ruy::Matrix<T>& ruy_rhs_matrix,
+                                           const Spec& spec,
+                                           ruy::Context* context,
+                                           ruy::Matrix<T>* dst_matrix) {
+    PrepackedRhsKey key{owner, rhs_buffer, ruy_lhs_matrix.layout.rows,
+                        ruy_lhs_matrix.layout.cols,
+                        static_cast<int>(sizeof(T))};
+    {
+      absl::MutexLock lock(&mutex);
+      auto it = prepacked_rhs.find(key);
+      if (it != prepacked_rhs.end()) return &it->second->matrix;
+    }
+
+    // Pack outside of the lock; if another thread packed the same matrix in
+    // the meantime ours is dropped.
+    auto entry = absl::make_unique<PrepackedRhs>();
+    entry->buffer = add_ref(rhs_buffer);
+    auto* allocator = &entry->allocator;
+    ruy::PrePackForMul<ruy::kAllPaths>(
+        ruy_lhs_matrix, ruy_rhs_matrix, spec, context, dst_matrix,
+        &entry->matrix, /*prepacked_rhs=*/nullptr,
+        [allocator](std::size_t num_bytes) {
+          return allocator->AllocateBytes(num_bytes);
+        });
+    absl::MutexLock lock(&mutex);
+    auto it = prepacked_rhs.emplace(key, std::move(entry)).first;
+    return &it->second->matrix;
+  }
+
+  // Drops all packed matrices (and the buffers they retain) cached for
+  // |owner|, such as when the executable owning the constants is released.
+  // No matmuls using them may be executing.
+  void EvictPrepackedRhs(const void* owner) {
+    absl::MutexLock lock(&mutex);
+    for (auto it = prepacked_rhs.begin(); it != prepacked_rhs.end();) {
+      if (std::get<0>(it->first) == owner) {
+        prepacked_rhs.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  const int context_count;
+  const int threads_per_context;
+
+  absl::Mutex mutex;
+  // Contexts are created on first use up to |context_count|.
+  int created_context_count ABSL_GUARDED_BY(mutex) = 0;
+  std::vector<std::unique_ptr<ruy::Context>> free_contexts
+      ABSL_GUARDED_BY(mutex);
+  // Entries are only removed by EvictPrepackedRhs so the returned matrices
+  // remain valid for as long as their owner.
+  absl::flat_hash_map<PrepackedRhsKey, std::unique_ptr<PrepackedRhs>>
+      prepacked_rhs ABSL_GUARDED_BY(mutex);
 };
 
-inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState() {
-  return absl::make_unique<RuntimeState>();
+inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState(
+    int max_thread_count, int context_count) {
+  return absl::make_unique<RuntimeState>(max_thread_count, context_count);
 }
 
+// ruy applies the bias and per-channel multipliers per row of its
+// destination matrix while IREE applies them per column (per output feature).
+// The row-major product dst = lhs * rhs is therefore computed as the
+// column-major product dst^T = rhs^T * lhs^T, which reads the same memory
+// without any copies.
 template <typename T, typename ACC>
 Status MatMul::Execute(RuntimeState* runtime_state,
                        const Buffers<T, ACC>& buffers) {
-  ruy::Matrix<T> lhs_matrix;
-  ruy::MakeSimpleLayout(buffers.lhs_shape[0], buffers.lhs_shape[1],
-                        ruy::Order::kRowMajor, &lhs_matrix.layout);
-  lhs_matrix.data.set(buffers.lhs_buffer.data());
+  ruy::Matrix<T> ruy_lhs_matrix;
+  ruy::MakeSimpleLayout(buffers.rhs_shape[1], buffers.rhs_shape[0],
+                        ruy::Order::kColMajor, &ruy_lhs_matrix.layout);
+  ruy_lhs_matrix.data.set(buffers.rhs_buffer.data());
 
-  ruy::Matrix<T> rhs_matrix;
-  ruy::MakeSimpleLayout(buffers.rhs_shape[0], buffers.rhs_shape[1],
-                        ruy::Order::kRowMajor, &rhs_matrix.layout);
-  rhs_matrix.data.set(buffers.rhs_buffer.data());
+  ruy::Matrix<T> ruy_rhs_matrix;
+  ruy::MakeSimpleLayout(buffers.lhs_shape[1], buffers.lhs_shape[0],
+                        ruy::Order::kColMajor, &ruy_rhs_matrix.layout);
+  ruy_rhs_matrix.data.set(buffers.lhs_buffer.data());
 
   ruy::Matrix<T> dst_matrix;
-  ruy::MakeSimpleLayout(buffers.dst_shape[0], buffers.dst_shape[1],
-                        ruy::Order::kRowMajor, &dst_matrix.layout);
+  ruy::MakeSimpleLayout(buffers.dst_shape[1], buffers.dst_shape[0],
+                        ruy::Order::kColMajor, &dst_matrix.layout);
   dst_matrix.data.set(buffers.dst_buffer.data());
 
   ruy::BasicSpec<ACC, T> spec;
   spec.bias = buffers.bias_buffer.data();
+  spec.clamp_min = buffers.clamp_min;
+  spec.clamp_max = buffers.clamp_max;
 
   if (buffers.multiplier_mantissa_buffer.size() == 1) {
     spec.multiplier_fixedpoint = buffers.multiplier_mantissa_buffer[0];
@@ -68,9 +188,84 @@ Status MatMul::Execute(RuntimeState* runtime_state,
         buffers.multiplier_exponent_buffer.data();
   }
 
-  ruy::Mul<ruy::kAllPaths>(lhs_matrix, rhs_matrix, spec,
-                           &runtime_state->context, &dst_matrix);
+  auto context = runtime_state->AcquireContext();
+  if (buffers.rhs_constant_buffer) {
+    auto* prepacked_rhs = runtime_state->LookupOrPrepackRhs(
+        buffers.rhs_constant_owner, buffers.rhs_constant_buffer,
+        ruy_lhs_matrix, ruy_rhs_matrix, spec, context.get(), &dst_matrix);
+    ruy::MulWithPrepacked<ruy::kAllPaths>(ruy_lhs_matrix, ruy_rhs_matrix, spec,
+                                          context.get(), &dst_matrix,
+                                          prepacked_rhs,
+                                          /*prepacked_rhs=*/nullptr);
+  } else {
+    ruy::Mul<ruy::kAllPaths>(ruy_lhs_matrix, ruy_rhs_matrix, spec,
+                             context.get(), &dst_matrix);
+  }
+  runtime_state->ReleaseContext(std::move(context));
+
+  return OkStatus();
+}
+
+// Depthwise convolutions are computed directly as they have no reduction
+// across input features to hand to a matmul. Ungrouped convolutions are
+// lowered to a matmul of the HWIO filter (as a [KH * KW * C, O] matrix) with
+// either the input itself (1x1 filters with unit strides and no padding) or
+// the im2col expansion of each image. Any other grouping uses the reference
+// kernel.
+template <typename T>
+Status Conv2D::Execute(MatMul::RuntimeState* runtime_state,
+                       const Buffers<T>& buffers, const Params& params) {
+  ASSIGN_OR_RETURN(auto geometry, impl::ComputeConv2DGeometry(
+                                      buffers.src_shape, buffers.filter_shape,
+                                      buffers.dst_shape, params));
+  if (buffers.dst_buffer.empty()) return OkStatus();
+  const auto& g = geometry;
+  const T* src = buffers.src_buffer.data();
+  const T* filter = buffers.filter_buffer.data();
+  T* dst = buffers.dst_buffer.data();
 
+  if (params.feature_group_count > 1) {
+    if (g.group_src_channels == 1) {
+      impl::DepthwiseConv2D(src, filter, dst, geometry, params);
+    } else {
+      impl::Conv2DReference(src, filter, dst, geometry, params);
+    }
+    return OkStatus();
+  }
+
+  int filter_rows = g.filter_height * g.filter_width * g.src_channels;
+  MatMul::Buffers<T, T> mat_mul_buffers;
+  mat_mul_buffers.rhs_shape = {filter_rows, g.dst_channels};
+  mat_mul_buffers.rhs_buffer = buffers.filter_buffer;
+  mat_mul_buffers.rhs_constant_buffer = buffers.filter_constant_buffer;
+  mat_mul_buffers.rhs_constant_owner = buffers.filter_constant_owner;
+
+  bool is_pointwise = g.filter_height == 1 && g.filter_width == 1 &&
+                      params.strides[0] == 1 && params.strides[1] == 1 &&
+                      params.padding == std::array<int32_t, 4>{{0, 0, 0, 0}};
+  if (is_pointwise) {
+    int pixel_count = g.batch * g.src_height * g.src_width;
+    mat_mul_buffers.lhs_shape = {pixel_count, g.src_channels};
+    mat_mul_buffers.lhs_buffer = buffers.src_buffer;
+    mat_mul_buffers.dst_shape = {pixel_count, g.dst_channels};
+    mat_mul_buffers.dst_buffer = buffers.dst_buffer;
+    return MatMul::Execute(runtime_state, mat_mul_buffers);
+  }
+
+  // Images are expanded one at a time to bound the scratch memory required.
+  int dst_pixel_count = g.dst_height * g.dst_width;
+  int src_image_size = g.src_height * g.src_width * g.src_channels;
+  int dst_image_size = dst_pixel_count * g.dst_channels;
+  std::vector<T> columns(dst_pixel_count * filter_rows);
+  mat_mul_buffers.lhs_shape = {dst_pixel_count, filter_rows};
+  mat_mul_buffers.lhs_buffer = columns;
+  mat_mul_buffers.dst_shape = {dst_pixel_count, g.dst_channels};
+  for (int n = 0; n < g.batch; ++n) {
+    impl::Im2Col(src + n * src_image_size, columns.data(), geometry, params);
+    mat_mul_buffers.dst_buffer =
+        buffers.dst_buffer.subspan(n * dst_image_size, dst_image_size);
+    RETURN_IF_ERROR(MatMul::Execute(runtime_state, mat_mul_buffers));
+  }
   return OkStatus();
 }
 
@@ -0,0 +1,939 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SIMD specializations of the elementwise and reduction kernels for 32-bit
+// float and 8/32-bit (un)signed integer element types. Any kernel/type
+// combination not specialized here uses the reference implementation in
+// bytecode_kernels_generic.h.
+//
+// Kernels are written against GCC/Clang vector extensions so that the same
+// source lowers to SSE/AVX on x86 and NEON on ARM. Compilers without vector
+// extensions (or the IREE_HAL_INTERPRETER_GENERIC_KERNELS_ONLY define) get the
+// generic kernels only.
+//
+// The trailing partial vector of each buffer is processed by padding it out to
+// a full vector so that the result for any element is independent of where it
+// lies within the buffer (and thus of how a dispatch is tiled).
+//
+// Exp/Log/Sin/Cos use the Cephes single-precision polynomial approximations
+// and Tanh uses a 13/6 rational approximation; all are within a few ULP of the
+// C library across the float range. Rsqrt is refined with Newton-Raphson.
+
+#ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_SIMD_H_
+#define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_SIMD_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "absl/types/span.h"
+#include "iree/base/shape.h"
+#include "iree/base/status.h"
+
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)
+// __builtin_convertvector is required and only available in GCC 9+.
+#if defined(__AVX2__)
+#define IREE_KERNELS_SIMD_VECTOR_BYTES 32
+#else
+#define IREE_KERNELS_SIMD_VECTOR_BYTES 16
+#endif  // __AVX2__
+#endif  // __clang__ || __GNUC__ >= 9
+
+#if defined(IREE_KERNELS_SIMD_VECTOR_BYTES)
+
+namespace iree {
+namespace hal {
+namespace kernels {
+namespace simd {
+
+// Full-width vectors.
+typedef float F32 __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES)));
+typedef int32_t I32
+    __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES)));
+typedef uint32_t U32
+    __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES)));
+typedef int8_t I8 __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES)));
+typedef uint8_t U8 __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES)));
+
+// Byte vectors with the same lane count as the 32-bit vectors above. Used for
+// comparison results, select conditions, and 8<->32-bit conversions.
+typedef int8_t I8x32
+    __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES / 4)));
+typedef uint8_t U8x32
+    __attribute__((vector_size(IREE_KERNELS_SIMD_VECTOR_BYTES / 4)));
+
+// Maps an element type to its full-width vector type (|type|), the type of the
+// mask produced by comparing two such vectors (|mask_type|), and a byte vector
+// with the same number of lanes (|byte_type|).
+template <typename T>
+struct Vector;
+template <>
+struct Vector<float> {
+  typedef F32 type;
+  typedef I32 mask_type;
+  typedef U8x32 byte_type;
+};
+template <>
+struct Vector<int32_t> {
+  typedef I32 type;
+  typedef I32 mask_type;
+  typedef U8x32 byte_type;
+};
+template <>
+struct Vector<uint32_t> {
+  typedef U32 type;
+  typedef I32 mask_type;
+  typedef U8x32 byte_type;
+};
+template <>
+struct Vector<int8_t> {
+  typedef I8 type;
+  typedef I8 mask_type;
+  typedef U8 byte_type;
+};
+template <>
+struct Vector<uint8_t> {
+  typedef U8 type;
+  typedef I8 mask_type;
+  typedef U8 byte_type;
+};
+
+// Maps an element type to a vector with one lane per 32-bit lane. Conversions
+// operate on these so that source and destination have matching lane counts.
+template <typename T>
+struct ConversionVector {
+  typedef typename Vector<T>::type type;
+};
+template <>
+struct ConversionVector<int8_t> {
+  typedef I8x32 type;
+};
+template <>
+struct ConversionVector<uint8_t> {
+  typedef U8x32 type;
+};
+
+template <typename V, typename T>
+inline V Load(const T* ptr) {
+  V value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+// Loads |count| elements and zero fills the remaining lanes.
+template <typename V, typename T>
+inline V LoadPartial(const T* ptr, size_t count) {
+  V value = {};
+  std::memcpy(&value, ptr, count * sizeof(T));
+  return value;
+}
+
+template <typename V, typename T>
+inline void Store(T* ptr, V value) {
+  std::memcpy(ptr, &value, sizeof(value));
+}
+
+template <typename V, typename T>
+inline void StorePartial(T* ptr, V value, size_t count) {
+  std::memcpy(ptr, &value, count * sizeof(T));
+}
+
+template <typename V, typename T>
+inline V Splat(T scalar) {
+  V value;
+  for (size_t i = 0; i < sizeof(V) / sizeof(T); ++i) {
+    value[i] = scalar;
+  }
+  return value;
+}
+
+// Returns |a| in lanes where |mask| is set and |b| elsewhere.
+template <typename M, typename V>
+inline V Blend(M mask, V a, V b) {
+  return (V)(((M)a & mask) | ((M)b & ~mask));
+}
+
+// Converts a comparison mask (all bits set per true lane) to 0/1 bytes.
+template <typename B, typename M>
+inline B MaskToBytes(M mask) {
+  return __builtin_convertvector(-mask, B);
+}
+
+template <typename T, typename OP>
+inline void MapUnary(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
+                     OP op) {
+  typedef typename Vector<T>::type V;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  const size_t count = dst_buffer.size();
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    Store(dst_buffer.data() + i, op(Load<V>(src_buffer.data() + i)));
+  }
+  if (i < count) {
+    const size_t tail = count - i;
+    StorePartial(dst_buffer.data() + i,
+                 op(LoadPartial<V>(src_buffer.data() + i, tail)), tail);
+  }
+}
+
+template <typename T, typename OP>
+inline void MapBinary(absl::Span<const T> lhs_buffer,
+                      absl::Span<const T> rhs_buffer, absl::Span<T> dst_buffer,
+                      OP op) {
+  typedef typename Vector<T>::type V;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  const size_t count = dst_buffer.size();
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    Store(dst_buffer.data() + i, op(Load<V>(lhs_buffer.data() + i),
+                                    Load<V>(rhs_buffer.data() + i)));
+  }
+  if (i < count) {
+    const size_t tail = count - i;
+    StorePartial(dst_buffer.data() + i,
+                 op(LoadPartial<V>(lhs_buffer.data() + i, tail),
+                    LoadPartial<V>(rhs_buffer.data() + i, tail)),
+                 tail);
+  }
+}
+
+template <typename T, typename OP>
+inline void MapTernary(absl::Span<const T> a_buffer,
+                       absl::Span<const T> b_buffer,
+                       absl::Span<const T> c_buffer, absl::Span<T> dst_buffer,
+                       OP op) {
+  typedef typename Vector<T>::type V;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  const size_t count = dst_buffer.size();
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    Store(dst_buffer.data() + i,
+          op(Load<V>(a_buffer.data() + i), Load<V>(b_buffer.data() + i),
+             Load<V>(c_buffer.data() + i)));
+  }
+  if (i < count) {
+    const size_t tail = count - i;
+    StorePartial(dst_buffer.data() + i,
+                 op(LoadPartial<V>(a_buffer.data() + i, tail),
+                    LoadPartial<V>(b_buffer.data() + i, tail),
+                    LoadPartial<V>(c_buffer.data() + i, tail)),
+                 tail);
+  }
+}
+
+template <typename T, typename OP>
+inline void MapCompare(absl::Span<const T> lhs_buffer,
+                       absl::Span<const T> rhs_buffer,
+                       absl::Span<uint8_t> dst_buffer, OP op) {
+  typedef typename Vector<T>::type V;
+  typedef typename Vector<T>::byte_type B;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  const size_t count = dst_buffer.size();
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    Store(dst_buffer.data() + i,
+          MaskToBytes<B>(op(Load<V>(lhs_buffer.data() + i),
+                            Load<V>(rhs_buffer.data() + i))));
+  }
+  if (i < count) {
+    const size_t tail = count - i;
+    StorePartial(dst_buffer.data() + i,
+                 MaskToBytes<B>(
+                     op(LoadPartial<V>(lhs_buffer.data() + i, tail),
+                        LoadPartial<V>(rhs_buffer.data() + i, tail))),
+                 tail);
+  }
+}
+
+template <typename T>
+inline void MapSelect(absl::Span<const uint8_t> cond_buffer,
+                      absl::Span<const T> lhs_buffer,
+                      absl::Span<const T> rhs_buffer,
+                      absl::Span<T> dst_buffer) {
+  typedef typename Vector<T>::type V;
+  typedef typename Vector<T>::mask_type M;
+  typedef typename Vector<T>::byte_type B;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  const size_t count = dst_buffer.size();
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    M mask = __builtin_convertvector(Load<B>(cond_buffer.data() + i), M) != 0;
+    Store(dst_buffer.data() + i, Blend(mask, Load<V>(lhs_buffer.data() + i),
+                                       Load<V>(rhs_buffer.data() + i)));
+  }
+  if (i < count) {
+    const size_t tail = count - i;
+    M mask = __builtin_convertvector(
+                 LoadPartial<B>(cond_buffer.data() + i, tail), M) != 0;
+    StorePartial(dst_buffer.data() + i,
+                 Blend(mask, LoadPartial<V>(lhs_buffer.data() + i, tail),
+                       LoadPartial<V>(rhs_buffer.data() + i, tail)),
+                 tail);
+  }
+}
+
+template <typename SRC, typename DST>
+inline void MapConvert(absl::Span<const SRC> src_buffer,
+                       absl::Span<DST> dst_buffer) {
+  typedef typename ConversionVector<SRC>::type SV;
+  typedef typename ConversionVector<DST>::type DV;
+  constexpr size_t kLanes = sizeof(SV) / sizeof(SRC);
+  static_assert(kLanes == sizeof(DV) / sizeof(DST), "lane count mismatch");
+  const size_t count = dst_buffer.size();
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    Store(dst_buffer.data() + i,
+          __builtin_convertvector(Load<SV>(src_buffer.data() + i), DV));
+  }
+  if (i < count) {
+    const size_t tail = count - i;
+    StorePartial(dst_buffer.data() + i,
+                 __builtin_convertvector(
+                     LoadPartial<SV>(src_buffer.data() + i, tail), DV),
+                 tail);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Float math
+//===----------------------------------------------------------------------===//
+
+constexpr int32_t kSignMask = std::numeric_limits<int32_t>::min();
+constexpr int32_t kInfinityBits = 0x7F800000;
+
+inline F32 Abs(F32 x) { return (F32)((I32)x & ~kSignMask); }
+
+// Rounds toward negative infinity. Values with no fractional part (including
+// inf/nan) are returned unchanged.
+inline F32 Floor(F32 x) {
+  F32 truncated = __builtin_convertvector(__builtin_convertvector(x, I32), F32);
+  truncated = truncated - Blend(truncated > x, Splat<F32>(1.0f), F32{});
+  truncated = (F32)((I32)truncated | ((I32)x & kSignMask));
+  return Blend(Abs(x) < 8388608.0f, truncated, x);
+}
+
+// Rounds toward positive infinity. Values with no fractional part (including
+// inf/nan) are returned unchanged.
+inline F32 Ceil(F32 x) {
+  F32 truncated = __builtin_convertvector(__builtin_convertvector(x, I32), F32);
+  truncated = truncated + Blend(truncated < x, Splat<F32>(1.0f), F32{});
+  truncated = (F32)((I32)truncated | ((I32)x & kSignMask));
+  return Blend(Abs(x) < 8388608.0f, truncated, x);
+}
+
+inline F32 Exp(F32 x) {
+  // Below this the result is 0 and above it is inf; clamping keeps the
+  // exponent math below in range while still producing those results.
+  x = Blend(x < -104.0f, Splat<F32>(-104.0f), x);
+  x = Blend(x > 89.0f, Splat<F32>(89.0f), x);
+
+  // exp(x) = 2^n * exp(r) with r in [-ln(2)/2, ln(2)/2].
+  F32 n = Floor(x * 1.44269504088896341f + 0.5f);
+  x = x - n * 0.693359375f;
+  x = x + n * 2.12194440e-4f;
+
+  F32 z = x * x;
+  F32 y = 1.9875691500e-4f * x + 1.3981999507e-3f;
+  y = y * x + 8.3334519073e-3f;
+  y = y * x + 4.1665795894e-2f;
+  y = y * x + 1.6666665459e-1f;
+  y = y * x + 5.0000001201e-1f;
+  y = y * z + x + 1.0f;
+
+  // 2^n is applied in two halves so that gradual underflow and overflow to
+  // inf happen in the final multiply instead of in the exponent bits.
+  I32 n_int = __builtin_convertvector(n, I32);
+  I32 n_lo = n_int >> 1;
+  I32 n_hi = n_int - n_lo;
+  return y * (F32)((n_lo + 127) << 23) * (F32)((n_hi + 127) << 23);
+}
+
+inline F32 Log(F32 x) {
+  const F32 input = x;
+
+  // Scale denormals into the normal range so the exponent can be extracted.
+  I32 denormal = x < std::numeric_limits<float>::min();
+  x = Blend(denormal, x * 8388608.0f, x);
+
+  // x = m * 2^e with m in [sqrt(1/2), sqrt(2)).
+  I32 bits = (I32)x;
+  I32 e = ((bits >> 23) & 0xFF) - 126 - (denormal & 23);
+  F32 m = (F32)((bits & 0x007FFFFF) | 0x3F000000);
+  I32 small = m < 0.707106781186547524f;
+  e = e + small;
+  m = m - 1.0f + (F32)((I32)m & small);
+
+  F32 z = m * m;
+  F32 y = 7.0376836292e-2f * m - 1.1514610310e-1f;
+  y = y * m + 1.1676998740e-1f;
+  y = y * m - 1.2420140846e-1f;
+  y = y * m + 1.4249322787e-1f;
+  y = y * m - 1.6668057665e-1f;
+  y = y * m + 2.0000714765e-1f;
+  y = y * m - 2.4999993993e-1f;
+  y = y * m + 3.3333331174e-1f;
+  y = y * m * z;
+
+  F32 ef = __builtin_convertvector(e, F32);
+  y = y - ef * 2.12194440e-4f;
+  y = y - 0.5f * z;
+  F32 result = m + y + ef * 0.693359375f;
+
+  result = Blend(input == 0.0f, (F32)Splat<I32>(kInfinityBits | kSignMask),
+                 result);
+  result = Blend(input < 0.0f,
+                 Splat<F32>(std::numeric_limits<float>::quiet_NaN()), result);
+  result = Blend(input == std::numeric_limits<float>::infinity(), input,
+                 result);
+  return Blend(input != input, input, result);
+}
+
+inline F32 Rsqrt(F32 x) {
+  // Scale denormals into the normal range for the initial estimate.
+  I32 denormal = (x > 0.0f) & (x < std::numeric_limits<float>::min());
+  F32 scaled = Blend(denormal, x * 16777216.0f, x);
+
+  F32 y = (F32)(0x5F3759DF - ((I32)scaled >> 1));
+  F32 half = scaled * 0.5f;
+  y = y * (1.5f - half * y * y);
+  y = y * (1.5f - half * y * y);
+  y = y * (1.5f - half * y * y);
+  y = Blend(denormal, y * 4096.0f, y);
+
+  y = Blend(x == 0.0f, (F32)(((I32)x & kSignMask) | kInfinityBits), y);
+  y = Blend(x < 0.0f, Splat<F32>(std::numeric_limits<float>::quiet_NaN()), y);
+  y = Blend(x == std::numeric_limits<float>::infinity(), F32{}, y);
+  return Blend(x != x, x, y);
+}
+
+// Polynomials approximating sin/cos on [-pi/4, pi/4].
+inline F32 SinPolynomial(F32 x) {
+  F32 z = x * x;
+  F32 y = -1.9515295891e-4f * z + 8.3321608736e-3f;
+  y = y * z - 1.6666654611e-1f;
+  return y * z * x + x;
+}
+inline F32 CosPolynomial(F32 x) {
+  F32 z = x * x;
+  F32 y = 2.443315711809948e-5f * z - 1.388731625493765e-3f;
+  y = y * z + 4.166664568298827e-2f;
+  return y * z * z - 0.5f * z + 1.0f;
+}
+
+// Reduces |x| to [-pi/4, pi/4] and returns the octant in |octant|.
+inline F32 ReduceQuarterPi(F32 x, I32* octant) {
+  I32 j = __builtin_convertvector(x * 1.27323954473516f, I32);
+  j = (j + 1) & ~1;
+  F32 y = __builtin_convertvector(j, F32);
+  *octant = j;
+  return ((x - y * 0.78515625f) - y * 2.4187564849853515625e-4f) -
+         y * 3.77489497744594108e-8f;
+}
+
+// The range reduction above loses precision for large arguments; those lanes
+// (and inf/nan) are recomputed with the C library.
+inline F32 FixupLargeArguments(F32 x, F32 result, float (*fn)(float)) {
+  I32 in_range = Abs(x) <= 8192.0f;
+  for (size_t i = 0; i < sizeof(F32) / sizeof(float); ++i) {
+    if (!in_range[i]) result[i] = fn(x[i]);
+  }
+  return result;
+}
+
+inline F32 Sin(F32 x) {
+  I32 octant;
+  F32 r = ReduceQuarterPi(Abs(x), &octant);
+  I32 sign = ((I32)x ^ ((octant & 4) != 0)) & kSignMask;
+  F32 result = Blend((octant & 2) != 0, CosPolynomial(r), SinPolynomial(r));
+  result = (F32)((I32)result ^ sign);
+  return FixupLargeArguments(x, result,
+                             static_cast<float (*)(float)>(std::sin));
+}
+
+inline F32 Cos(F32 x) {
+  I32 octant;
+  F32 r = ReduceQuarterPi(Abs(x), &octant);
+  octant = octant - 2;
+  I32 sign = ((octant & 4) == 0) & kSignMask;
+  F32 result = Blend((octant & 2) != 0, CosPolynomial(r), SinPolynomial(r));
+  result = (F32)((I32)result ^ sign);
+  return FixupLargeArguments(x, result,
+                             static_cast<float (*)(float)>(std::cos));
+}
+
+inline F32 Tanh(F32 x) {
+  // tanh(x) rounds to +/-1 outside of [-9, 9].
+  F32 clamped = Blend(x < -9.0f, Splat<F32>(-9.0f), x);
+  clamped = Blend(clamped > 9.0f, Splat<F32>(9.0f), clamped);
+
+  F32 x2 = clamped * clamped;
+  F32 p = -2.76076847742355e-16f * x2 + 2.00018790482477e-13f;
+  p = p * x2 - 8.60467152213735e-11f;
+  p = p * x2 + 5.12229709037114e-08f;
+  p = p * x2 + 1.48572235717979e-05f;
+  p = p * x2 + 6.37261928875436e-04f;
+  p = p * x2 + 4.89352455891786e-03f;
+  p = p * clamped;
+  F32 q = 1.19825839466702e-06f * x2 + 1.18534705686654e-04f;
+  q = q * x2 + 2.26843463243900e-03f;
+  q = q * x2 + 4.89352518554385e-03f;
+  F32 result = p / q;
+
+  // Tiny values are returned as-is to preserve precision (and -0).
+  return Blend(Abs(x) < 0.0004f, x, result);
+}
+
+//===----------------------------------------------------------------------===//
+// Elementwise ops
+//===----------------------------------------------------------------------===//
+
+struct AddOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a + b;
+  }
+};
+struct SubOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a - b;
+  }
+};
+struct MulOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a * b;
+  }
+};
+struct DivOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a / b;
+  }
+};
+struct MulAddOp {
+  template <typename V>
+  V operator()(V a, V b, V c) const {
+    return a + (b * c);
+  }
+};
+struct NotOp {
+  template <typename V>
+  V operator()(V a) const {
+    return ~a;
+  }
+};
+struct AndOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a & b;
+  }
+};
+struct OrOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a | b;
+  }
+};
+struct XorOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return a ^ b;
+  }
+};
+struct AbsOp {
+  F32 operator()(F32 a) const { return Abs(a); }
+  template <typename V>
+  V operator()(V a) const {
+    V zero = {};
+    return Blend(a < zero, zero - a, a);
+  }
+};
+// Matches std::min/std::max, including which operand is returned for NaN.
+struct MinOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return Blend(b < a, b, a);
+  }
+};
+struct MaxOp {
+  template <typename V>
+  V operator()(V a, V b) const {
+    return Blend(a < b, b, a);
+  }
+};
+struct ClampOp {
+  template <typename V>
+  V operator()(V src, V min, V max) const {
+    return Blend(src <= min, min, Blend(src >= max, max, src));
+  }
+};
+struct CompareEQOp {
+  template <typename V>
+  auto operator()(V a, V b) const -> decltype(a == b) {
+    return a == b;
+  }
+};
+struct CompareNEOp {
+  template <typename V>
+  auto operator()(V a, V b) const -> decltype(a != b) {
+    return a != b;
+  }
+};
+struct CompareLTOp {
+  template <typename V>
+  auto operator()(V a, V b) const -> decltype(a < b) {
+    return a < b;
+  }
+};
+struct CompareLEOp {
+  template <typename V>
+  auto operator()(V a, V b) const -> decltype(a <= b) {
+    return a <= b;
+  }
+};
+struct CompareGTOp {
+  template <typename V>
+  auto operator()(V a, V b) const -> decltype(a > b) {
+    return a > b;
+  }
+};
+struct CompareGEOp {
+  template <typename V>
+  auto operator()(V a, V b) const -> decltype(a >= b) {
+    return a >= b;
+  }
+};
+struct ExpOp {
+  F32 operator()(F32 a) const { return Exp(a); }
+};
+struct LogOp {
+  F32 operator()(F32 a) const { return Log(a); }
+};
+struct RsqrtOp {
+  F32 operator()(F32 a) const { return Rsqrt(a); }
+};
+struct CosOp {
+  F32 operator()(F32 a) const { return Cos(a); }
+};
+struct SinOp {
+  F32 operator()(F32 a) const { return Sin(a); }
+};
+struct TanhOp {
+  F32 operator()(F32 a) const { return Tanh(a); }
+};
+struct FloorOp {
+  F32 operator()(F32 a) const { return Floor(a); }
+};
+struct CeilOp {
+  F32 operator()(F32 a) const { return Ceil(a); }
+};
+
+//===----------------------------------------------------------------------===//
+// Reductions
+//===----------------------------------------------------------------------===//
+
+// Reduces a contiguous run of |count| elements into |init| with the vector op
+// VOP, combining lanes and the scalar tail with the scalar op SOP.
+template <typename T, typename VOP, typename SOP>
+inline T ReduceRun(const T* src, size_t count, T init) {
+  typedef typename Vector<T>::type V;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  VOP op;
+  size_t i = 0;
+  if (count >= 2 * kLanes) {
+    // Two accumulators hide the latency of the vector op.
+    V acc0 = Load<V>(src);
+    V acc1 = Load<V>(src + kLanes);
+    for (i = 2 * kLanes; i + 2 * kLanes <= count; i += 2 * kLanes) {
+      acc0 = op(acc0, Load<V>(src + i));
+      acc1 = op(acc1, Load<V>(src + i + kLanes));
+    }
+    V acc = op(acc0, acc1);
+    for (size_t j = 0; j < kLanes; ++j) {
+      init = SOP::Apply(init, static_cast<T>(acc[j]));
+    }
+  }
+  for (; i < count; ++i) {
+    init = SOP::Apply(init, src[i]);
+  }
+  return init;
+}
+
+inline float PairwiseSum(const float* src, size_t count) {
+  if (count <= impl::kPairwiseSumBlockSize) {
+    return ReduceRun<float, AddOp, impl::SumOp>(src, count, 0.0f);
+  }
+  size_t half = count / 2;
+  return PairwiseSum(src, half) + PairwiseSum(src + half, count - half);
+}
+
+// Applies VOP between each of the |reduced| rows of |inner| elements in |src|
+// and the |inner| elements of |dst|. As in impl::AccumulateRows the rows are
+// walked one tile of |dst| at a time so that the tile stays in L1.
+template <typename T, typename VOP>
+inline void AccumulateRows(const T* src, size_t reduced, size_t inner, T* dst) {
+  typedef typename Vector<T>::type V;
+  constexpr size_t kLanes = sizeof(V) / sizeof(T);
+  constexpr size_t kTileVectors = impl::kReduceTileSize / kLanes;
+  VOP op;
+  V acc[kTileVectors];
+  for (size_t tile = 0; tile < inner; tile += kTileVectors * kLanes) {
+    const size_t tile_size = std::min(kTileVectors * kLanes, inner - tile);
+    const size_t vector_count = (tile_size + kLanes - 1) / kLanes;
+    const size_t tail = tile_size - (vector_count - 1) * kLanes;
+    for (size_t v = 0; v + 1 < vector_count; ++v) {
+      acc[v] = Load<V>(dst + tile + v * kLanes);
+    }
+    T* dst_tail = dst + tile + (vector_count - 1) * kLanes;
+    acc[vector_count - 1] = LoadPartial<V>(dst_tail, tail);
+    for (size_t r = 0; r < reduced; ++r) {
+      const T* src_tile = src + r * inner + tile;
+      for (size_t v = 0; v + 1 < vector_count; ++v) {
+        acc[v] = op(acc[v], Load<V>(src_tile + v * kLanes));
+      }
+      acc[vector_count - 1] =
+          op(acc[vector_count - 1],
+             LoadPartial<V>(src_tile + (vector_count - 1) * kLanes, tail));
+    }
+    for (size_t v = 0; v + 1 < vector_count; ++v) {
+      Store(dst + tile + v * kLanes, acc[v]);
+    }
+    StorePartial(dst_tail, acc[vector_count - 1], tail);
+  }
+}
+
+// Vectorized impl::KahanAccumulateRows.
+inline void KahanAccumulateRows(const float* src, size_t reduced, size_t inner,
+                                float* dst) {
+  constexpr size_t kLanes = sizeof(F32) / sizeof(float);
+  constexpr size_t kTileVectors = impl::kReduceTileSize / kLanes;
+  F32 sum[kTileVectors];
+  F32 compensation[kTileVectors];
+  for (size_t tile = 0; tile < inner; tile += kTileVectors * kLanes) {
+    const size_t tile_size = std::min(kTileVectors * kLanes, inner - tile);
+    const size_t vector_count = (tile_size + kLanes - 1) / kLanes;
+    const size_t tail = tile_size - (vector_count - 1) * kLanes;
+    for (size_t v = 0; v < vector_count; ++v) {
+      sum[v] = LoadPartial<F32>(dst + tile + v * kLanes,
+                                v + 1 < vector_count ? kLanes : tail);
+      compensation[v] = F32{};
+    }
+    for (size_t r = 0; r < reduced; ++r) {
+      const float* src_tile = src + r * inner + tile;
+      for (size_t v = 0; v < vector_count; ++v) {
+        F32 x = v + 1 < vector_count
+                    ? Load<F32>(src_tile + v * kLanes)
+                    : LoadPartial<F32>(src_tile + v * kLanes, tail);
+        F32 y = x - compensation[v];
+        F32 t = sum[v] + y;
+        compensation[v] = (t - sum[v]) - y;
+        sum[v] = t;
+      }
+    }
+    for (size_t v = 0; v < vector_count; ++v) {
+      StorePartial(dst + tile + v * kLanes, sum[v],
+                   v + 1 < vector_count ? kLanes : tail);
+    }
+  }
+}
+
+template <typename VOP, typename SOP>
+struct ReduceKernel {
+  template <typename T>
+  static T ReduceRun(const T* src, size_t count, T init) {
+    return simd::ReduceRun<T, VOP, SOP>(src, count, init);
+  }
+  template <typename T>
+  static void AccumulateRows(const T* src, size_t reduced, size_t inner,
+                             T* dst) {
+    simd::AccumulateRows<T, VOP>(src, reduced, inner, dst);
+  }
+};
+using ReduceSumIntKernel = ReduceKernel<AddOp, impl::SumOp>;
+using ReduceMinKernel = ReduceKernel<MinOp, impl::MinOp>;
+using ReduceMaxKernel = ReduceKernel<MaxOp, impl::MaxOp>;
+
+// Float sums match the accuracy of the generic kernel: pairwise within a run
+// and Kahan across rows.
+struct ReduceSumFloatKernel {
+  static float ReduceRun(const float* src, size_t count, float init) {
+    return init + PairwiseSum(src, count);
+  }
+  static void AccumulateRows(const float* src, size_t reduced, size_t inner,
+                             float* dst) {
+    KahanAccumulateRows(src, reduced, inner, dst);
+  }
+};
+
+}  // namespace simd
+
+#define IREE_KERNELS_SIMD_UNARY(KERNEL, T)                                  \
+  template <>                                                               \
+  inline Status KERNEL::Execute<T>(absl::Span<const T> src_buffer,          \
+                                   absl::Span<T> dst_buffer) {              \
+    simd::MapUnary<T>(src_buffer, dst_buffer, simd::KERNEL##Op());          \
+    return OkStatus();                                                      \
+  }
+#define IREE_KERNELS_SIMD_BINARY(KERNEL, T)                                 \
+  template <>                                                               \
+  inline Status KERNEL::Execute<T>(absl::Span<const T> lhs_buffer,          \
+                                   absl::Span<const T> rhs_buffer,          \
+                                   absl::Span<T> dst_buffer) {              \
+    simd::MapBinary<T>(lhs_buffer, rhs_buffer, dst_buffer,                  \
+                       simd::KERNEL##Op());                                 \
+    return OkStatus();                                                      \
+  }
+#define IREE_KERNELS_SIMD_TERNARY(KERNEL, T)                                \
+  template <>                                                               \
+  inline Status KERNEL::Execute<T>(                                         \
+      absl::Span<const T> a_buffer, absl::Span<const T> b_buffer,           \
+      absl::Span<const T> c_buffer, absl::Span<T> dst_buffer) {             \
+    simd::MapTernary<T>(a_buffer, b_buffer, c_buffer, dst_buffer,           \
+                        simd::KERNEL##Op());                                \
+    return OkStatus();                                                      \
+  }
+#define IREE_KERNELS_SIMD_COMPARE(KERNEL, T)                                \
+  template <>                                                               \
+  inline Status KERNEL::Execute<T>(absl::Span<const T> lhs_buffer,          \
+                                   absl::Span<const T> rhs_buffer,          \
+                                   absl::Span<uint8_t> dst_buffer) {        \
+    simd::MapCompare<T>(lhs_buffer, rhs_buffer, dst_buffer,                 \
+                        simd::KERNEL##Op());                                \
+    return OkStatus();                                                      \
+  }
+#define IREE_KERNELS_SIMD_SELECT(T)                                         \
+  template <>                                                               \
+  inline Status Select::Execute<T>(                                         \
+      absl::Span<const uint8_t> cond_buffer, absl::Span<const T> lhs_buffer, \
+      absl::Span<const T> rhs_buffer, absl::Span<T> dst_buffer) {           \
+    simd::MapSelect<T>(cond_buffer, lhs_buffer, rhs_buffer, dst_buffer);    \
+    return OkStatus();                                                      \
+  }
+#define IREE_KERNELS_SIMD_CONVERT(SRC, DST)                                 \
+  template <>                                                               \
+  inline Status Convert::Execute<SRC, DST>(absl::Span<const SRC> src_buffer, \
+                                           absl::Span<DST> dst_buffer) {    \
+    DCHECK_EQ(src_buffer.size(), dst_buffer.size());                        \
+    simd::MapConvert<SRC, DST>(src_buffer, dst_buffer);                     \
+    return OkStatus();                                                      \
+  }
+#define IREE_KERNELS_SIMD_REDUCE(KERNEL, T, IMPL)                            \
+  template <>                                                               \
+  inline Status KERNEL::Execute<T>(                                         \
+      absl::Span<const T> src_buffer, absl::Span<const T> init_buffer,      \
+      absl::Span<T> dst_buffer, int32_t dimension, const Shape& src_shape,  \
+      const Shape& dst_shape) {                                             \
+    return impl::GenericReduce<T, IMPL>(src_buffer, init_buffer, dst_buffer, \
+                                        dimension, src_shape, dst_shape);   \
+  }
+
+// Kernels valid for all supported element types.
+#define IREE_KERNELS_SIMD_ALL_TYPES(MACRO, KERNEL) \
+  MACRO(KERNEL, float)                             \
+  MACRO(KERNEL, int8_t)                            \
+  MACRO(KERNEL, uint8_t)                           \
+  MACRO(KERNEL, int32_t)                           \
+  MACRO(KERNEL, uint32_t)
+// Kernels valid only for integer element types.
+#define IREE_KERNELS_SIMD_INT_TYPES(MACRO, KERNEL) \
+  MACRO(KERNEL, int8_t)                            \
+  MACRO(KERNEL, uint8_t)                           \
+  MACRO(KERNEL, int32_t)                           \
+  MACRO(KERNEL, uint32_t)
+
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_COMPARE, CompareEQ)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_COMPARE, CompareNE)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_COMPARE, CompareLT)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_COMPARE, CompareLE)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_COMPARE, CompareGT)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_COMPARE, CompareGE)
+
+IREE_KERNELS_SIMD_SELECT(float)
+IREE_KERNELS_SIMD_SELECT(int8_t)
+IREE_KERNELS_SIMD_SELECT(uint8_t)
+IREE_KERNELS_SIMD_SELECT(int32_t)
+IREE_KERNELS_SIMD_SELECT(uint32_t)
+
+IREE_KERNELS_SIMD_INT_TYPES(IREE_KERNELS_SIMD_UNARY, Not)
+IREE_KERNELS_SIMD_INT_TYPES(IREE_KERNELS_SIMD_BINARY, And)
+IREE_KERNELS_SIMD_INT_TYPES(IREE_KERNELS_SIMD_BINARY, Or)
+IREE_KERNELS_SIMD_INT_TYPES(IREE_KERNELS_SIMD_BINARY, Xor)
+
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_BINARY, Add)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_BINARY, Sub)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_BINARY, Mul)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_TERNARY, MulAdd)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_BINARY, Min)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_BINARY, Max)
+IREE_KERNELS_SIMD_ALL_TYPES(IREE_KERNELS_SIMD_TERNARY, Clamp)
+
+// std::abs promotes 8-bit values to int; the wrapped result is the same.
+IREE_KERNELS_SIMD_UNARY(Abs, float)
+IREE_KERNELS_SIMD_UNARY(Abs, int8_t)
+IREE_KERNELS_SIMD_UNARY(Abs, int32_t)
+
+// Integer division has no vector instructions and is left to the generic
+// kernels.
+IREE_KERNELS_SIMD_BINARY(Div, float)
+
+IREE_KERNELS_SIMD_UNARY(Exp, float)
+IREE_KERNELS_SIMD_UNARY(Log, float)
+IREE_KERNELS_SIMD_UNARY(Rsqrt, float)
+IREE_KERNELS_SIMD_UNARY(Cos, float)
+IREE_KERNELS_SIMD_UNARY(Sin, float)
+IREE_KERNELS_SIMD_UNARY(Tanh, float)
+IREE_KERNELS_SIMD_UNARY(Floor, float)
+IREE_KERNELS_SIMD_UNARY(Ceil, float)
+
+// Widening from 8-bit sources is no faster than the generic loop (which the
+// compiler vectorizes itself) and is left to the generic kernels.
+IREE_KERNELS_SIMD_CONVERT(int32_t, int8_t)
+IREE_KERNELS_SIMD_CONVERT(int32_t, uint8_t)
+IREE_KERNELS_SIMD_CONVERT(int32_t, uint32_t)
+IREE_KERNELS_SIMD_CONVERT(int32_t, float)
+IREE_KERNELS_SIMD_CONVERT(uint32_t, int8_t)
+IREE_KERNELS_SIMD_CONVERT(uint32_t, uint8_t)
+IREE_KERNELS_SIMD_CONVERT(uint32_t, int32_t)
+IREE_KERNELS_SIMD_CONVERT(float, int8_t)
+IREE_KERNELS_SIMD_CONVERT(float, uint8_t)
+IREE_KERNELS_SIMD_CONVERT(float, int32_t)
+
+// Reductions are only dispatched for signed integer and float types.
+IREE_KERNELS_SIMD_REDUCE(ReduceSum, float, simd::ReduceSumFloatKernel)
+IREE_KERNELS_SIMD_REDUCE(ReduceSum, int32_t, simd::ReduceSumIntKernel)
+IREE_KERNELS_SIMD_REDUCE(ReduceMin, float, simd::ReduceMinKernel)
+IREE_KERNELS_SIMD_REDUCE(ReduceMin, int32_t, simd::ReduceMinKernel)
+IREE_KERNELS_SIMD_REDUCE(ReduceMax, float, simd::ReduceMaxKernel)
+IREE_KERNELS_SIMD_REDUCE(ReduceMax, int32_t, simd::ReduceMaxKernel)
+
+#undef IREE_KERNELS_SIMD_INT_TYPES
+#undef IREE_KERNELS_SIMD_REDUCE
+#undef IREE_KERNELS_SIMD_ALL_TYPES
+#undef IREE_KERNELS_SIMD_CONVERT
+#undef IREE_KERNELS_SIMD_SELECT
+#undef IREE_KERNELS_SIMD_COMPARE
+#undef IREE_KERNELS_SIMD_TERNARY
+#undef IREE_KERNELS_SIMD_BINARY
+#undef IREE_KERNELS_SIMD_UNARY
+
+}  // namespace kernels
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_KERNELS_SIMD_VECTOR_BYTES
+
+#endif  // IREE_HAL_INTERPRETER_BYTECODE_KERNELS_SIMD_H_
@@ -14,10 +14,17 @@
 
 #include "iree/hal/interpreter/bytecode_kernels.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>  // NOLINT
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/synchronization/mutex.h"
 #include "iree/base/memory.h"
 #include "iree/base/status_matchers.h"
+#include "iree/hal/heap_buffer.h"
 
 namespace iree {
 namespace hal {
@@ -365,6 +372,140 @@ TEST(Pad, HighRank) {
   EXPECT_EQ(dst_buffer, expected_dst);
 }
 
+TEST(Pad, InteriorPaddingMultiByte) {
+  Shape src_shape = {2, 2};
+  std::vector<float> src_buffer = {1.0f, 2.0f, 3.0f, 4.0f};
+  std::vector<float> pad_value_buffer = {-1.0f};
+  std::vector<int32_t> edge_padding_low = {0, 1};
+  std::vector<int32_t> edge_padding_high = {0, 0};
+  std::vector<int32_t> interior_padding = {0, 2};
+  Shape dst_shape = {2, 5};
+  std::vector<float> dst_buffer(dst_shape.element_count(), 0.0f);
+  std::vector<float> expected_dst = {-1.0f, 1.0f, -1.0f, -1.0f, 2.0f,
+                                     -1.0f, 3.0f, -1.0f, -1.0f, 4.0f};
+
+  EXPECT_OK(Pad::Execute<float>(
+      src_buffer, pad_value_buffer, absl::MakeSpan(dst_buffer), src_shape,
+      dst_shape, edge_padding_low, edge_padding_high, interior_padding));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+// Element-at-a-time transpose used as a reference for the blocked kernel.
+std::vector<uint32_t> ReferenceTranspose(const std::vector<uint32_t>& src,
+                                         const Shape& src_shape,
+                                         absl::Span<const int32_t> perm) {
+  int rank = src_shape.size();
+  std::vector<size_t> src_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    src_strides[i] = src_strides[i + 1] * src_shape[i + 1];
+  }
+  std::vector<uint32_t> dst(src.size());
+  std::vector<int> dst_index(rank, 0);
+  for (size_t dst_i = 0; dst_i < dst.size(); ++dst_i) {
+    size_t src_i = 0;
+    for (int i = 0; i < rank; ++i) src_i += dst_index[i] * src_strides[perm[i]];
+    dst[dst_i] = src[src_i];
+    for (int i = rank - 1; i >= 0; --i) {
+      if (++dst_index[i] < src_shape[perm[i]]) break;
+      dst_index[i] = 0;
+    }
+  }
+  return dst;
+}
+
+TEST(Transpose, MatchesReference) {
+  struct TestCase {
+    Shape src_shape;
+    std::vector<int32_t> perm;
+  };
+  std::vector<TestCase> test_cases = {
+      {{37, 41}, {1, 0}},              // 2-D, spans several blocks
+      {{2, 5, 7, 3}, {0, 3, 1, 2}},    // NHWC -> NCHW
+      {{2, 3, 5, 7}, {0, 2, 3, 1}},    // NCHW -> NHWC
+      {{3, 4, 19, 33}, {0, 1, 3, 2}},  // last two axes
+      {{4, 3, 6}, {1, 0, 2}},          // innermost dimension unchanged
+      {{2, 1, 3, 4}, {3, 1, 2, 0}},    // unit dimension and full reversal
+      {{5, 6}, {0, 1}},                // identity
+  };
+  for (const auto& test_case : test_cases) {
+    auto src_buffer = MakeIota<uint32_t>(test_case.src_shape.element_count());
+    std::vector<uint32_t> dst_buffer(src_buffer.size());
+    EXPECT_OK(Transpose::Execute<uint32_t>(src_buffer,
+                                           absl::MakeSpan(dst_buffer),
+                                           test_case.src_shape, test_case.perm));
+    EXPECT_EQ(dst_buffer, ReferenceTranspose(src_buffer, test_case.src_shape,
+                                             test_case.perm))
+        << "shape " << test_case.src_shape;
+  }
+}
+
+TEST(Reverse, InnerDimension) {
+  Shape src_shape = {2, 3};
+  auto src_buffer = MakeIota<uint16_t>(src_shape.element_count());
+  std::vector<int32_t> dimensions = {1};
+  std::vector<uint16_t> dst_buffer(src_shape.element_count());
+  std::vector<uint16_t> expected_dst = {3, 2, 1, 6, 5, 4};
+
+  EXPECT_OK(Reverse::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                       src_shape, dimensions));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Reverse, OuterDimensions) {
+  Shape src_shape = {2, 2, 3};
+  auto src_buffer = MakeIota<uint16_t>(src_shape.element_count());
+  std::vector<int32_t> dimensions = {0, 1};
+  std::vector<uint16_t> dst_buffer(src_shape.element_count());
+  std::vector<uint16_t> expected_dst = {10, 11, 12, 7, 8, 9,
+                                        4,  5,  6,  1, 2, 3};
+
+  EXPECT_OK(Reverse::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                       src_shape, dimensions));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Reverse, MixedDimensions) {
+  Shape src_shape = {2, 2, 2};
+  auto src_buffer = MakeIota<uint16_t>(src_shape.element_count());
+  std::vector<int32_t> dimensions = {0, 2};
+  std::vector<uint16_t> dst_buffer(src_shape.element_count());
+  std::vector<uint16_t> expected_dst = {6, 5, 8, 7, 2, 1, 4, 3};
+
+  EXPECT_OK(Reverse::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                       src_shape, dimensions));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, ReplicatesRowsAndColumns) {
+  Shape src_shape = {2, 2};
+  auto src_buffer = MakeIota<uint16_t>(src_shape.element_count());
+  Shape dst_shape = {4, 6};
+  std::vector<uint16_t> dst_buffer(dst_shape.element_count());
+  // clang-format off
+  std::vector<uint16_t> expected_dst = {1, 2, 1, 2, 1, 2,
+                                        3, 4, 3, 4, 3, 4,
+                                        1, 2, 1, 2, 1, 2,
+                                        3, 4, 3, 4, 3, 4};
+  // clang-format on
+
+  EXPECT_OK(Tile::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                    src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Tile, PartialTile) {
+  Shape src_shape = {1, 3};
+  auto src_buffer = MakeIota<uint16_t>(src_shape.element_count());
+  Shape dst_shape = {2, 8};
+  std::vector<uint16_t> dst_buffer(dst_shape.element_count());
+  std::vector<uint16_t> expected_dst = {1, 2, 3, 1, 2, 3, 1, 2,
+                                        1, 2, 3, 1, 2, 3, 1, 2};
+
+  EXPECT_OK(Tile::Execute<uint16_t>(src_buffer, absl::MakeSpan(dst_buffer),
+                                    src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
 TEST(ReduceSum, Scalar) {
   Shape src_shape = {5};
   int32_t dimension = 0;
@@ -401,6 +542,822 @@ TEST(ReduceMin, TwoDimensionsToOne) {
   }
 }
 
+TEST(ReduceSum, InnerDimension) {
+  Shape src_shape = {2, 3};
+  int32_t dimension = 1;
+  Shape dst_shape = {2};
+  auto src_buffer = MakeIota<int32_t>(src_shape.element_count());
+  std::vector<int32_t> init_buffer = {10};
+  std::vector<int32_t> dst_buffer(dst_shape.element_count(), 0);
+  std::vector<int32_t> expected_dst = {16, 25};
+
+  EXPECT_OK(ReduceSum::Execute<int32_t>(src_buffer, init_buffer,
+                                        absl::MakeSpan(dst_buffer), dimension,
+                                        src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(ReduceMax, MiddleDimension) {
+  Shape src_shape = {2, 3, 2};
+  int32_t dimension = 1;
+  Shape dst_shape = {2, 2};
+  std::vector<float> src_buffer = {1, 8, 3, 2, 5, 4, 6, 7, 9, 0, 2, 11};
+  std::vector<float> init_buffer = {std::numeric_limits<float>::lowest()};
+  std::vector<float> dst_buffer(dst_shape.element_count(), 0.0f);
+  std::vector<float> expected_dst = {5.0f, 8.0f, 9.0f, 11.0f};
+
+  EXPECT_OK(ReduceMax::Execute<float>(src_buffer, init_buffer,
+                                      absl::MakeSpan(dst_buffer), dimension,
+                                      src_shape, dst_shape));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+// Summing many small values one at a time loses most of their precision once
+// the total grows; both reduction orders must stay accurate.
+TEST(ReduceSum, LongFloatRunsStayAccurate) {
+  const int kCount = 1 << 20;
+  std::vector<float> src_buffer(kCount, 0.1f);
+  std::vector<float> init_buffer = {0.0f};
+  std::vector<float> dst_buffer(1);
+
+  EXPECT_OK(ReduceSum::Execute<float>(src_buffer, init_buffer,
+                                      absl::MakeSpan(dst_buffer), 0,
+                                      Shape{kCount}, Shape{}));
+  EXPECT_NEAR(kCount * 0.1f, dst_buffer[0], kCount * 0.1f * 1e-6f);
+
+  EXPECT_OK(ReduceSum::Execute<float>(src_buffer, init_buffer,
+                                      absl::MakeSpan(dst_buffer), 0,
+                                      Shape{kCount, 1}, Shape{1}));
+  EXPECT_NEAR(kCount * 0.1f, dst_buffer[0], kCount * 0.1f * 1e-6f);
+}
+
+TEST(ReduceSum, InvalidDimension) {
+  std::vector<float> src_buffer = {1.0f, 2.0f};
+  std::vector<float> init_buffer = {0.0f};
+  std::vector<float> dst_buffer(1);
+  EXPECT_FALSE(ReduceSum::Execute<float>(src_buffer, init_buffer,
+                                         absl::MakeSpan(dst_buffer), 1,
+                                         Shape{2}, Shape{})
+                   .ok());
+}
+
+TEST(ReduceSumWidening, Int8ToInt32) {
+  Shape src_shape = {3, 2};
+  std::vector<int8_t> src_buffer = {127, -128, 127, -128, 127, -128};
+  std::vector<int32_t> init_buffer = {1};
+
+  std::vector<int32_t> outer_dst(2);
+  EXPECT_OK((ReduceSumWidening::Execute<int8_t, int32_t>(
+      src_buffer, init_buffer, absl::MakeSpan(outer_dst), 0, src_shape,
+      Shape{2})));
+  EXPECT_THAT(outer_dst, ::testing::ElementsAre(382, -383));
+
+  std::vector<int32_t> inner_dst(3);
+  EXPECT_OK((ReduceSumWidening::Execute<int8_t, int32_t>(
+      src_buffer, init_buffer, absl::MakeSpan(inner_dst), 1, src_shape,
+      Shape{3})));
+  EXPECT_THAT(inner_dst, ::testing::ElementsAre(0, 0, 0));
+}
+
+// Elementwise kernels are tested with sizes that are not a multiple of any
+// vector width so that the tail handling of specialized kernels is covered.
+constexpr int kElementwiseSize = 67;
+
+template <typename T>
+std::vector<T> MakeRange(int size, T lo, T hi) {
+  std::vector<T> v(size);
+  for (int i = 0; i < size; ++i) {
+    v[i] = static_cast<T>(lo + (hi - lo) * (static_cast<double>(i) / size));
+  }
+  return v;
+}
+
+template <typename KERNEL>
+void ExpectUnaryNearReference(float (*reference)(float), float lo, float hi,
+                              float relative_tolerance) {
+  auto src_buffer = MakeRange<float>(kElementwiseSize, lo, hi);
+  std::vector<float> dst_buffer(src_buffer.size());
+  EXPECT_OK(KERNEL::template Execute<float>(src_buffer,
+                                            absl::MakeSpan(dst_buffer)));
+  for (int i = 0; i < src_buffer.size(); ++i) {
+    float expected = reference(src_buffer[i]);
+    EXPECT_NEAR(expected, dst_buffer[i],
+                std::max(std::abs(expected) * relative_tolerance, kEpsilon))
+        << "src: " << src_buffer[i];
+  }
+}
+
+TEST(Exp, MatchesReference) {
+  ExpectUnaryNearReference<Exp>(std::exp, -80.0f, 80.0f, 1e-6f);
+}
+
+TEST(Exp, Limits) {
+  std::vector<float> src_buffer = {-200.0f, 200.0f,
+                                   -std::numeric_limits<float>::infinity(),
+                                   std::numeric_limits<float>::infinity()};
+  std::vector<float> dst_buffer(src_buffer.size());
+  EXPECT_OK(Exp::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer)));
+  EXPECT_EQ(0.0f, dst_buffer[0]);
+  EXPECT_TRUE(std::isinf(dst_buffer[1]));
+  EXPECT_EQ(0.0f, dst_buffer[2]);
+  EXPECT_TRUE(std::isinf(dst_buffer[3]));
+}
+
+TEST(Log, MatchesReference) {
+  ExpectUnaryNearReference<Log>(std::log, 1e-3f, 1e4f, 1e-6f);
+}
+
+TEST(Log, Limits) {
+  std::vector<float> src_buffer = {0.0f, -1.0f,
+                                   std::numeric_limits<float>::infinity()};
+  std::vector<float> dst_buffer(src_buffer.size());
+  EXPECT_OK(Log::Execute<float>(src_buffer, absl::MakeSpan(dst_buffer)));
+  EXPECT_EQ(-std::numeric_limits<float>::infinity(), dst_buffer[0]);
+  EXPECT_TRUE(std::isnan(dst_buffer[1]));
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), dst_buffer[2]);
+}
+
+TEST(Rsqrt, MatchesReference) {
+  ExpectUnaryNearReference<Rsqrt>(
+      [](float x) { return 1.0f / std::sqrt(x); }, 1e-3f, 1e4f, 1e-6f);
+}
+
+TEST(Tanh, MatchesReference) {
+  ExpectUnaryNearReference<Tanh>(std::tanh, -10.0f, 10.0f, 1e-6f);
+}
+
+TEST(Sin, MatchesReference) {
+  ExpectUnaryNearReference<Sin>(std::sin, -100.0f, 100.0f, 1e-6f);
+}
+
+TEST(Cos, MatchesReference) {
+  ExpectUnaryNearReference<Cos>(std::cos, -100.0f, 100.0f, 1e-6f);
+}
+
+TEST(Floor, MatchesReference) {
+  ExpectUnaryNearReference<Floor>(std::floor, -10.0f, 10.0f, 0.0f);
+}
+
+TEST(Ceil, MatchesReference) {
+  ExpectUnaryNearReference<Ceil>(std::ceil, -10.0f, 10.0f, 0.0f);
+}
+
+TEST(Add, Int8Wraps) {
+  auto lhs_buffer = MakeRange<int8_t>(kElementwiseSize, -128, 127);
+  std::vector<int8_t> rhs_buffer(lhs_buffer.size(), 100);
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(Add::Execute<int8_t>(lhs_buffer, rhs_buffer,
+                                 absl::MakeSpan(dst_buffer)));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(static_cast<int8_t>(lhs_buffer[i] + rhs_buffer[i]),
+              dst_buffer[i]);
+  }
+}
+
+TEST(Clamp, Int32) {
+  auto src_buffer = MakeRange<int32_t>(kElementwiseSize, -100, 100);
+  std::vector<int32_t> min_buffer(src_buffer.size(), -10);
+  std::vector<int32_t> max_buffer(src_buffer.size(), 20);
+  std::vector<int32_t> dst_buffer(src_buffer.size());
+  EXPECT_OK(Clamp::Execute<int32_t>(src_buffer, min_buffer, max_buffer,
+                                    absl::MakeSpan(dst_buffer)));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(std::min(std::max(src_buffer[i], -10), 20), dst_buffer[i]);
+  }
+}
+
+TEST(CompareLT, Float) {
+  auto lhs_buffer = MakeRange<float>(kElementwiseSize, -1.0f, 1.0f);
+  std::vector<float> rhs_buffer(lhs_buffer.size(), 0.25f);
+  std::vector<uint8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(CompareLT::Execute<float>(lhs_buffer, rhs_buffer,
+                                      absl::MakeSpan(dst_buffer)));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(lhs_buffer[i] < rhs_buffer[i] ? 1 : 0, dst_buffer[i]);
+  }
+}
+
+TEST(CompareGE, Uint8) {
+  auto lhs_buffer = MakeRange<uint8_t>(kElementwiseSize, 0, 255);
+  std::vector<uint8_t> rhs_buffer(lhs_buffer.size(), 200);
+  std::vector<uint8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(CompareGE::Execute<uint8_t>(lhs_buffer, rhs_buffer,
+                                        absl::MakeSpan(dst_buffer)));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(lhs_buffer[i] >= rhs_buffer[i] ? 1 : 0, dst_buffer[i]);
+  }
+}
+
+TEST(Select, Uint32) {
+  std::vector<uint8_t> cond_buffer(kElementwiseSize);
+  for (int i = 0; i < cond_buffer.size(); ++i) cond_buffer[i] = i % 3;
+  auto lhs_buffer = MakeIota<uint32_t>(kElementwiseSize);
+  std::vector<uint32_t> rhs_buffer(lhs_buffer.size(), 0xFFFFFFFFu);
+  std::vector<uint32_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(Select::Execute<uint32_t>(cond_buffer, lhs_buffer, rhs_buffer,
+                                      absl::MakeSpan(dst_buffer)));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(cond_buffer[i] ? lhs_buffer[i] : rhs_buffer[i], dst_buffer[i]);
+  }
+}
+
+TEST(Convert, FloatToInt32) {
+  auto src_buffer = MakeRange<float>(kElementwiseSize, -50.0f, 50.0f);
+  std::vector<int32_t> dst_buffer(src_buffer.size());
+  EXPECT_OK((Convert::Execute<float, int32_t>(src_buffer,
+                                               absl::MakeSpan(dst_buffer))));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(static_cast<int32_t>(src_buffer[i]), dst_buffer[i]);
+  }
+}
+
+TEST(Convert, Int8ToFloat) {
+  auto src_buffer = MakeRange<int8_t>(kElementwiseSize, -128, 127);
+  std::vector<float> dst_buffer(src_buffer.size());
+  EXPECT_OK((Convert::Execute<int8_t, float>(src_buffer,
+                                              absl::MakeSpan(dst_buffer))));
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(static_cast<float>(src_buffer[i]), dst_buffer[i]);
+  }
+}
+
+// Fixed-point multipliers as (Q0.31 mantissa, exponent) pairs.
+constexpr int32_t kHalfMantissa = 1 << 30;
+constexpr int32_t kThreeQuartersMantissa = 3 << 29;
+
+// Returns |value| clamped to the range of T and truncated toward zero, as the
+// unfused clamp_f and convert_f_s ops that kTowardZero reproduces compute it.
+template <typename T>
+T ClampAndTruncate(float value) {
+  value = std::max<float>(std::numeric_limits<T>::min(), value);
+  value = std::min<float>(std::numeric_limits<T>::max(), value);
+  return static_cast<T>(value);
+}
+
+TEST(Requantize, Int32ToInt8Saturates) {
+  std::vector<int32_t> src_buffer = {-1000, -6, 0, 10, 254, 1000};
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};  // 0.5
+  std::vector<int32_t> exponent_buffer = {0};
+  std::vector<int32_t> zero_point_buffer = {0, 0};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  EXPECT_OK((Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{6}, RoundingMode::kToNearest)));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(-128, -3, 0, 5, 127, 127));
+}
+
+TEST(Requantize, ZeroPoints) {
+  std::vector<int32_t> src_buffer = {10, 20, 0, 300};
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};  // 0.5
+  std::vector<int32_t> exponent_buffer = {0};
+  // (src - 10) * 0.5 - 5.
+  std::vector<int32_t> zero_point_buffer = {10, -5};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  EXPECT_OK((Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{4}, RoundingMode::kToNearest)));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(-5, 0, -10, 127));
+}
+
+TEST(Requantize, PerChannel) {
+  std::vector<int32_t> src_buffer = {8, 8, 8, -20, -20, -20};
+  // 0.5, 1.0 and 0.25.
+  std::vector<int32_t> mantissa_buffer(3, kHalfMantissa);
+  std::vector<int32_t> exponent_buffer = {0, 1, -1};
+  std::vector<int32_t> zero_point_buffer = {0, 0};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  EXPECT_OK((Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{2, 3}, RoundingMode::kToNearest)));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(4, 8, 2, -10, -20, -5));
+}
+
+TEST(Requantize, TowardZeroMatchesFloat) {
+  std::vector<int32_t> src_buffer(401);
+  std::iota(src_buffer.begin(), src_buffer.end(), -200);
+  // (src - 3) * 0.75 - 2 has fractional parts of 0.25, 0.5 and 0.75.
+  std::vector<int32_t> mantissa_buffer = {kThreeQuartersMantissa};
+  std::vector<int32_t> exponent_buffer = {0};
+  std::vector<int32_t> zero_point_buffer = {3, -2};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  EXPECT_OK((Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{401}, RoundingMode::kTowardZero)));
+  for (size_t i = 0; i < src_buffer.size(); ++i) {
+    EXPECT_EQ(ClampAndTruncate<int8_t>((src_buffer[i] - 3) * 0.75f - 2),
+              dst_buffer[i])
+        << "src " << src_buffer[i];
+  }
+}
+
+TEST(Requantize, MismatchedChannelCount) {
+  std::vector<int32_t> src_buffer(4);
+  std::vector<int32_t> mantissa_buffer(2, kHalfMantissa);
+  std::vector<int32_t> exponent_buffer(2);
+  std::vector<int32_t> zero_point_buffer = {0, 0};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  EXPECT_TRUE(IsInvalidArgument(Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{4}, RoundingMode::kToNearest)));
+  EXPECT_TRUE(IsInvalidArgument(Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{1, 4}, RoundingMode::kToNearest)));
+}
+
+TEST(Requantize, MissingZeroPoint) {
+  std::vector<int32_t> src_buffer(4);
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {0};
+  std::vector<int32_t> zero_point_buffer = {0};
+  std::vector<int8_t> dst_buffer(src_buffer.size());
+  EXPECT_TRUE(IsInvalidArgument(Requantize::Execute<int32_t, int8_t>(
+      src_buffer, mantissa_buffer, exponent_buffer, zero_point_buffer,
+      absl::MakeSpan(dst_buffer), Shape{4}, RoundingMode::kToNearest)));
+}
+
+TEST(AddQ, Int8) {
+  std::vector<int8_t> lhs_buffer = {10, -20, 100, 127};
+  std::vector<int8_t> rhs_buffer = {4, 8, 100, 127};
+  // lhs * 0.5 + rhs * 0.25.
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa, kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {0, -1};
+  std::vector<int32_t> zero_point_buffer = {0, 0, 0};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(AddQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer), RoundingMode::kToNearest));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(6, -8, 75, 95));
+}
+
+TEST(AddQ, ZeroPoints) {
+  std::vector<int8_t> lhs_buffer = {10, -20};
+  std::vector<int8_t> rhs_buffer = {4, 8};
+  // (lhs - 2) * 0.5 + (rhs + 4) * 0.25 + 3.
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa, kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {0, -1};
+  std::vector<int32_t> zero_point_buffer = {2, -4, 3};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(AddQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer), RoundingMode::kToNearest));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(9, -5));
+}
+
+TEST(AddQ, Int8Saturates) {
+  std::vector<int8_t> lhs_buffer = {100, -100};
+  std::vector<int8_t> rhs_buffer = {100, -100};
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa, kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {1, 1};
+  std::vector<int32_t> zero_point_buffer = {0, 0, 0};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(AddQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer), RoundingMode::kToNearest));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(127, -128));
+}
+
+TEST(AddQ, TowardZeroMatchesFloat) {
+  std::vector<int8_t> lhs_buffer;
+  std::vector<int8_t> rhs_buffer;
+  for (int lhs = -128; lhs <= 127; lhs += 5) {
+    for (int rhs = -128; rhs <= 127; rhs += 3) {
+      lhs_buffer.push_back(lhs);
+      rhs_buffer.push_back(rhs);
+    }
+  }
+  // (lhs - 1) * 0.5 + (rhs + 1) * 0.375 + 2.
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa,
+                                          kThreeQuartersMantissa};
+  std::vector<int32_t> exponent_buffer = {0, -1};
+  std::vector<int32_t> zero_point_buffer = {1, -1, 2};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(AddQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer),
+      RoundingMode::kTowardZero));
+  for (size_t i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(ClampAndTruncate<int8_t>((lhs_buffer[i] - 1) * 0.5f +
+                                       (rhs_buffer[i] + 1) * 0.375f + 2),
+              dst_buffer[i])
+        << "lhs " << int{lhs_buffer[i]} << " rhs " << int{rhs_buffer[i]};
+  }
+}
+
+TEST(AddQ, MissingMultiplier) {
+  std::vector<int8_t> lhs_buffer(4);
+  std::vector<int8_t> rhs_buffer(4);
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {0};
+  std::vector<int32_t> zero_point_buffer = {0, 0, 0};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_TRUE(IsInvalidArgument(AddQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer),
+      RoundingMode::kToNearest)));
+}
+
+TEST(MulQ, Int8) {
+  std::vector<int8_t> lhs_buffer = {10, -12, 100};
+  std::vector<int8_t> rhs_buffer = {4, 4, 100};
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};  // 0.25
+  std::vector<int32_t> exponent_buffer = {-1};
+  std::vector<int32_t> zero_point_buffer = {0, 0, 0};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(MulQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer), RoundingMode::kToNearest));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(10, -12, 127));
+}
+
+TEST(MulQ, ZeroPoints) {
+  std::vector<int8_t> lhs_buffer = {10, -12};
+  std::vector<int8_t> rhs_buffer = {4, 4};
+  // (lhs - 2) * (rhs + 4) * 0.25 + 1.
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {-1};
+  std::vector<int32_t> zero_point_buffer = {2, -4, 1};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(MulQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer), RoundingMode::kToNearest));
+  EXPECT_THAT(dst_buffer, ::testing::ElementsAre(17, -27));
+}
+
+TEST(MulQ, TowardZeroMatchesFloat) {
+  std::vector<int8_t> lhs_buffer;
+  std::vector<int8_t> rhs_buffer;
+  for (int lhs = -20; lhs <= 20; ++lhs) {
+    for (int rhs = -20; rhs <= 20; ++rhs) {
+      lhs_buffer.push_back(lhs);
+      rhs_buffer.push_back(rhs);
+    }
+  }
+  // (lhs - 1) * (rhs + 2) * 0.375 - 3.
+  std::vector<int32_t> mantissa_buffer = {kThreeQuartersMantissa};
+  std::vector<int32_t> exponent_buffer = {-1};
+  std::vector<int32_t> zero_point_buffer = {1, -2, -3};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_OK(MulQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer),
+      RoundingMode::kTowardZero));
+  for (size_t i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_EQ(ClampAndTruncate<int8_t>(
+                  (lhs_buffer[i] - 1) * (rhs_buffer[i] + 2) * 0.375f - 3),
+              dst_buffer[i])
+        << "lhs " << int{lhs_buffer[i]} << " rhs " << int{rhs_buffer[i]};
+  }
+}
+
+TEST(MulQ, MissingZeroPoint) {
+  std::vector<int8_t> lhs_buffer(4);
+  std::vector<int8_t> rhs_buffer(4);
+  std::vector<int32_t> mantissa_buffer = {kHalfMantissa};
+  std::vector<int32_t> exponent_buffer = {-1};
+  std::vector<int32_t> zero_point_buffer = {0, 0};
+  std::vector<int8_t> dst_buffer(lhs_buffer.size());
+  EXPECT_TRUE(IsInvalidArgument(MulQ::Execute<int8_t>(
+      lhs_buffer, rhs_buffer, mantissa_buffer, exponent_buffer,
+      zero_point_buffer, absl::MakeSpan(dst_buffer),
+      RoundingMode::kToNearest)));
+}
+
+int32_t MakeInstruction(ElementwiseOp op, int a, int b = 0, int c = 0) {
+  return static_cast<int32_t>((static_cast<uint32_t>(op) << 24) | (a << 16) |
+                              (b << 8) | c);
+}
+
+TEST(ElementwiseProgram, MatchesUnfusedOps) {
+  // Spans multiple tiles with a partial tail.
+  int size = ElementwiseProgram::kTileSize * 2 + kElementwiseSize;
+  auto x_buffer = MakeRange<float>(size, -4.0f, 4.0f);
+  auto y_buffer = MakeRange<float>(size, 0.5f, 2.0f);
+  auto z_buffer = MakeRange<float>(size, -1.0f, 1.0f);
+  std::vector<absl::Span<const float>> src_buffers = {x_buffer, y_buffer,
+                                                      z_buffer};
+  // tanh(x * y + z)
+  std::vector<int32_t> program = {
+      MakeInstruction(ElementwiseOp::kMul, 0, 1),
+      MakeInstruction(ElementwiseOp::kAdd, 3, 2),
+      MakeInstruction(ElementwiseOp::kTanh, 4),
+  };
+  std::vector<float> dst_buffer(size);
+  EXPECT_OK(ElementwiseProgram::Execute<float>(src_buffers, program,
+                                               absl::MakeSpan(dst_buffer)));
+
+  std::vector<float> mul_buffer(size);
+  std::vector<float> add_buffer(size);
+  std::vector<float> expected_buffer(size);
+  EXPECT_OK(
+      Mul::Execute<float>(x_buffer, y_buffer, absl::MakeSpan(mul_buffer)));
+  EXPECT_OK(
+      Add::Execute<float>(mul_buffer, z_buffer, absl::MakeSpan(add_buffer)));
+  EXPECT_OK(
+      Tanh::Execute<float>(add_buffer, absl::MakeSpan(expected_buffer)));
+  for (int i = 0; i < size; ++i) {
+    EXPECT_EQ(expected_buffer[i], dst_buffer[i]);
+  }
+}
+
+TEST(ElementwiseProgram, InvalidPrograms) {
+  std::vector<float> src_buffer(4);
+  std::vector<absl::Span<const float>> src_buffers = {src_buffer};
+  std::vector<float> dst_buffer(src_buffer.size());
+
+  // Reads a register that has not yet been written.
+  std::vector<int32_t> program = {MakeInstruction(ElementwiseOp::kAdd, 0, 1)};
+  EXPECT_TRUE(IsInvalidArgument(ElementwiseProgram::Execute<float>(
+      src_buffers, program, absl::MakeSpan(dst_buffer))));
+
+  // Unknown op.
+  program = {static_cast<int32_t>(0xFF000000u)};
+  EXPECT_TRUE(IsInvalidArgument(ElementwiseProgram::Execute<float>(
+      src_buffers, program, absl::MakeSpan(dst_buffer))));
+
+  // Mismatched lengths.
+  std::vector<float> short_buffer(2);
+  src_buffers.push_back(short_buffer);
+  program = {MakeInstruction(ElementwiseOp::kAdd, 0, 1)};
+  EXPECT_TRUE(IsInvalidArgument(ElementwiseProgram::Execute<float>(
+      src_buffers, program, absl::MakeSpan(dst_buffer))));
+}
+
+TEST(MatMul, PrepackedConstantRhs) {
+  auto lhs_buffer = MakeIota<float>(6);
+  auto rhs_buffer = MakeIota<float>(6);
+  auto rhs_constant = HeapBuffer::Wrap(
+      MemoryType::kHostLocal, BufferUsage::kConstant | BufferUsage::kAll,
+      absl::MakeConstSpan(rhs_buffer));
+  std::vector<float> dst_buffer(4);
+  std::vector<float> expected_dst = {22, 28, 49, 64};
+
+  MatMul::Buffers<float, float> buffers;
+  buffers.lhs_shape = {2, 3};
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = {3, 2};
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = {2, 2};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  auto runtime_state = MatMul::CreateRuntimeState();
+
+  EXPECT_OK(MatMul::Execute(runtime_state.get(), buffers));
+  EXPECT_EQ(dst_buffer, expected_dst);
+
+  // The first execution packs the RHS and the second reuses the packed form.
+  int owner = 0;
+  buffers.rhs_constant_buffer = rhs_constant.get();
+  buffers.rhs_constant_owner = &owner;
+  for (int i = 0; i < 2; ++i) {
+    std::fill(dst_buffer.begin(), dst_buffer.end(), 0.0f);
+    EXPECT_OK(MatMul::Execute(runtime_state.get(), buffers));
+    EXPECT_EQ(dst_buffer, expected_dst);
+  }
+  {
+    absl::MutexLock lock(&runtime_state->mutex);
+    EXPECT_EQ(1, runtime_state->prepacked_rhs.size());
+  }
+
+  // Evicting another owner keeps the entry; evicting ours releases it.
+  int other_owner = 0;
+  runtime_state->EvictPrepackedRhs(&other_owner);
+  {
+    absl::MutexLock lock(&runtime_state->mutex);
+    EXPECT_EQ(1, runtime_state->prepacked_rhs.size());
+  }
+  runtime_state->EvictPrepackedRhs(&owner);
+  {
+    absl::MutexLock lock(&runtime_state->mutex);
+    EXPECT_TRUE(runtime_state->prepacked_rhs.empty());
+  }
+
+  // Packing again after eviction still produces the right result.
+  std::fill(dst_buffer.begin(), dst_buffer.end(), 0.0f);
+  EXPECT_OK(MatMul::Execute(runtime_state.get(), buffers));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(MatMul, ConcurrentMatMulsShareContexts) {
+  auto lhs_buffer = MakeIota<float>(6);
+  auto rhs_buffer = MakeIota<float>(6);
+  auto runtime_state =
+      MatMul::CreateRuntimeState(/*max_thread_count=*/4, /*context_count=*/2);
+  EXPECT_EQ(2, runtime_state->threads_per_context);
+
+  constexpr int kThreadCount = 8;
+  std::vector<std::vector<float>> dst_buffers(kThreadCount,
+                                              std::vector<float>(4));
+  std::vector<std::thread> threads;
+  for (auto& dst_buffer : dst_buffers) {
+    auto dst_span = absl::MakeSpan(dst_buffer);
+    threads.emplace_back([&, dst_span]() {
+      MatMul::Buffers<float, float> buffers;
+      buffers.lhs_shape = {2, 3};
+      buffers.lhs_buffer = lhs_buffer;
+      buffers.rhs_shape = {3, 2};
+      buffers.rhs_buffer = rhs_buffer;
+      buffers.dst_shape = {2, 2};
+      buffers.dst_buffer = dst_span;
+      EXPECT_OK(MatMul::Execute(runtime_state.get(), buffers));
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (const auto& dst_buffer : dst_buffers) {
+    EXPECT_EQ(dst_buffer, (std::vector<float>{22, 28, 49, 64}));
+  }
+
+  // No more contexts (and their threads) than requested are ever created.
+  absl::MutexLock lock(&runtime_state->mutex);
+  EXPECT_LE(runtime_state->created_context_count, 2);
+  EXPECT_EQ(runtime_state->created_context_count,
+            static_cast<int>(runtime_state->free_contexts.size()));
+}
+
+TEST(MatMul, BiasAndClamp) {
+  auto lhs_buffer = MakeIota<float>(6);
+  auto rhs_buffer = MakeIota<float>(6);
+  std::vector<float> bias_buffer = {-30, 10};
+  std::vector<float> dst_buffer(4);
+
+  MatMul::Buffers<float, float> buffers;
+  buffers.lhs_shape = {2, 3};
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = {3, 2};
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = {2, 2};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  buffers.bias_buffer = bias_buffer;
+  auto runtime_state = MatMul::CreateRuntimeState();
+
+  // The bias is applied per column of dst.
+  EXPECT_OK(MatMul::Execute(runtime_state.get(), buffers));
+  EXPECT_EQ(dst_buffer, (std::vector<float>{-8, 38, 19, 74}));
+
+  buffers.clamp_min = 0.0f;
+  buffers.clamp_max = 50.0f;
+  EXPECT_OK(MatMul::Execute(runtime_state.get(), buffers));
+  EXPECT_EQ(dst_buffer, (std::vector<float>{0, 38, 19, 50}));
+}
+
+// Sums 2x2 windows of a 3x3 image.
+TEST(Conv2D, Valid) {
+  auto src_buffer = MakeIota<float>(9);
+  std::vector<float> filter_buffer(4, 1.0f);
+  std::vector<float> dst_buffer(4);
+
+  Conv2D::Buffers<float> buffers;
+  buffers.src_shape = {1, 3, 3, 1};
+  buffers.src_buffer = src_buffer;
+  buffers.filter_shape = {2, 2, 1, 1};
+  buffers.filter_buffer = filter_buffer;
+  buffers.dst_shape = {1, 2, 2, 1};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  auto runtime_state = MatMul::CreateRuntimeState();
+
+  EXPECT_OK(Conv2D::Execute(runtime_state.get(), buffers, Conv2D::Params{}));
+  EXPECT_EQ(dst_buffer, (std::vector<float>{12, 16, 24, 28}));
+}
+
+TEST(Conv2D, StridedPadded) {
+  auto src_buffer = MakeIota<float>(9);
+  std::vector<float> filter_buffer(4, 1.0f);
+  std::vector<float> dst_buffer(4);
+
+  Conv2D::Buffers<float> buffers;
+  buffers.src_shape = {1, 3, 3, 1};
+  buffers.src_buffer = src_buffer;
+  buffers.filter_shape = {2, 2, 1, 1};
+  buffers.filter_buffer = filter_buffer;
+  buffers.dst_shape = {1, 2, 2, 1};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  Conv2D::Params params;
+  params.strides = {{2, 2}};
+  params.padding = {{0, 1, 0, 1}};
+  auto runtime_state = MatMul::CreateRuntimeState();
+
+  EXPECT_OK(Conv2D::Execute(runtime_state.get(), buffers, params));
+  EXPECT_EQ(dst_buffer, (std::vector<float>{12, 9, 15, 9}));
+}
+
+TEST(Conv2D, MismatchedDstShape) {
+  auto src_buffer = MakeIota<float>(9);
+  std::vector<float> filter_buffer(4, 1.0f);
+  std::vector<float> dst_buffer(9);
+
+  Conv2D::Buffers<float> buffers;
+  buffers.src_shape = {1, 3, 3, 1};
+  buffers.src_buffer = src_buffer;
+  buffers.filter_shape = {2, 2, 1, 1};
+  buffers.filter_buffer = filter_buffer;
+  buffers.dst_shape = {1, 3, 3, 1};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  auto runtime_state = MatMul::CreateRuntimeState();
+
+  EXPECT_TRUE(IsInvalidArgument(
+      Conv2D::Execute(runtime_state.get(), buffers, Conv2D::Params{})));
+}
+
+TEST(Conv2D, WindowLargerThanSrc) {
+  auto src_buffer = MakeIota<float>(4);
+  std::vector<float> filter_buffer(9, 1.0f);
+  std::vector<float> dst_buffer(1);
+
+  // The 3x3 window does not fit within the 2x2 source so there are no outputs
+  // (where truncating (2 - 3) / 2 + 1 would give 1).
+  Conv2D::Buffers<float> buffers;
+  buffers.src_shape = {1, 2, 2, 1};
+  buffers.src_buffer = src_buffer;
+  buffers.filter_shape = {3, 3, 1, 1};
+  buffers.filter_buffer = filter_buffer;
+  buffers.dst_shape = {1, 0, 0, 1};
+  Conv2D::Params params;
+  params.strides = {{2, 2}};
+  auto runtime_state = MatMul::CreateRuntimeState();
+
+  ASSERT_OK_AND_ASSIGN(
+      auto geometry,
+      impl::ComputeConv2DGeometry(buffers.src_shape, buffers.filter_shape,
+                                  buffers.dst_shape, params));
+  EXPECT_EQ(0, geometry.dst_height);
+  EXPECT_EQ(0, geometry.dst_width);
+  EXPECT_OK(Conv2D::Execute(runtime_state.get(), buffers, params));
+
+  // A single output would read past the source.
+  buffers.dst_shape = {1, 1, 1, 1};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  EXPECT_TRUE(IsInvalidArgument(
+      Conv2D::Execute(runtime_state.get(), buffers, params)));
+}
+
+struct Conv2DCase {
+  const char* name;
+  Shape src_shape;
+  Shape filter_shape;
+  Shape dst_shape;
+  Conv2D::Params params;
+};
+
+Conv2D::Params MakeConv2DParams(std::array<int32_t, 2> strides,
+                                std::array<int32_t, 4> padding,
+                                std::array<int32_t, 2> dilation,
+                                int32_t feature_group_count) {
+  Conv2D::Params params;
+  params.strides = strides;
+  params.padding = padding;
+  params.dilation = dilation;
+  params.feature_group_count = feature_group_count;
+  return params;
+}
+
+// Each case takes a different path through Conv2D::Execute (direct matmul,
+// im2col + matmul, depthwise, or grouped reference), all of which must match
+// the reference kernel. Small integer values keep the sums exact regardless
+// of accumulation order.
+TEST(Conv2D, MatchesReference) {
+  std::vector<Conv2DCase> cases = {
+      {"pointwise", {2, 4, 4, 8}, {1, 1, 8, 16}, {2, 4, 4, 16},
+       MakeConv2DParams({{1, 1}}, {{0, 0, 0, 0}}, {{1, 1}}, 1)},
+      {"pointwise_strided", {1, 4, 4, 2}, {1, 1, 2, 3}, {1, 2, 2, 3},
+       MakeConv2DParams({{2, 2}}, {{0, 0, 0, 0}}, {{1, 1}}, 1)},
+      {"same_padding", {2, 5, 5, 3}, {3, 3, 3, 4}, {2, 5, 5, 4},
+       MakeConv2DParams({{1, 1}}, {{1, 1, 1, 1}}, {{1, 1}}, 1)},
+      {"strided_dilated", {1, 9, 9, 2}, {3, 3, 2, 3}, {1, 3, 3, 3},
+       MakeConv2DParams({{2, 2}}, {{1, 0, 0, 1}}, {{2, 2}}, 1)},
+      {"depthwise", {1, 6, 6, 4}, {3, 3, 1, 4}, {1, 3, 3, 4},
+       MakeConv2DParams({{2, 2}}, {{1, 1, 1, 1}}, {{1, 1}}, 4)},
+      {"depthwise_multiplier", {1, 5, 5, 3}, {3, 3, 1, 6}, {1, 3, 3, 6},
+       MakeConv2DParams({{1, 1}}, {{0, 0, 0, 0}}, {{1, 1}}, 3)},
+      {"grouped", {1, 4, 4, 4}, {2, 2, 2, 6}, {1, 3, 3, 6},
+       MakeConv2DParams({{1, 1}}, {{0, 0, 0, 0}}, {{1, 1}}, 2)},
+  };
+  auto runtime_state = MatMul::CreateRuntimeState();
+  for (const auto& test_case : cases) {
+    SCOPED_TRACE(test_case.name);
+    std::vector<float> src_buffer(test_case.src_shape.element_count());
+    for (int i = 0; i < src_buffer.size(); ++i) src_buffer[i] = i % 7 - 3;
+    std::vector<float> filter_buffer(test_case.filter_shape.element_count());
+    for (int i = 0; i < filter_buffer.size(); ++i) filter_buffer[i] = i % 5 - 2;
+    std::vector<float> dst_buffer(test_case.dst_shape.element_count());
+    std::vector<float> expected_dst(dst_buffer.size());
+
+    Conv2D::Buffers<float> buffers;
+    buffers.src_shape = test_case.src_shape;
+    buffers.src_buffer = src_buffer;
+    buffers.filter_shape = test_case.filter_shape;
+    buffers.filter_buffer = filter_buffer;
+    buffers.dst_shape = test_case.dst_shape;
+    buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+    ASSERT_OK_AND_ASSIGN(auto geometry,
+                         impl::ComputeConv2DGeometry(
+                             test_case.src_shape, test_case.filter_shape,
+                             test_case.dst_shape, test_case.params));
+    impl::Conv2DReference(src_buffer.data(), filter_buffer.data(),
+                          expected_dst.data(), geometry, test_case.params);
+
+    EXPECT_OK(Conv2D::Execute(runtime_state.get(), buffers, test_case.params));
+    EXPECT_EQ(dst_buffer, expected_dst);
+  }
+}
+
 }  // namespace
 }  // namespace kernels
 }  // namespace hal
@@ -0,0 +1,361 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "iree/hal/interpreter/bytecode_tiling.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+#include "iree/vm/bytecode_tables_interpreter.h"
+#include "iree/vm/bytecode_util.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+// Union-find over local slots tracking which slots must be tiled identically.
+class SlotClasses {
+ public:
+  explicit SlotClasses(int slot_count)
+      : parents_(slot_count),
+        requires_whole_(slot_count, false),
+        written_(slot_count, false) {
+    std::iota(parents_.begin(), parents_.end(), 0);
+  }
+
+  StatusOr<int> Find(int slot) {
+    if (slot < 0 || slot >= parents_.size()) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Out of bounds local access " << slot << " of "
+             << parents_.size();
+    }
+    while (parents_[slot] != slot) {
+      parents_[slot] = parents_[parents_[slot]];
+      slot = parents_[slot];
+    }
+    return slot;
+  }
+
+  Status Unify(int a, int b) {
+    ASSIGN_OR_RETURN(a, Find(a));
+    ASSIGN_OR_RETURN(b, Find(b));
+    if (a != b) {
+      parents_[b] = a;
+      requires_whole_[a] = requires_whole_[a] || requires_whole_[b];
+      written_[a] = written_[a] || written_[b];
+    }
+    return OkStatus();
+  }
+
+  Status MarkWritten(int slot) {
+    ASSIGN_OR_RETURN(slot, Find(slot));
+    written_[slot] = true;
+    return OkStatus();
+  }
+
+  Status RequireWhole(int slot) {
+    ASSIGN_OR_RETURN(slot, Find(slot));
+    requires_whole_[slot] = true;
+    return OkStatus();
+  }
+
+  bool requires_whole(int root) const { return requires_whole_[root]; }
+  bool written(int root) const { return written_[root]; }
+
+ private:
+  std::vector<int> parents_;
+  std::vector<bool> requires_whole_;
+  std::vector<bool> written_;
+};
+
+uint16_t ReadSlot(absl::Span<const uint8_t> operand_data, int offset) {
+  return *reinterpret_cast<const uint16_t*>(&operand_data[offset]);
+}
+
+// Unifies |slot_count| consecutive slot operands starting at |offset|, the
+// last of which is the output written by the op.
+Status UnifySlots(SlotClasses* classes, absl::Span<const uint8_t> operand_data,
+                  int offset, int slot_count) {
+  int dst_slot =
+      ReadSlot(operand_data, offset + (slot_count - 1) * sizeof(uint16_t));
+  for (int i = 0; i < slot_count - 1; ++i) {
+    RETURN_IF_ERROR(classes->Unify(
+        dst_slot, ReadSlot(operand_data, offset + i * sizeof(uint16_t))));
+  }
+  return classes->MarkWritten(dst_slot);
+}
+
+}  // namespace
+
+// static
+StatusOr<BytecodeTiling> BytecodeTiling::Analyze(const vm::Function& function) {
+  BytecodeTiling tiling;
+  const auto* bytecode_def = function.def().bytecode();
+  if (!bytecode_def || !bytecode_def->contents() ||
+      function.result_count() > 0) {
+    return tiling;
+  }
+  int input_count = function.input_count();
+  int local_count = std::max(bytecode_def->local_count(), input_count);
+  SlotClasses classes(local_count);
+
+  bool is_tileable = true;
+  auto bytecode_data = absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(bytecode_def->contents()->data()),
+      bytecode_def->contents()->size());
+  RETURN_IF_ERROR(vm::ForEachInstruction(
+      vm::interpreter_opcode_table(), bytecode_data,
+      [&](int offset, uint8_t opcode,
+          absl::Span<const uint8_t> operand_data) -> Status {
+        if (!is_tileable) return OkStatus();
+        switch (static_cast<InterpreterOpcode>(opcode)) {
+          // Row-independent unary ops: src, dst.
+          case InterpreterOpcode::kNot:
+          case InterpreterOpcode::kAbsI:
+          case InterpreterOpcode::kAbsF:
+          case InterpreterOpcode::kCosF:
+          case InterpreterOpcode::kSinF:
+          case InterpreterOpcode::kTanhF:
+          case InterpreterOpcode::kExpF:
+          case InterpreterOpcode::kLogF:
+          case InterpreterOpcode::kRsqrtF:
+          case InterpreterOpcode::kFloorF:
+          case InterpreterOpcode::kCeilF:
+          case InterpreterOpcode::kAssign:
+          case InterpreterOpcode::kClone:
+            return UnifySlots(&classes, operand_data, 0, 2);
+
+          // Row-independent binary ops: lhs, rhs, dst.
+          case InterpreterOpcode::kAnd:
+          case InterpreterOpcode::kOr:
+          case InterpreterOpcode::kXor:
+          case InterpreterOpcode::kShiftLeft:
+          case InterpreterOpcode::kShiftRightLogical:
+          case InterpreterOpcode::kShiftRightArithmetic:
+          case InterpreterOpcode::kAddI:
+          case InterpreterOpcode::kAddF:
+          case InterpreterOpcode::kSubI:
+          case InterpreterOpcode::kSubF:
+          case InterpreterOpcode::kMulI:
+          case InterpreterOpcode::kMulF:
+          case InterpreterOpcode::kDivIS:
+          case InterpreterOpcode::kDivIU:
+          case InterpreterOpcode::kDivF:
+          case InterpreterOpcode::kAtan2F:
+          case InterpreterOpcode::kMinIS:
+          case InterpreterOpcode::kMinIU:
+          case InterpreterOpcode::kMinF:
+          case InterpreterOpcode::kMaxIS:
+          case InterpreterOpcode::kMaxIU:
+          case InterpreterOpcode::kMaxF:
+            return UnifySlots(&classes, operand_data, 0, 3);
+
+          // Row-independent ternary ops: a, b, c, dst.
+          case InterpreterOpcode::kMulAddI:
+          case InterpreterOpcode::kMulAddF:
+          case InterpreterOpcode::kClampIS:
+          case InterpreterOpcode::kClampIU:
+          case InterpreterOpcode::kClampF:
+          case InterpreterOpcode::kSelect:
+            return UnifySlots(&classes, operand_data, 0, 4);
+
+          // Fused elementwise programs: srcs..., program, dst.
+          case InterpreterOpcode::kElementwiseF: {
+            int src_count = operand_data[0];
+            int operand_offset = sizeof(uint8_t) + src_count * sizeof(uint16_t);
+            int program_length = operand_data[operand_offset];
+            operand_offset +=
+                sizeof(uint8_t) + program_length * sizeof(int32_t);
+            int dst_slot = ReadSlot(operand_data, operand_offset);
+            for (int i = 0; i < src_count; ++i) {
+              RETURN_IF_ERROR(classes.Unify(
+                  dst_slot,
+                  ReadSlot(operand_data,
+                           sizeof(uint8_t) + i * sizeof(uint16_t))));
+            }
+            return classes.MarkWritten(dst_slot);
+          }
+
+          // Comparisons: predicate, lhs, rhs, dst.
+          case InterpreterOpcode::kCmpI:
+          case InterpreterOpcode::kCmpF:
+            return UnifySlots(&classes, operand_data, sizeof(uint8_t), 3);
+
+          // Conversions: src_type, src, dst_type, dst.
+          case InterpreterOpcode::kConvertSS:
+          case InterpreterOpcode::kConvertUU:
+          case InterpreterOpcode::kConvertSU:
+          case InterpreterOpcode::kConvertUS: {
+            int src_slot = ReadSlot(operand_data, sizeof(uint8_t));
+            int dst_slot = ReadSlot(operand_data,
+                                    sizeof(uint8_t) * 2 + sizeof(uint16_t));
+            RETURN_IF_ERROR(classes.Unify(src_slot, dst_slot));
+            return classes.MarkWritten(dst_slot);
+          }
+
+          // Float matmul: rows of lhs map to rows of dst; rhs is needed in
+          // its entirety by every tile.
+          case InterpreterOpcode::kMatMulF: {
+            RETURN_IF_ERROR(classes.Unify(ReadSlot(operand_data, 0),
+                                          ReadSlot(operand_data, 4)));
+            RETURN_IF_ERROR(classes.MarkWritten(ReadSlot(operand_data, 4)));
+            return classes.RequireWhole(ReadSlot(operand_data, 2));
+          }
+
+          // Fused float matmul: lhs, rhs, bias, clamp bounds..., dst. As
+          // with kMatMulF only lhs and dst are sliced by row.
+          case InterpreterOpcode::kMatMulBiasF: {
+            int clamp_bound_count = operand_data[sizeof(uint16_t) * 3];
+            int dst_slot = ReadSlot(operand_data,
+                                    sizeof(uint16_t) * 3 + sizeof(uint8_t) +
+                                        clamp_bound_count * sizeof(uint16_t));
+            RETURN_IF_ERROR(
+                classes.Unify(ReadSlot(operand_data, 0), dst_slot));
+            RETURN_IF_ERROR(classes.MarkWritten(dst_slot));
+            RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(operand_data, 2)));
+            RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(operand_data, 4)));
+            for (int i = 0; i < clamp_bound_count; ++i) {
+              RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(
+                  operand_data, sizeof(uint16_t) * 3 + sizeof(uint8_t) +
+                                    i * sizeof(uint16_t))));
+            }
+            return OkStatus();
+          }
+
+          // Convolution: src, filter, strides, padding, dilation,
+          // feature_group_count, dst. Images (the outermost dimension) of
+          // src map to images of dst; the filter is passed whole.
+          case InterpreterOpcode::kConvF: {
+            int operand_offset = sizeof(uint16_t) * 2;
+            for (int i = 0; i < 3; ++i) {
+              int list_length = operand_data[operand_offset];
+              operand_offset +=
+                  sizeof(uint8_t) + list_length * sizeof(int32_t);
+            }
+            int dst_slot =
+                ReadSlot(operand_data, operand_offset + sizeof(int32_t));
+            RETURN_IF_ERROR(
+                classes.Unify(ReadSlot(operand_data, 0), dst_slot));
+            RETURN_IF_ERROR(classes.MarkWritten(dst_slot));
+            return classes.RequireWhole(ReadSlot(operand_data, 2));
+          }
+
+          // Requantization: src, multiplier mantissas, multiplier exponents,
+          // zero points, rounding mode, dst. Per-channel multipliers index the
+          // innermost dimension and are passed whole, as are the zero points.
+          case InterpreterOpcode::kRequantize: {
+            int dst_slot = ReadSlot(operand_data,
+                                    sizeof(uint16_t) * 4 + sizeof(int32_t));
+            RETURN_IF_ERROR(
+                classes.Unify(ReadSlot(operand_data, 0), dst_slot));
+            RETURN_IF_ERROR(classes.MarkWritten(dst_slot));
+            RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(operand_data, 2)));
+            RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(operand_data, 4)));
+            return classes.RequireWhole(ReadSlot(operand_data, 6));
+          }
+
+          // Quantized binary ops: lhs, rhs, multiplier mantissas, multiplier
+          // exponents, zero points, rounding mode, dst.
+          case InterpreterOpcode::kAddQ:
+          case InterpreterOpcode::kMulQ: {
+            int dst_slot = ReadSlot(operand_data,
+                                    sizeof(uint16_t) * 5 + sizeof(int32_t));
+            RETURN_IF_ERROR(
+                classes.Unify(ReadSlot(operand_data, 0), dst_slot));
+            RETURN_IF_ERROR(
+                classes.Unify(ReadSlot(operand_data, 2), dst_slot));
+            RETURN_IF_ERROR(classes.MarkWritten(dst_slot));
+            RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(operand_data, 4)));
+            RETURN_IF_ERROR(classes.RequireWhole(ReadSlot(operand_data, 6)));
+            return classes.RequireWhole(ReadSlot(operand_data, 8));
+          }
+
+          // Reductions: src, init, dimension, dst. Reducing any dimension
+          // but the outermost keeps rows of src and dst aligned; the scalar
+          // init value is passed whole.
+          case InterpreterOpcode::kReduceSumI:
+          case InterpreterOpcode::kReduceSumF:
+          case InterpreterOpcode::kReduceMinI:
+          case InterpreterOpcode::kReduceMinF:
+          case InterpreterOpcode::kReduceMaxI:
+          case InterpreterOpcode::kReduceMaxF: {
+            int32_t dimension = *reinterpret_cast<const int32_t*>(
+                &operand_data[sizeof(uint16_t) * 2]);
+            if (dimension == 0) {
+              is_tileable = false;
+              return OkStatus();
+            }
+            int dst_slot = ReadSlot(operand_data,
+                                    sizeof(uint16_t) * 2 + sizeof(int32_t));
+            RETURN_IF_ERROR(
+                classes.Unify(dst_slot, ReadSlot(operand_data, 0)));
+            return classes.MarkWritten(dst_slot);
+          }
+
+          // Allocations with static shapes are sized for the entire workload
+          // and must not be combined with sliced values.
+          case InterpreterOpcode::kAllocHeap: {
+            int operand_offset = sizeof(int32_t) + sizeof(uint8_t);
+            int dim_count = operand_data[operand_offset];
+            operand_offset += sizeof(uint8_t) + dim_count * sizeof(int32_t);
+            int dynamic_dim_count = operand_data[operand_offset];
+            operand_offset +=
+                sizeof(uint8_t) + dynamic_dim_count * sizeof(uint16_t);
+            if (dynamic_dim_count > 0) {
+              is_tileable = false;
+              return OkStatus();
+            }
+            return classes.RequireWhole(
+                ReadSlot(operand_data, operand_offset));
+          }
+
+          case InterpreterOpcode::kDiscard:
+          case InterpreterOpcode::kReturn:
+            return OkStatus();
+
+          default:
+            // Anything else (control flow, calls, shape manipulation, etc)
+            // may depend on the full extent of its operands.
+            is_tileable = false;
+            return OkStatus();
+        }
+      }));
+  if (!is_tileable) {
+    return tiling;
+  }
+
+  // Any class containing a written value must be sliced so that tiles write
+  // disjoint ranges; everything else is passed whole to each tile.
+  bool any_sliced = false;
+  tiling.argument_modes_.resize(input_count, TileArgumentMode::kWhole);
+  for (int i = 0; i < input_count; ++i) {
+    ASSIGN_OR_RETURN(int root, classes.Find(i));
+    if (!classes.written(root)) continue;
+    if (classes.requires_whole(root)) {
+      // Written values depend on something that cannot be sliced.
+      tiling.argument_modes_.clear();
+      return tiling;
+    }
+    tiling.argument_modes_[i] = TileArgumentMode::kSliced;
+    any_sliced = true;
+  }
+  tiling.is_tileable_ = any_sliced;
+  return tiling;
+}
+
+}  // namespace hal
+}  // namespace iree
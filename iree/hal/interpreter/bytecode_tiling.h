@@ -0,0 +1,72 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Analysis used to split interpreter dispatches into independent tiles.
+//
+// Interpreter entry points operate on entire bindings and have no notion of
+// a workgroup ID. Some entry points, however, only contain operations that
+// are row-independent along the outermost dimension of their outputs (such as
+// elementwise math or the LHS of a matmul). Those entry points can be invoked
+// once per tile with their bindings subspanned to a range of rows and produce
+// the same results as a single invocation over the entire workload.
+
+#ifndef IREE_HAL_INTERPRETER_BYTECODE_TILING_H_
+#define IREE_HAL_INTERPRETER_BYTECODE_TILING_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+#include "iree/vm/function.h"
+
+namespace iree {
+namespace hal {
+
+// How an entry point argument is presented to each tile.
+enum class TileArgumentMode : uint8_t {
+  // The argument is subspanned to the rows of the tile.
+  kSliced = 0,
+  // The argument is passed in its entirety to every tile.
+  kWhole = 1,
+};
+
+// Describes whether and how an entry point may be tiled.
+class BytecodeTiling {
+ public:
+  // Analyzes the bytecode of |function| and returns its tiling description.
+  // Functions containing unsupported operations are returned as untileable.
+  static StatusOr<BytecodeTiling> Analyze(const vm::Function& function);
+
+  BytecodeTiling() = default;
+
+  // True if the entry point may be split into tiles at all.
+  bool is_tileable() const { return is_tileable_; }
+
+  // Mode of each entry point argument when tiled. Arguments written by the
+  // entry point are always sliced such that tiles write disjoint ranges.
+  absl::Span<const TileArgumentMode> argument_modes() const {
+    return argument_modes_;
+  }
+
+ private:
+  bool is_tileable_ = false;
+  std::vector<TileArgumentMode> argument_modes_;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_INTERPRETER_BYTECODE_TILING_H_
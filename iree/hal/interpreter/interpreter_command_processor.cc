@@ -14,6 +14,9 @@
 
 #include "iree/hal/interpreter/interpreter_command_processor.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/source_location.h"
@@ -25,10 +28,60 @@
 namespace iree {
 namespace hal {
 
+namespace {
+
+// Minimum number of elements written by each tile. Dispatches smaller than
+// this are not worth the overhead of fanning out across threads.
+constexpr int kMinTileElementCount = 16 * 1024;
+
+// Returns the number of rows (outermost dimension) shared by all sliced
+// bindings or 0 if the bindings cannot be sliced consistently.
+int GetSlicedRowCount(absl::Span<const BufferBinding> bindings,
+                      absl::Span<const TileArgumentMode> argument_modes,
+                      int* out_row_element_count) {
+  int row_count = 0;
+  *out_row_element_count = 0;
+  for (int i = 0; i < bindings.size(); ++i) {
+    if (argument_modes[i] != TileArgumentMode::kSliced) continue;
+    const auto& shape = bindings[i].shape;
+    if (shape.empty() || shape[0] <= 0) return 0;
+    if (row_count == 0) {
+      row_count = shape[0];
+    } else if (shape[0] != row_count) {
+      return 0;
+    }
+    *out_row_element_count =
+        std::max(*out_row_element_count, shape.element_count() / shape[0]);
+  }
+  return row_count;
+}
+
+// Returns |binding| as a BufferView, restricted to rows [row_offset,
+// row_offset + row_count) if it is sliced.
+StatusOr<BufferView> MakeTileBufferView(const BufferBinding& binding,
+                                        TileArgumentMode mode, int row_offset,
+                                        int row_count) {
+  BufferView buffer_view{add_ref(binding.buffer), binding.shape,
+                         binding.element_size};
+  if (mode == TileArgumentMode::kWhole) {
+    return buffer_view;
+  }
+  device_size_t row_length =
+      (binding.shape.element_count() / binding.shape[0]) * binding.element_size;
+  ASSIGN_OR_RETURN(buffer_view.buffer,
+                   Buffer::Subspan(buffer_view.buffer, row_offset * row_length,
+                                   row_count * row_length));
+  buffer_view.shape[0] = row_count;
+  return buffer_view;
+}
+
+}  // namespace
+
 InterpreterCommandProcessor::InterpreterCommandProcessor(
     Allocator* allocator, CommandBufferModeBitfield mode,
-    CommandCategoryBitfield command_categories)
-    : HostLocalCommandProcessor(allocator, mode, command_categories) {}
+    CommandCategoryBitfield command_categories, HostThreadPool* thread_pool)
+    : HostLocalCommandProcessor(allocator, mode, command_categories),
+      thread_pool_(thread_pool) {}
 
 InterpreterCommandProcessor::~InterpreterCommandProcessor() = default;
 
@@ -43,25 +96,66 @@ Status InterpreterCommandProcessor::Dispatch(
   ASSIGN_OR_RETURN(auto entry_function, module.function_table().LookupExport(
                                             dispatch_request.entry_point));
 
-  vm::Stack stack;
-
-  // TODO(benvanik): avoid this by directly referencing the bindings.
-  absl::InlinedVector<BufferView, 8> args;
-  args.reserve(dispatch_request.bindings.size());
-  for (auto& binding : dispatch_request.bindings) {
-    args.push_back(BufferView{add_ref(binding.buffer), binding.shape,
-                              binding.element_size});
-  }
-  absl::InlinedVector<BufferView, 8> results;
   if (entry_function.result_count() > 0) {
     return UnimplementedErrorBuilder(IREE_LOC)
            << "Executable export results are not yet implemented";
   }
 
-  RETURN_IF_ERROR(executable->context().Invoke(
-      &stack, entry_function, absl::MakeSpan(args), absl::MakeSpan(results)));
+  // Determine how many tiles we can split the dispatch into, if any.
+  const auto& tiling = executable->export_tiling(dispatch_request.entry_point);
+  int tile_count = 1;
+  int row_count = 0;
+  if (thread_pool_ && thread_pool_->concurrency() > 1 &&
+      tiling.is_tileable() &&
+      tiling.argument_modes().size() == dispatch_request.bindings.size()) {
+    int row_element_count = 0;
+    row_count = GetSlicedRowCount(dispatch_request.bindings,
+                                  tiling.argument_modes(), &row_element_count);
+    if (row_count > 0 && row_element_count > 0) {
+      int min_tile_rows =
+          std::max(1, kMinTileElementCount / row_element_count);
+      tile_count = std::max(1, std::min(thread_pool_->concurrency(),
+                                        row_count / min_tile_rows));
+    }
+  }
+
+  if (tile_count == 1) {
+    vm::Stack stack;
+
+    // TODO(benvanik): avoid this by directly referencing the bindings.
+    absl::InlinedVector<BufferView, 8> args;
+    args.reserve(dispatch_request.bindings.size());
+    for (auto& binding : dispatch_request.bindings) {
+      args.push_back(BufferView{add_ref(binding.buffer), binding.shape,
+                                binding.element_size});
+    }
+    absl::InlinedVector<BufferView, 8> results;
+    return executable->context().Invoke(&stack, entry_function,
+                                        absl::MakeSpan(args),
+                                        absl::MakeSpan(results));
+  }
 
-  return OkStatus();
+  // Execute each tile with its own stack over its range of rows.
+  return thread_pool_->ParallelFor(tile_count, [&](int tile_index) -> Status {
+    int row_offset = static_cast<int>(
+        static_cast<int64_t>(row_count) * tile_index / tile_count);
+    int row_end = static_cast<int>(static_cast<int64_t>(row_count) *
+                                   (tile_index + 1) / tile_count);
+    absl::InlinedVector<BufferView, 8> args;
+    args.reserve(dispatch_request.bindings.size());
+    for (int i = 0; i < dispatch_request.bindings.size(); ++i) {
+      ASSIGN_OR_RETURN(auto arg,
+                       MakeTileBufferView(dispatch_request.bindings[i],
+                                          tiling.argument_modes()[i],
+                                          row_offset, row_end - row_offset));
+      args.push_back(std::move(arg));
+    }
+    absl::InlinedVector<BufferView, 8> results;
+    vm::Stack stack;
+    return executable->context().Invoke(&stack, entry_function,
+                                        absl::MakeSpan(args),
+                                        absl::MakeSpan(results));
+  });
 }
 
 }  // namespace hal
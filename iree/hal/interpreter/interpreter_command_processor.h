@@ -16,18 +16,28 @@
 #define IREE_HAL_INTERPRETER_INTERPRETER_COMMAND_PROCESSOR_H_
 
 #include "iree/hal/host/host_local_command_processor.h"
+#include "iree/hal/host/host_thread_pool.h"
 
 namespace iree {
 namespace hal {
 
+// Command processor that executes dispatches with the bytecode interpreter.
+//
+// Dispatches of entry points that can be tiled (see BytecodeTiling) are split
+// along the outermost dimension of their bindings and executed across the
+// provided |thread_pool|. All other dispatches run on the calling thread.
 class InterpreterCommandProcessor final : public HostLocalCommandProcessor {
  public:
   InterpreterCommandProcessor(Allocator* allocator,
                               CommandBufferModeBitfield mode,
-                              CommandCategoryBitfield command_categories);
+                              CommandCategoryBitfield command_categories,
+                              HostThreadPool* thread_pool = nullptr);
   ~InterpreterCommandProcessor() override;
 
   Status Dispatch(const DispatchRequest& dispatch_request) override;
+
+ private:
+  HostThreadPool* thread_pool_;
 };
 
 }  // namespace hal
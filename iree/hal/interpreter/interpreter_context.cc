@@ -14,6 +14,7 @@
 
 #include "iree/hal/interpreter/interpreter_context.h"
 
+#include "absl/memory/memory.h"
 #include "iree/base/flatbuffer_util.h"
 #include "iree/base/status.h"
 #include "iree/hal/interpreter/bytecode_dispatch.h"
@@ -27,6 +28,15 @@ using ::iree::vm::Function;
 
 }  // namespace
 
+InterpreterContext::InterpreterContext(
+    hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state)
+    : allocator_(allocator), kernel_runtime_state_(kernel_runtime_state) {
+  if (!kernel_runtime_state_) {
+    owned_kernel_runtime_state_ = absl::make_unique<kernels::RuntimeState>();
+    kernel_runtime_state_ = owned_kernel_runtime_state_.get();
+  }
+}
+
 Status InterpreterContext::Invoke(vm::Stack* stack, Function function,
                                   absl::Span<BufferView> args,
                                   absl::Span<BufferView> results) const {
@@ -53,7 +63,7 @@ Status InterpreterContext::Invoke(vm::Stack* stack, Function function,
   }
 
   // Run main dispatch loop until it exits (or errors).
-  RETURN_IF_ERROR(Dispatch(allocator_, &kernel_runtime_state_, stack,
+  RETURN_IF_ERROR(Dispatch(allocator_, kernel_runtime_state_, stack,
                            callee_stack_frame, results));
 
   // Pop the callee frame to balance out the stack.
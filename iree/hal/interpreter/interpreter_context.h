@@ -31,17 +31,31 @@ namespace hal {
 
 class InterpreterContext final : public vm::Context {
  public:
-  explicit InterpreterContext(hal::Allocator* allocator)
-      : allocator_(allocator) {}
+  // |kernel_runtime_state| is usually owned by the device and shared by all
+  // executables on it; it must remain valid for the lifetime of the context.
+  // If omitted the context creates its own.
+  explicit InterpreterContext(
+      hal::Allocator* allocator,
+      kernels::RuntimeState* kernel_runtime_state = nullptr);
 
   // TODO(benvanik): helpers to make passing args easier
+  //
+  // Thread-safe; multiple invocations (such as the tiles of a dispatch) may run
+  // concurrently as long as each uses its own |stack|.
   Status Invoke(vm::Stack* stack, vm::Function function,
                 absl::Span<BufferView> args,
                 absl::Span<BufferView> results) const;
 
+  kernels::RuntimeState* kernel_runtime_state() const {
+    return kernel_runtime_state_;
+  }
+
  private:
   hal::Allocator* allocator_;
-  mutable kernels::RuntimeState kernel_runtime_state_;
+
+  // Kernel runtime state is thread-safe and shared by concurrent invocations.
+  std::unique_ptr<kernels::RuntimeState> owned_kernel_runtime_state_;
+  kernels::RuntimeState* kernel_runtime_state_;
 };
 
 }  // namespace hal
@@ -14,9 +14,12 @@
 
 #include "iree/hal/interpreter/interpreter_device.h"
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/command_buffer_validation.h"
@@ -45,10 +48,12 @@ namespace {
 // that is dependent on how it is performing its synchronization.
 class UnsynchronizedCommandQueue final : public CommandQueue {
  public:
-  UnsynchronizedCommandQueue(Allocator* allocator, std::string name,
+  UnsynchronizedCommandQueue(Allocator* allocator, HostThreadPool* thread_pool,
+                             std::string name,
                              CommandCategoryBitfield supported_categories)
       : CommandQueue(std::move(name), supported_categories),
-        allocator_(allocator) {}
+        allocator_(allocator),
+        thread_pool_(thread_pool) {}
   ~UnsynchronizedCommandQueue() override = default;
 
   Status Submit(absl::Span<const SubmissionBatch> batches,
@@ -90,34 +95,60 @@ class UnsynchronizedCommandQueue final : public CommandQueue {
       auto* inproc_command_buffer =
           static_cast<InProcCommandBuffer*>(command_buffer->impl());
       InterpreterCommandProcessor command_processor(
-          allocator_, command_buffer->mode(), supported_categories());
+          allocator_, command_buffer->mode(), supported_categories(),
+          thread_pool_);
       RETURN_IF_ERROR(inproc_command_buffer->Process(&command_processor));
     }
     return OkStatus();
   }
 
   Allocator* const allocator_;
+  HostThreadPool* const thread_pool_;
 };
 
 }  // namespace
 
 InterpreterDevice::InterpreterDevice(DeviceInfo device_info)
-    : Device(std::move(device_info)) {
-  // We currently only expose a single command queue.
-  auto command_queue = absl::make_unique<UnsynchronizedCommandQueue>(
-      &allocator_, "cpu0",
-      CommandCategory::kTransfer | CommandCategory::kDispatch);
+    : InterpreterDevice(std::move(device_info), Options{}) {}
+
+InterpreterDevice::InterpreterDevice(DeviceInfo device_info, Options options)
+    : Device(std::move(device_info)),
+      kernel_runtime_state_(options.kernel_options),
+      allocator_(options.allocator_options) {
+  int worker_count = options.worker_count < 0
+                         ? HostThreadPool::DefaultWorkerCount()
+                         : options.worker_count;
+  if (worker_count > 0) {
+    thread_pool_ = absl::make_unique<HostThreadPool>(worker_count);
+  }
+
+  // Each queue gets its own AsyncCommandQueue (and thus thread) so that
+  // independent submissions don't serialize behind each other.
   // TODO(benvanik): allow injection of the wrapper type to support
   // SyncCommandQueue without always linking in both.
-  auto async_command_queue =
-      absl::make_unique<AsyncCommandQueue>(std::move(command_queue));
-  command_queues_.push_back(std::move(async_command_queue));
+  auto create_queue = [this](std::string name,
+                             CommandCategoryBitfield supported_categories) {
+    auto command_queue = absl::make_unique<UnsynchronizedCommandQueue>(
+        &allocator_, thread_pool_.get(), std::move(name),
+        supported_categories);
+    return absl::make_unique<AsyncCommandQueue>(std::move(command_queue));
+  };
+  int dispatch_queue_count = std::max(1, options.dispatch_queue_count);
+  for (int i = 0; i < dispatch_queue_count; ++i) {
+    dispatch_queues_.push_back(
+        create_queue(absl::StrCat("cpu", i),
+                     CommandCategory::kTransfer | CommandCategory::kDispatch));
+  }
+  for (int i = 0; i < options.transfer_queue_count; ++i) {
+    transfer_queues_.push_back(create_queue(absl::StrCat("cpu_transfer", i),
+                                            CommandCategory::kTransfer));
+  }
 }
 
 InterpreterDevice::~InterpreterDevice() = default;
 
 std::shared_ptr<ExecutableCache> InterpreterDevice::CreateExecutableCache() {
-  return std::make_shared<BytecodeCache>(&allocator_);
+  return std::make_shared<BytecodeCache>(&allocator_, &kernel_runtime_state_);
 }
 
 StatusOr<ref_ptr<CommandBuffer>> InterpreterDevice::CreateCommandBuffer(
@@ -142,10 +173,7 @@ StatusOr<ref_ptr<BinarySemaphore>> InterpreterDevice::CreateBinarySemaphore(
 StatusOr<ref_ptr<TimelineSemaphore>> InterpreterDevice::CreateTimelineSemaphore(
     uint64_t initial_value) {
   IREE_TRACE_SCOPE0("InterpreterDevice::CreateTimelineSemaphore");
-
-  // TODO(b/140141417): implement timeline semaphores.
-  return UnimplementedErrorBuilder(IREE_LOC)
-         << "Timeline semaphores not yet implemented";
+  return make_ref<HostTimelineSemaphore>(initial_value);
 }
 
 StatusOr<ref_ptr<Fence>> InterpreterDevice::CreateFence(
@@ -167,7 +195,10 @@ StatusOr<int> InterpreterDevice::WaitAnyFence(
 }
 
 Status InterpreterDevice::WaitIdle(absl::Time deadline) {
-  for (auto& command_queue : command_queues_) {
+  for (auto& command_queue : dispatch_queues_) {
+    RETURN_IF_ERROR(command_queue->WaitIdle(deadline));
+  }
+  for (auto& command_queue : transfer_queues_) {
     RETURN_IF_ERROR(command_queue->WaitIdle(deadline));
   }
   return OkStatus();
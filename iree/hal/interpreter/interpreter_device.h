@@ -19,7 +19,8 @@
 #include "absl/types/span.h"
 #include "iree/base/memory.h"
 #include "iree/hal/device.h"
-#include "iree/hal/host/host_local_allocator.h"
+#include "iree/hal/host/host_caching_allocator.h"
+#include "iree/hal/host/host_thread_pool.h"
 #include "iree/hal/interpreter/bytecode_kernels.h"
 
 namespace iree {
@@ -27,7 +28,31 @@ namespace hal {
 
 class InterpreterDevice final : public Device {
  public:
+  struct Options {
+    // Number of worker threads used to execute the tiles of dispatches in
+    // addition to the queue thread. 0 executes all dispatches on the queue
+    // thread and -1 selects a count based on the host concurrency.
+    int worker_count = -1;
+
+    // Number of queues exposed for dispatch (and transfer) commands. Each queue
+    // has its own submission thread so submissions to different queues are
+    // processed concurrently; dispatch tiles from all queues share the worker
+    // threads.
+    int dispatch_queue_count = 1;
+
+    // Number of additional transfer-only queues. When 0 the dispatch queues
+    // are also exposed as the transfer queues.
+    int transfer_queue_count = 0;
+
+    // Controls caching of the host memory backing released buffers.
+    HostCachingAllocator::Options allocator_options;
+
+    // Kernel runtime state shared by all executables on the device.
+    kernels::RuntimeState::Options kernel_options;
+  };
+
   explicit InterpreterDevice(DeviceInfo device_info);
+  InterpreterDevice(DeviceInfo device_info, Options options);
   ~InterpreterDevice() override;
 
   kernels::RuntimeState* kernel_runtime_state() {
@@ -37,11 +62,13 @@ class InterpreterDevice final : public Device {
   Allocator* allocator() const override { return &allocator_; }
 
   absl::Span<CommandQueue*> dispatch_queues() const override {
-    return RawPtrSpan(absl::MakeSpan(command_queues_));
+    return RawPtrSpan(absl::MakeSpan(dispatch_queues_));
   }
 
   absl::Span<CommandQueue*> transfer_queues() const override {
-    return RawPtrSpan(absl::MakeSpan(command_queues_));
+    return transfer_queues_.empty()
+               ? RawPtrSpan(absl::MakeSpan(dispatch_queues_))
+               : RawPtrSpan(absl::MakeSpan(transfer_queues_));
   }
 
   std::shared_ptr<ExecutableCache> CreateExecutableCache() override;
@@ -67,8 +94,12 @@ class InterpreterDevice final : public Device {
 
  private:
   kernels::RuntimeState kernel_runtime_state_;
-  mutable HostLocalAllocator allocator_;
-  mutable absl::InlinedVector<std::unique_ptr<CommandQueue>, 1> command_queues_;
+  mutable HostCachingAllocator allocator_;
+  std::unique_ptr<HostThreadPool> thread_pool_;
+  mutable absl::InlinedVector<std::unique_ptr<CommandQueue>, 1>
+      dispatch_queues_;
+  mutable absl::InlinedVector<std::unique_ptr<CommandQueue>, 1>
+      transfer_queues_;
 };
 
 }  // namespace hal
@@ -0,0 +1,127 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/interpreter_device.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/command_buffer.h"
+#include "iree/hal/command_queue.h"
+#include "iree/hal/fence.h"
+#include "iree/hal/semaphore.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+InterpreterDevice::Options MakeOptions(int dispatch_queue_count,
+                                       int transfer_queue_count) {
+  InterpreterDevice::Options options;
+  options.worker_count = 0;
+  options.dispatch_queue_count = dispatch_queue_count;
+  options.transfer_queue_count = transfer_queue_count;
+  return options;
+}
+
+// Records a command buffer filling |buffer| with |value|.
+StatusOr<ref_ptr<CommandBuffer>> RecordFill(Device* device, Buffer* buffer,
+                                            uint32_t value) {
+  ASSIGN_OR_RETURN(auto command_buffer,
+                   device->CreateCommandBuffer(CommandBufferMode::kOneShot,
+                                               CommandCategory::kTransfer));
+  RETURN_IF_ERROR(command_buffer->Begin());
+  RETURN_IF_ERROR(command_buffer->FillBuffer(buffer, 0, kWholeBuffer, &value,
+                                             sizeof(value)));
+  RETURN_IF_ERROR(command_buffer->End());
+  return command_buffer;
+}
+
+TEST(InterpreterDeviceTest, QueueCounts) {
+  InterpreterDevice default_device(
+      DeviceInfo("interpreter", DeviceFeature::kNone), MakeOptions(0, 0));
+  EXPECT_EQ(1, default_device.dispatch_queues().size());
+  EXPECT_EQ(default_device.dispatch_queues()[0],
+            default_device.transfer_queues()[0]);
+
+  InterpreterDevice device(DeviceInfo("interpreter", DeviceFeature::kNone),
+                           MakeOptions(2, 1));
+  EXPECT_EQ(2, device.dispatch_queues().size());
+  ASSERT_EQ(1, device.transfer_queues().size());
+  EXPECT_NE(device.dispatch_queues()[0], device.transfer_queues()[0]);
+  EXPECT_NE(device.dispatch_queues()[1], device.transfer_queues()[0]);
+}
+
+// Submits work to queue 0 that cannot start until work submitted afterwards to
+// queue 1 has completed. This only makes progress if the queues execute
+// independently of each other.
+TEST(InterpreterDeviceTest, QueuesExecuteConcurrently) {
+  InterpreterDevice device(DeviceInfo("interpreter", DeviceFeature::kNone),
+                           MakeOptions(2, 0));
+  ASSERT_EQ(2, device.dispatch_queues().size());
+
+  std::vector<ref_ptr<Buffer>> buffers;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(
+        auto buffer,
+        device.allocator()->Allocate(
+            MemoryType::kHostLocal | MemoryType::kDeviceVisible,
+            BufferUsage::kAll, 16 * sizeof(uint32_t)));
+    buffers.push_back(std::move(buffer));
+  }
+  ASSERT_OK_AND_ASSIGN(auto command_buffer_0,
+                       RecordFill(&device, buffers[0].get(), 0xA));
+  ASSERT_OK_AND_ASSIGN(auto command_buffer_1,
+                       RecordFill(&device, buffers[1].get(), 0xB));
+
+  ASSERT_OK_AND_ASSIGN(auto semaphore, device.CreateTimelineSemaphore(0u));
+  ASSERT_OK_AND_ASSIGN(auto fence_0, device.CreateFence(0u));
+  ASSERT_OK_AND_ASSIGN(auto fence_1, device.CreateFence(0u));
+
+  std::vector<SemaphoreValue> semaphore_values = {
+      std::make_pair(semaphore.get(), uint64_t{1})};
+  auto* command_buffer_ptr_0 = command_buffer_0.get();
+  SubmissionBatch batch_0;
+  batch_0.wait_semaphores = semaphore_values;
+  batch_0.command_buffers = absl::MakeConstSpan(&command_buffer_ptr_0, 1);
+  ASSERT_OK(device.dispatch_queues()[0]->Submit(batch_0, {fence_0.get(), 1u}));
+
+  auto* command_buffer_ptr_1 = command_buffer_1.get();
+  SubmissionBatch batch_1;
+  batch_1.command_buffers = absl::MakeConstSpan(&command_buffer_ptr_1, 1);
+  batch_1.signal_semaphores = semaphore_values;
+  ASSERT_OK(device.dispatch_queues()[1]->Submit(batch_1, {fence_1.get(), 1u}));
+
+  ASSERT_OK(device.WaitAllFences({{fence_0.get(), 1u}, {fence_1.get(), 1u}},
+                                 absl::Now() + absl::Seconds(10)));
+  ASSERT_OK(device.WaitIdle(absl::InfiniteFuture()));
+
+  std::vector<uint32_t> contents(16);
+  ASSERT_OK(buffers[0]->ReadData(0, contents.data(),
+                                 contents.size() * sizeof(uint32_t)));
+  EXPECT_THAT(contents, ::testing::Each(0xAu));
+  ASSERT_OK(buffers[1]->ReadData(0, contents.data(),
+                                 contents.size() * sizeof(uint32_t)));
+  EXPECT_THAT(contents, ::testing::Each(0xBu));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
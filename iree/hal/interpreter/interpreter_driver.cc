@@ -37,7 +37,10 @@ DeviceInfo GetDefaultDeviceInfo() {
 
 }  // namespace
 
-InterpreterDriver::InterpreterDriver() : Driver("interpreter") {}
+InterpreterDriver::InterpreterDriver() : InterpreterDriver(Options{}) {}
+
+InterpreterDriver::InterpreterDriver(Options options)
+    : Driver("interpreter"), options_(std::move(options)) {}
 
 InterpreterDriver::~InterpreterDriver() = default;
 
@@ -54,7 +57,8 @@ StatusOr<std::shared_ptr<Device>> InterpreterDriver::CreateDefaultDevice() {
 
 StatusOr<std::shared_ptr<Device>> InterpreterDriver::CreateDevice(
     const DeviceInfo& device_info) {
-  auto device = std::make_shared<InterpreterDevice>(device_info);
+  auto device = std::make_shared<InterpreterDevice>(device_info,
+                                                    options_.device_options);
   return device;
 }
 
@@ -16,13 +16,20 @@
 #define IREE_HAL_INTERPRETER_INTERPRETER_DRIVER_H_
 
 #include "iree/hal/driver.h"
+#include "iree/hal/interpreter/interpreter_device.h"
 
 namespace iree {
 namespace hal {
 
 class InterpreterDriver final : public Driver {
  public:
+  struct Options {
+    // Options used for all devices created by the driver.
+    InterpreterDevice::Options device_options;
+  };
+
   InterpreterDriver();
+  explicit InterpreterDriver(Options options);
   ~InterpreterDriver() override;
 
   StatusOr<std::vector<DeviceInfo>> EnumerateAvailableDevices() override;
@@ -31,6 +38,9 @@ class InterpreterDriver final : public Driver {
 
   StatusOr<std::shared_ptr<Device>> CreateDevice(
       const DeviceInfo& device_info) override;
+
+ private:
+  Options options_;
 };
 
 }  // namespace hal
@@ -14,17 +14,48 @@
 
 #include <memory>
 
+#include "absl/flags/flag.h"
 #include "iree/base/init.h"
 #include "iree/base/status.h"
 #include "iree/hal/driver_registry.h"
 #include "iree/hal/interpreter/interpreter_driver.h"
 
+ABSL_FLAG(int, interpreter_worker_count, -1,
+          "Number of worker threads used to execute interpreter dispatches in "
+          "parallel. 0 runs on the queue thread only; -1 uses all cores.");
+
+ABSL_FLAG(int, interpreter_matmul_thread_count, 1,
+          "Maximum number of threads used by matmuls on a device. Threads are "
+          "divided between --interpreter_matmul_context_count matmuls.");
+
+ABSL_FLAG(int, interpreter_matmul_context_count, 1,
+          "Number of matmuls that may execute concurrently on a device. "
+          "Others wait for one to finish.");
+
+ABSL_FLAG(int, interpreter_dispatch_queue_count, 1,
+          "Number of dispatch queues (each with its own submission thread) "
+          "exposed by interpreter devices.");
+ABSL_FLAG(int, interpreter_transfer_queue_count, 0,
+          "Number of additional transfer-only queues exposed by interpreter "
+          "devices. 0 shares the dispatch queues.");
+
 namespace iree {
 namespace hal {
 namespace {
 
 StatusOr<std::shared_ptr<Driver>> CreateInterpreterDriver() {
-  return std::make_shared<InterpreterDriver>();
+  InterpreterDriver::Options options;
+  options.device_options.worker_count =
+      absl::GetFlag(FLAGS_interpreter_worker_count);
+  options.device_options.kernel_options.mat_mul_max_thread_count =
+      absl::GetFlag(FLAGS_interpreter_matmul_thread_count);
+  options.device_options.kernel_options.mat_mul_context_count =
+      absl::GetFlag(FLAGS_interpreter_matmul_context_count);
+  options.device_options.dispatch_queue_count =
+      absl::GetFlag(FLAGS_interpreter_dispatch_queue_count);
+  options.device_options.transfer_queue_count =
+      absl::GetFlag(FLAGS_interpreter_transfer_queue_count);
+  return std::make_shared<InterpreterDriver>(std::move(options));
 }
 
 }  // namespace
@@ -0,0 +1,156 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how end-to-end invocation throughput of a module scales with the
+// number of interpreter worker threads.
+//
+// Usage:
+//   interpreter_scaling_benchmark \
+//       --main_module=gemm.emod --main_function=main \
+//       --input_values="512x512xf32\n512x512xf32" \
+//       --benchmark_format=json
+//
+// One benchmark is registered per worker count (0, 1, 2, 4, ... up to the
+// host concurrency) and reports invocations/sec along with the total thread
+// count used for execution. Modules can be produced from the test/e2e/xla
+// sources (such as gemm.mlir and mnist.mlir) with iree-translate.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/init.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer_view_string_util.h"
+#include "iree/hal/device_info.h"
+#include "iree/hal/interpreter/interpreter_device.h"
+#include "iree/schemas/module_def_generated.h"
+#include "iree/vm/fiber_state.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/module.h"
+#include "iree/vm/sequencer_context.h"
+
+ABSL_FLAG(std::string, main_module, "", "Main module with entry point.");
+ABSL_FLAG(std::string, main_function, "main",
+          "Function within the main module to execute.");
+ABSL_FLAG(std::string, input_values, "", "Input shapes and optional values.");
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Device, context, and arguments used by a single benchmark run.
+struct InvocationState {
+  std::shared_ptr<vm::Instance> instance;
+  std::unique_ptr<vm::SequencerContext> context;
+  std::unique_ptr<vm::FiberState> fiber_state;
+  vm::Function function;
+  std::vector<BufferView> args;
+};
+
+StatusOr<std::unique_ptr<InvocationState>> CreateInvocationState(
+    int worker_count) {
+  auto state = absl::make_unique<InvocationState>();
+  state->instance = std::make_shared<vm::Instance>();
+
+  InterpreterDevice::Options options;
+  options.worker_count = worker_count;
+  auto device = std::make_shared<InterpreterDevice>(
+      DeviceInfo("interpreter", DeviceFeature::kNone), options);
+  RETURN_IF_ERROR(state->instance->device_manager()->RegisterDevice(device));
+
+  state->context = absl::make_unique<vm::SequencerContext>(state->instance);
+  ASSIGN_OR_RETURN(auto module_file,
+                   vm::ModuleFile::LoadFile(ModuleDefIdentifier(),
+                                            absl::GetFlag(FLAGS_main_module)));
+  ASSIGN_OR_RETURN(auto module, vm::Module::FromFile(std::move(module_file)));
+  RETURN_IF_ERROR(state->context->RegisterModule(std::move(module)));
+  ASSIGN_OR_RETURN(state->function, state->context->LookupExport(
+                                        absl::GetFlag(FLAGS_main_function)));
+  state->fiber_state = absl::make_unique<vm::FiberState>(state->instance);
+
+  auto input_values =
+      absl::StrReplaceAll(absl::GetFlag(FLAGS_input_values), {{"\\n", "\n"}});
+  for (const auto& line :
+       absl::StrSplit(input_values, '\n', absl::SkipWhitespace())) {
+    ASSIGN_OR_RETURN(auto input,
+                     ParseBufferViewFromString(line, device->allocator()));
+    state->args.push_back(std::move(input));
+  }
+  return state;
+}
+
+void BM_InvokeScaling(benchmark::State& state, int worker_count) {
+  auto invocation_state_or = CreateInvocationState(worker_count);
+  if (!invocation_state_or.ok()) {
+    state.SkipWithError(invocation_state_or.status().ToString().c_str());
+    return;
+  }
+  auto invocation_state = std::move(invocation_state_or).ValueOrDie();
+
+  for (auto _ : state) {
+    // Invocation consumes the arguments so we pass copies (which only retain
+    // the underlying buffers).
+    std::vector<BufferView> args = invocation_state->args;
+    std::vector<BufferView> results(invocation_state->function.result_count());
+    auto status = invocation_state->context->Invoke(
+        invocation_state->fiber_state.get(), invocation_state->function,
+        absl::MakeSpan(args), absl::MakeSpan(results));
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["threads"] = worker_count + 1;
+}
+
+void RegisterScalingBenchmarks() {
+  int max_worker_count =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())) - 1;
+  std::vector<int> worker_counts = {0};
+  for (int i = 1; i < max_worker_count; i *= 2) {
+    worker_counts.push_back(i);
+  }
+  if (max_worker_count > 0) {
+    worker_counts.push_back(max_worker_count);
+  }
+  for (int worker_count : worker_counts) {
+    benchmark::RegisterBenchmark(
+        absl::StrCat("BM_InvokeScaling/threads:", worker_count + 1).c_str(),
+        BM_InvokeScaling, worker_count)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+  }
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::iree::InitializeEnvironment(&argc, &argv);
+  ::iree::hal::RegisterScalingBenchmarks();
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
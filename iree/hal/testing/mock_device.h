@@ -0,0 +1,64 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_TESTING_MOCK_DEVICE_H_
+#define IREE_HAL_TESTING_MOCK_DEVICE_H_
+
+#include "gmock/gmock.h"
+#include "iree/hal/device.h"
+
+namespace iree {
+namespace hal {
+namespace testing {
+
+class MockDevice : public ::testing::StrictMock<Device> {
+ public:
+  explicit MockDevice(DeviceInfo device_info)
+      : ::testing::StrictMock<Device>(std::move(device_info)) {}
+
+  MOCK_CONST_METHOD0(allocator, Allocator*());
+  MOCK_CONST_METHOD0(dispatch_queues, absl::Span<CommandQueue*>());
+  MOCK_CONST_METHOD0(transfer_queues, absl::Span<CommandQueue*>());
+
+  MOCK_METHOD0(CreateExecutableCache, std::shared_ptr<ExecutableCache>());
+
+  MOCK_METHOD2(CreateCommandBuffer,
+               StatusOr<ref_ptr<CommandBuffer>>(
+                   CommandBufferModeBitfield mode,
+                   CommandCategoryBitfield command_categories));
+
+  MOCK_METHOD0(CreateEvent, StatusOr<ref_ptr<Event>>());
+
+  MOCK_METHOD1(CreateBinarySemaphore,
+               StatusOr<ref_ptr<BinarySemaphore>>(bool initial_value));
+
+  MOCK_METHOD1(CreateTimelineSemaphore,
+               StatusOr<ref_ptr<TimelineSemaphore>>(uint64_t initial_value));
+
+  MOCK_METHOD1(CreateFence, StatusOr<ref_ptr<Fence>>(uint64_t initial_value));
+
+  MOCK_METHOD2(WaitAllFences, Status(absl::Span<const FenceValue> fences,
+                                     absl::Time deadline));
+
+  MOCK_METHOD2(WaitAnyFence, StatusOr<int>(absl::Span<const FenceValue> fences,
+                                           absl::Time deadline));
+
+  MOCK_METHOD1(WaitIdle, Status(absl::Time deadline));
+};
+
+}  // namespace testing
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_TESTING_MOCK_DEVICE_H_
@@ -38,7 +38,8 @@ namespace iree {
 
 #define IREE_CONSTANT_ENCODING_LIST(ENC) \
   ENC(0x00, kDense, "dense")             \
-  ENC(0x01, kSplat, "splat")
+  ENC(0x01, kSplat, "splat")             \
+  ENC(0x02, kPooled, "pooled")
 
 #define IREE_TYPE_LIST(TYP)                      \
   TYP(0x00, kI8, "i8", 1)                        \
@@ -111,6 +112,8 @@ static constexpr uint8_t kBuiltinTypeCount =
 
 enum class OpcodeFlag : uint8_t {
   kDefault = 0,
+  // Opcode ends a block; execution never falls through to the next opcode.
+  kTerminator = 1 << 0,
 };
 IREE_BITFIELD(OpcodeFlag);
 using OpcodeFlagBitfield = OpcodeFlag;
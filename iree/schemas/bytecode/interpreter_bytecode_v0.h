@@ -41,9 +41,9 @@ namespace iree {
   OPC(0x01, kCall, "call", FLAG(kDefault), "fSR", FF)                         \
   OPC(0x02, kCallImport, "call_import", FLAG(kDefault), "FSR", FF)            \
   OPC(0x03, kCallIndirect, "call_indirect", FLAG(kDefault), "tsSR", FF)       \
-  OPC(0x04, kReturn, "return", FLAG(kDefault), "S", FF)                       \
-  OPC(0x05, kBranch, "br", FLAG(kDefault), "bT", FF)                          \
-  OPC(0x06, kCondBranch, "cond_br", FLAG(kDefault), "sbTbT", FF)              \
+  OPC(0x04, kReturn, "return", FLAG(kTerminator), "S", FF)                    \
+  OPC(0x05, kBranch, "br", FLAG(kTerminator), "bT", FF)                       \
+  OPC(0x06, kCondBranch, "cond_br", FLAG(kTerminator), "sbTbT", FF)           \
   OPC(0x07, kCmpI, "cmp_i", FLAG(kDefault), "psso", FF)                       \
   OPC(0x08, kCmpF, "cmp_f", FLAG(kDefault), "Psso", FF)                       \
                                                                               \
@@ -178,8 +178,8 @@ namespace iree {
   OPC(0x81, kExpF, "exp_f", FLAG(kDefault), "so", FF)                         \
   OPC(0x82, kLogF, "log_f", FLAG(kDefault), "so", FF)                         \
   OPC(0x83, kRsqrtF, "rsqrt_f", FLAG(kDefault), "so", FF)                     \
+  OPC(0x84, kElementwiseF, "elementwise_f", FLAG(kDefault), "SIo", FF)        \
                                                                               \
-  RSV(0x84, RESERVED_OPC)                                                     \
   RSV(0x85, RESERVED_OPC)                                                     \
   RSV(0x86, RESERVED_OPC)                                                     \
   RSV(0x87, RESERVED_OPC)                                                     \
@@ -216,7 +216,6 @@ namespace iree {
                                                                               \
   OPC(0xA0, kMatMulI, "matmul_i", FLAG(kDefault), "sssso", FF)                \
   OPC(0xA1, kMatMulF, "matmul_f", FLAG(kDefault), "sso", FF)                  \
-  /* TODO(benvanik): convolution */                                           \
                                                                               \
   OPC(0xA2, kReduceSumI, "reduce_sum_i", FLAG(kDefault), "ssio", FF)          \
   OPC(0xA3, kReduceSumF, "reduce_sum_f", FLAG(kDefault), "ssio", FF)          \
@@ -224,11 +223,24 @@ namespace iree {
   OPC(0xA5, kReduceMinF, "reduce_min_f", FLAG(kDefault), "ssio", FF)          \
   OPC(0xA6, kReduceMaxI, "reduce_max_i", FLAG(kDefault), "ssio", FF)          \
   OPC(0xA7, kReduceMaxF, "reduce_max_f", FLAG(kDefault), "ssio", FF)          \
-  RSV(0xA8, RESERVED_OPC)                                                     \
-  RSV(0xA9, RESERVED_OPC)                                                     \
-  RSV(0xAA, RESERVED_OPC)                                                     \
-  RSV(0xAB, RESERVED_OPC)                                                     \
-  RSV(0xAC, RESERVED_OPC)                                                     \
+                                                                              \
+  /* lhs, rhs, bias, clamp bounds ([] or [min, max] scalars), dst */          \
+  OPC(0xA8, kMatMulBiasF, "matmul_bias_f", FLAG(kDefault), "sssSo", FF)       \
+                                                                              \
+  /* NHWC input, HWIO filter, strides [h, w], padding [top, bottom, left,     \
+     right], filter dilation [h, w], feature_group_count, NHWC dst */         \
+  OPC(0xA9, kConvF, "conv_f", FLAG(kDefault), "ssIIIio", FF)                  \
+                                                                              \
+  /* src, multiplier mantissas, multiplier exponents (1 or per innermost      \
+     index), [src, dst] zero points, RoundingMode, dst; see                   \
+     kernels::Requantize */                                                   \
+  OPC(0xAA, kRequantize, "requantize", FLAG(kDefault), "ssssio", FF)          \
+  /* lhs, rhs, multiplier mantissas, multiplier exponents, [lhs, rhs, dst]    \
+     zero points, RoundingMode, dst; add_q takes [lhs, rhs] multipliers and   \
+     mul_q takes a single multiplier */                                       \
+  OPC(0xAB, kAddQ, "add_q", FLAG(kDefault), "sssssio", FF)                    \
+  OPC(0xAC, kMulQ, "mul_q", FLAG(kDefault), "sssssio", FF)                    \
+                                                                              \
   RSV(0xAD, RESERVED_OPC)                                                     \
   RSV(0xAE, RESERVED_OPC)                                                     \
   RSV(0xAF, RESERVED_OPC)                                                     \
@@ -314,12 +326,49 @@ namespace iree {
   OPC(0xFE, kCondBreak, "cond_break", FLAG(kDefault), "s", FF)                \
   OPC(0xFF, kBreak, "break", FLAG(kDefault), "", FF)
 
+// Operations that may appear in the program of a kElementwiseF op.
+// The program is an index list with one instruction per element packed as
+// [op:8][a:8][b:8][c:8] (most significant byte first). a/b/c are register
+// indices used as the operands of the op, up to the op arity. Registers
+// [0, N) hold the N op inputs and instruction i writes register N+i. The
+// result of the last instruction is stored to the op output.
+#define IREE_ELEMENTWISE_OP_LIST(OP) \
+  OP(0x00, kAbs, "abs", 1)           \
+  OP(0x01, kExp, "exp", 1)           \
+  OP(0x02, kLog, "log", 1)           \
+  OP(0x03, kRsqrt, "rsqrt", 1)       \
+  OP(0x04, kCos, "cos", 1)           \
+  OP(0x05, kSin, "sin", 1)           \
+  OP(0x06, kTanh, "tanh", 1)         \
+  OP(0x07, kFloor, "floor", 1)       \
+  OP(0x08, kCeil, "ceil", 1)         \
+  OP(0x10, kAdd, "add", 2)           \
+  OP(0x11, kSub, "sub", 2)           \
+  OP(0x12, kMul, "mul", 2)           \
+  OP(0x13, kDiv, "div", 2)           \
+  OP(0x14, kMin, "min", 2)           \
+  OP(0x15, kMax, "max", 2)           \
+  OP(0x16, kAtan2, "atan2", 2)       \
+  OP(0x20, kMulAdd, "madd", 3)       \
+  OP(0x21, kClamp, "clamp", 3)
+
 #define DECLARE_ENUM(ordinal, enum_name, ...) enum_name = ordinal,
 enum class InterpreterOpcode : uint8_t {
   IREE_INTERPRETER_OPCODE_LIST(DECLARE_ENUM, DECLARE_ENUM)
 };
+
+enum class ElementwiseOp : uint8_t { IREE_ELEMENTWISE_OP_LIST(DECLARE_ENUM) };
 #undef DECLARE_ENUM
 
+// Rounding applied by the quantized ops (requantize, add_q and mul_q) when
+// rescaled values are narrowed to integers.
+enum class RoundingMode : int32_t {
+  // Rounds to nearest with ties away from zero.
+  kToNearest = 0,
+  // Truncates toward zero as a float to integer conversion (convert_f_s) does.
+  kTowardZero = 1,
+};
+
 }  // namespace iree
 
 #endif  // IREE_SCHEMAS_BYTECODE_INTERPRETER_BYTECODE_V0_H_
@@ -41,9 +41,9 @@ namespace iree {
   OPC(0x01, kCall, "call", FLAG(kDefault), "fSR", FF)                          \
   OPC(0x02, kCallImport, "call_import", FLAG(kDefault), "FSR", FF)             \
   OPC(0x03, kCallIndirect, "call_indirect", FLAG(kDefault), "tsSR", FF)        \
-  OPC(0x04, kReturn, "return", FLAG(kDefault), "S", FF)                        \
-  OPC(0x05, kBranch, "br", FLAG(kDefault), "bT", FF)                           \
-  OPC(0x06, kCondBranch, "cond_br", FLAG(kDefault), "sbTbT", FF)               \
+  OPC(0x04, kReturn, "return", FLAG(kTerminator), "S", FF)                     \
+  OPC(0x05, kBranch, "br", FLAG(kTerminator), "bT", FF)                        \
+  OPC(0x06, kCondBranch, "cond_br", FLAG(kTerminator), "sbTbT", FF)            \
                                                                                \
   RSV(0x07, RESERVED_OPC)                                                      \
   RSV(0x08, RESERVED_OPC)                                                      \
@@ -73,7 +73,7 @@ namespace iree {
   RSV(0x1E, RESERVED_OPC)                                                      \
   RSV(0x1F, RESERVED_OPC)                                                      \
                                                                                \
-  OPC(0x20, kAllocStatic, "alloc_static", FLAG(kDefault), "Icr", FF)           \
+  OPC(0x20, kAllocStatic, "alloc_static", FLAG(kDefault), "sitIr", FF)         \
   OPC(0x21, kAllocStack, "alloc_stack", FLAG(kDefault), "itISr", FF)           \
   OPC(0x22, kAllocStackInit, "alloc_stack_init", FLAG(kDefault), "tIScr", FF)  \
   OPC(0x23, kAllocHeap, "alloc_heap", FLAG(kDefault), "itISr", FF)             \
@@ -224,8 +224,19 @@ Status BytecodePrinter::PrintToStream(absl::Span<const uint8_t> data,
             ASSIGN_OR_RETURN(int dim, ReadValue<int32_t>(data, &offset));
             element_count *= dim;
           }
-          offset += sizeof(ConstantEncoding);
-          offset += element_count * type.element_size();
+          ASSIGN_OR_RETURN(auto encoding,
+                           ReadValue<ConstantEncoding>(data, &offset));
+          switch (encoding) {
+            case ConstantEncoding::kSplat:
+              offset += type.element_size();
+              break;
+            case ConstantEncoding::kPooled:
+              offset += sizeof(uint32_t);
+              break;
+            default:
+              offset += element_count * type.element_size();
+              break;
+          }
           break;
         }
         case OperandEncoding::kFunctionOrdinal: {
@@ -375,6 +386,16 @@ Status BytecodePrinter::PrintToStream(absl::Span<const uint8_t> data,
           ASSIGN_OR_RETURN(auto encoding,
                            ReadValue<ConstantEncoding>(data, &offset));
           *stream << ConstantEncodingToString(encoding);
+          if (encoding == ConstantEncoding::kPooled) {
+            ASSIGN_OR_RETURN(auto constant_ordinal,
+                             ReadValue<uint32_t>(data, &offset));
+            *stream << " buffer_view<";
+            if (!shape.empty()) {
+              *stream << absl::StrJoin(shape, "x") << "x";
+            }
+            *stream << type << ">#" << constant_ordinal;
+            break;
+          }
           int serialized_element_count = 1;
           switch (encoding) {
             case ConstantEncoding::kDense:
@@ -14,17 +14,183 @@
 
 #include "iree/vm/bytecode_reader.h"
 
+#include "absl/memory/memory.h"
+#include "absl/types/span.h"
 #include "iree/base/shape.h"
 #include "iree/base/status.h"
 #include "iree/hal/heap_buffer.h"
+#include "iree/schemas/bytecode_def_generated.h"
+#include "iree/vm/bytecode_util.h"
+#include "iree/vm/bytecode_validator.h"
+#include "iree/vm/module.h"
 
 namespace iree {
 namespace vm {
 
 namespace {
+
 using ::iree::hal::BufferView;
+
+// Decodes the constant operand at |data|. Dense constants reference the
+// module data in-place, splats are materialized and pooled constants are
+// shared with the module constant pool.
+StatusOr<BufferView> DecodeConstant(const Module& module, const uint8_t* data) {
+  BufferView buffer_view;
+
+  // Element type defines the buffer_view size (but we don't really care about
+  // the data format).
+  ASSIGN_OR_RETURN(auto element_type, Type::FromTypeIndex(*data++));
+  buffer_view.element_size = element_type.element_size();
+
+  // Parse shape - constants always define a full shape.
+  int rank = *data++;
+  buffer_view.shape = Shape(absl::MakeConstSpan(
+      reinterpret_cast<const int32_t*>(data), rank));
+  data += rank * sizeof(int32_t);
+
+  // Read encoding to determine how the constant data is stored in the file.
+  auto encoding = static_cast<ConstantEncoding>(*data++);
+
+  // Get buffer for the constant data.
+  switch (encoding) {
+    case ConstantEncoding::kDense: {
+      // The constant data is referenced in-place from the module (which is
+      // usually memory-mapped) and marked as device-visible constant memory so
+      // that host devices can use it directly without copying.
+      buffer_view.buffer = hal::HeapBuffer::Wrap(
+          hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible,
+          hal::BufferUsage::kConstant | hal::BufferUsage::kAll, data,
+          buffer_view.byte_length());
+      break;
+    }
+    case ConstantEncoding::kSplat: {
+      // NOTE: this is not much different than if a alloc_heap+broadcast pair
+      // had been in the IR. The splat is filled once when the function is
+      // prepared and shared by all executions.
+      buffer_view.buffer = hal::HeapBuffer::Allocate(
+          hal::MemoryType::kHostLocal, hal::BufferUsage::kAll,
+          buffer_view.byte_length());
+      switch (buffer_view.element_size) {
+        case 1: {
+          uint8_t value = *reinterpret_cast<const uint8_t*>(data);
+          RETURN_IF_ERROR(buffer_view.buffer->Fill8(value));
+          break;
+        }
+        case 2: {
+          uint16_t value = *reinterpret_cast<const uint16_t*>(data);
+          RETURN_IF_ERROR(buffer_view.buffer->Fill16(value));
+          break;
+        }
+        case 4: {
+          uint32_t value = *reinterpret_cast<const uint32_t*>(data);
+          RETURN_IF_ERROR(buffer_view.buffer->Fill32(value));
+          break;
+        }
+        case 8: {
+          // TODO(benvanik): add Fill64.
+          uint64_t value = *reinterpret_cast<const uint64_t*>(data);
+          ASSIGN_OR_RETURN(auto mapping,
+                           buffer_view.buffer->MapMemory<uint64_t>(
+                               hal::MemoryAccess::kDiscardWrite));
+          auto mapped_data = mapping.mutable_contents();
+          for (int i = 0; i < mapping.size(); ++i) {
+            mapped_data[i] = value;
+          }
+          break;
+        }
+        default:
+          return UnimplementedErrorBuilder(IREE_LOC)
+                 << "Unimplemented splat element stride "
+                 << buffer_view.element_size;
+      }
+      break;
+    }
+    case ConstantEncoding::kPooled: {
+      auto constant_ordinal = *reinterpret_cast<const uint32_t*>(data);
+
+      // Pooled constants are materialized once per module and shared.
+      ASSIGN_OR_RETURN(buffer_view.buffer,
+                       module.constant_pool().LookupConstant(constant_ordinal));
+      if (buffer_view.buffer->byte_length() != buffer_view.byte_length()) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Pooled constant " << constant_ordinal << " has "
+               << buffer_view.buffer->byte_length() << " bytes but "
+               << buffer_view.byte_length() << " are required";
+      }
+      break;
+    }
+    default:
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unimplemented constant encoding "
+             << static_cast<int>(encoding);
+  }
+
+  return buffer_view;
+}
+
+// Decodes all constant operands in |bytecode_def|, which must have been
+// validated, keyed by the bytecode offset of the operand.
+StatusOr<std::unique_ptr<DecodedFunction>> DecodeFunction(
+    OpcodeTable opcode_table, const Module& module,
+    const BytecodeDef& bytecode_def) {
+  auto decoded_function = absl::make_unique<DecodedFunction>();
+  auto bytecode_data = absl::MakeConstSpan(bytecode_def.contents()->Data(),
+                                           bytecode_def.contents()->size());
+  RETURN_IF_ERROR(ForEachInstruction(
+      opcode_table, bytecode_data,
+      [&](int offset, uint8_t opcode,
+          absl::Span<const uint8_t> operand_data) -> Status {
+        const auto& opcode_info = GetOpcodeInfo(opcode_table, opcode);
+        int operand_offset = 0;
+        for (auto encoding : opcode_info.operands) {
+          if (encoding == OperandEncoding::kNone) break;
+          int operand_start = operand_offset;
+          RETURN_IF_ERROR(
+              SkipOperand(encoding, operand_data, &operand_offset));
+          if (encoding != OperandEncoding::kConstant) continue;
+          DecodedFunction::Constant constant;
+          ASSIGN_OR_RETURN(
+              constant.value,
+              DecodeConstant(module, operand_data.data() + operand_start));
+          constant.encoded_length = operand_offset - operand_start;
+          decoded_function->AddConstant(offset + 1 + operand_start,
+                                        std::move(constant));
+        }
+        return OkStatus();
+      }));
+  return decoded_function;
+}
+
 }  // namespace
 
+// static
+StatusOr<const DecodedFunction*> BytecodeReader::PrepareFunction(
+    OpcodeTable opcode_table, const Function& function, int function_ordinal) {
+  const auto& function_table = function.module().function_table();
+  if (const auto* decoded_function =
+          function_table.LookupDecodedFunction(function_ordinal)) {
+    return decoded_function;
+  }
+
+  const auto* bytecode_def = function.def().bytecode();
+  if (!bytecode_def) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Function " << function.name() << " has no bytecode";
+  }
+  RETURN_IF_ERROR(BytecodeValidator::Validate(opcode_table, function.module(),
+                                              *bytecode_def))
+      << "in function " << function.name();
+  ASSIGN_OR_RETURN(
+      auto decoded_function,
+      DecodeFunction(opcode_table, function.module(), *bytecode_def),
+      _ << "in function " << function.name());
+
+  // Another thread may have prepared the function concurrently in which case
+  // ours is dropped and the existing one is returned.
+  return function_table.SetDecodedFunction(function_ordinal,
+                                           std::move(decoded_function));
+}
+
 StatusOr<const uint8_t*> BytecodeReader::AdvanceOffset() {
   *stack_frame_->mutable_offset() = offset();
   // TODO(benvanik): make a flag and/or remove.
@@ -45,24 +211,9 @@ StatusOr<const uint8_t*> BytecodeReader::AdvanceOffset() {
   return bytecode_pc_++;
 }
 
-Status BytecodeReader::SkipLocals(int count) {
-  size_t stride = sizeof(uint16_t) * count;
-  if (bytecode_pc_ + stride >= bytecode_limit_) {
-    return OutOfRangeErrorBuilder(IREE_LOC) << "Bytecode underflow";
-  }
-  bytecode_pc_ += stride;
-  return OkStatus();
-}
-
-Status BytecodeReader::ReadShape(Shape* out_shape) {
-  ASSIGN_OR_RETURN(auto shape_dims, ReadIndexList());
-  *out_shape = Shape(shape_dims);
-  return OkStatus();
-}
-
 StatusOr<Shape> BytecodeReader::ReadShapePieces() {
   // TODO(benvanik): rewrite to be faster (multiple offsets to walk both lists).
-  ASSIGN_OR_RETURN(auto shape_dims, ReadIndexList());
+  auto shape_dims = ReadIndexList();
   if (shape_dims.size() >= kMaxRank) {
     return UnimplementedErrorBuilder(IREE_LOC)
            << "Shapes limited to rank " << kMaxRank << " right now";
@@ -75,7 +226,7 @@ StatusOr<Shape> BytecodeReader::ReadShapePieces() {
   }
 
   Shape shape(shape_dims);
-  ASSIGN_OR_RETURN(int dynamic_dims, ReadCount());
+  int dynamic_dims = ReadCount();
   if (dynamic_dims != expected_dynamic_dims) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Expected " << expected_dynamic_dims << " dynamic dims but only "
@@ -103,18 +254,6 @@ StatusOr<Shape> BytecodeReader::ReadShapePieces(size_t* out_element_count) {
   return shape;
 }
 
-StatusOr<absl::Span<const int32_t>> BytecodeReader::ReadIndexList() {
-  ASSIGN_OR_RETURN(int count, ReadCount());
-  int stride = count * sizeof(int32_t);
-  if (bytecode_pc_ + stride >= bytecode_limit_) {
-    return OutOfRangeErrorBuilder(IREE_LOC) << "Bytecode underflow";
-  }
-  auto list = absl::Span<const int32_t>(
-      reinterpret_cast<const int32_t*>(bytecode_pc_), count);
-  bytecode_pc_ += stride;
-  return list;
-}
-
 Status BytecodeReader::SwitchStackFrame(StackFrame* new_stack_frame) {
   // Flush old state.
   auto* old_stack_frame = stack_frame_;
@@ -126,18 +265,30 @@ Status BytecodeReader::SwitchStackFrame(StackFrame* new_stack_frame) {
   // current one for easy access.
   stack_frame_ = new_stack_frame;
 
-  // Setup state pointers for faster dereferencing.
+  // Operands are decoded without checks so the function must be prepared
+  // before we execute any of it. This is usually done when the module is
+  // loaded and otherwise happens once on first entry. The result is cached on
+  // the frame for when execution returns to it.
   const auto& function = new_stack_frame->function();
+  if (!new_stack_frame->decoded_function()) {
+    ASSIGN_OR_RETURN(
+        int function_ordinal,
+        function.module().function_table().LookupFunctionOrdinal(function));
+    ASSIGN_OR_RETURN(
+        auto* decoded_function,
+        PrepareFunction(opcode_table_, function, function_ordinal));
+    new_stack_frame->set_decoded_function(decoded_function, function_ordinal);
+  }
+  decoded_function_ = new_stack_frame->decoded_function();
+  int function_ordinal = new_stack_frame->function_ordinal();
+
+  // Setup state pointers for faster dereferencing.
   const auto& bytecode = *function.def().bytecode();
   bytecode_base_ = bytecode.contents()->Data();
   bytecode_limit_ = bytecode_base_ + bytecode.contents()->size();
   bytecode_pc_ = bytecode_base_ + new_stack_frame->offset();
   locals_ = new_stack_frame->mutable_locals();
   // TODO(benvanik): reimplement breakpoints as bytecode rewriting.
-  int function_ordinal = function.module()
-                             .function_table()
-                             .LookupFunctionOrdinal(function)
-                             .ValueOrDie();
   breakpoint_table_ =
       function.module().function_table().GetFunctionBreakpointTable(
           function_ordinal);
@@ -146,10 +297,9 @@ Status BytecodeReader::SwitchStackFrame(StackFrame* new_stack_frame) {
 
 Status BytecodeReader::CopyInputsAndSwitchStackFrame(
     StackFrame* src_stack_frame, StackFrame* dst_stack_frame) {
-  ASSIGN_OR_RETURN(int32_t src_count, ReadCount());
+  int32_t src_count = ReadCount();
   for (int i = 0; i < src_count; ++i) {
-    ASSIGN_OR_RETURN(auto* src_local,
-                     ReadLocal(src_stack_frame->mutable_locals()));
+    auto* src_local = ReadLocal(src_stack_frame->mutable_locals());
     *dst_stack_frame->mutable_local(i) = *src_local;
   }
   return SwitchStackFrame(dst_stack_frame);
@@ -157,139 +307,55 @@ Status BytecodeReader::CopyInputsAndSwitchStackFrame(
 
 Status BytecodeReader::CopyResultsAndSwitchStackFrame(
     StackFrame* src_stack_frame, StackFrame* dst_stack_frame) {
-  ASSIGN_OR_RETURN(int32_t src_count, ReadCount());
+  return TransferResultsAndSwitchStackFrame(src_stack_frame, dst_stack_frame,
+                                            /*move_results=*/false);
+}
+
+Status BytecodeReader::MoveResultsAndSwitchStackFrame(
+    StackFrame* src_stack_frame, StackFrame* dst_stack_frame) {
+  return TransferResultsAndSwitchStackFrame(src_stack_frame, dst_stack_frame,
+                                            /*move_results=*/true);
+}
+
+Status BytecodeReader::TransferResultsAndSwitchStackFrame(
+    StackFrame* src_stack_frame, StackFrame* dst_stack_frame,
+    bool move_results) {
+  int32_t src_count = ReadCount();
   // TODO(benvanik): avoid vector.
   absl::InlinedVector<BufferView*, 8> src_locals(src_count);
   for (int i = 0; i < src_count; ++i) {
-    ASSIGN_OR_RETURN(src_locals[i],
-                     ReadLocal(src_stack_frame->mutable_locals()));
+    src_locals[i] = ReadLocal(src_stack_frame->mutable_locals());
   }
   RETURN_IF_ERROR(SwitchStackFrame(dst_stack_frame));
-  ASSIGN_OR_RETURN(int32_t dst_count, ReadCount());
+  int32_t dst_count = ReadCount();
   if (src_count != dst_count) {
     return OutOfRangeErrorBuilder(IREE_LOC)
            << "Src and dst value counts differ: " << src_count << " vs "
            << dst_count;
   }
   for (int i = 0; i < dst_count; ++i) {
-    ASSIGN_OR_RETURN(auto* dst_local,
-                     ReadLocal(dst_stack_frame->mutable_locals()));
-    *dst_local = *src_locals[i];
+    auto* dst_local = ReadLocal(dst_stack_frame->mutable_locals());
+    // Results are copied if the same local is returned again later.
+    bool returned_again = false;
+    for (int j = i + 1; j < src_count && !returned_again; ++j) {
+      returned_again = src_locals[j] == src_locals[i];
+    }
+    if (!move_results || returned_again) {
+      *dst_local = *src_locals[i];
+    } else {
+      *dst_local = std::move(*src_locals[i]);
+    }
   }
   return OkStatus();
 }
 
-Status BytecodeReader::CopySlots() {
-  ASSIGN_OR_RETURN(int32_t count, ReadCount());
+void BytecodeReader::CopySlots() {
+  int32_t count = ReadCount();
   for (int i = 0; i < count; ++i) {
-    ASSIGN_OR_RETURN(auto* src_local,
-                     ReadLocal(stack_frame_->mutable_locals()));
-    ASSIGN_OR_RETURN(auto* dst_local,
-                     ReadLocal(stack_frame_->mutable_locals()));
+    auto* src_local = ReadLocal();
+    auto* dst_local = ReadLocal();
     *dst_local = *src_local;
   }
-  return OkStatus();
-}
-
-Status BytecodeReader::BranchToOffset(int32_t offset) {
-  const uint8_t* new_bytecode_pc = bytecode_base_ + offset;
-  if (new_bytecode_pc < bytecode_base_ || new_bytecode_pc > bytecode_limit_) {
-    return OutOfRangeErrorBuilder(IREE_LOC)
-           << "Branch target " << offset
-           << " is out of bounds of the function bytecode ("
-           << static_cast<size_t>(bytecode_limit_ - bytecode_base_)
-           << "b total)";
-  }
-  bytecode_pc_ = new_bytecode_pc;
-  return OkStatus();
-}
-
-StatusOr<BufferView> BytecodeReader::ReadConstant() {
-  BufferView buffer_view;
-
-  // Element type defines the buffer_view size (but we don't really care about
-  // the data format).
-  ASSIGN_OR_RETURN(auto element_type, ReadType());
-  buffer_view.element_size = element_type.element_size();
-
-  // Parse shape - constants always define a full shape.
-  RETURN_IF_ERROR(ReadShape(&buffer_view.shape));
-
-  // Read encoding to determine how the constant data is stored in the file.
-  ASSIGN_OR_RETURN(auto encoding, ReadValue<ConstantEncoding>());
-
-  // Get buffer for the constant data.
-  switch (encoding) {
-    case ConstantEncoding::kDense: {
-      // Validate we have all constant data present.
-      device_size_t serialized_length = buffer_view.byte_length();
-      if (bytecode_pc_ + serialized_length >= bytecode_limit_) {
-        return OutOfRangeErrorBuilder(IREE_LOC)
-               << "Constant data out of bounds";
-      }
-
-      buffer_view.buffer = hal::HeapBuffer::Wrap(
-          hal::MemoryType::kHostLocal, hal::BufferUsage::kAll, bytecode_pc_,
-          serialized_length);
-      bytecode_pc_ += serialized_length;
-      break;
-    }
-    case ConstantEncoding::kSplat: {
-      // Validate we have at least one element worth of data in the buffer.
-      if (bytecode_pc_ + buffer_view.element_size >= bytecode_limit_) {
-        return OutOfRangeErrorBuilder(IREE_LOC)
-               << "Constant data out of bounds";
-      }
-
-      // TODO(benvanik): replace with fancy constant pool and such.
-      // NOTE: this is not much different than if a alloc_heap+broadcast pair
-      // had been in the IR.
-      buffer_view.buffer = hal::HeapBuffer::Allocate(
-          hal::MemoryType::kHostLocal, hal::BufferUsage::kAll,
-          buffer_view.byte_length());
-      switch (buffer_view.element_size) {
-        case 1: {
-          uint8_t value = *reinterpret_cast<const uint8_t*>(bytecode_pc_);
-          RETURN_IF_ERROR(buffer_view.buffer->Fill8(value));
-          break;
-        }
-        case 2: {
-          uint16_t value = *reinterpret_cast<const uint16_t*>(bytecode_pc_);
-          RETURN_IF_ERROR(buffer_view.buffer->Fill16(value));
-          break;
-        }
-        case 4: {
-          uint32_t value = *reinterpret_cast<const uint32_t*>(bytecode_pc_);
-          RETURN_IF_ERROR(buffer_view.buffer->Fill32(value));
-          break;
-        }
-        case 8: {
-          // TODO(benvanik): add Fill64.
-          uint64_t value = *reinterpret_cast<const uint64_t*>(bytecode_pc_);
-          ASSIGN_OR_RETURN(auto mapping,
-                           buffer_view.buffer->MapMemory<uint64_t>(
-                               hal::MemoryAccess::kDiscardWrite));
-          auto mapped_data = mapping.mutable_contents();
-          for (int i = 0; i < mapping.size(); ++i) {
-            mapped_data[i] = value;
-          }
-          break;
-        }
-        default:
-          return UnimplementedErrorBuilder(IREE_LOC)
-                 << "Unimplemented splat element stride "
-                 << buffer_view.element_size;
-      }
-      bytecode_pc_ += buffer_view.element_size;
-      break;
-    }
-    default:
-      return UnimplementedErrorBuilder(IREE_LOC)
-             << "Unimplemented constant encoding "
-             << static_cast<int>(encoding);
-  }
-
-  return buffer_view;
 }
 
 }  // namespace vm
@@ -17,10 +17,13 @@
 
 #include "absl/base/attributes.h"
 #include "absl/container/inlined_vector.h"
+#include "iree/base/logging.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
 #include "iree/schemas/bytecode/bytecode_v0.h"
+#include "iree/vm/decoded_function.h"
 #include "iree/vm/function.h"
+#include "iree/vm/opcode_info.h"
 #include "iree/vm/stack.h"
 #include "iree/vm/stack_frame.h"
 #include "iree/vm/type.h"
@@ -28,84 +31,125 @@
 namespace iree {
 namespace vm {
 
+// Decodes bytecode operands for the dispatch loops.
+//
+// Functions are prepared with PrepareFunction before they are executed
+// (either when their module is loaded or on first entry in SwitchStackFrame)
+// and operands are then decoded without any per-read checks. Debug builds
+// still check that reads stay within the function bytecode.
 class BytecodeReader {
  public:
-  explicit BytecodeReader(Stack* stack) : stack_(stack) {}
+  // Validates the bytecode of |function| and decodes its constants, caching
+  // the result in the function table of its module. Subsequent calls return
+  // the cached DecodedFunction.
+  static StatusOr<const DecodedFunction*> PrepareFunction(
+      OpcodeTable opcode_table, const Function& function,
+      int function_ordinal);
+
+  // |opcode_table| is used to prepare functions that were not prepared when
+  // their module was loaded.
+  BytecodeReader(Stack* stack, OpcodeTable opcode_table)
+      : stack_(stack), opcode_table_(opcode_table) {}
 
   int offset() const { return static_cast<int>(bytecode_pc_ - bytecode_base_); }
 
+  // True if the current function has breakpoints registered and opcodes must
+  // be read with AdvanceOffset.
+  bool has_breakpoints() const { return breakpoint_table_ != nullptr; }
+
+  // Reads the next opcode, updating the stack frame offset and issuing any
+  // breakpoint registered at the current offset.
   StatusOr<const uint8_t*> AdvanceOffset();
 
+  // Reads the next opcode. Must only be used when has_breakpoints() is false.
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint8_t ReadOpcode() {
+    return ReadValue<uint8_t>();
+  }
+
   Status SwitchStackFrame(StackFrame* new_stack_frame);
-  Status BranchToOffset(int32_t offset);
+
+  // Branch targets were validated to be instruction starts when the function
+  // was prepared.
+  ABSL_ATTRIBUTE_ALWAYS_INLINE void BranchToOffset(int32_t offset) {
+    bytecode_pc_ = bytecode_base_ + offset;
+  }
 
   Status CopyInputsAndSwitchStackFrame(StackFrame* src_stack_frame,
                                        StackFrame* dst_stack_frame);
   Status CopyResultsAndSwitchStackFrame(StackFrame* src_stack_frame,
                                         StackFrame* dst_stack_frame);
-  Status CopySlots();
-
-  StatusOr<hal::BufferView> ReadConstant();
-
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<int> ReadCount() {
-    return ReadValue<uint8_t>();
+  // Like CopyResultsAndSwitchStackFrame but moves the results out of
+  // |src_stack_frame|, avoiding reference counting when the source frame is
+  // being popped.
+  Status MoveResultsAndSwitchStackFrame(StackFrame* src_stack_frame,
+                                        StackFrame* dst_stack_frame);
+  void CopySlots();
+
+  // Returns the constant decoded when the function was prepared. The returned
+  // view shares the constant buffer with all other executions.
+  ABSL_ATTRIBUTE_ALWAYS_INLINE hal::BufferView ReadConstant() {
+    const auto* constant = decoded_function_->LookupConstant(offset());
+    DCHECK(constant != nullptr);
+    bytecode_pc_ += constant->encoded_length;
+    DCHECK(bytecode_pc_ <= bytecode_limit_);
+    return constant->value;
   }
 
+  ABSL_ATTRIBUTE_ALWAYS_INLINE int ReadCount() { return ReadValue<uint8_t>(); }
+
   ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<const Type> ReadType() {
-    ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>());
-    return Type::FromTypeIndex(type_index);
+    return Type::FromTypeIndex(ReadValue<uint8_t>());
   }
 
   ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<const Function> ReadFunction() {
-    ASSIGN_OR_RETURN(auto value, ReadValue<uint32_t>());
+    auto value = ReadValue<uint32_t>();
     const auto& module = stack_frame_->module();
     return module.function_table().LookupFunction(value);
   }
 
   ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<const ImportFunction*>
   ReadImportFunction() {
-    ASSIGN_OR_RETURN(auto value, ReadValue<uint32_t>());
+    auto value = ReadValue<uint32_t>();
     const auto& module = stack_frame_->module();
     return module.function_table().LookupImport(value);
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<hal::BufferView*> ReadLocal(
+  ABSL_ATTRIBUTE_ALWAYS_INLINE hal::BufferView* ReadLocal(
       absl::Span<hal::BufferView> locals) {
-    ASSIGN_OR_RETURN(auto value, ReadValue<uint16_t>());
-    if (value > locals.size()) {
-      return OutOfRangeErrorBuilder(IREE_LOC)
-             << "Out of bounds local access " << value << " of "
-             << locals.size();
-    }
+    auto value = ReadValue<uint16_t>();
+    DCHECK_LT(value, locals.size());
     return &locals[value];
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<hal::BufferView*> ReadLocal() {
+  ABSL_ATTRIBUTE_ALWAYS_INLINE hal::BufferView* ReadLocal() {
     return ReadLocal(locals_);
   }
 
-  Status SkipLocals(int count);
+  void SkipLocals(int count) {
+    bytecode_pc_ += sizeof(uint16_t) * count;
+    DCHECK(bytecode_pc_ <= bytecode_limit_);
+  }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<uint8_t> ReadUint8_t() {
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint8_t ReadUint8_t() {
     return ReadValue<uint8_t>();
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<uint16_t> ReadUint16_t() {
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint16_t ReadUint16_t() {
     return ReadValue<uint16_t>();
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<int32_t> ReadInt32() {
+  ABSL_ATTRIBUTE_ALWAYS_INLINE int32_t ReadInt32() {
     return ReadValue<int32_t>();
   }
 
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<uint32_t> ReadBlockOffset() {
+  ABSL_ATTRIBUTE_ALWAYS_INLINE uint32_t ReadBlockOffset() {
     return ReadValue<uint32_t>();
   }
 
   template <typename T, size_t N = 8>
   ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<absl::InlinedVector<T, N>>
   ReadSlotElements() {
-    ASSIGN_OR_RETURN(auto* local, ReadLocal(locals_));
+    auto* local = ReadLocal(locals_);
     absl::InlinedVector<T, N> result(local->shape.element_count());
     if (sizeof(T) == local->element_size) {
       // Fast(ish) path: requested element size matches the actual element size.
@@ -138,24 +182,37 @@ class BytecodeReader {
     return result;
   }
 
-  Status ReadShape(Shape* out_shape);
-
   StatusOr<Shape> ReadShapePieces();
   StatusOr<Shape> ReadShapePieces(size_t* out_element_count);
 
-  StatusOr<absl::Span<const int32_t>> ReadIndexList();
+  ABSL_ATTRIBUTE_ALWAYS_INLINE absl::Span<const int32_t> ReadIndexList() {
+    int count = ReadCount();
+    auto list = absl::Span<const int32_t>(
+        reinterpret_cast<const int32_t*>(bytecode_pc_), count);
+    bytecode_pc_ += count * sizeof(int32_t);
+    DCHECK(bytecode_pc_ <= bytecode_limit_);
+    return list;
+  }
 
  private:
+  Status TransferResultsAndSwitchStackFrame(StackFrame* src_stack_frame,
+                                            StackFrame* dst_stack_frame,
+                                            bool move_results);
+
+  // Reads a value from the bytecode without bounds checks; the bytecode of
+  // the current function has been validated.
   template <typename T>
-  ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<T> ReadValue() {
-    // TODO(benvanik): validate bounds.
+  ABSL_ATTRIBUTE_ALWAYS_INLINE T ReadValue() {
+    DCHECK(bytecode_pc_ + sizeof(T) <= bytecode_limit_);
     T value = *reinterpret_cast<const T*>(bytecode_pc_);
     bytecode_pc_ += sizeof(T);
     return value;
   }
 
   Stack* stack_ = nullptr;
+  OpcodeTable opcode_table_;
   StackFrame* stack_frame_ = nullptr;
+  const DecodedFunction* decoded_function_ = nullptr;
   const uint8_t* bytecode_base_ = nullptr;
   const uint8_t* bytecode_limit_ = nullptr;
   const uint8_t* bytecode_pc_ = nullptr;
@@ -0,0 +1,150 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/bytecode_reader.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/schemas/bytecode/sequencer_bytecode_v0.h"
+#include "iree/vm/bytecode_tables_sequencer.h"
+#include "iree/vm/module.h"
+#include "iree/vm/stack.h"
+#include "iree/vm/testing/test_module.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::iree::vm::testing::BuildTestModule;
+using ::iree::vm::testing::BytecodeBuilder;
+using ::iree::vm::testing::TestFunction;
+
+hal::BufferView MakeBufferView() {
+  return hal::BufferView(
+      hal::HeapBuffer::Allocate(hal::BufferUsage::kAll, sizeof(float)), {1},
+      sizeof(float));
+}
+
+// Builds a module where function 0 calls function 1 with local 0 and stores
+// the results in |caller_result_locals|. Function 1 returns its
+// |callee_return_locals|.
+StatusOr<std::unique_ptr<Module>> BuildCallModule(
+    std::vector<uint16_t> caller_result_locals,
+    std::vector<uint16_t> callee_return_locals) {
+  auto caller = BytecodeBuilder()
+                    .Opcode(SequencerOpcode::kCall)
+                    .Uint32(1)
+                    .Locals({0})
+                    .Locals(caller_result_locals)
+                    .Opcode(SequencerOpcode::kReturn)
+                    .Locals({});
+  auto callee = BytecodeBuilder()
+                    .Opcode(SequencerOpcode::kReturn)
+                    .Locals(callee_return_locals);
+  std::vector<TestFunction> functions = {
+      {"caller", 1, 0, /*local_count=*/3, caller.bytecode()},
+      {"callee", 1, static_cast<int>(callee_return_locals.size()),
+       /*local_count=*/1, callee.bytecode()},
+  };
+  return BuildTestModule(functions);
+}
+
+class BytecodeReaderTest : public ::testing::Test {
+ protected:
+  // Pushes the caller frame of |module|, calls into the callee and returns
+  // with the results moved back into the caller frame.
+  void CallAndReturn(const Module& module) {
+    ASSERT_OK_AND_ASSIGN(auto caller_function,
+                         module.function_table().LookupFunction(0));
+    ASSERT_OK_AND_ASSIGN(caller_frame_, stack_.PushFrame(caller_function));
+    *caller_frame_->mutable_local(0) = MakeBufferView();
+    buffer_ = caller_frame_->local(0).buffer.get();
+
+    ASSERT_OK(reader_.SwitchStackFrame(caller_frame_));
+    ASSERT_EQ(static_cast<uint8_t>(SequencerOpcode::kCall),
+              reader_.ReadOpcode());
+    ASSERT_OK_AND_ASSIGN(auto callee_function, reader_.ReadFunction());
+    ASSERT_OK_AND_ASSIGN(callee_frame_, stack_.PushFrame(callee_function));
+    ASSERT_OK(
+        reader_.CopyInputsAndSwitchStackFrame(caller_frame_, callee_frame_));
+    EXPECT_EQ(buffer_, callee_frame_->local(0).buffer.get());
+
+    ASSERT_EQ(static_cast<uint8_t>(SequencerOpcode::kReturn),
+              reader_.ReadOpcode());
+    ASSERT_OK(
+        reader_.MoveResultsAndSwitchStackFrame(callee_frame_, caller_frame_));
+  }
+
+  Stack stack_;
+  BytecodeReader reader_{&stack_, sequencer_opcode_table()};
+  StackFrame* caller_frame_ = nullptr;
+  StackFrame* callee_frame_ = nullptr;
+  hal::Buffer* buffer_ = nullptr;
+};
+
+TEST_F(BytecodeReaderTest, MoveResultsAndSwitchStackFrame) {
+  ASSERT_OK_AND_ASSIGN(auto module, BuildCallModule({1}, {0}));
+  CallAndReturn(*module);
+
+  // Both frames keep the function state prepared when they were entered.
+  EXPECT_NE(nullptr, caller_frame_->decoded_function());
+  EXPECT_EQ(0, caller_frame_->function_ordinal());
+  EXPECT_EQ(1, callee_frame_->function_ordinal());
+
+  // The result is moved out of the callee frame that is about to be popped.
+  EXPECT_EQ(buffer_, caller_frame_->local(1).buffer.get());
+  EXPECT_EQ(nullptr, callee_frame_->local(0).buffer);
+  EXPECT_EQ(nullptr, caller_frame_->local(2).buffer);
+  ASSERT_OK(stack_.PopFrame());
+
+  // The reader resumes the caller after the call.
+  EXPECT_EQ(static_cast<uint8_t>(SequencerOpcode::kReturn),
+            reader_.ReadOpcode());
+}
+
+TEST_F(BytecodeReaderTest, MoveResultsReturnedTwice) {
+  ASSERT_OK_AND_ASSIGN(auto module, BuildCallModule({1, 2}, {0, 0}));
+  CallAndReturn(*module);
+
+  // A local returned more than once is copied to all but its last result.
+  EXPECT_EQ(buffer_, caller_frame_->local(1).buffer.get());
+  EXPECT_EQ(buffer_, caller_frame_->local(2).buffer.get());
+  ASSERT_OK(stack_.PopFrame());
+}
+
+TEST_F(BytecodeReaderTest, ResultCountMismatch) {
+  ASSERT_OK_AND_ASSIGN(auto module, BuildCallModule({1, 2}, {0}));
+  ASSERT_OK_AND_ASSIGN(auto caller_function,
+                       module->function_table().LookupFunction(0));
+  ASSERT_OK_AND_ASSIGN(auto* caller_frame, stack_.PushFrame(caller_function));
+  ASSERT_OK(reader_.SwitchStackFrame(caller_frame));
+  reader_.ReadOpcode();
+  ASSERT_OK_AND_ASSIGN(auto callee_function, reader_.ReadFunction());
+  ASSERT_OK_AND_ASSIGN(auto* callee_frame, stack_.PushFrame(callee_function));
+  ASSERT_OK(reader_.CopyInputsAndSwitchStackFrame(caller_frame, callee_frame));
+  reader_.ReadOpcode();
+  EXPECT_TRUE(IsOutOfRange(
+      reader_.MoveResultsAndSwitchStackFrame(callee_frame, caller_frame)));
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
@@ -14,9 +14,127 @@
 
 #include "iree/vm/bytecode_util.h"
 
+#include <limits>
+
+#include "absl/base/macros.h"
+#include "iree/base/shape.h"
+#include "iree/vm/type.h"
+
 namespace iree {
 namespace vm {
 
+namespace {
+
+template <typename T>
+StatusOr<T> ReadValue(absl::Span<const uint8_t> data, int* offset) {
+  if (*offset + sizeof(T) > data.size()) {
+    return OutOfRangeErrorBuilder(IREE_LOC) << "Bytecode data underrun";
+  }
+  auto value = *reinterpret_cast<const T*>(&data[*offset]);
+  *offset = *offset + sizeof(T);
+  return value;
+}
+
+}  // namespace
+
+StatusOr<uint64_t> ReadConstantElementCount(absl::Span<const uint8_t> data,
+                                            int* offset) {
+  ASSIGN_OR_RETURN(uint8_t rank, ReadValue<uint8_t>(data, offset));
+  if (rank > kMaxRank) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Constant rank " << static_cast<int>(rank)
+           << " exceeds the maximum rank of " << kMaxRank;
+  }
+  uint64_t element_count = 1;
+  for (int i = 0; i < rank; ++i) {
+    ASSIGN_OR_RETURN(int32_t dim, ReadValue<int32_t>(data, offset));
+    if (dim < 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Constants must have a fully static shape";
+    }
+    if (dim != 0 &&
+        element_count > std::numeric_limits<uint64_t>::max() / dim) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Constant element count overflows";
+    }
+    element_count *= dim;
+  }
+  return element_count;
+}
+
+Status SkipOperand(OperandEncoding encoding, absl::Span<const uint8_t> data,
+                   int* offset) {
+  switch (encoding) {
+    case OperandEncoding::kInputSlot:
+    case OperandEncoding::kOutputSlot:
+    case OperandEncoding::kResultSlot:
+      *offset += sizeof(uint16_t);
+      break;
+    case OperandEncoding::kVariadicInputSlots:
+    case OperandEncoding::kVariadicOutputSlots:
+    case OperandEncoding::kVariadicResultSlots: {
+      ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+      *offset += count * sizeof(uint16_t);
+      break;
+    }
+    case OperandEncoding::kVariadicTransferSlots: {
+      ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+      *offset += count * 2 * sizeof(uint16_t);
+      break;
+    }
+    case OperandEncoding::kConstant: {
+      ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>(data, offset));
+      ASSIGN_OR_RETURN(auto type, Type::FromTypeIndex(type_index));
+      ASSIGN_OR_RETURN(uint64_t element_count,
+                       ReadConstantElementCount(data, offset));
+      ASSIGN_OR_RETURN(auto constant_encoding,
+                       ReadValue<ConstantEncoding>(data, offset));
+      if (constant_encoding == ConstantEncoding::kSplat) {
+        *offset += type.element_size();
+      } else if (constant_encoding == ConstantEncoding::kPooled) {
+        *offset += sizeof(uint32_t);
+      } else {
+        // Compare element counts so that the byte length cannot overflow.
+        uint64_t remaining_length = data.size() - *offset;
+        if (type.element_size() > 0 &&
+            element_count > remaining_length / type.element_size()) {
+          return OutOfRangeErrorBuilder(IREE_LOC) << "Bytecode data underrun";
+        }
+        *offset += element_count * type.element_size();
+      }
+      break;
+    }
+    case OperandEncoding::kFunctionOrdinal:
+    case OperandEncoding::kImportOrdinal:
+    case OperandEncoding::kBlockOffset:
+      *offset += sizeof(uint32_t);
+      break;
+    case OperandEncoding::kDispatchOrdinal:
+      *offset += sizeof(uint32_t) + sizeof(uint16_t);
+      break;
+    case OperandEncoding::kTypeIndex:
+    case OperandEncoding::kCmpIPredicate:
+    case OperandEncoding::kCmpFPredicate:
+      *offset += sizeof(uint8_t);
+      break;
+    case OperandEncoding::kIndex:
+      *offset += sizeof(int32_t);
+      break;
+    case OperandEncoding::kIndexList: {
+      ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+      *offset += count * sizeof(int32_t);
+      break;
+    }
+    default:
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unhandled op encoding " << static_cast<int>(encoding);
+  }
+  if (*offset > data.size()) {
+    return OutOfRangeErrorBuilder(IREE_LOC) << "Bytecode data underrun";
+  }
+  return OkStatus();
+}
+
 absl::string_view PredicateToString(CmpIPredicate p) {
 #define PRED(index, name, str, ...) \
   case CmpIPredicate::name:         \
@@ -39,5 +157,32 @@ absl::string_view PredicateToString(CmpFPredicate p) {
   return "<unknown>";
 }
 
+Status ForEachInstruction(OpcodeTable opcode_table,
+                          absl::Span<const uint8_t> bytecode_data,
+                          const InstructionCallback& callback) {
+  int offset = 0;
+  while (offset < bytecode_data.size()) {
+    int opcode_offset = offset;
+    uint8_t opcode = bytecode_data[offset++];
+    const auto& opcode_info = GetOpcodeInfo(opcode_table, opcode);
+    if (!opcode_info.mnemonic) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Unhandled opcode " << static_cast<int>(opcode)
+             << " at offset " << opcode_offset;
+    }
+    int operand_offset = offset;
+    for (int i = 0; i < ABSL_ARRAYSIZE(opcode_info.operands); ++i) {
+      if (opcode_info.operands[i] == OperandEncoding::kNone) break;
+      RETURN_IF_ERROR(SkipOperand(opcode_info.operands[i], bytecode_data,
+                                  &offset))
+          << "at offset " << opcode_offset;
+    }
+    RETURN_IF_ERROR(callback(
+        opcode_offset, opcode,
+        bytecode_data.subspan(operand_offset, offset - operand_offset)));
+  }
+  return OkStatus();
+}
+
 }  // namespace vm
 }  // namespace iree
@@ -15,8 +15,14 @@
 #ifndef IREE_VM_BYTECODE_UTIL_H_
 #define IREE_VM_BYTECODE_UTIL_H_
 
+#include <cstdint>
+#include <functional>
+
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "iree/base/status.h"
 #include "iree/schemas/bytecode/bytecode_v0.h"
+#include "iree/vm/opcode_info.h"
 
 namespace iree {
 namespace vm {
@@ -25,6 +31,31 @@ absl::string_view PredicateToString(CmpIPredicate predicate);
 
 absl::string_view PredicateToString(CmpFPredicate predicate);
 
+// Reads the rank and dimensions of a constant operand from |data| at |offset|
+// and returns the number of elements in the constant.
+// Returns an error if the rank exceeds kMaxRank, a dimension is dynamic or the
+// element count overflows.
+StatusOr<uint64_t> ReadConstantElementCount(absl::Span<const uint8_t> data,
+                                            int* offset);
+
+// Advances |offset| past the operand with the given |encoding| in |data|.
+// Returns an error if the operand extends past the end of |data|.
+Status SkipOperand(OperandEncoding encoding, absl::Span<const uint8_t> data,
+                   int* offset);
+
+// Callback issued for each instruction in a bytecode stream.
+// |offset| is the offset of the opcode within the stream and |operand_data| is
+// the encoded operand payload following the opcode.
+using InstructionCallback = std::function<Status(
+    int offset, uint8_t opcode, absl::Span<const uint8_t> operand_data)>;
+
+// Walks all instructions in |bytecode_data| in order using the operand
+// encodings from |opcode_table| to find instruction boundaries.
+// Returns an error if the bytecode is malformed or any callback fails.
+Status ForEachInstruction(OpcodeTable opcode_table,
+                          absl::Span<const uint8_t> bytecode_data,
+                          const InstructionCallback& callback);
+
 }  // namespace vm
 }  // namespace iree
 
@@ -14,13 +14,263 @@
 
 #include "iree/vm/bytecode_validator.h"
 
+#include <vector>
+
+#include "absl/base/macros.h"
+#include "iree/vm/bytecode_util.h"
+#include "iree/vm/stack_frame.h"
+#include "iree/vm/type.h"
+
 namespace iree {
 namespace vm {
 
+namespace {
+
+template <typename T>
+StatusOr<T> ReadValue(absl::Span<const uint8_t> data, int* offset) {
+  if (*offset + sizeof(T) > data.size()) {
+    return OutOfRangeErrorBuilder(IREE_LOC) << "Operand data underrun";
+  }
+  auto value = *reinterpret_cast<const T*>(&data[*offset]);
+  *offset = *offset + sizeof(T);
+  return value;
+}
+
+// Validates the operands of a single instruction against the function and the
+// module containing it.
+class InstructionValidator {
+ public:
+  InstructionValidator(const Module& module, const BytecodeDef& bytecode_def,
+                       std::vector<int>* branch_targets)
+      : module_(module),
+        local_count_(bytecode_def.local_count()),
+        branch_targets_(branch_targets) {}
+
+  Status ValidateOperands(const OpcodeInfo& opcode_info,
+                          absl::Span<const uint8_t> operand_data) {
+    int offset = 0;
+    callee_local_count_ = -1;
+    for (int i = 0; i < ABSL_ARRAYSIZE(opcode_info.operands); ++i) {
+      if (opcode_info.operands[i] == OperandEncoding::kNone) break;
+      RETURN_IF_ERROR(
+          ValidateOperand(opcode_info.operands[i], operand_data, &offset))
+          << "operand " << i << " of " << opcode_info.mnemonic;
+    }
+    return OkStatus();
+  }
+
+ private:
+  Status ValidateLocals(int count, absl::Span<const uint8_t> data,
+                        int* offset) {
+    for (int i = 0; i < count; ++i) {
+      ASSIGN_OR_RETURN(uint16_t ordinal, ReadValue<uint16_t>(data, offset));
+      if (ordinal >= local_count_) {
+        return OutOfRangeErrorBuilder(IREE_LOC)
+               << "Local " << ordinal << " out of range (function has "
+               << local_count_ << " locals)";
+      }
+    }
+    return OkStatus();
+  }
+
+  // Call arguments are copied into the first locals of the callee frame.
+  Status ValidateCallArguments(int count) {
+    if (count > callee_local_count_) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Call passes " << count << " arguments to a function with "
+             << callee_local_count_ << " locals";
+    }
+    return OkStatus();
+  }
+
+  Status ValidateOrdinal(uint32_t ordinal, int count, const char* kind) {
+    if (ordinal >= static_cast<uint32_t>(count)) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << kind << " ordinal " << ordinal << " out of range (" << count
+             << " defined)";
+    }
+    return OkStatus();
+  }
+
+  Status ValidateConstant(absl::Span<const uint8_t> data, int* offset) {
+    ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>(data, offset));
+    ASSIGN_OR_RETURN(auto type, Type::FromTypeIndex(type_index));
+    if (type.element_size() == 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Constants must have a sized element type";
+    }
+    ASSIGN_OR_RETURN(uint64_t element_count,
+                     ReadConstantElementCount(data, offset));
+    ASSIGN_OR_RETURN(auto encoding, ReadValue<ConstantEncoding>(data, offset));
+    switch (encoding) {
+      case ConstantEncoding::kDense: {
+        uint64_t remaining_length = data.size() - *offset;
+        if (element_count > remaining_length / type.element_size()) {
+          return OutOfRangeErrorBuilder(IREE_LOC)
+                 << "Dense constant of " << element_count
+                 << " elements extends past the operand data";
+        }
+        *offset += element_count * type.element_size();
+        break;
+      }
+      case ConstantEncoding::kSplat:
+        *offset += type.element_size();
+        break;
+      case ConstantEncoding::kPooled: {
+        ASSIGN_OR_RETURN(uint32_t ordinal, ReadValue<uint32_t>(data, offset));
+        RETURN_IF_ERROR(ValidateOrdinal(
+            ordinal, module_.constant_pool().size(), "Constant"));
+        break;
+      }
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented constant encoding "
+               << static_cast<int>(encoding);
+    }
+    return OkStatus();
+  }
+
+  // Operand sizes have already been checked by ForEachInstruction so only
+  // the referenced values need validation.
+  Status ValidateOperand(OperandEncoding encoding,
+                         absl::Span<const uint8_t> data, int* offset) {
+    const auto& function_table_def = module_.function_table().def();
+    switch (encoding) {
+      case OperandEncoding::kInputSlot:
+      case OperandEncoding::kOutputSlot:
+      case OperandEncoding::kResultSlot:
+        return ValidateLocals(1, data, offset);
+      case OperandEncoding::kVariadicInputSlots: {
+        ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+        if (callee_local_count_ >= 0) {
+          RETURN_IF_ERROR(ValidateCallArguments(count));
+        }
+        return ValidateLocals(count, data, offset);
+      }
+      case OperandEncoding::kVariadicOutputSlots:
+      case OperandEncoding::kVariadicResultSlots: {
+        ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+        return ValidateLocals(count, data, offset);
+      }
+      case OperandEncoding::kVariadicTransferSlots: {
+        ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+        return ValidateLocals(count * 2, data, offset);
+      }
+      case OperandEncoding::kConstant:
+        return ValidateConstant(data, offset);
+      case OperandEncoding::kFunctionOrdinal: {
+        ASSIGN_OR_RETURN(uint32_t ordinal, ReadValue<uint32_t>(data, offset));
+        RETURN_IF_ERROR(ValidateOrdinal(
+            ordinal, function_table_def.functions()->size(), "Function"));
+        ASSIGN_OR_RETURN(auto function,
+                         module_.function_table().LookupFunction(ordinal));
+        callee_local_count_ = StackFrame::RequiredLocalCount(function);
+        return OkStatus();
+      }
+      case OperandEncoding::kImportOrdinal: {
+        ASSIGN_OR_RETURN(uint32_t ordinal, ReadValue<uint32_t>(data, offset));
+        int import_count = function_table_def.imports()
+                               ? function_table_def.imports()->size()
+                               : 0;
+        RETURN_IF_ERROR(ValidateOrdinal(ordinal, import_count, "Import"));
+        // Imports are resolved when the module is registered with a context,
+        // which happens before any of its functions are prepared.
+        ASSIGN_OR_RETURN(const auto* import_function,
+                         module_.function_table().LookupImport(ordinal));
+        callee_local_count_ =
+            import_function->link_type() == ImportFunction::LinkType::kModule
+                ? StackFrame::RequiredLocalCount(
+                      import_function->linked_function())
+                : StackFrame::RequiredLocalCount(*import_function);
+        return OkStatus();
+      }
+      case OperandEncoding::kDispatchOrdinal:
+        // Executables and their exports are checked when they are looked up.
+        *offset += sizeof(uint32_t) + sizeof(uint16_t);
+        return OkStatus();
+      case OperandEncoding::kBlockOffset: {
+        ASSIGN_OR_RETURN(uint32_t block_offset,
+                         ReadValue<uint32_t>(data, offset));
+        branch_targets_->push_back(block_offset);
+        return OkStatus();
+      }
+      case OperandEncoding::kTypeIndex: {
+        ASSIGN_OR_RETURN(uint8_t type_index, ReadValue<uint8_t>(data, offset));
+        return Type::FromTypeIndex(type_index).status();
+      }
+      case OperandEncoding::kCmpIPredicate:
+      case OperandEncoding::kCmpFPredicate:
+        *offset += sizeof(uint8_t);
+        return OkStatus();
+      case OperandEncoding::kIndex:
+        *offset += sizeof(int32_t);
+        return OkStatus();
+      case OperandEncoding::kIndexList: {
+        ASSIGN_OR_RETURN(uint8_t count, ReadValue<uint8_t>(data, offset));
+        *offset += count * sizeof(int32_t);
+        return OkStatus();
+      }
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unhandled op encoding " << static_cast<int>(encoding);
+    }
+  }
+
+  const Module& module_;
+  int local_count_;
+  // Local count of the function called by the current instruction or -1.
+  int callee_local_count_ = -1;
+  std::vector<int>* branch_targets_;
+};
+
+}  // namespace
+
 // static
-Status BytecodeValidator::Validate(const Context& context, const Module& module,
+Status BytecodeValidator::Validate(OpcodeTable opcode_table,
+                                   const Module& module,
                                    const BytecodeDef& bytecode_def) {
-  // TODO(benvanik): validate bytecode.
+  if (!bytecode_def.contents() || bytecode_def.contents()->size() == 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "Bytecode is empty";
+  }
+  auto bytecode_data = absl::MakeConstSpan(bytecode_def.contents()->Data(),
+                                           bytecode_def.contents()->size());
+
+  // Walk all instructions and validate their operands. Branch targets are
+  // gathered and checked once we know where all instructions begin.
+  std::vector<bool> instruction_starts(bytecode_data.size());
+  std::vector<int> branch_targets;
+  InstructionValidator instruction_validator(module, bytecode_def,
+                                             &branch_targets);
+  const OpcodeInfo* last_opcode_info = nullptr;
+  RETURN_IF_ERROR(ForEachInstruction(
+      opcode_table, bytecode_data,
+      [&](int offset, uint8_t opcode,
+          absl::Span<const uint8_t> operand_data) -> Status {
+        instruction_starts[offset] = true;
+        last_opcode_info = &GetOpcodeInfo(opcode_table, opcode);
+        RETURN_IF_ERROR(instruction_validator.ValidateOperands(
+            *last_opcode_info, operand_data))
+            << "at offset " << offset;
+        return OkStatus();
+      }));
+
+  for (int branch_target : branch_targets) {
+    if (branch_target < 0 || branch_target >= bytecode_data.size() ||
+        !instruction_starts[branch_target]) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Branch target " << branch_target
+             << " is not the start of an instruction";
+    }
+  }
+
+  // The dispatch loop reads the next opcode after each instruction so the
+  // final instruction must not fall through past the end of the bytecode.
+  if (!AllBitsSet(last_opcode_info->flag, OpcodeFlag::kTerminator)) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Bytecode must end with a terminator but ends with "
+           << last_opcode_info->mnemonic;
+  }
+
   return OkStatus();
 }
 
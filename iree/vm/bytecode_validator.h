@@ -17,18 +17,24 @@
 
 #include "iree/base/status.h"
 #include "iree/schemas/bytecode_def_generated.h"
-#include "iree/vm/context.h"
 #include "iree/vm/module.h"
+#include "iree/vm/opcode_info.h"
 
 namespace iree {
 namespace vm {
 
 // Validates bytecode such that success indicates the bytecode does not
-// reference undefined types, functions, or required imports and all imports can
-// be resolved with matching signatures.
+// reference undefined types, functions, constants, or locals, calls do not
+// pass more arguments than the callee has locals, all branches target
+// instructions within the function, and execution cannot run past the end of
+// the bytecode.
+//
+// Validated bytecode can be decoded by BytecodeReader without checking each
+// operand as it is read. BytecodeReader::PrepareFunction validates functions
+// before they are first executed.
 class BytecodeValidator {
  public:
-  static Status Validate(const Context& context, const Module& module,
+  static Status Validate(OpcodeTable opcode_table, const Module& module,
                          const BytecodeDef& bytecode_def);
 };
 
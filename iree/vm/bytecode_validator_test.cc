@@ -0,0 +1,182 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/bytecode_validator.h"
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "iree/base/shape.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/schemas/bytecode/bytecode_v0.h"
+#include "iree/schemas/bytecode/sequencer_bytecode_v0.h"
+#include "iree/vm/bytecode_tables_sequencer.h"
+#include "iree/vm/module.h"
+#include "iree/vm/testing/test_module.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::iree::vm::testing::BuildTestModule;
+using ::iree::vm::testing::BytecodeBuilder;
+using ::iree::vm::testing::TestFunction;
+
+// Validates |bytecode| as the body of a function with |local_count| locals.
+Status ValidateBytecode(const BytecodeBuilder& bytecode, int local_count) {
+  std::vector<TestFunction> functions = {
+      {"main", 0, 0, local_count, bytecode.bytecode()},
+  };
+  ASSIGN_OR_RETURN(auto module, BuildTestModule(functions));
+  ASSIGN_OR_RETURN(auto function, module->function_table().LookupFunction(0));
+  return BytecodeValidator::Validate(sequencer_opcode_table(), *module,
+                                     *function.def().bytecode());
+}
+
+// Validates a function with |caller_local_count| locals that passes all of
+// them to a function with |callee_local_count| locals.
+Status ValidateCall(int caller_local_count, int callee_local_count) {
+  std::vector<uint16_t> args;
+  for (int i = 0; i < caller_local_count; ++i) args.push_back(i);
+  auto caller_bytecode = BytecodeBuilder()
+                             .Opcode(SequencerOpcode::kCall)
+                             .Uint32(1)
+                             .Locals(args)
+                             .Locals({})
+                             .Opcode(SequencerOpcode::kReturn)
+                             .Locals({});
+  auto callee_bytecode =
+      BytecodeBuilder().Opcode(SequencerOpcode::kReturn).Locals({});
+  std::vector<TestFunction> functions = {
+      {"main", 0, 0, caller_local_count, caller_bytecode.bytecode()},
+      {"callee", 0, 0, callee_local_count, callee_bytecode.bytecode()},
+  };
+  ASSIGN_OR_RETURN(auto module, BuildTestModule(functions));
+  ASSIGN_OR_RETURN(auto function, module->function_table().LookupFunction(0));
+  return BytecodeValidator::Validate(sequencer_opcode_table(), *module,
+                                     *function.def().bytecode());
+}
+
+// Appends a constant operand header with the given f32 |dims|.
+BytecodeBuilder& ConstantShape(BytecodeBuilder& bytecode,
+                               const std::vector<int32_t>& dims) {
+  bytecode.Uint8(static_cast<uint8_t>(BuiltinType::kF32)).Uint8(dims.size());
+  for (int32_t dim : dims) bytecode.Uint32(dim);
+  return bytecode;
+}
+
+TEST(BytecodeValidatorTest, Valid) {
+  auto bytecode = BytecodeBuilder()
+                      .Opcode(SequencerOpcode::kClone)
+                      .Uint16(0)
+                      .Uint16(1)
+                      .Opcode(SequencerOpcode::kReturn)
+                      .Locals({1});
+  EXPECT_OK(ValidateBytecode(bytecode, /*local_count=*/2));
+}
+
+TEST(BytecodeValidatorTest, Empty) {
+  EXPECT_TRUE(IsInvalidArgument(ValidateBytecode(BytecodeBuilder(), 0)));
+}
+
+TEST(BytecodeValidatorTest, OutOfRangeLocal) {
+  auto bytecode = BytecodeBuilder()
+                      .Opcode(SequencerOpcode::kClone)
+                      .Uint16(0)
+                      .Uint16(2)
+                      .Opcode(SequencerOpcode::kReturn)
+                      .Locals({});
+  EXPECT_TRUE(IsOutOfRange(ValidateBytecode(bytecode, /*local_count=*/2)));
+}
+
+TEST(BytecodeValidatorTest, Call) {
+  EXPECT_OK(ValidateCall(/*caller_local_count=*/2, /*callee_local_count=*/2));
+}
+
+TEST(BytecodeValidatorTest, OversizedCall) {
+  // The arguments would be written past the locals of the callee frame.
+  EXPECT_TRUE(IsOutOfRange(
+      ValidateCall(/*caller_local_count=*/3, /*callee_local_count=*/1)));
+}
+
+TEST(BytecodeValidatorTest, BranchIntoInstruction) {
+  // Offset 1 is within the operands of the branch itself.
+  auto bytecode = BytecodeBuilder()
+                      .Opcode(SequencerOpcode::kBranch)
+                      .Uint32(1)
+                      .Uint8(0)
+                      .Opcode(SequencerOpcode::kReturn)
+                      .Locals({});
+  EXPECT_TRUE(IsOutOfRange(ValidateBytecode(bytecode, /*local_count=*/0)));
+}
+
+TEST(BytecodeValidatorTest, BranchPastEnd) {
+  auto bytecode = BytecodeBuilder()
+                      .Opcode(SequencerOpcode::kBranch)
+                      .Uint32(100)
+                      .Uint8(0)
+                      .Opcode(SequencerOpcode::kReturn)
+                      .Locals({});
+  EXPECT_TRUE(IsOutOfRange(ValidateBytecode(bytecode, /*local_count=*/0)));
+}
+
+TEST(BytecodeValidatorTest, MissingTerminator) {
+  auto bytecode = BytecodeBuilder()
+                      .Opcode(SequencerOpcode::kClone)
+                      .Uint16(0)
+                      .Uint16(1);
+  EXPECT_TRUE(IsInvalidArgument(ValidateBytecode(bytecode, /*local_count=*/2)));
+}
+
+TEST(BytecodeValidatorTest, OversizedConstantRank) {
+  BytecodeBuilder bytecode;
+  bytecode.Opcode(SequencerOpcode::kConstant);
+  ConstantShape(bytecode, std::vector<int32_t>(kMaxRank + 1, 1))
+      .Uint8(static_cast<uint8_t>(ConstantEncoding::kSplat))
+      .Uint32(0)
+      .Uint16(0)
+      .Opcode(SequencerOpcode::kReturn)
+      .Locals({});
+  EXPECT_TRUE(IsInvalidArgument(ValidateBytecode(bytecode, /*local_count=*/1)));
+}
+
+TEST(BytecodeValidatorTest, OverflowingConstantElementCount) {
+  BytecodeBuilder bytecode;
+  bytecode.Opcode(SequencerOpcode::kConstant);
+  ConstantShape(bytecode, std::vector<int32_t>(kMaxRank, 0x7FFFFFFF))
+      .Uint8(static_cast<uint8_t>(ConstantEncoding::kDense))
+      .Uint32(0)
+      .Uint16(0)
+      .Opcode(SequencerOpcode::kReturn)
+      .Locals({});
+  EXPECT_TRUE(IsOutOfRange(ValidateBytecode(bytecode, /*local_count=*/1)));
+}
+
+TEST(BytecodeValidatorTest, TruncatedDenseConstant) {
+  BytecodeBuilder bytecode;
+  bytecode.Opcode(SequencerOpcode::kConstant);
+  ConstantShape(bytecode, {1024})
+      .Uint8(static_cast<uint8_t>(ConstantEncoding::kDense))
+      .Uint32(0)
+      .Uint16(0)
+      .Opcode(SequencerOpcode::kReturn)
+      .Locals({});
+  EXPECT_TRUE(IsOutOfRange(ValidateBytecode(bytecode, /*local_count=*/1)));
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
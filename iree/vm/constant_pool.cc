@@ -0,0 +1,144 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/constant_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/heap_buffer.h"
+
+namespace iree {
+namespace vm {
+
+// static
+constexpr size_t ConstantPool::kAlignment;
+
+// static
+Status ConstantPool::ValidateStructure(
+    const ConstantPoolDef& constant_pool_def) {
+  uint32_t alignment = constant_pool_def.alignment();
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Constant pool alignment " << alignment
+           << " is not a power of two";
+  }
+  if (!constant_pool_def.constants()) {
+    return OkStatus();
+  }
+  uint64_t data_length =
+      constant_pool_def.data() ? constant_pool_def.data()->size() : 0;
+  for (int i = 0; i < constant_pool_def.constants()->size(); ++i) {
+    const auto* constant_def = constant_pool_def.constants()->Get(i);
+    if (!constant_def) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Constant ordinal " << i << " is missing its contents";
+    }
+    uint64_t stored_length = constant_def->length();
+    if (constant_def->splat_size() != 0) {
+      stored_length = constant_def->splat_size();
+      if (constant_def->length() % constant_def->splat_size() != 0) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Constant ordinal " << i << " length "
+               << constant_def->length()
+               << " is not a multiple of its splat size "
+               << static_cast<int>(constant_def->splat_size());
+      }
+    }
+    if (constant_def->offset() > data_length ||
+        stored_length > data_length - constant_def->offset()) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Constant ordinal " << i << " contents out of bounds";
+    }
+  }
+  return OkStatus();
+}
+
+ConstantPool::ConstantPool(const ConstantPoolDef* constant_pool_def)
+    : constant_pool_def_(constant_pool_def) {
+  constants_.resize(size());
+}
+
+ConstantPool::~ConstantPool() = default;
+
+int ConstantPool::size() const {
+  return constant_pool_def_ && constant_pool_def_->constants()
+             ? constant_pool_def_->constants()->size()
+             : 0;
+}
+
+StatusOr<ref_ptr<hal::Buffer>> ConstantPool::LookupConstant(
+    int constant_ordinal) const {
+  if (constant_ordinal < 0 || constant_ordinal >= size()) {
+    return OutOfRangeErrorBuilder(IREE_LOC)
+           << "Invalid constant ordinal " << constant_ordinal;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  auto& constant = constants_[constant_ordinal];
+  if (!constant) {
+    ASSIGN_OR_RETURN(constant,
+                     MaterializeConstant(*constant_pool_def_->constants()->Get(
+                         constant_ordinal)));
+  }
+  return add_ref(constant);
+}
+
+StatusOr<ref_ptr<hal::Buffer>> ConstantPool::MaterializeConstant(
+    const ConstantDef& constant_def) const {
+  IREE_TRACE_SCOPE0("ConstantPool::MaterializeConstant");
+
+  const uint8_t* contents =
+      constant_pool_def_->data()->data() + constant_def.offset();
+  size_t length = constant_def.length();
+  size_t splat_size = constant_def.splat_size();
+
+  // Modules that are memory-mapped (or otherwise loaded at an aligned address)
+  // can have their constants used as-is without copying.
+  if (splat_size == 0 &&
+      reinterpret_cast<uintptr_t>(contents) % kAlignment == 0) {
+    return hal::HeapBuffer::Wrap(
+        hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible,
+        hal::BufferUsage::kConstant | hal::BufferUsage::kAll, contents,
+        length);
+  }
+
+  storage_.push_back(absl::make_unique<uint8_t[]>(length + kAlignment - 1));
+  uintptr_t storage_address =
+      reinterpret_cast<uintptr_t>(storage_.back().get());
+  auto* aligned_storage = reinterpret_cast<uint8_t*>(
+      (storage_address + kAlignment - 1) & ~(kAlignment - 1));
+  if (splat_size == 0) {
+    std::memcpy(aligned_storage, contents, length);
+  } else if (length > 0) {
+    // Write one element and then repeatedly double the filled prefix.
+    std::memcpy(aligned_storage, contents, splat_size);
+    size_t filled_length = splat_size;
+    while (filled_length < length) {
+      size_t copy_length = std::min(filled_length, length - filled_length);
+      std::memcpy(aligned_storage + filled_length, aligned_storage,
+                  copy_length);
+      filled_length += copy_length;
+    }
+  }
+  return hal::HeapBuffer::Wrap(
+      hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible,
+      hal::BufferUsage::kConstant | hal::BufferUsage::kAll, aligned_storage,
+      length);
+}
+
+}  // namespace vm
+}  // namespace iree
@@ -0,0 +1,80 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_VM_CONSTANT_POOL_H_
+#define IREE_VM_CONSTANT_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/ref_ptr.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer.h"
+#include "iree/schemas/constant_pool_def_generated.h"
+
+namespace iree {
+namespace vm {
+
+// A table of constants present within a module and referenced by ordinal from
+// bytecode. Each constant is materialized once on first use and the resulting
+// buffer is shared by all invocations of functions within the module.
+//
+// Constants that are suitably aligned within the module data are referenced
+// in-place; splats and unaligned constants are expanded into storage owned by
+// the pool. Returned buffers are read-only and must not outlive the module.
+//
+// Thread-safe.
+class ConstantPool {
+ public:
+  // Alignment in bytes of the contents of all buffers returned by the pool.
+  static constexpr size_t kAlignment = 64;
+
+  static Status ValidateStructure(const ConstantPoolDef& constant_pool_def);
+
+  // |constant_pool_def| may be null if the module has no pooled constants.
+  explicit ConstantPool(const ConstantPoolDef* constant_pool_def);
+  ConstantPool(const ConstantPool&) = delete;
+  ConstantPool& operator=(const ConstantPool&) = delete;
+  ~ConstantPool();
+
+  // Total number of constants in the pool.
+  int size() const;
+
+  // Returns a buffer with the contents of the constant with the given ordinal,
+  // materializing it on first use.
+  StatusOr<ref_ptr<hal::Buffer>> LookupConstant(int constant_ordinal) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  StatusOr<ref_ptr<hal::Buffer>> MaterializeConstant(
+      const ConstantDef& constant_def) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const ConstantPoolDef* constant_pool_def_;
+
+  mutable absl::Mutex mutex_;
+  mutable std::vector<ref_ptr<hal::Buffer>> constants_ ABSL_GUARDED_BY(mutex_);
+  // Storage backing expanded/realigned constants.
+  mutable std::vector<std::unique_ptr<uint8_t[]>> storage_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace vm
+}  // namespace iree
+
+#endif  // IREE_VM_CONSTANT_POOL_H_
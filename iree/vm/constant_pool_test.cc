@@ -0,0 +1,174 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/constant_pool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/buffer.h"
+#include "iree/schemas/constant_pool_def_generated.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+struct TestConstant {
+  uint64_t offset;
+  uint64_t length;
+  uint8_t splat_size;
+};
+
+// Serializes a ConstantPoolDef into storage aligned to
+// ConstantPool::kAlignment such that the pool data is aligned as it would be
+// in a memory-mapped module.
+class TestConstantPoolDef {
+ public:
+  TestConstantPoolDef(uint32_t alignment,
+                      const std::vector<TestConstant>& constants,
+                      const std::vector<uint8_t>& data) {
+    ::flatbuffers::FlatBufferBuilder fbb;
+    std::vector<::flatbuffers::Offset<ConstantDef>> constant_defs;
+    for (const auto& constant : constants) {
+      constant_defs.push_back(CreateConstantDef(
+          fbb, constant.offset, constant.length, constant.splat_size));
+    }
+    auto constants_offset = fbb.CreateVector(constant_defs);
+    fbb.ForceVectorAlignment(data.size(), sizeof(uint8_t),
+                             ConstantPool::kAlignment);
+    auto data_offset = fbb.CreateVector(data);
+    fbb.Finish(
+        CreateConstantPoolDef(fbb, alignment, constants_offset, data_offset));
+
+    storage_.resize(fbb.GetSize() + ConstantPool::kAlignment);
+    auto storage_address = reinterpret_cast<uintptr_t>(storage_.data());
+    auto* aligned_storage = reinterpret_cast<uint8_t*>(
+        (storage_address + ConstantPool::kAlignment - 1) &
+        ~(ConstantPool::kAlignment - 1));
+    std::memcpy(aligned_storage, fbb.GetBufferPointer(), fbb.GetSize());
+    def_ = ::flatbuffers::GetRoot<ConstantPoolDef>(aligned_storage);
+  }
+
+  const ConstantPoolDef& def() const { return *def_; }
+  const uint8_t* data() const { return def_->data()->data(); }
+
+ private:
+  std::vector<uint8_t> storage_;
+  const ConstantPoolDef* def_ = nullptr;
+};
+
+std::vector<uint8_t> ReadContents(hal::Buffer* buffer) {
+  std::vector<uint8_t> contents(buffer->byte_length());
+  CHECK_OK(buffer->ReadData(0, contents.data(), contents.size()));
+  return contents;
+}
+
+const uint8_t* MappedData(hal::Buffer* buffer) {
+  auto mapping_or = buffer->MapMemory<uint8_t>(hal::MemoryAccess::kRead);
+  CHECK_OK(mapping_or.status());
+  return mapping_or.ValueOrDie().data();
+}
+
+TEST(ConstantPoolTest, ValidStructure) {
+  TestConstantPoolDef pool(64, {{0, 8, 0}, {64, 16, 4}},
+                           std::vector<uint8_t>(68, 1));
+  EXPECT_OK(ConstantPool::ValidateStructure(pool.def()));
+}
+
+TEST(ConstantPoolTest, BadAlignment) {
+  TestConstantPoolDef zero_alignment(0, {}, {});
+  EXPECT_TRUE(
+      IsInvalidArgument(ConstantPool::ValidateStructure(zero_alignment.def())));
+  TestConstantPoolDef odd_alignment(48, {}, {});
+  EXPECT_TRUE(
+      IsInvalidArgument(ConstantPool::ValidateStructure(odd_alignment.def())));
+}
+
+TEST(ConstantPoolTest, OutOfBoundsOffset) {
+  TestConstantPoolDef pool(64, {{128, 4, 0}}, std::vector<uint8_t>(64, 1));
+  EXPECT_TRUE(IsOutOfRange(ConstantPool::ValidateStructure(pool.def())));
+}
+
+TEST(ConstantPoolTest, OutOfBoundsLength) {
+  TestConstantPoolDef pool(64, {{0, 8, 0}, {64, 8, 0}},
+                           std::vector<uint8_t>(68, 1));
+  EXPECT_TRUE(IsOutOfRange(ConstantPool::ValidateStructure(pool.def())));
+}
+
+TEST(ConstantPoolTest, SplatLengthNotMultiple) {
+  TestConstantPoolDef pool(64, {{0, 10, 4}}, std::vector<uint8_t>(4, 1));
+  EXPECT_TRUE(IsInvalidArgument(ConstantPool::ValidateStructure(pool.def())));
+}
+
+TEST(ConstantPoolTest, InvalidOrdinal) {
+  TestConstantPoolDef pool(64, {{0, 4, 0}}, std::vector<uint8_t>(4, 1));
+  ConstantPool constant_pool(&pool.def());
+  EXPECT_TRUE(IsOutOfRange(constant_pool.LookupConstant(-1).status()));
+  EXPECT_TRUE(IsOutOfRange(constant_pool.LookupConstant(1).status()));
+}
+
+TEST(ConstantPoolTest, AlignedConstantIsWrappedInPlace) {
+  std::vector<uint8_t> data = {1, 2, 3, 4, 5, 6, 7, 8};
+  TestConstantPoolDef pool(64, {{0, 8, 0}}, data);
+  ASSERT_OK(ConstantPool::ValidateStructure(pool.def()));
+  ConstantPool constant_pool(&pool.def());
+  ASSERT_OK_AND_ASSIGN(auto buffer, constant_pool.LookupConstant(0));
+  EXPECT_EQ(pool.data(), MappedData(buffer.get()));
+  EXPECT_THAT(ReadContents(buffer.get()), ElementsAreArray(data));
+
+  // Subsequent lookups share the materialized buffer.
+  ASSERT_OK_AND_ASSIGN(auto buffer_again, constant_pool.LookupConstant(0));
+  EXPECT_EQ(buffer.get(), buffer_again.get());
+}
+
+TEST(ConstantPoolTest, UnalignedConstantIsCopied) {
+  std::vector<uint8_t> data = {0, 0, 0, 0, 1, 2, 3, 4};
+  TestConstantPoolDef pool(64, {{4, 4, 0}}, data);
+  ConstantPool constant_pool(&pool.def());
+  ASSERT_OK_AND_ASSIGN(auto buffer, constant_pool.LookupConstant(0));
+  const uint8_t* contents = MappedData(buffer.get());
+  EXPECT_NE(pool.data() + 4, contents);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(contents) %
+                   ConstantPool::kAlignment);
+  EXPECT_THAT(ReadContents(buffer.get()), ElementsAre(1, 2, 3, 4));
+}
+
+TEST(ConstantPoolTest, SplatIsExpanded) {
+  TestConstantPoolDef pool(64, {{0, 36, 4}}, {0xAB, 0xCD, 0xEF, 0x01});
+  ASSERT_OK(ConstantPool::ValidateStructure(pool.def()));
+  ConstantPool constant_pool(&pool.def());
+  ASSERT_OK_AND_ASSIGN(auto buffer, constant_pool.LookupConstant(0));
+  ASSERT_EQ(36, buffer->byte_length());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(MappedData(buffer.get())) %
+                   ConstantPool::kAlignment);
+  auto contents = ReadContents(buffer.get());
+  std::vector<uint32_t> elements(contents.size() / sizeof(uint32_t));
+  std::memcpy(elements.data(), contents.data(), contents.size());
+  uint32_t splat_value;
+  std::memcpy(&splat_value, pool.data(), sizeof(splat_value));
+  EXPECT_THAT(elements, Each(splat_value));
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
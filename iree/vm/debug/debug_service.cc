@@ -108,13 +108,13 @@ StatusOr<Offset<rpc::StackFrameDef>> SerializeStackFrame(
 // Resolves a local from a fiber:frame:local_index to a BufferView.
 StatusOr<BufferView*> ResolveFiberLocal(FiberState* fiber_state,
                                         int frame_index, int local_index) {
-  auto frames = fiber_state->mutable_stack()->mutable_frames();
-  if (frame_index < 0 || frame_index > frames.size()) {
+  auto* stack = fiber_state->mutable_stack();
+  if (frame_index < 0 || frame_index >= stack->depth()) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Frame index " << frame_index << " out of bounds ("
-           << frames.size() << ")";
+           << stack->depth() << ")";
   }
-  auto locals = frames[frame_index].mutable_locals();
+  auto locals = stack->mutable_frame(frame_index)->mutable_locals();
   if (local_index < 0 || local_index > locals.size()) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Local index " << local_index << " out of bounds ("
@@ -292,8 +292,9 @@ StatusOr<FiberState*> DebugService::GetFiberState(int fiber_id) const {
 StatusOr<Offset<rpc::FiberStateDef>> DebugService::SerializeFiberState(
     const FiberState& fiber_state, FlatBufferBuilder* fbb) {
   std::vector<Offset<rpc::StackFrameDef>> frame_offs_list;
-  for (const auto& frame : fiber_state.stack().frames()) {
-    ASSIGN_OR_RETURN(auto frame_offs, SerializeStackFrame(frame, fbb));
+  const auto& stack = fiber_state.stack();
+  for (int i = 0; i < stack.depth(); ++i) {
+    ASSIGN_OR_RETURN(auto frame_offs, SerializeStackFrame(stack.frame(i), fbb));
     frame_offs_list.push_back(frame_offs);
   }
   auto frames_offs = fbb->CreateVector(frame_offs_list);
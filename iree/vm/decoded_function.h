@@ -0,0 +1,63 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_VM_DECODED_FUNCTION_H_
+#define IREE_VM_DECODED_FUNCTION_H_
+
+#include "absl/container/flat_hash_map.h"
+#include "iree/hal/buffer_view.h"
+
+namespace iree {
+namespace vm {
+
+// Operands of a validated function that are decoded once when the function is
+// prepared instead of each time their instruction executes.
+//
+// Constants are materialized into buffer views (referencing the module data
+// where possible) that are shared by all executions of the function. They are
+// keyed by the bytecode offset of their operand so that the reader can return
+// them without parsing the encoded constant.
+//
+// Thread-safe; decoded functions are immutable once prepared.
+class DecodedFunction {
+ public:
+  struct Constant {
+    hal::BufferView value;
+    // Length of the encoded constant operand in the bytecode.
+    int encoded_length = 0;
+  };
+
+  DecodedFunction() = default;
+  DecodedFunction(const DecodedFunction&) = delete;
+  DecodedFunction& operator=(const DecodedFunction&) = delete;
+
+  void AddConstant(int operand_offset, Constant constant) {
+    constants_[operand_offset] = std::move(constant);
+  }
+
+  // Returns the constant with an operand at |operand_offset| or nullptr if
+  // none was decoded there.
+  const Constant* LookupConstant(int operand_offset) const {
+    auto it = constants_.find(operand_offset);
+    return it != constants_.end() ? &it->second : nullptr;
+  }
+
+ private:
+  absl::flat_hash_map<int, Constant> constants_;
+};
+
+}  // namespace vm
+}  // namespace iree
+
+#endif  // IREE_VM_DECODED_FUNCTION_H_
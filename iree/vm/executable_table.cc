@@ -14,36 +14,14 @@
 
 #include "iree/vm/executable_table.h"
 
+#include "absl/synchronization/mutex.h"
 #include "iree/base/flatbuffer_util.h"
 #include "iree/base/status.h"
+#include "iree/base/tracing.h"
 
 namespace iree {
 namespace vm {
 
-// static
-Status ExecutableTable::ValidateStructure(
-    const ExecutableTableDef& executable_table_def) {
-  if (!executable_table_def.multi_arch_executables()) {
-    // May have sequencer only fns. Fine to not have dispatchable executables.
-    return OkStatus();
-  }
-
-  // All fat executables need at least one device-specific executable.
-  const auto& multi_arch_executables =
-      *executable_table_def.multi_arch_executables();
-  for (int i = 0; i < multi_arch_executables.size(); ++i) {
-    const auto* multi_arch_executable = multi_arch_executables[i];
-    if (!multi_arch_executable || !multi_arch_executable->executables() ||
-        multi_arch_executable->executables()->size() == 0) {
-      return InvalidArgumentErrorBuilder(IREE_LOC)
-             << "Multi-arch executable ordinal " << i
-             << " is missing its contents";
-    }
-  }
-
-  return OkStatus();
-}
-
 ExecutableTable::ExecutableTable(const ExecutableTableDef& executable_table_def)
     : executable_table_def_(executable_table_def) {}
 
@@ -52,13 +30,112 @@ ExecutableTable::~ExecutableTable() = default;
 StatusOr<const MultiArchExecutableDef*>
 ExecutableTable::LookupMultiArchExecutable(int executable_ordinal) const {
   if (executable_ordinal < 0 ||
+      !executable_table_def_.multi_arch_executables() ||
+      executable_ordinal >=
+          executable_table_def_.multi_arch_executables()->size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid multi-arch executable ordinal " << executable_ordinal;
+  }
+  const auto* multi_arch_executable_def =
+      executable_table_def_.multi_arch_executables()->Get(executable_ordinal);
+  // All fat executables need at least one device-specific executable.
+  if (!multi_arch_executable_def ||
+      !multi_arch_executable_def->executables() ||
+      multi_arch_executable_def->executables()->size() == 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Multi-arch executable ordinal " << executable_ordinal
+           << " is missing its contents";
+  }
+  return multi_arch_executable_def;
+}
+
+StatusOr<ref_ptr<hal::Executable>> ExecutableTable::LookupOrPrepareExecutable(
+    const std::shared_ptr<hal::Device>& device, int executable_ordinal) const {
+  if (executable_ordinal < 0 ||
+      !executable_table_def_.multi_arch_executables() ||
       executable_ordinal >=
           executable_table_def_.multi_arch_executables()->size()) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Invalid multi-arch executable ordinal " << executable_ordinal;
   }
-  return executable_table_def_.multi_arch_executables()->Get(
-      executable_ordinal);
+
+  // Preparation may be slow (translation, validation, etc) and is performed
+  // outside of the lock such that other devices and contexts are not blocked
+  // on it. If two threads race to prepare the same executable the first one
+  // to finish wins and the other result is dropped.
+  std::shared_ptr<hal::ExecutableCache> executable_cache;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto* entry = LookupOrCreateEntry(device);
+    if (const auto& executable = entry->executables[executable_ordinal]) {
+      return add_ref(executable);
+    }
+    executable_cache = entry->executable_cache;
+  }
+
+  ASSIGN_OR_RETURN(auto prepared_executable,
+                   PrepareExecutable(executable_cache.get(),
+                                     executable_ordinal));
+
+  absl::MutexLock lock(&mutex_);
+  auto* entry = LookupOrCreateEntry(device);
+  auto& executable = entry->executables[executable_ordinal];
+  if (!executable) {
+    executable = std::move(prepared_executable);
+  }
+  return add_ref(executable);
+}
+
+ExecutableTable::DeviceExecutables* ExecutableTable::LookupOrCreateEntry(
+    const std::shared_ptr<hal::Device>& device) const {
+  auto it = device_executables_.find(device.get());
+  if (it != device_executables_.end() && it->second.device.lock() == device) {
+    return &it->second;
+  }
+
+  // First use of this device. Drop the executables of any devices that have
+  // since been released (including a stale entry for a released device that
+  // happened to live at the same address).
+  for (it = device_executables_.begin(); it != device_executables_.end();) {
+    if (it->second.device.expired()) {
+      device_executables_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  auto& entry = device_executables_[device.get()];
+  entry.device = device;
+  entry.executable_cache = device->CreateExecutableCache();
+  entry.executables.resize(
+      executable_table_def_.multi_arch_executables()->size());
+  return &entry;
+}
+
+StatusOr<ref_ptr<hal::Executable>> ExecutableTable::PrepareExecutable(
+    hal::ExecutableCache* executable_cache, int executable_ordinal) const {
+  IREE_TRACE_SCOPE0("ExecutableTable::PrepareExecutable");
+  ASSIGN_OR_RETURN(const auto* multi_arch_executable_def,
+                   LookupMultiArchExecutable(executable_ordinal));
+  for (const auto* executable_def :
+       *multi_arch_executable_def->executables()) {
+    if (!executable_cache->CanPrepareFormat(executable_def->format())) {
+      continue;
+    }
+    hal::ExecutableSpec executable_spec;
+    executable_spec.format = executable_def->format();
+    executable_spec.executable_data =
+        absl::Span<const uint8_t>(executable_def->contents()->data(),
+                                  executable_def->contents()->size());
+    return executable_cache->PrepareExecutable(
+        hal::ExecutableCachingMode::kDefault |
+            hal::ExecutableCachingMode::kAliasProvidedData,
+        executable_spec);
+  }
+  return NotFoundErrorBuilder(IREE_LOC)
+         << "No executable found for the current driver in multi-arch "
+            "executable ordinal "
+         << executable_ordinal;
 }
 
 }  // namespace vm
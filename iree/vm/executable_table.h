@@ -15,7 +15,17 @@
 #ifndef IREE_VM_EXECUTABLE_TABLE_H_
 #define IREE_VM_EXECUTABLE_TABLE_H_
 
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/ref_ptr.h"
 #include "iree/base/status.h"
+#include "iree/hal/device.h"
+#include "iree/hal/executable.h"
+#include "iree/hal/executable_cache.h"
 #include "iree/schemas/executable_table_def_generated.h"
 
 namespace iree {
@@ -27,9 +37,6 @@ namespace vm {
 // Thread-safe.
 class ExecutableTable {
  public:
-  static Status ValidateStructure(
-      const ExecutableTableDef& executable_table_def);
-
   explicit ExecutableTable(const ExecutableTableDef& executable_table_def);
   ExecutableTable(const ExecutableTable&) = delete;
   ExecutableTable& operator=(const ExecutableTable&) = delete;
@@ -42,10 +49,41 @@ class ExecutableTable {
 
   // TODO(benvanik): resolve executable by ID+format+features (ExecutableDef).
 
-  // TODO(benvanik): insert/get HAL executables (thread-safe!).
+  // Returns the HAL executable prepared for |device| from the multi-arch
+  // executable with the given ordinal, preparing it on first use.
+  // Prepared executables are retained for the lifetime of the table (or until
+  // the device is released) such that subsequent dispatches against the same
+  // device avoid re-parsing and re-validating the executable contents. The
+  // executable is prepared without holding the table lock.
+  StatusOr<ref_ptr<hal::Executable>> LookupOrPrepareExecutable(
+      const std::shared_ptr<hal::Device>& device, int executable_ordinal) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
+  // Executables prepared for a single device, indexed by executable ordinal.
+  struct DeviceExecutables {
+    // Used to detect when a device has been released and a new device has been
+    // allocated at the same address.
+    std::weak_ptr<hal::Device> device;
+    std::shared_ptr<hal::ExecutableCache> executable_cache;
+    std::vector<ref_ptr<hal::Executable>> executables;
+  };
+
+  // Returns the entry for |device|, creating it if needed, and evicts the
+  // entries of any devices that have been released.
+  DeviceExecutables* LookupOrCreateEntry(
+      const std::shared_ptr<hal::Device>& device) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  StatusOr<ref_ptr<hal::Executable>> PrepareExecutable(
+      hal::ExecutableCache* executable_cache, int executable_ordinal) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   const ExecutableTableDef& executable_table_def_;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<hal::Device*, DeviceExecutables>
+      device_executables_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace vm
@@ -0,0 +1,227 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/executable_table.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/device.h"
+#include "iree/hal/executable.h"
+#include "iree/hal/executable_cache.h"
+#include "iree/hal/executable_format.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+// Tracks the number of live executables so that tests can verify the table
+// releases the executables it retains.
+class TestExecutable final : public hal::Executable {
+ public:
+  explicit TestExecutable(int* live_count) : live_count_(live_count) {
+    ++*live_count_;
+  }
+  ~TestExecutable() override { --*live_count_; }
+
+  bool supports_debugging() const override { return false; }
+
+ private:
+  int* live_count_;
+};
+
+// Counts the number of times executables are prepared such that tests can
+// tell cache hits apart from re-preparation.
+class TestExecutableCache final : public hal::ExecutableCache {
+ public:
+  TestExecutableCache(int* prepare_count, int* live_executable_count)
+      : prepare_count_(prepare_count),
+        live_executable_count_(live_executable_count) {}
+
+  bool CanPrepareFormat(hal::ExecutableFormat format) const override {
+    return format == hal::kExecutableFormatIreeBytecode;
+  }
+
+  StatusOr<ref_ptr<hal::Executable>> PrepareExecutable(
+      hal::ExecutableCachingModeBitfield mode,
+      const hal::ExecutableSpec& spec) override {
+    ++*prepare_count_;
+    return make_ref<TestExecutable>(live_executable_count_);
+  }
+
+ private:
+  int* prepare_count_;
+  int* live_executable_count_;
+};
+
+class TestDevice final : public hal::Device {
+ public:
+  explicit TestDevice(int* live_executable_count)
+      : hal::Device(hal::DeviceInfo("test", hal::DeviceFeature::kNone)),
+        live_executable_count_(live_executable_count) {}
+
+  int prepare_count() const { return prepare_count_; }
+  int executable_cache_count() const { return executable_cache_count_; }
+
+  hal::Allocator* allocator() const override { return nullptr; }
+  absl::Span<hal::CommandQueue*> dispatch_queues() const override {
+    return {};
+  }
+  absl::Span<hal::CommandQueue*> transfer_queues() const override {
+    return {};
+  }
+
+  std::shared_ptr<hal::ExecutableCache> CreateExecutableCache() override {
+    ++executable_cache_count_;
+    return std::make_shared<TestExecutableCache>(&prepare_count_,
+                                                 live_executable_count_);
+  }
+
+  StatusOr<ref_ptr<hal::CommandBuffer>> CreateCommandBuffer(
+      hal::CommandBufferModeBitfield mode,
+      hal::CommandCategoryBitfield command_categories) override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  StatusOr<ref_ptr<hal::Event>> CreateEvent() override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  StatusOr<ref_ptr<hal::BinarySemaphore>> CreateBinarySemaphore(
+      bool initial_value) override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  StatusOr<ref_ptr<hal::TimelineSemaphore>> CreateTimelineSemaphore(
+      uint64_t initial_value) override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  StatusOr<ref_ptr<hal::Fence>> CreateFence(uint64_t initial_value) override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  Status WaitAllFences(absl::Span<const hal::FenceValue> fences,
+                       absl::Time deadline) override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  StatusOr<int> WaitAnyFence(absl::Span<const hal::FenceValue> fences,
+                             absl::Time deadline) override {
+    return UnimplementedErrorBuilder(IREE_LOC);
+  }
+  Status WaitIdle(absl::Time deadline) override { return OkStatus(); }
+
+ private:
+  int* live_executable_count_;
+  int prepare_count_ = 0;
+  int executable_cache_count_ = 0;
+};
+
+class ExecutableTableTest : public ::testing::Test {
+ protected:
+  // Builds a table with |count| multi-arch executables each containing a
+  // single (empty) bytecode executable.
+  void BuildTable(int count) {
+    std::vector<::flatbuffers::Offset<MultiArchExecutableDef>> executables;
+    for (int i = 0; i < count; ++i) {
+      std::vector<uint8_t> contents = {0};
+      auto contents_offset = fbb_.CreateVector(contents);
+      std::vector<::flatbuffers::Offset<ExecutableDef>> executable_defs = {
+          CreateExecutableDef(fbb_, hal::kExecutableFormatIreeBytecode,
+                              ExecutableFeature::kDebugging, contents_offset)};
+      executables.push_back(CreateMultiArchExecutableDef(
+          fbb_, /*name=*/0, /*entry_point_count=*/1,
+          fbb_.CreateVector(executable_defs)));
+    }
+    fbb_.Finish(
+        CreateExecutableTableDef(fbb_, fbb_.CreateVector(executables)));
+    executable_table_ = absl::make_unique<ExecutableTable>(
+        *::flatbuffers::GetRoot<ExecutableTableDef>(
+            fbb_.GetBufferPointer()));
+  }
+
+  std::shared_ptr<TestDevice> CreateDevice() {
+    return std::make_shared<TestDevice>(&live_executable_count_);
+  }
+
+  int live_executable_count_ = 0;
+  ::flatbuffers::FlatBufferBuilder fbb_;
+  std::unique_ptr<ExecutableTable> executable_table_;
+};
+
+TEST_F(ExecutableTableTest, InvalidOrdinal) {
+  BuildTable(1);
+  auto device = CreateDevice();
+  EXPECT_TRUE(IsInvalidArgument(
+      executable_table_->LookupOrPrepareExecutable(device, -1).status()));
+  EXPECT_TRUE(IsInvalidArgument(
+      executable_table_->LookupOrPrepareExecutable(device, 1).status()));
+  EXPECT_EQ(0, device->prepare_count());
+}
+
+TEST_F(ExecutableTableTest, CacheHit) {
+  BuildTable(2);
+  auto device = CreateDevice();
+  ASSERT_OK_AND_ASSIGN(auto executable_0a,
+                       executable_table_->LookupOrPrepareExecutable(device, 0));
+  ASSERT_OK_AND_ASSIGN(auto executable_0b,
+                       executable_table_->LookupOrPrepareExecutable(device, 0));
+  EXPECT_EQ(executable_0a.get(), executable_0b.get());
+  EXPECT_EQ(1, device->prepare_count());
+
+  ASSERT_OK_AND_ASSIGN(auto executable_1,
+                       executable_table_->LookupOrPrepareExecutable(device, 1));
+  EXPECT_NE(executable_0a.get(), executable_1.get());
+  EXPECT_EQ(2, device->prepare_count());
+  EXPECT_EQ(1, device->executable_cache_count());
+}
+
+TEST_F(ExecutableTableTest, PerDeviceSeparation) {
+  BuildTable(1);
+  auto device_a = CreateDevice();
+  auto device_b = CreateDevice();
+  ASSERT_OK_AND_ASSIGN(
+      auto executable_a,
+      executable_table_->LookupOrPrepareExecutable(device_a, 0));
+  ASSERT_OK_AND_ASSIGN(
+      auto executable_b,
+      executable_table_->LookupOrPrepareExecutable(device_b, 0));
+  EXPECT_NE(executable_a.get(), executable_b.get());
+  EXPECT_EQ(1, device_a->prepare_count());
+  EXPECT_EQ(1, device_a->executable_cache_count());
+  EXPECT_EQ(1, device_b->prepare_count());
+  EXPECT_EQ(1, device_b->executable_cache_count());
+}
+
+TEST_F(ExecutableTableTest, ReleasedDeviceEvicted) {
+  BuildTable(1);
+  auto device_a = CreateDevice();
+  ASSERT_OK(
+      executable_table_->LookupOrPrepareExecutable(device_a, 0).status());
+  EXPECT_EQ(1, live_executable_count_);
+  device_a.reset();
+
+  // The entry for the released device is pruned the next time a new device
+  // is seen, dropping the table's reference to its executables.
+  auto device_b = CreateDevice();
+  ASSERT_OK_AND_ASSIGN(
+      auto executable_b,
+      executable_table_->LookupOrPrepareExecutable(device_b, 0));
+  EXPECT_EQ(1, live_executable_count_);
+  EXPECT_EQ(1, device_b->prepare_count());
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
@@ -14,9 +14,6 @@
 
 #include "iree/vm/fiber_state.h"
 
-#include <iterator>
-
-#include "absl/strings/str_join.h"
 #include "iree/base/status.h"
 
 namespace iree {
@@ -55,21 +52,7 @@ Status FiberState::Step(StepTarget step_target,
   return UnimplementedErrorBuilder(IREE_LOC) << "Step not yet implemented";
 }
 
-namespace {
-struct StackFrameFormatter {
-  void operator()(std::string* out, const StackFrame& stack_frame) const {
-    out->append(absl::StrCat(stack_frame.module().name(), ":",
-                             stack_frame.function().name(), "@",
-                             stack_frame.offset()));
-  }
-};
-}  // namespace
-
-std::string FiberState::DebugString() const {
-  auto frames = stack_.frames();
-  return absl::StrJoin(frames.begin(), frames.end(), "\n",
-                       StackFrameFormatter());
-}
+std::string FiberState::DebugString() const { return stack_.DebugString(); }
 
 }  // namespace vm
 }  // namespace iree
@@ -15,6 +15,7 @@
 #include "iree/vm/function_table.h"
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "iree/base/flatbuffer_util.h"
 #include "iree/base/status.h"
 
@@ -82,9 +83,21 @@ Status FunctionTable::ValidateStructure(
 
 FunctionTable::FunctionTable(const Module& module,
                              const FunctionTableDef& function_table_def)
-    : module_(module), function_table_def_(function_table_def) {}
+    : module_(module),
+      function_table_def_(function_table_def),
+      decoded_functions_(
+          absl::make_unique<std::atomic<const DecodedFunction*>[]>(
+              function_table_def.functions()
+                  ? function_table_def.functions()->size()
+                  : 0)) {}
 
-FunctionTable::~FunctionTable() = default;
+FunctionTable::~FunctionTable() {
+  if (function_table_def_.functions()) {
+    for (int i = 0; i < function_table_def_.functions()->size(); ++i) {
+      delete decoded_functions_[i].load(std::memory_order_relaxed);
+    }
+  }
+}
 
 Status FunctionTable::ResolveImports(ImportResolver import_resolver) {
   if (!function_table_def_.imports()) {
@@ -211,6 +224,18 @@ StatusOr<int> FunctionTable::LookupFunctionOrdinalByName(
          << "' not found in function table (or names have been stripped)";
 }
 
+const DecodedFunction* FunctionTable::SetDecodedFunction(
+    int function_ordinal,
+    std::unique_ptr<DecodedFunction> decoded_function) const {
+  const DecodedFunction* expected = nullptr;
+  if (decoded_functions_[function_ordinal].compare_exchange_strong(
+          expected, decoded_function.get(), std::memory_order_acq_rel)) {
+    return decoded_function.release();
+  }
+  // Another thread won the race; keep its decoded form.
+  return expected;
+}
+
 Status FunctionTable::RegisterBreakpoint(int function_ordinal, int offset,
                                          BreakpointCallback callback) {
   if (breakpoint_tables_.empty()) {
@@ -15,7 +15,9 @@
 #ifndef IREE_VM_FUNCTION_TABLE_H_
 #define IREE_VM_FUNCTION_TABLE_H_
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -23,6 +25,7 @@
 #include "absl/types/span.h"
 #include "iree/base/status.h"
 #include "iree/schemas/function_table_def_generated.h"
+#include "iree/vm/decoded_function.h"
 #include "iree/vm/function.h"
 
 namespace iree {
@@ -65,6 +68,20 @@ class FunctionTable {
   StatusOr<int> LookupFunctionOrdinal(const Function& function) const;
   StatusOr<int> LookupFunctionOrdinalByName(absl::string_view name) const;
 
+  // Returns the decoded form of the function or nullptr if the function has
+  // not yet been validated and decoded (see BytecodeReader::PrepareFunction).
+  const DecodedFunction* LookupDecodedFunction(int function_ordinal) const {
+    return decoded_functions_[function_ordinal].load(
+        std::memory_order_acquire);
+  }
+
+  // Sets the decoded form of the function and returns the one in use.
+  // Functions may be prepared concurrently from multiple threads; if the
+  // function was already decoded the existing decoded form is kept.
+  const DecodedFunction* SetDecodedFunction(
+      int function_ordinal,
+      std::unique_ptr<DecodedFunction> decoded_function) const;
+
   // Handles breakpoints that are encountered during execution.
   // The current function and offset within the function will be provided.
   // The fiber is set as suspended prior to issuing the callback and resumed
@@ -113,6 +130,10 @@ class FunctionTable {
   const FunctionTableDef& function_table_def_;
   std::vector<ImportFunction> import_functions_;
 
+  // One slot per function in the function table holding the owned decoded
+  // form of the function once it has been validated.
+  std::unique_ptr<std::atomic<const DecodedFunction*>[]> decoded_functions_;
+
   // One slot per function in the function table. The hash map contains the
   // breakpoints for that particular function mapped by offset within the
   // function.
@@ -31,10 +31,14 @@ Status Module::ValidateStructure(const ModuleDef& module_def) {
            << "ModuleDef is missing a function table";
   }
 
-  // May optionally have an executable table.
-  if (module_def.executable_table()) {
+  // May optionally have an executable table. Executables are validated as
+  // they are first prepared so that loading a module does not need to touch
+  // the (potentially large) executable contents.
+
+  // May optionally have a constant pool.
+  if (module_def.constant_pool()) {
     RETURN_IF_ERROR(
-        ExecutableTable::ValidateStructure(*module_def.executable_table()));
+        ConstantPool::ValidateStructure(*module_def.constant_pool()));
   }
 
   return OkStatus();
@@ -60,7 +64,8 @@ StatusOr<std::unique_ptr<Module>> Module::FromFile(
 
   auto module = absl::WrapUnique(new Module(std::move(module_file)));
 
-  // TODO(benvanik): validate internals here? or make explicit?
+  // NOTE: executables and constants are validated and prepared lazily on
+  // first use so that loading large modules does not touch their contents.
 
   return {std::move(module)};
 }
@@ -69,7 +74,8 @@ Module::Module(std::unique_ptr<ModuleFile> module_file)
     : module_file_(std::move(module_file)),
       module_def_(*module_file_->root()),
       function_table_(*this, *module_def_.function_table()),
-      executable_table_(*module_def_.executable_table()) {}
+      executable_table_(*module_def_.executable_table()),
+      constant_pool_(module_def_.constant_pool()) {}
 
 Module::~Module() = default;
 
@@ -19,6 +19,7 @@
 
 #include "iree/base/flatbuffer_util.h"
 #include "iree/schemas/module_def_generated.h"
+#include "iree/vm/constant_pool.h"
 #include "iree/vm/executable_table.h"
 #include "iree/vm/function_table.h"
 
@@ -47,6 +48,7 @@ class Module {
   FunctionTable* mutable_function_table() { return &function_table_; }
   const ExecutableTable& executable_table() const { return executable_table_; }
   ExecutableTable* mutable_executable_table() { return &executable_table_; }
+  const ConstantPool& constant_pool() const { return constant_pool_; }
 
  private:
   explicit Module(std::unique_ptr<ModuleFile> module_file);
@@ -55,6 +57,7 @@ class Module {
   const ModuleDef& module_def_;
   FunctionTable function_table_;
   ExecutableTable executable_table_;
+  ConstantPool constant_pool_;
 };
 
 }  // namespace vm
@@ -17,6 +17,8 @@
 #include "iree/base/flatbuffer_util.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/vm/bytecode_reader.h"
+#include "iree/vm/bytecode_tables_sequencer.h"
 #include "iree/vm/fiber_state.h"
 #include "iree/vm/sequencer_dispatch.h"
 
@@ -74,6 +76,10 @@ Status ValidateArgType(const BufferView& arg,
   for (int i = 0; i < expected_shape->size(); ++i) {
     auto dim_size = arg.shape[i];
     auto expected_dim_size = expected_shape->Get(i);
+    if (expected_dim_size < 0) {
+      // Dynamic dimensions accept any size.
+      continue;
+    }
     if (dim_size != expected_dim_size) {
       return InvalidArgumentErrorBuilder(IREE_LOC)
              << "Argument dimension " << i << " should have size "
@@ -83,10 +89,63 @@ Status ValidateArgType(const BufferView& arg,
   return OkStatus();
 }
 
+Status ValidateArgAndResultCounts(const Function& function,
+                                  absl::Span<const BufferView> args,
+                                  absl::Span<const BufferView> results) {
+  if (args.size() != function.input_count()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Function " << function.name() << " requires "
+           << function.input_count() << " inputs but " << args.size()
+           << " provided";
+  }
+  if (results.size() != function.result_count()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Function " << function.name() << " requires "
+           << function.result_count() << " outputs but " << results.size()
+           << " provided";
+  }
+  return OkStatus();
+}
+
+Status ValidateArgTypes(const Function& function,
+                        absl::Span<const BufferView> args) {
+  for (int i = 0; i < args.size(); ++i) {
+    auto expected_arg_type = function.type_def().inputs()->Get(i);
+    RETURN_IF_ERROR(ValidateArgType(
+        args[i], *expected_arg_type->type_union_as_MemRefTypeDef()))
+        << "Function " << function.name() << " argument " << i;
+  }
+  return OkStatus();
+}
+
+// Pushes a frame for each argument set and dispatches them back-to-back into a
+// single command batch that is flushed once all sequences have been recorded.
+Status DispatchSequenceBatch(const hal::DevicePlacement& placement,
+                             SequencerMode mode, Stack* stack,
+                             const Function& function,
+                             absl::Span<const absl::Span<BufferView>> args,
+                             absl::Span<const absl::Span<BufferView>> results) {
+  CommandBatch batch(placement, mode);
+  for (int i = 0; i < args.size(); ++i) {
+    ASSIGN_OR_RETURN(auto* callee_stack_frame, stack->PushFrame(function));
+    for (int j = 0; j < args[i].size(); ++j) {
+      *callee_stack_frame->mutable_local(j) = args[i][j];
+    }
+    RETURN_IF_ERROR(
+        DispatchSequence(&batch, stack, callee_stack_frame, results[i]));
+    RETURN_IF_ERROR(stack->PopFrame());
+  }
+  return batch.Flush();
+}
+
 }  // namespace
 
-SequencerContext::SequencerContext(std::shared_ptr<Instance> instance)
-    : instance_(std::move(instance)) {
+SequencerContext::SequencerContext(std::shared_ptr<Instance> instance,
+                                   SequencerMode mode,
+                                   hal::PlacementSpec placement_spec)
+    : instance_(std::move(instance)),
+      mode_(mode),
+      placement_spec_(placement_spec) {
   if (instance_->debug_server()) {
     CHECK_OK(instance_->debug_server()->RegisterContext(this));
   }
@@ -106,6 +165,18 @@ Status SequencerContext::RegisterNativeFunction(
 }
 
 Status SequencerContext::RegisterModule(std::unique_ptr<Module> module) {
+  // Prepare bytecode up front so that errors are reported at load time and
+  // the first invocation of each function doesn't pay for validation or
+  // constant decoding.
+  const auto& function_table = module->function_table();
+  for (int i = 0; i < function_table.def().functions()->size(); ++i) {
+    ASSIGN_OR_RETURN(auto function, function_table.LookupFunction(i));
+    if (!function.def().bytecode()) continue;
+    RETURN_IF_ERROR(
+        BytecodeReader::PrepareFunction(sequencer_opcode_table(), function, i)
+            .status());
+  }
+
   auto* module_ptr = module.get();
   RETURN_IF_ERROR(Context::RegisterModule(std::move(module)));
   if (instance_->debug_server()) {
@@ -119,18 +190,7 @@ Status SequencerContext::Invoke(FiberState* fiber_state, Function function,
                                 absl::Span<BufferView> args,
                                 absl::Span<BufferView> results) const {
   // Verify arg/result counts.
-  if (args.size() != function.input_count()) {
-    return InvalidArgumentErrorBuilder(IREE_LOC)
-           << "Function " << function.name() << " requires "
-           << function.input_count() << " inputs but " << args.size()
-           << " provided";
-  }
-  if (results.size() != function.result_count()) {
-    return InvalidArgumentErrorBuilder(IREE_LOC)
-           << "Function " << function.name() << " requires "
-           << function.result_count() << " outputs but " << results.size()
-           << " provided";
-  }
+  RETURN_IF_ERROR(ValidateArgAndResultCounts(function, args, results));
 
   // Push stack frame for the function we are calling.
   auto* stack = fiber_state->mutable_stack();
@@ -146,16 +206,13 @@ Status SequencerContext::Invoke(FiberState* fiber_state, Function function,
     *callee_stack_frame->mutable_local(i) = std::move(arg);
   }
 
-  // TODO(benvanik): change to:
-  //   get command queue (any command queue)
-  //   make command buffer
-  //   record dispatch
-  //   submit
-  //   wait on fence
+  auto* device_manager = instance_->device_manager();
   ASSIGN_OR_RETURN(auto placement,
-                   instance_->device_manager()->ResolvePlacement({}));
-  RETURN_IF_ERROR(
-      DispatchSequence(placement, stack, callee_stack_frame, results));
+                   device_manager->ResolvePlacement(placement_spec_));
+  auto dispatch_status =
+      DispatchSequence(placement, stack, callee_stack_frame, results, mode_);
+  device_manager->ReleasePlacement(placement);
+  RETURN_IF_ERROR(dispatch_status);
 
   // Pop the callee frame to balance out the stack.
   RETURN_IF_ERROR(stack->PopFrame());
@@ -163,5 +220,49 @@ Status SequencerContext::Invoke(FiberState* fiber_state, Function function,
   return OkStatus();
 }
 
+Status SequencerContext::InvokeBatch(
+    FiberState* fiber_state, Function function,
+    absl::Span<const absl::Span<BufferView>> args,
+    absl::Span<const absl::Span<BufferView>> results) const {
+  if (args.size() != results.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Batch has " << args.size() << " argument sets but "
+           << results.size() << " result sets";
+  }
+  if (args.empty()) return OkStatus();
+
+  // Types are only checked against the signature for the first argument set;
+  // arguments in the rest of the batch that match it need no further checks.
+  RETURN_IF_ERROR(ValidateArgAndResultCounts(function, args[0], results[0]));
+  RETURN_IF_ERROR(ValidateArgTypes(function, args[0]));
+  for (int i = 1; i < args.size(); ++i) {
+    RETURN_IF_ERROR(ValidateArgAndResultCounts(function, args[i], results[i]))
+        << "Batch entry " << i;
+    for (int j = 0; j < args[i].size(); ++j) {
+      const auto& arg = args[i][j];
+      const auto& first_arg = args[0][j];
+      if (arg.element_size == first_arg.element_size &&
+          arg.shape == first_arg.shape) {
+        continue;
+      }
+      // Shapes may differ in dynamic dimensions.
+      auto expected_arg_type = function.type_def().inputs()->Get(j);
+      RETURN_IF_ERROR(ValidateArgType(
+          arg, *expected_arg_type->type_union_as_MemRefTypeDef()))
+          << "Function " << function.name() << " batch entry " << i
+          << " argument " << j;
+    }
+  }
+
+  auto* device_manager = instance_->device_manager();
+  ASSIGN_OR_RETURN(auto placement,
+                   device_manager->ResolvePlacement(placement_spec_));
+  auto dispatch_status =
+      DispatchSequenceBatch(placement, mode_, fiber_state->mutable_stack(),
+                            function, args, results);
+  device_manager->ReleasePlacement(placement);
+  return dispatch_status;
+}
+
 }  // namespace vm
 }  // namespace iree
@@ -22,17 +22,26 @@
 #include "absl/types/span.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/device_manager.h"
 #include "iree/vm/context.h"
 #include "iree/vm/function.h"
 #include "iree/vm/instance.h"
 #include "iree/vm/module.h"
+#include "iree/vm/sequencer_dispatch.h"
 
 namespace iree {
 namespace vm {
 
 class SequencerContext final : public Context {
  public:
-  explicit SequencerContext(std::shared_ptr<Instance> instance);
+  // |mode| controls how device work is submitted during invocation; see
+  // SequencerMode for details. |placement_spec| is used to resolve the device
+  // each invocation runs on; any available_formats it references must remain
+  // valid for the lifetime of the context.
+  explicit SequencerContext(
+      std::shared_ptr<Instance> instance,
+      SequencerMode mode = SequencerMode::kBatched,
+      hal::PlacementSpec placement_spec = {});
   ~SequencerContext() override;
 
   Status RegisterNativeFunction(std::string name,
@@ -45,8 +54,25 @@ class SequencerContext final : public Context {
                 absl::Span<hal::BufferView> args,
                 absl::Span<hal::BufferView> results) const;
 
+  // Invokes |function| once for each set of arguments in |args|, storing the
+  // results of invocation i in |results|[i].
+  //
+  // The first argument set is validated against the function signature and
+  // arguments in the other sets with the same shapes are not validated again;
+  // others (such as those differing in dynamic dimensions) are. The
+  // invocations share a single placement and record their device work into
+  // shared command buffers that are submitted together. Invocations that need
+  // to observe buffer contents on the host (such as conditional branches)
+  // will flush the work recorded so far.
+  Status InvokeBatch(
+      FiberState* fiber_state, vm::Function function,
+      absl::Span<const absl::Span<hal::BufferView>> args,
+      absl::Span<const absl::Span<hal::BufferView>> results) const;
+
  private:
   std::shared_ptr<Instance> instance_;
+  SequencerMode mode_;
+  hal::PlacementSpec placement_spec_;
 };
 
 }  // namespace vm
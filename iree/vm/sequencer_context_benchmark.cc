@@ -0,0 +1,257 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures end-to-end SequencerContext::Invoke latency of a compiled module.
+//
+// Usage:
+//   sequencer_context_benchmark \
+//       --main_module=mnist.emod --main_function=main \
+//       --input_values="1x28x28x1xf32" \
+//       --benchmark_format=json
+//
+// Modules are produced from test/e2e/xla/*.mlir and test/models/mnist.mlir
+// with iree-translate; the input values are the same as in their RUN lines.
+//
+// BM_Invoke reports steady-state invocations/sec with the module already
+// loaded. BM_InvokeBatch reports the same for N invocations issued with a
+// single InvokeBatch call. BM_LoadAndInvoke includes loading the module file,
+// registering it with a fresh context and the first invocation (which prepares
+// executables).
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/file_io.h"
+#include "iree/base/init.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer_view_string_util.h"
+#include "iree/hal/device.h"
+#include "iree/hal/driver_registry.h"
+#include "iree/schemas/module_def_generated.h"
+#include "iree/vm/fiber_state.h"
+#include "iree/vm/function.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/module.h"
+#include "iree/vm/sequencer_context.h"
+
+ABSL_FLAG(std::string, main_module, "", "Main module with entry point.");
+ABSL_FLAG(std::string, main_function, "main",
+          "Function within the main module to execute.");
+ABSL_FLAG(std::string, driver, "interpreter", "HAL driver to execute with.");
+
+ABSL_FLAG(std::string, input_values, "", "Input shapes and optional values.");
+ABSL_FLAG(std::string, input_file, "",
+          "Input shapes and optional values serialized in a file.");
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::iree::hal::BufferView;
+
+// Instance with a single registered device shared by all benchmark runs.
+struct DeviceState {
+  std::shared_ptr<Instance> instance;
+  std::shared_ptr<hal::Device> device;
+  std::vector<BufferView> args;
+};
+
+StatusOr<std::vector<BufferView>> ParseInputsFromFlags(
+    hal::Allocator* allocator) {
+  std::string file_contents;
+  if (!absl::GetFlag(FLAGS_input_values).empty()) {
+    file_contents =
+        absl::StrReplaceAll(absl::GetFlag(FLAGS_input_values), {{"\\n", "\n"}});
+  } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
+    ASSIGN_OR_RETURN(file_contents,
+                     file_io::GetFileContents(absl::GetFlag(FLAGS_input_file)));
+  }
+  std::vector<BufferView> inputs;
+  for (const auto& line :
+       absl::StrSplit(file_contents, '\n', absl::SkipWhitespace())) {
+    ASSIGN_OR_RETURN(auto input,
+                     hal::ParseBufferViewFromString(line, allocator));
+    inputs.push_back(std::move(input));
+  }
+  return inputs;
+}
+
+StatusOr<std::unique_ptr<DeviceState>> CreateDeviceState() {
+  auto state = absl::make_unique<DeviceState>();
+  state->instance = std::make_shared<Instance>();
+  ASSIGN_OR_RETURN(auto driver, hal::DriverRegistry::shared_registry()->Create(
+                                    absl::GetFlag(FLAGS_driver)));
+  ASSIGN_OR_RETURN(state->device, driver->CreateDefaultDevice());
+  RETURN_IF_ERROR(
+      state->instance->device_manager()->RegisterDevice(state->device));
+  ASSIGN_OR_RETURN(state->args,
+                   ParseInputsFromFlags(state->device->allocator()));
+  return state;
+}
+
+// Loads the main module into |context| and returns its main function.
+StatusOr<Function> LoadMainFunction(SequencerContext* context) {
+  ASSIGN_OR_RETURN(auto module_file,
+                   ModuleFile::LoadFile(ModuleDefIdentifier(),
+                                        absl::GetFlag(FLAGS_main_module)),
+                   _ << "while loading module file "
+                     << absl::GetFlag(FLAGS_main_module));
+  ASSIGN_OR_RETURN(auto module, Module::FromFile(std::move(module_file)));
+  RETURN_IF_ERROR(context->RegisterModule(std::move(module)));
+  return context->LookupExport(absl::GetFlag(FLAGS_main_function));
+}
+
+Status Invoke(SequencerContext* context, FiberState* fiber_state,
+              const Function& function, const DeviceState& device_state) {
+  // Invocation consumes the arguments so we pass copies (which only retain
+  // the underlying buffers).
+  std::vector<BufferView> args = device_state.args;
+  std::vector<BufferView> results(function.result_count());
+  return context->Invoke(fiber_state, function, absl::MakeSpan(args),
+                         absl::MakeSpan(results));
+}
+
+void BM_Invoke(benchmark::State& state) {
+  auto device_state_or = CreateDeviceState();
+  if (!device_state_or.ok()) {
+    state.SkipWithError(device_state_or.status().ToString().c_str());
+    return;
+  }
+  auto device_state = std::move(device_state_or).ValueOrDie();
+  SequencerContext context(device_state->instance);
+  auto function_or = LoadMainFunction(&context);
+  if (!function_or.ok()) {
+    state.SkipWithError(function_or.status().ToString().c_str());
+    return;
+  }
+  auto function = function_or.ValueOrDie();
+  FiberState fiber_state(device_state->instance);
+
+  // Warm up so that executable preparation is not measured.
+  auto status = Invoke(&context, &fiber_state, function, *device_state);
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+
+  for (auto _ : state) {
+    status = Invoke(&context, &fiber_state, function, *device_state);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(absl::GetFlag(FLAGS_main_module));
+}
+BENCHMARK(BM_Invoke)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+void BM_InvokeBatch(benchmark::State& state) {
+  auto device_state_or = CreateDeviceState();
+  if (!device_state_or.ok()) {
+    state.SkipWithError(device_state_or.status().ToString().c_str());
+    return;
+  }
+  auto device_state = std::move(device_state_or).ValueOrDie();
+  SequencerContext context(device_state->instance);
+  auto function_or = LoadMainFunction(&context);
+  if (!function_or.ok()) {
+    state.SkipWithError(function_or.status().ToString().c_str());
+    return;
+  }
+  auto function = function_or.ValueOrDie();
+  FiberState fiber_state(device_state->instance);
+
+  int batch_size = state.range(0);
+  std::vector<std::vector<BufferView>> args(batch_size);
+  std::vector<std::vector<BufferView>> results(batch_size);
+  std::vector<absl::Span<BufferView>> arg_spans(batch_size);
+  std::vector<absl::Span<BufferView>> result_spans(batch_size);
+  auto invoke_batch = [&]() {
+    for (int i = 0; i < batch_size; ++i) {
+      args[i] = device_state->args;
+      results[i].assign(function.result_count(), {});
+      arg_spans[i] = absl::MakeSpan(args[i]);
+      result_spans[i] = absl::MakeSpan(results[i]);
+    }
+    return context.InvokeBatch(&fiber_state, function, arg_spans,
+                               result_spans);
+  };
+
+  // Warm up so that executable preparation is not measured.
+  auto status = invoke_batch();
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+
+  for (auto _ : state) {
+    status = invoke_batch();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+  state.SetLabel(absl::GetFlag(FLAGS_main_module));
+}
+BENCHMARK(BM_InvokeBatch)
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_LoadAndInvoke(benchmark::State& state) {
+  auto device_state_or = CreateDeviceState();
+  if (!device_state_or.ok()) {
+    state.SkipWithError(device_state_or.status().ToString().c_str());
+    return;
+  }
+  auto device_state = std::move(device_state_or).ValueOrDie();
+
+  for (auto _ : state) {
+    SequencerContext context(device_state->instance);
+    FiberState fiber_state(device_state->instance);
+    auto function_or = LoadMainFunction(&context);
+    auto status = function_or.ok()
+                      ? Invoke(&context, &fiber_state, function_or.ValueOrDie(),
+                               *device_state)
+                      : function_or.status();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(absl::GetFlag(FLAGS_main_module));
+}
+BENCHMARK(BM_LoadAndInvoke)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  ::iree::InitializeEnvironment(&argc, &argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
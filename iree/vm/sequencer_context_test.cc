@@ -0,0 +1,201 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/sequencer_context.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/types/span.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/hal/device_info.h"
+#include "iree/hal/interpreter/interpreter_device.h"
+#include "iree/schemas/bytecode/sequencer_bytecode_v0.h"
+#include "iree/vm/fiber_state.h"
+#include "iree/vm/function.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/testing/test_module.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::iree::hal::BufferView;
+using ::iree::vm::testing::BuildTestModule;
+using ::iree::vm::testing::BytecodeBuilder;
+using ::iree::vm::testing::TestFunction;
+using ::testing::ElementsAre;
+
+constexpr int kElementCount = 4;
+constexpr float kFillValue = -1.0f;
+
+class SequencerContextTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    instance_ = std::make_shared<Instance>();
+    device_ = std::make_shared<hal::InterpreterDevice>(
+        hal::DeviceInfo("interpreter", hal::DeviceFeature::kNone));
+    ASSERT_OK(instance_->device_manager()->RegisterDevice(device_));
+    context_ = absl::make_unique<SequencerContext>(instance_);
+    fiber_state_ = absl::make_unique<FiberState>(instance_);
+
+    // clone_fill(%0) -> %1: clones the input and overwrites its first element,
+    // recording both a copy and a dependent fill into the command batch.
+    float fill_value = kFillValue;
+    uint32_t fill_pattern;
+    std::memcpy(&fill_pattern, &fill_value, sizeof(fill_pattern));
+    auto bytecode = BytecodeBuilder()
+                        .Opcode(SequencerOpcode::kClone)
+                        .Uint16(0)
+                        .Uint16(1)
+                        .Opcode(SequencerOpcode::kStaticFill)
+                        .Uint32(fill_pattern)
+                        .Uint16(1)
+                        .Uint32(0)
+                        .Uint32(sizeof(float))
+                        .Opcode(SequencerOpcode::kReturn)
+                        .Locals({1});
+    std::vector<TestFunction> functions = {
+        {"clone_fill", 1, 1, /*local_count=*/2, bytecode.bytecode()},
+    };
+    ASSERT_OK_AND_ASSIGN(auto module, BuildTestModule(functions));
+    ASSERT_OK(context_->RegisterModule(std::move(module)));
+    ASSERT_OK_AND_ASSIGN(function_, context_->LookupExport("clone_fill"));
+  }
+
+  // Returns a buffer of |element_count| elements all set to |value|.
+  BufferView MakeInput(float value, int element_count = kElementCount) {
+    auto buffer = device_->allocator()
+                      ->Allocate(hal::MemoryType::kHostLocal |
+                                     hal::MemoryType::kDeviceVisible,
+                                 hal::BufferUsage::kAll,
+                                 element_count * sizeof(float))
+                      .ValueOrDie();
+    std::vector<float> data(element_count, value);
+    CHECK_OK(buffer->WriteData(0, data.data(), element_count * sizeof(float)));
+    return BufferView(std::move(buffer), {element_count}, sizeof(float));
+  }
+
+  std::vector<float> ReadResult(const BufferView& result) {
+    std::vector<float> data(result.shape.element_count());
+    CHECK_OK(result.buffer->ReadData(0, data.data(),
+                                     data.size() * sizeof(float)));
+    return data;
+  }
+
+  std::shared_ptr<Instance> instance_;
+  std::shared_ptr<hal::InterpreterDevice> device_;
+  std::unique_ptr<SequencerContext> context_;
+  std::unique_ptr<FiberState> fiber_state_;
+  Function function_;
+};
+
+TEST_F(SequencerContextTest, InvokeBatchMatchesInvoke) {
+  constexpr int kBatchSize = 3;
+
+  std::vector<std::vector<float>> expected_results;
+  for (int i = 0; i < kBatchSize; ++i) {
+    std::vector<BufferView> args = {MakeInput(i)};
+    std::vector<BufferView> results(1);
+    ASSERT_OK(context_->Invoke(fiber_state_.get(), function_,
+                               absl::MakeSpan(args), absl::MakeSpan(results)));
+    expected_results.push_back(ReadResult(results[0]));
+  }
+  EXPECT_THAT(expected_results[1], ElementsAre(kFillValue, 1.0f, 1.0f, 1.0f));
+
+  std::vector<std::vector<BufferView>> args(kBatchSize);
+  std::vector<std::vector<BufferView>> results(kBatchSize);
+  std::vector<absl::Span<BufferView>> arg_spans;
+  std::vector<absl::Span<BufferView>> result_spans;
+  for (int i = 0; i < kBatchSize; ++i) {
+    args[i] = {MakeInput(i)};
+    results[i].resize(1);
+    arg_spans.push_back(absl::MakeSpan(args[i]));
+    result_spans.push_back(absl::MakeSpan(results[i]));
+  }
+  ASSERT_OK(context_->InvokeBatch(fiber_state_.get(), function_, arg_spans,
+                                  result_spans));
+  for (int i = 0; i < kBatchSize; ++i) {
+    ASSERT_NE(nullptr, results[i][0].buffer);
+    EXPECT_EQ(expected_results[i], ReadResult(results[i][0]))
+        << "Batch entry " << i;
+  }
+  EXPECT_EQ(0, fiber_state_->stack().depth());
+}
+
+TEST_F(SequencerContextTest, InvokeBatchDynamicDims) {
+  // The function takes memref<?xf32> so batch entries may differ in length.
+  std::vector<BufferView> args_0 = {MakeInput(1.0f, 2)};
+  std::vector<BufferView> args_1 = {MakeInput(2.0f, 3)};
+  std::vector<BufferView> results_0(1);
+  std::vector<BufferView> results_1(1);
+  std::vector<absl::Span<BufferView>> arg_spans = {absl::MakeSpan(args_0),
+                                                   absl::MakeSpan(args_1)};
+  std::vector<absl::Span<BufferView>> result_spans = {
+      absl::MakeSpan(results_0), absl::MakeSpan(results_1)};
+  ASSERT_OK(context_->InvokeBatch(fiber_state_.get(), function_, arg_spans,
+                                  result_spans));
+  EXPECT_THAT(ReadResult(results_0[0]), ElementsAre(kFillValue, 1.0f));
+  EXPECT_THAT(ReadResult(results_1[0]), ElementsAre(kFillValue, 2.0f, 2.0f));
+}
+
+TEST_F(SequencerContextTest, InvokeBatchEmpty) {
+  EXPECT_OK(context_->InvokeBatch(fiber_state_.get(), function_, {}, {}));
+}
+
+TEST_F(SequencerContextTest, InvokeBatchSetCountMismatch) {
+  std::vector<BufferView> args = {MakeInput(0)};
+  std::vector<BufferView> results(1);
+  std::vector<absl::Span<BufferView>> arg_spans = {absl::MakeSpan(args),
+                                                   absl::MakeSpan(args)};
+  std::vector<absl::Span<BufferView>> result_spans = {absl::MakeSpan(results)};
+  EXPECT_TRUE(IsInvalidArgument(context_->InvokeBatch(
+      fiber_state_.get(), function_, arg_spans, result_spans)));
+}
+
+TEST_F(SequencerContextTest, InvokeBatchArgCountMismatch) {
+  std::vector<BufferView> args_0 = {MakeInput(0)};
+  std::vector<BufferView> args_1 = {MakeInput(1), MakeInput(1)};
+  std::vector<BufferView> results_0(1);
+  std::vector<BufferView> results_1(1);
+  std::vector<absl::Span<BufferView>> arg_spans = {absl::MakeSpan(args_0),
+                                                   absl::MakeSpan(args_1)};
+  std::vector<absl::Span<BufferView>> result_spans = {
+      absl::MakeSpan(results_0), absl::MakeSpan(results_1)};
+  EXPECT_TRUE(IsInvalidArgument(context_->InvokeBatch(
+      fiber_state_.get(), function_, arg_spans, result_spans)));
+}
+
+TEST_F(SequencerContextTest, InvokeBatchResultCountMismatch) {
+  std::vector<BufferView> args_0 = {MakeInput(0)};
+  std::vector<BufferView> args_1 = {MakeInput(1)};
+  std::vector<BufferView> results_0(1);
+  std::vector<BufferView> results_1(2);
+  std::vector<absl::Span<BufferView>> arg_spans = {absl::MakeSpan(args_0),
+                                                   absl::MakeSpan(args_1)};
+  std::vector<absl::Span<BufferView>> result_spans = {
+      absl::MakeSpan(results_0), absl::MakeSpan(results_1)};
+  EXPECT_TRUE(IsInvalidArgument(context_->InvokeBatch(
+      fiber_state_.get(), function_, arg_spans, result_spans)));
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
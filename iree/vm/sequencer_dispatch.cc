@@ -13,21 +13,25 @@
 // limitations under the License.
 
 // Implements a full bytecode dispatch system for sequencer ops.
-// TODO(benvanik): rework to be async against CommandBuffers.
 
 #include "iree/vm/sequencer_dispatch.h"
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/base/optimization.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/str_join.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "iree/base/bitfield.h"
 #include "iree/base/logging.h"
 #include "iree/base/memory.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/command_buffer.h"
 #include "iree/hal/command_queue.h"
 #include "iree/hal/device.h"
 #include "iree/hal/heap_buffer.h"
@@ -41,9 +45,181 @@
 namespace iree {
 namespace vm {
 
+using ::iree::hal::Buffer;
+
+CommandBatch::CommandBatch(const hal::DevicePlacement& placement,
+                           SequencerMode mode)
+    : placement_(placement), mode_(mode) {}
+
+CommandBatch::~CommandBatch() = default;
+
+Status CommandBatch::Dispatch(ref_ptr<hal::Executable> executable,
+                              const hal::DispatchRequest& dispatch_request,
+                              int input_count) {
+  absl::InlinedVector<BufferRange, 8> reads;
+  absl::InlinedVector<BufferRange, 8> writes;
+  for (int i = 0; i < dispatch_request.bindings.size(); ++i) {
+    auto* buffer = dispatch_request.bindings[i].buffer;
+    (i < input_count ? reads : writes)
+        .push_back({buffer, 0, hal::kWholeBuffer});
+  }
+  RETURN_IF_ERROR(PrepareCommand(reads, writes));
+  RETURN_IF_ERROR(command_buffer_->Dispatch(dispatch_request));
+  executables_.push_back(std::move(executable));
+  return FinishCommand();
+}
+
+Status CommandBatch::Copy(Buffer* source_buffer, device_size_t source_offset,
+                          Buffer* target_buffer, device_size_t target_offset,
+                          device_size_t length) {
+  if (!CanRecordTransfer(source_buffer) || !CanRecordTransfer(target_buffer)) {
+    RETURN_IF_ERROR(Flush());
+    return target_buffer->CopyData(target_offset, source_buffer, source_offset,
+                                   length);
+  }
+  RETURN_IF_ERROR(PrepareCommand({{source_buffer, source_offset, length}},
+                                 {{target_buffer, target_offset, length}}));
+  RETURN_IF_ERROR(command_buffer_->CopyBuffer(source_buffer, source_offset,
+                                              target_buffer, target_offset,
+                                              length));
+  return FinishCommand();
+}
+
+Status CommandBatch::Fill(Buffer* target_buffer, device_size_t target_offset,
+                          device_size_t length, uint32_t value) {
+  if (!CanRecordTransfer(target_buffer)) {
+    RETURN_IF_ERROR(Flush());
+    return target_buffer->Fill32(target_offset, length, value);
+  }
+  RETURN_IF_ERROR(PrepareCommand({}, {{target_buffer, target_offset, length}}));
+  RETURN_IF_ERROR(command_buffer_->FillBuffer(target_buffer, target_offset,
+                                              length, &value, sizeof(value)));
+  return FinishCommand();
+}
+
+Status CommandBatch::Flush() {
+  if (!command_buffer_) return OkStatus();
+  auto command_buffer = std::move(command_buffer_);
+  RETURN_IF_ERROR(command_buffer->End());
+
+  if (!fence_) {
+    ASSIGN_OR_RETURN(fence_, placement_.device->CreateFence(0u));
+  }
+  ++fence_value_;
+
+  auto* command_buffer_ptr = command_buffer.get();
+  auto* queue = placement_.device->dispatch_queues()[placement_.queue_id];
+  hal::SubmissionBatch batch;
+  batch.command_buffers = absl::MakeConstSpan(&command_buffer_ptr, 1);
+  RETURN_IF_ERROR(queue->Submit(batch, {fence_.get(), fence_value_}));
+  RETURN_IF_ERROR(placement_.device->WaitAllFences(
+      {{fence_.get(), fence_value_}}, absl::InfiniteFuture()));
+
+  pending_reads_.clear();
+  pending_writes_.clear();
+  buffers_.clear();
+  executables_.clear();
+  return OkStatus();
+}
+
+bool CommandBatch::CanRecordTransfer(Buffer* buffer) const {
+  return mode_ == SequencerMode::kBatched &&
+         AllBitsSet(buffer->usage(), hal::BufferUsage::kTransfer);
+}
+
+// static
+CommandBatch::AllocationRange CommandBatch::ResolveRange(
+    const BufferRange& range) {
+  auto* buffer = range.buffer;
+  device_size_t length = range.length == hal::kWholeBuffer
+                             ? buffer->byte_length() - range.offset
+                             : range.length;
+  device_size_t begin = buffer->byte_offset() + range.offset;
+  return {buffer->allocated_buffer(), begin, begin + length};
+}
+
+// static
+bool CommandBatch::Overlaps(absl::Span<const AllocationRange> ranges,
+                            const AllocationRange& range) {
+  for (const auto& other : ranges) {
+    if (other.allocated_buffer == range.allocated_buffer &&
+        other.begin < range.end && range.begin < other.end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Status CommandBatch::PrepareCommand(absl::Span<const BufferRange> reads,
+                                    absl::Span<const BufferRange> writes) {
+  if (!command_buffer_) {
+    // Validate the placement before recording anything such that the error is
+    // reported at the command that first needs the queue.
+    auto dispatch_queues = placement_.device->dispatch_queues();
+    if (placement_.queue_id < 0 ||
+        placement_.queue_id >= dispatch_queues.size()) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Placement queue " << placement_.queue_id
+             << " out of range; device has " << dispatch_queues.size()
+             << " dispatch queues";
+    }
+    ASSIGN_OR_RETURN(
+        command_buffer_,
+        placement_.device->CreateCommandBuffer(
+            hal::CommandBufferMode::kOneShot,
+            hal::CommandCategory::kTransfer | hal::CommandCategory::kDispatch),
+        _.LogError());
+    RETURN_IF_ERROR(command_buffer_->Begin());
+  }
+
+  // Allocations are commonly subspans of a single arena (see
+  // PlanStaticAllocations) and as such hazards are tracked per byte range.
+  absl::InlinedVector<AllocationRange, 8> read_ranges;
+  absl::InlinedVector<AllocationRange, 8> write_ranges;
+  bool has_hazard = false;
+  for (const auto& range : reads) {
+    read_ranges.push_back(ResolveRange(range));
+    has_hazard |= Overlaps(pending_writes_, read_ranges.back());
+  }
+  for (const auto& range : writes) {
+    write_ranges.push_back(ResolveRange(range));
+    has_hazard |= Overlaps(pending_reads_, write_ranges.back()) ||
+                  Overlaps(pending_writes_, write_ranges.back());
+  }
+  if (has_hazard) {
+    hal::MemoryBarrier barrier;
+    barrier.source_scope =
+        hal::AccessScope::kDispatchWrite | hal::AccessScope::kTransferWrite;
+    barrier.target_scope =
+        hal::AccessScope::kDispatchRead | hal::AccessScope::kDispatchWrite |
+        hal::AccessScope::kTransferRead | hal::AccessScope::kTransferWrite;
+    RETURN_IF_ERROR(command_buffer_->ExecutionBarrier(
+        hal::ExecutionStage::kDispatch | hal::ExecutionStage::kTransfer,
+        hal::ExecutionStage::kDispatch | hal::ExecutionStage::kTransfer,
+        absl::MakeConstSpan(&barrier, 1), {}));
+    pending_reads_.clear();
+    pending_writes_.clear();
+  }
+
+  pending_reads_.insert(pending_reads_.end(), read_ranges.begin(),
+                        read_ranges.end());
+  pending_writes_.insert(pending_writes_.end(), write_ranges.begin(),
+                         write_ranges.end());
+  for (const auto& range : reads) {
+    buffers_.push_back(add_ref(range.buffer));
+  }
+  for (const auto& range : writes) {
+    buffers_.push_back(add_ref(range.buffer));
+  }
+  return OkStatus();
+}
+
+Status CommandBatch::FinishCommand() {
+  return mode_ == SequencerMode::kSynchronous ? Flush() : OkStatus();
+}
+
 namespace {
 
-using ::iree::hal::Buffer;
 using ::iree::hal::BufferView;
 
 // TODO(benvanik): remove (this should happen via predication).
@@ -107,9 +283,56 @@ StatusOr<device_size_t> CalculateOffset(absl::Span<const int32_t> indices,
   return offset;
 }
 
+// Looks up (and prepares, if needed) the executable for a dispatch op.
+StatusOr<ref_ptr<hal::Executable>> LookupDispatchExecutable(
+    Stack* stack, const std::shared_ptr<hal::Device>& device,
+    int32_t dispatch_ordinal, uint16_t export_ordinal) {
+  auto& executable_table = stack->current_frame()->module().executable_table();
+  ASSIGN_OR_RETURN(
+      auto* multi_arch_executable_def,
+      executable_table.LookupMultiArchExecutable(dispatch_ordinal));
+  if (export_ordinal >= multi_arch_executable_def->entry_point_count()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid executable export ordinal " << export_ordinal;
+  }
+  return executable_table.LookupOrPrepareExecutable(device, dispatch_ordinal);
+}
+
+// Reads the input and output bindings of a dispatch op into |bindings| and
+// returns the number of inputs.
+StatusOr<int> ReadDispatchBindings(BytecodeReader* reader,
+                                   std::vector<hal::BufferBinding>* bindings) {
+  int input_count = reader->ReadCount();
+  for (int i = 0; i < input_count; ++i) {
+    auto* input_local = reader->ReadLocal();
+    bindings->push_back(hal::BufferBinding(
+        input_local->buffer->allowed_access() & hal::MemoryAccess::kAll,
+        *input_local));
+  }
+  int output_count = reader->ReadCount();
+  for (int i = 0; i < output_count; ++i) {
+    auto* output_local = reader->ReadLocal();
+    bindings->push_back(
+        hal::BufferBinding(hal::MemoryAccess::kWrite, *output_local));
+  }
+  int result_count = reader->ReadCount();
+  CHECK_EQ(0, result_count) << "Results not yet implemented";
+  return input_count;
+}
+
 }  // namespace
 
 Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
+                        StackFrame* entry_stack_frame,
+                        absl::Span<BufferView> entry_results,
+                        SequencerMode mode) {
+  CommandBatch batch(placement, mode);
+  RETURN_IF_ERROR(
+      DispatchSequence(&batch, stack, entry_stack_frame, entry_results));
+  return batch.Flush();
+}
+
+Status DispatchSequence(CommandBatch* batch_ptr, Stack* stack,
                         StackFrame* entry_stack_frame,
                         absl::Span<BufferView> entry_results) {
   // Dispatch table mapping 1:1 with bytecode ops.
@@ -134,15 +357,30 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   // We hope that LLVM decides to keep these in registers (as they are touched
   // for every instruction executed). The stack_frame will change as we call
   // into different functions.
-  BytecodeReader reader(stack);
+  BytecodeReader reader(stack, sequencer_opcode_table());
   RETURN_IF_ERROR(reader.SwitchStackFrame(entry_stack_frame));
 
-#define DISPATCH_NEXT()                                                   \
-  {                                                                       \
-    uint8_t opcode = *reader.AdvanceOffset().ValueOrDie();                \
-    DVLOG(1) << "Sequencer dispatching op code: "                         \
-             << GetOpcodeInfo(sequencer_opcode_table(), opcode).mnemonic; \
-    goto* kDispatchTable[opcode];                                         \
+  // Device work is batched until the host needs to observe buffer contents.
+  // Ops that read or write buffers on the host must flush first. Work still
+  // pending when the entry function returns is flushed by the caller.
+  auto& batch = *batch_ptr;
+  const auto& placement = batch.placement();
+
+  // Functions are validated before they execute so opcodes and operands are
+  // decoded without checks. Only functions with breakpoints take the slower
+  // AdvanceOffset path.
+#define DISPATCH_NEXT()                                                    \
+  {                                                                        \
+    uint8_t opcode;                                                        \
+    if (ABSL_PREDICT_FALSE(reader.has_breakpoints())) {                    \
+      ASSIGN_OR_RETURN(const uint8_t* opcode_ptr, reader.AdvanceOffset()); \
+      opcode = *opcode_ptr;                                                \
+    } else {                                                               \
+      opcode = reader.ReadOpcode();                                        \
+    }                                                                      \
+    DVLOG(1) << "Sequencer dispatching op code: "                          \
+             << GetOpcodeInfo(sequencer_opcode_table(), opcode).mnemonic;  \
+    goto* kDispatchTable[opcode];                                          \
   }
 
 #define DISPATCH_CORE_OPCODE(opcode, body) \
@@ -151,9 +389,10 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   DISPATCH_NEXT();
 
   DISPATCH_CORE_OPCODE(kConstant, {
-    ASSIGN_OR_RETURN(auto value, reader.ReadConstant());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    // TODO(b/139121143): until we have full command buffers we need to do this.
+    auto value = reader.ReadConstant();
+    auto* dst_local = reader.ReadLocal();
+    // Host devices can use the module-backed constant buffer as-is; others
+    // will get a device-local copy.
     ASSIGN_OR_RETURN(value.buffer,
                      placement.device->allocator()->AllocateConstant(
                          hal::BufferUsage::kConstant | hal::BufferUsage::kAll,
@@ -183,6 +422,7 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
         break;
       }
       case ImportFunction::LinkType::kNativeFunction: {
+        RETURN_IF_ERROR(batch.Flush());
         ASSIGN_OR_RETURN(auto* new_stack_frame,
                          stack->PushFrame(*target_function));
         RETURN_IF_ERROR(reader.CopyInputsAndSwitchStackFrame(old_stack_frame,
@@ -207,10 +447,23 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
     auto* new_stack_frame = stack->caller_frame();
     if (old_stack_frame == entry_stack_frame) {
       // Returning from entry function. Marshal results from the return stmt.
-      ASSIGN_OR_RETURN(int32_t src_count, reader.ReadCount());
+      // Results may still be written by pending commands in the batch.
+      int32_t src_count = reader.ReadCount();
       for (int i = 0; i < src_count; ++i) {
-        ASSIGN_OR_RETURN(auto* src_local,
-                         reader.ReadLocal(old_stack_frame->mutable_locals()));
+        auto* src_local = reader.ReadLocal(old_stack_frame->mutable_locals());
+        if (AnyBitSet(src_local->buffer->usage() &
+                      hal::BufferUsage::kConstant)) {
+          // Constants may reference the module data directly and the results
+          // must remain valid after the module has been released.
+          ASSIGN_OR_RETURN(auto buffer,
+                           placement.device->allocator()->Allocate(
+                               hal::MemoryType::kHostLocal |
+                                   hal::MemoryType::kDeviceVisible,
+                               hal::BufferUsage::kAll,
+                               src_local->buffer->byte_length()));
+          RETURN_IF_ERROR(buffer->CopyData(0, src_local->buffer.get()));
+          src_local->buffer = std::move(buffer);
+        }
         entry_results[i] = std::move(*src_local);
       }
       DVLOG(1) << "Returning to entry";
@@ -218,35 +471,36 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
     } else if (!new_stack_frame) {
       return FailedPreconditionErrorBuilder(IREE_LOC) << "Stack underflow";
     }
-    RETURN_IF_ERROR(reader.CopyResultsAndSwitchStackFrame(old_stack_frame,
+    RETURN_IF_ERROR(reader.MoveResultsAndSwitchStackFrame(old_stack_frame,
                                                           new_stack_frame));
     RETURN_IF_ERROR(stack->PopFrame());
     DVLOG(1) << "Return; stack now: " << stack->DebugString();
   });
 
   DISPATCH_CORE_OPCODE(kBranch, {
-    ASSIGN_OR_RETURN(int32_t offset, reader.ReadBlockOffset());
-    RETURN_IF_ERROR(reader.CopySlots());
-    RETURN_IF_ERROR(reader.BranchToOffset(offset));
+    int32_t offset = reader.ReadBlockOffset();
+    reader.CopySlots();
+    reader.BranchToOffset(offset);
   });
 
   DISPATCH_CORE_OPCODE(kCondBranch, {
     // Evaluate condition first so we can do the copies as we read them for
     // which side of the branch we take.
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
+    RETURN_IF_ERROR(batch.Flush());
     bool cond_value = BufferViewIsTrue(*cond_local);
-    ASSIGN_OR_RETURN(int32_t true_offset, reader.ReadBlockOffset());
+    int32_t true_offset = reader.ReadBlockOffset();
 
     if (cond_value) {
-      RETURN_IF_ERROR(reader.CopySlots());
-      RETURN_IF_ERROR(reader.BranchToOffset(true_offset));
+      reader.CopySlots();
+      reader.BranchToOffset(true_offset);
     } else {
-      ASSIGN_OR_RETURN(int32_t true_op_count, reader.ReadCount());
-      RETURN_IF_ERROR(reader.SkipLocals(2 * true_op_count));
-      ASSIGN_OR_RETURN(int32_t false_offset, reader.ReadBlockOffset());
+      int32_t true_op_count = reader.ReadCount();
+      reader.SkipLocals(2 * true_op_count);
+      int32_t false_offset = reader.ReadBlockOffset();
 
-      RETURN_IF_ERROR(reader.CopySlots());
-      RETURN_IF_ERROR(reader.BranchToOffset(false_offset));
+      reader.CopySlots();
+      reader.BranchToOffset(false_offset);
     }
   });
 
@@ -257,74 +511,20 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
 
   DISPATCH_CORE_OPCODE(kStaticDispatch, {
     // TODO(benvanik): the real sequencer :)
-    ASSIGN_OR_RETURN(auto dispatch_ordinal, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto export_ordinal, reader.ReadUint16_t());
-    auto& executable_table =
-        stack->current_frame()->module().executable_table();
-    ASSIGN_OR_RETURN(
-        auto* multi_arch_executable_def,
-        executable_table.LookupMultiArchExecutable(dispatch_ordinal));
-    if (export_ordinal >= multi_arch_executable_def->entry_point_count()) {
-      return InvalidArgumentErrorBuilder(IREE_LOC)
-             << "Invalid executable export ordinal " << export_ordinal;
-    }
-    auto* executable_def = multi_arch_executable_def->executables()->Get(0);
-    hal::ExecutableSpec executable_spec;
-    executable_spec.format = executable_def->format();
-    executable_spec.executable_data = absl::Span<const uint8_t>(
-        executable_def->contents()->data(), executable_def->contents()->size());
-    auto executable_cache = placement.device->CreateExecutableCache();
-    ref_ptr<hal::Executable> executable;
-    for (auto* executable_def : *multi_arch_executable_def->executables()) {
-      if (!executable_cache->CanPrepareFormat(executable_def->format())) {
-        continue;
-      }
-      hal::ExecutableSpec executable_spec;
-      executable_spec.format = executable_def->format();
-      executable_spec.executable_data =
-          absl::Span<const uint8_t>(executable_def->contents()->data(),
-                                    executable_def->contents()->size());
-      ASSIGN_OR_RETURN(executable,
-                       executable_cache->PrepareExecutable(
-                           hal::ExecutableCachingMode::kDefault |
-                               hal::ExecutableCachingMode::kAliasProvidedData,
-                           executable_spec),
-                       _.LogError());
-      break;
-    }
-    if (!executable) {
-      return InvalidArgumentErrorBuilder(IREE_LOC)
-             << "No executable found for the current driver";
-    }
+    auto dispatch_ordinal = reader.ReadInt32();
+    auto export_ordinal = reader.ReadUint16_t();
+    ASSIGN_OR_RETURN(auto executable,
+                     LookupDispatchExecutable(stack, placement.device,
+                                              dispatch_ordinal, export_ordinal),
+                     _.LogError());
 
-    ASSIGN_OR_RETURN(int workload_x, reader.ReadInt32());
-    ASSIGN_OR_RETURN(int workload_y, reader.ReadInt32());
-    ASSIGN_OR_RETURN(int workload_z, reader.ReadInt32());
+    int workload_x = reader.ReadInt32();
+    int workload_y = reader.ReadInt32();
+    int workload_z = reader.ReadInt32();
 
     std::vector<hal::BufferBinding> bindings;
-    ASSIGN_OR_RETURN(int input_count, reader.ReadCount());
-    for (int i = 0; i < input_count; ++i) {
-      ASSIGN_OR_RETURN(auto* input_local, reader.ReadLocal());
-      bindings.push_back(hal::BufferBinding(
-          input_local->buffer->allowed_access() & hal::MemoryAccess::kAll,
-          *input_local));
-    }
-    ASSIGN_OR_RETURN(int output_count, reader.ReadCount());
-    for (int i = 0; i < output_count; ++i) {
-      ASSIGN_OR_RETURN(auto* output_local, reader.ReadLocal());
-      bindings.push_back(
-          hal::BufferBinding(hal::MemoryAccess::kWrite, *output_local));
-    }
-    ASSIGN_OR_RETURN(int result_count, reader.ReadCount());
-    CHECK_EQ(0, result_count) << "Results not yet implemented";
+    ASSIGN_OR_RETURN(int input_count, ReadDispatchBindings(&reader, &bindings));
 
-    ASSIGN_OR_RETURN(
-        auto cmd,
-        placement.device->CreateCommandBuffer(
-            hal::CommandBufferMode::kOneShot,
-            hal::CommandCategory::kTransfer | hal::CommandCategory::kDispatch),
-        _.LogError());
-    RETURN_IF_ERROR(cmd->Begin());
     hal::DispatchRequest dispatch_request;
     dispatch_request.executable = executable.get();
     dispatch_request.entry_point = export_ordinal;
@@ -332,21 +532,25 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
     dispatch_request.workload[1] = workload_y;
     dispatch_request.workload[2] = workload_z;
     dispatch_request.bindings = bindings;
-    RETURN_IF_ERROR(cmd->Dispatch(dispatch_request));
-    RETURN_IF_ERROR(cmd->End());
-    auto* cmd_ptr = cmd.get();
-
-    auto* queue = placement.device->dispatch_queues().front();
-    hal::SubmissionBatch batch;
-    batch.command_buffers = absl::MakeConstSpan(&cmd_ptr, 1);
-    ASSIGN_OR_RETURN(auto fence, placement.device->CreateFence(0u));
-    RETURN_IF_ERROR(queue->Submit(batch, {fence.get(), 1u}));
-    RETURN_IF_ERROR(placement.device->WaitAllFences({{fence.get(), 1u}},
-                                                    absl::InfiniteFuture()));
+    RETURN_IF_ERROR(
+        batch.Dispatch(std::move(executable), dispatch_request, input_count));
   });
 
   DISPATCH_CORE_OPCODE(kAllocStatic, {
-    return UnimplementedErrorBuilder(IREE_LOC) << "Unimplemented alloc_static";
+    // Static allocations are planned by the compiler into an arena that is
+    // allocated on function entry; here we just carve out our range.
+    auto* arena_local = reader.ReadLocal();
+    auto offset = reader.ReadInt32();
+    ASSIGN_OR_RETURN(auto type, reader.ReadType());
+    auto shape_dims = reader.ReadIndexList();
+    auto* dst_local = reader.ReadLocal();
+    Shape shape(shape_dims);
+    size_t element_size = type.element_size();
+    dst_local->element_size = element_size;
+    dst_local->shape = shape;
+    ASSIGN_OR_RETURN(dst_local->buffer,
+                     Buffer::Subspan(arena_local->buffer, offset,
+                                     element_size * shape.element_count()));
   });
 
   DISPATCH_CORE_OPCODE(kAllocStack, {
@@ -359,7 +563,7 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   });
 
   DISPATCH_CORE_OPCODE(kAllocHeap, {
-    ASSIGN_OR_RETURN(auto heap_type, reader.ReadInt32());
+    auto heap_type = reader.ReadInt32();
     ASSIGN_OR_RETURN(auto type, reader.ReadType());
     size_t element_size = type.element_size();
 
@@ -368,7 +572,7 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
     ASSIGN_OR_RETURN(auto shape, reader.ReadShapePieces(&element_count));
     size_t allocation_size = element_size * element_count;
 
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     dst_local->element_size = element_size;
     dst_local->shape = shape;
 
@@ -384,17 +588,18 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
 
   DISPATCH_CORE_OPCODE(kDiscard, {
     // NOTE: if we were an encoder we would actually discard the buffer.
-    ASSIGN_OR_RETURN(auto* local, reader.ReadLocal());
+    auto* local = reader.ReadLocal();
     *local = {};
   });
 
   DISPATCH_CORE_OPCODE(kComputeRange, {
+    RETURN_IF_ERROR(batch.Flush());
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto element_size, reader.ReadUint8_t());
+    auto element_size = reader.ReadUint8_t();
     ASSIGN_OR_RETURN(auto indices, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_offset_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_length_local, reader.ReadLocal());
+    auto* dst_offset_local = reader.ReadLocal();
+    auto* dst_length_local = reader.ReadLocal();
 
     Shape shape(shape_data);
     ASSIGN_OR_RETURN(device_size_t dst_offset,
@@ -425,16 +630,18 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   });
 
   DISPATCH_CORE_OPCODE(kShape, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    RETURN_IF_ERROR(batch.Flush());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(
         0, src_local->shape.subspan().data(),
         src_local->shape.subspan().size() * sizeof(int32_t)));
   });
 
   DISPATCH_CORE_OPCODE(kLength, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    RETURN_IF_ERROR(batch.Flush());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     int32_t length = src_local->shape.element_count();
     RETURN_IF_ERROR(dst_local->buffer->WriteData(0, &length, sizeof(int32_t)));
   });
@@ -445,12 +652,13 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   });
 
   DISPATCH_CORE_OPCODE(kStaticSlice, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto offset, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto length, reader.ReadInt32());
+    RETURN_IF_ERROR(batch.Flush());
+    auto* src_local = reader.ReadLocal();
+    auto offset = reader.ReadInt32();
+    auto length = reader.ReadInt32();
     ASSIGN_OR_RETURN(auto type, reader.ReadType());
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     Shape new_shape = Shape{shape_data};
     if (new_shape.element_count() * type.element_size() != length) {
       return InvalidArgumentErrorBuilder(IREE_LOC)
@@ -465,9 +673,10 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
 
   DISPATCH_CORE_OPCODE(kDynamicCopy, {
     // TODO(b/139299169): implement indirect copies to avoid CPU readback.
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    RETURN_IF_ERROR(batch.Flush());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto src_offset_span, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto dst_offset_span, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto length_span, reader.ReadSlotElements<int32_t>());
     RETURN_IF_ERROR(dst_local->buffer->CopyData(
@@ -476,13 +685,13 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   });
 
   DISPATCH_CORE_OPCODE(kStaticCopy, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto src_offset, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_offset, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto length, reader.ReadInt32());
-    RETURN_IF_ERROR(dst_local->buffer->CopyData(
-        dst_offset, src_local->buffer.get(), src_offset, length));
+    auto* src_local = reader.ReadLocal();
+    auto src_offset = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
+    auto dst_offset = reader.ReadInt32();
+    auto length = reader.ReadInt32();
+    RETURN_IF_ERROR(batch.Copy(src_local->buffer.get(), src_offset,
+                               dst_local->buffer.get(), dst_offset, length));
   });
 
   DISPATCH_CORE_OPCODE(kDynamicFill, {
@@ -491,44 +700,49 @@ Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
   });
 
   DISPATCH_CORE_OPCODE(kStaticFill, {
-    ASSIGN_OR_RETURN(auto value, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto dst_offset, reader.ReadInt32());
-    ASSIGN_OR_RETURN(auto length, reader.ReadInt32());
-    RETURN_IF_ERROR(dst_local->buffer->Fill32(dst_offset, length, value));
+    auto value = reader.ReadInt32();
+    auto* dst_local = reader.ReadLocal();
+    auto dst_offset = reader.ReadInt32();
+    auto length = reader.ReadInt32();
+    RETURN_IF_ERROR(
+        batch.Fill(dst_local->buffer.get(), dst_offset, length, value));
   });
 
   DISPATCH_CORE_OPCODE(kClone, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     dst_local->element_size = src_local->element_size;
     dst_local->shape = src_local->shape;
     ASSIGN_OR_RETURN(dst_local->buffer, placement.device->allocator()->Allocate(
                                             src_local->buffer->memory_type(),
                                             src_local->buffer->usage(),
                                             src_local->buffer->byte_length()));
-    RETURN_IF_ERROR(dst_local->buffer->CopyData(0, src_local->buffer.get()));
+    RETURN_IF_ERROR(batch.Copy(src_local->buffer.get(), 0,
+                               dst_local->buffer.get(), 0,
+                               src_local->buffer->byte_length()));
   });
 
   DISPATCH_CORE_OPCODE(kAssign, {
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* src_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
     *dst_local = *src_local;
   });
 
   DISPATCH_CORE_OPCODE(kCondAssign, {
-    ASSIGN_OR_RETURN(auto* cond_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* cond_local = reader.ReadLocal();
+    auto* lhs_local = reader.ReadLocal();
+    auto* rhs_local = reader.ReadLocal();
+    auto* dst_local = reader.ReadLocal();
+    RETURN_IF_ERROR(batch.Flush());
     *dst_local = BufferViewIsTrue(*cond_local) ? *lhs_local : *rhs_local;
   });
 
   DISPATCH_CORE_OPCODE(kReshape, {
     // TODO(benvanik): more logic required if strides differ.
-    ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
+    RETURN_IF_ERROR(batch.Flush());
+    auto* src_local = reader.ReadLocal();
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
-    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    auto* dst_local = reader.ReadLocal();
     Shape new_shape = Shape{shape_data};
     if (src_local->shape.element_count() != new_shape.element_count()) {
       return InvalidArgumentErrorBuilder(IREE_LOC)
@@ -15,17 +15,137 @@
 #ifndef IREE_VM_SEQUENCER_DISPATCH_H_
 #define IREE_VM_SEQUENCER_DISPATCH_H_
 
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "iree/base/ref_ptr.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/command_buffer.h"
 #include "iree/hal/device_placement.h"
+#include "iree/hal/executable.h"
+#include "iree/hal/fence.h"
 #include "iree/vm/stack.h"
 #include "iree/vm/stack_frame.h"
 
 namespace iree {
 namespace vm {
 
+// Controls how device work issued by the sequencer is submitted.
+enum class SequencerMode {
+  // Each dispatch is submitted and waited on before the next op is executed.
+  // Transfers are performed on the host. Useful when debugging.
+  kSynchronous,
+  // Consecutive dispatch, copy, and fill ops are recorded into a single command
+  // buffer with barriers between dependent commands. The command buffer is
+  // submitted (and waited on) only when the host needs to observe buffer
+  // contents, such as for a conditional branch, a native call, or a return.
+  kBatched,
+};
+
+// Records device work issued by the sequencer into a single one-shot command
+// buffer that is only submitted when the host needs to observe the results.
+// Barriers are inserted between commands only when they touch overlapping byte
+// ranges of the same allocation in a conflicting way (RAW, WAR, WAW) such that
+// independent dispatches - including those on disjoint subspans of a shared
+// arena - remain free to overlap.
+//
+// Command buffers do not retain the resources they reference and as such the
+// batch holds references to all buffers and executables until flushed.
+//
+// A batch may be shared by several sequences dispatched back-to-back (see
+// SequencerContext::InvokeBatch) so that their work is submitted together.
+class CommandBatch {
+ public:
+  CommandBatch(const hal::DevicePlacement& placement, SequencerMode mode);
+  ~CommandBatch();
+
+  const hal::DevicePlacement& placement() const { return placement_; }
+  SequencerMode mode() const { return mode_; }
+
+  // Records a dispatch. The first |input_count| bindings are read and the
+  // remaining bindings are written.
+  Status Dispatch(ref_ptr<hal::Executable> executable,
+                  const hal::DispatchRequest& dispatch_request,
+                  int input_count);
+
+  // Copies |length| bytes from |source_buffer| to |target_buffer|.
+  Status Copy(hal::Buffer* source_buffer, device_size_t source_offset,
+              hal::Buffer* target_buffer, device_size_t target_offset,
+              device_size_t length);
+
+  // Fills |length| bytes of |target_buffer| with the 4-byte |value|.
+  Status Fill(hal::Buffer* target_buffer, device_size_t target_offset,
+              device_size_t length, uint32_t value);
+
+  // Submits all recorded commands and waits for them to complete.
+  // Must be called before the host reads or writes any buffer that may be
+  // referenced by a pending command.
+  Status Flush();
+
+ private:
+  // Transfers are only recorded in batched mode and when the buffers support
+  // them; otherwise they are performed on the host.
+  bool CanRecordTransfer(hal::Buffer* buffer) const;
+
+  // A byte range of a buffer accessed by a command.
+  struct BufferRange {
+    hal::Buffer* buffer;
+    device_size_t offset;
+    device_size_t length;
+  };
+
+  // A byte range accessed by a recorded command, resolved to the underlying
+  // allocation such that subspans of the same allocation can be compared.
+  struct AllocationRange {
+    hal::Buffer* allocated_buffer;
+    device_size_t begin;
+    device_size_t end;
+  };
+
+  static AllocationRange ResolveRange(const BufferRange& range);
+  static bool Overlaps(absl::Span<const AllocationRange> ranges,
+                       const AllocationRange& range);
+
+  // Ensures a command buffer is recording and inserts a barrier if the command
+  // about to be recorded depends on any command already recorded.
+  Status PrepareCommand(absl::Span<const BufferRange> reads,
+                        absl::Span<const BufferRange> writes);
+
+  // Completes recording of a command; in synchronous mode this submits it.
+  Status FinishCommand();
+
+  const hal::DevicePlacement& placement_;
+  SequencerMode mode_;
+
+  ref_ptr<hal::CommandBuffer> command_buffer_;
+  ref_ptr<hal::Fence> fence_;
+  uint64_t fence_value_ = 0;
+
+  // Allocation ranges accessed by commands since the last barrier.
+  std::vector<AllocationRange> pending_reads_;
+  std::vector<AllocationRange> pending_writes_;
+
+  // Resources referenced by the recorded commands.
+  std::vector<ref_ptr<hal::Buffer>> buffers_;
+  std::vector<ref_ptr<hal::Executable>> executables_;
+};
+
+// Runs the sequence starting at |entry_stack_frame| and waits for all of its
+// device work to complete before returning.
 // TODO(benvanik): API that supports yielding.
 Status DispatchSequence(const hal::DevicePlacement& placement, Stack* stack,
+                        StackFrame* entry_stack_frame,
+                        absl::Span<hal::BufferView> entry_results,
+                        SequencerMode mode = SequencerMode::kBatched);
+
+// Runs the sequence starting at |entry_stack_frame|, recording device work into
+// |batch|. Work that the host does not need to observe during the sequence may
+// still be pending on return and |batch| must be flushed before the contents of
+// |entry_results| are accessed.
+Status DispatchSequence(CommandBatch* batch, Stack* stack,
                         StackFrame* entry_stack_frame,
                         absl::Span<hal::BufferView> entry_results);
 
@@ -0,0 +1,175 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/sequencer_dispatch.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/command_buffer.h"
+#include "iree/hal/command_queue.h"
+#include "iree/hal/executable.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/testing/mock_command_buffer.h"
+#include "iree/hal/testing/mock_device.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::iree::hal::testing::MockCommandBuffer;
+using ::iree::hal::testing::MockDevice;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class TestExecutable final : public hal::Executable {
+ public:
+  bool supports_debugging() const override { return false; }
+};
+
+class CommandBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    device_ = std::make_shared<MockDevice>(
+        hal::DeviceInfo("mock", hal::DeviceFeature::kNone));
+    placement_.device = device_;
+    EXPECT_CALL(*device_, dispatch_queues())
+        .WillRepeatedly(Return(absl::MakeSpan(queues_)));
+    command_buffer_ = make_ref<MockCommandBuffer>(
+        nullptr, hal::CommandBufferMode::kOneShot,
+        hal::CommandCategory::kTransfer | hal::CommandCategory::kDispatch);
+    EXPECT_CALL(*device_, CreateCommandBuffer(_, _))
+        .WillOnce(Invoke([this](hal::CommandBufferModeBitfield mode,
+                                hal::CommandCategoryBitfield categories)
+                             -> StatusOr<ref_ptr<hal::CommandBuffer>> {
+          return ref_ptr<hal::CommandBuffer>(add_ref(command_buffer_));
+        }));
+    EXPECT_CALL(*command_buffer_, Begin()).WillOnce(Return(OkStatus()));
+
+    // All buffers are suballocated from a single arena as is done for
+    // statically planned allocations.
+    arena_ = hal::HeapBuffer::Allocate(hal::BufferUsage::kAll,
+                                       4 * kSubspanSize);
+  }
+
+  static constexpr device_size_t kSubspanSize = 16;
+
+  ref_ptr<hal::Buffer> Subspan(int index) {
+    return hal::Buffer::Subspan(arena_, index * kSubspanSize, kSubspanSize)
+        .ValueOrDie();
+  }
+
+  Status Dispatch(CommandBatch* batch, hal::Buffer* input,
+                  hal::Buffer* output) {
+    auto executable = make_ref<TestExecutable>();
+    std::vector<hal::BufferBinding> bindings = {
+        {hal::MemoryAccess::kRead, input},
+        {hal::MemoryAccess::kDiscardWrite, output},
+    };
+    hal::DispatchRequest dispatch_request;
+    dispatch_request.executable = executable.get();
+    dispatch_request.workload = {1, 1, 1};
+    dispatch_request.bindings = bindings;
+    return batch->Dispatch(std::move(executable), dispatch_request,
+                           /*input_count=*/1);
+  }
+
+  std::shared_ptr<MockDevice> device_;
+  std::vector<hal::CommandQueue*> queues_ = {nullptr};
+  hal::DevicePlacement placement_;
+  ref_ptr<MockCommandBuffer> command_buffer_;
+  ref_ptr<hal::Buffer> arena_;
+};
+
+TEST_F(CommandBatchTest, DisjointSubspansHaveNoBarrier) {
+  CommandBatch batch(placement_, SequencerMode::kBatched);
+  auto buffer_0 = Subspan(0);
+  auto buffer_1 = Subspan(1);
+  auto buffer_2 = Subspan(2);
+  auto buffer_3 = Subspan(3);
+  EXPECT_CALL(*command_buffer_, Dispatch(_))
+      .Times(2)
+      .WillRepeatedly(Return(OkStatus()));
+  EXPECT_CALL(*command_buffer_, ExecutionBarrier(_, _, _, _)).Times(0);
+  EXPECT_OK(Dispatch(&batch, buffer_0.get(), buffer_1.get()));
+  EXPECT_OK(Dispatch(&batch, buffer_2.get(), buffer_3.get()));
+}
+
+TEST_F(CommandBatchTest, ReadAfterWriteHasBarrier) {
+  CommandBatch batch(placement_, SequencerMode::kBatched);
+  auto buffer_0 = Subspan(0);
+  auto buffer_1 = Subspan(1);
+  auto buffer_2 = Subspan(2);
+  EXPECT_CALL(*command_buffer_, Dispatch(_))
+      .Times(2)
+      .WillRepeatedly(Return(OkStatus()));
+  EXPECT_CALL(*command_buffer_, ExecutionBarrier(_, _, _, _))
+      .WillOnce(Return(OkStatus()));
+  EXPECT_OK(Dispatch(&batch, buffer_0.get(), buffer_1.get()));
+  EXPECT_OK(Dispatch(&batch, buffer_1.get(), buffer_2.get()));
+}
+
+TEST_F(CommandBatchTest, WriteAfterReadHasBarrier) {
+  CommandBatch batch(placement_, SequencerMode::kBatched);
+  auto buffer_0 = Subspan(0);
+  auto buffer_1 = Subspan(1);
+  auto buffer_2 = Subspan(2);
+  EXPECT_CALL(*command_buffer_, Dispatch(_))
+      .Times(2)
+      .WillRepeatedly(Return(OkStatus()));
+  EXPECT_CALL(*command_buffer_, ExecutionBarrier(_, _, _, _))
+      .WillOnce(Return(OkStatus()));
+  EXPECT_OK(Dispatch(&batch, buffer_0.get(), buffer_1.get()));
+  EXPECT_OK(Dispatch(&batch, buffer_2.get(), buffer_0.get()));
+}
+
+TEST_F(CommandBatchTest, PartiallyOverlappingFillsHaveBarrier) {
+  CommandBatch batch(placement_, SequencerMode::kBatched);
+  EXPECT_CALL(*command_buffer_, FillBuffer(_, _, _, _, _))
+      .Times(3)
+      .WillRepeatedly(Return(OkStatus()));
+  EXPECT_CALL(*command_buffer_, ExecutionBarrier(_, _, _, _))
+      .WillOnce(Return(OkStatus()));
+  // Disjoint ranges of the same allocation.
+  EXPECT_OK(batch.Fill(arena_.get(), 0, 8, 0u));
+  EXPECT_OK(batch.Fill(arena_.get(), 8, 8, 0u));
+  // Overlaps the tail of the second fill.
+  EXPECT_OK(batch.Fill(arena_.get(), 12, 8, 0u));
+}
+
+TEST(CommandBatchPlacementTest, OutOfRangeQueue) {
+  auto device = std::make_shared<MockDevice>(
+      hal::DeviceInfo("mock", hal::DeviceFeature::kNone));
+  std::vector<hal::CommandQueue*> queues = {nullptr};
+  EXPECT_CALL(*device, dispatch_queues())
+      .WillRepeatedly(Return(absl::MakeSpan(queues)));
+  hal::DevicePlacement placement;
+  placement.device = device;
+  placement.queue_id = 1;
+  CommandBatch batch(placement, SequencerMode::kBatched);
+  auto buffer = hal::HeapBuffer::Allocate(hal::BufferUsage::kAll, 16);
+  // No command buffer is created for a placement that cannot be submitted.
+  EXPECT_TRUE(IsOutOfRange(batch.Fill(buffer.get(), 0, 16, 0u)));
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
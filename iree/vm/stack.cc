@@ -14,7 +14,7 @@
 
 #include "iree/vm/stack.h"
 
-#include <iterator>
+#include <algorithm>
 
 #include "absl/strings/str_join.h"
 #include "iree/base/status.h"
@@ -28,28 +28,72 @@ Stack::Stack() = default;
 
 Stack::~Stack() = default;
 
-StatusOr<StackFrame*> Stack::PushFrame(Function function) {
+StatusOr<int> Stack::ReserveFrame() {
   if (stack_depth_ + 1 > kMaxStackDepth) {
     return InternalErrorBuilder(IREE_LOC)
            << "Max stack depth of " << kMaxStackDepth << " exceeded";
   }
-  stack_[stack_depth_++] = StackFrame(function);
+  if (stack_depth_ == frames_.size()) {
+    frames_.emplace_back();
+    frame_slots_.emplace_back();
+  }
+  return stack_depth_++;
+}
+
+absl::Span<hal::BufferView> Stack::AllocateSlots(int count) {
+  // Advance to the first block (at or after the current one) with enough free
+  // slots. Blocks after the current one are empty as frames are popped in LIFO
+  // order, so any that are too small can be replaced without moving live
+  // slots.
+  while (slot_block_index_ < slot_blocks_.size()) {
+    auto& block = slot_blocks_[slot_block_index_];
+    if (block.capacity - block.used >= count) break;
+    if (block.used == 0) {
+      block.slots.reset();
+      block.capacity = 0;
+      break;
+    }
+    ++slot_block_index_;
+  }
+  if (slot_block_index_ == slot_blocks_.size()) {
+    slot_blocks_.emplace_back();
+  }
+  auto& block = slot_blocks_[slot_block_index_];
+  if (!block.slots) {
+    // Blocks after the first grow geometrically to amortize deep call chains.
+    int min_capacity = slot_block_index_ > 0
+                           ? slot_blocks_[slot_block_index_ - 1].capacity * 2
+                           : 0;
+    block.capacity = std::max(count, min_capacity);
+    block.slots.reset(new hal::BufferView[block.capacity]);
+  }
+
+  auto& slot_range = frame_slots_[stack_depth_ - 1];
+  slot_range.block_index = slot_block_index_;
+  slot_range.offset = block.used;
+  slot_range.count = count;
+  block.used += count;
+  return absl::MakeSpan(block.slots.get() + slot_range.offset, count);
+}
+
+StatusOr<StackFrame*> Stack::PushFrame(Function function) {
+  ASSIGN_OR_RETURN(int frame_index, ReserveFrame());
+  frames_[frame_index] = StackFrame(
+      function, AllocateSlots(StackFrame::RequiredLocalCount(function)));
 
   // TODO(benvanik): WTF scope enter.
 
-  return current_frame();
+  return &frames_[frame_index];
 }
 
 StatusOr<StackFrame*> Stack::PushFrame(const ImportFunction& function) {
-  if (stack_depth_ + 1 > kMaxStackDepth) {
-    return InternalErrorBuilder(IREE_LOC)
-           << "Max stack depth of " << kMaxStackDepth << " exceeded";
-  }
-  stack_[stack_depth_++] = StackFrame(function);
+  ASSIGN_OR_RETURN(int frame_index, ReserveFrame());
+  frames_[frame_index] = StackFrame(
+      function, AllocateSlots(StackFrame::RequiredLocalCount(function)));
 
   // TODO(benvanik): WTF scope enter.
 
-  return current_frame();
+  return &frames_[frame_index];
 }
 
 Status Stack::PopFrame() {
@@ -59,6 +103,14 @@ Status Stack::PopFrame() {
 
   // TODO(benvanik): WTF scope leave.
 
+  // Reset locals so that buffers are released as soon as the frame returns.
+  for (auto& local : frames_[stack_depth_ - 1].mutable_locals()) {
+    local = {};
+  }
+  const auto& slot_range = frame_slots_[stack_depth_ - 1];
+  slot_block_index_ = slot_range.block_index;
+  slot_blocks_[slot_block_index_].used = slot_range.offset;
+
   --stack_depth_;
   return OkStatus();
 }
@@ -74,8 +126,8 @@ struct StackFrameFormatter {
 }  // namespace
 
 std::string Stack::DebugString() const {
-  return absl::StrJoin(std::begin(stack_), std::begin(stack_) + stack_depth_,
-                       "\n", StackFrameFormatter());
+  return absl::StrJoin(frames_.begin(), frames_.begin() + stack_depth_, "\n",
+                       StackFrameFormatter());
 }
 
 }  // namespace vm
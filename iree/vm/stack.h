@@ -15,10 +15,15 @@
 #ifndef IREE_VM_STACK_H_
 #define IREE_VM_STACK_H_
 
+#include <deque>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/vm/function.h"
 #include "iree/vm/stack_frame.h"
 
 namespace iree {
@@ -26,45 +31,76 @@ namespace vm {
 
 // VM call stack.
 //
+// The stack owns the local slots of all frames, allocated from a growable
+// arena of slot blocks. Pushing a frame carves its slots out of the current
+// block and popping it releases them in LIFO order, so steady-state calls
+// perform no heap allocations. The first block is sized to the first frame
+// pushed such that short-lived stacks (such as those used for a single
+// dispatch) only allocate the slots they use. Frames and their slots never move once pushed:
+// pointers to frames and locals remain valid until the frame is popped.
+//
 // Stacks are thread-compatible.
 class Stack {
  public:
-  static constexpr int kMaxStackDepth = 32;
+  // Maximum call depth, used to detect runaway recursion.
+  static constexpr int kMaxStackDepth = 4096;
 
   Stack();
   Stack(const Stack&) = delete;
   Stack& operator=(const Stack&) = delete;
   ~Stack();
 
-  absl::Span<const StackFrame> frames() const {
-    return absl::MakeConstSpan(stack_, stack_depth_);
-  }
-  absl::Span<StackFrame> mutable_frames() {
-    return absl::MakeSpan(stack_, stack_depth_);
-  }
+  int depth() const { return stack_depth_; }
+  const StackFrame& frame(int index) const { return frames_[index]; }
+  StackFrame* mutable_frame(int index) { return &frames_[index]; }
 
   StackFrame* current_frame() {
-    return stack_depth_ > 0 ? &stack_[stack_depth_ - 1] : nullptr;
+    return stack_depth_ > 0 ? &frames_[stack_depth_ - 1] : nullptr;
   }
   const StackFrame* current_frame() const {
-    return stack_depth_ > 0 ? &stack_[stack_depth_ - 1] : nullptr;
+    return stack_depth_ > 0 ? &frames_[stack_depth_ - 1] : nullptr;
   }
   StackFrame* caller_frame() {
-    return stack_depth_ > 1 ? &stack_[stack_depth_ - 2] : nullptr;
+    return stack_depth_ > 1 ? &frames_[stack_depth_ - 2] : nullptr;
   }
   const StackFrame* caller_frame() const {
-    return stack_depth_ > 1 ? &stack_[stack_depth_ - 2] : nullptr;
+    return stack_depth_ > 1 ? &frames_[stack_depth_ - 2] : nullptr;
   }
 
   StatusOr<StackFrame*> PushFrame(Function function);
   StatusOr<StackFrame*> PushFrame(const ImportFunction& function);
+
+  // Pops the current frame and resets its locals, releasing any buffers they
+  // reference.
   Status PopFrame();
 
   std::string DebugString() const;
 
  private:
-  StackFrame stack_[kMaxStackDepth];
+  struct SlotBlock {
+    std::unique_ptr<hal::BufferView[]> slots;
+    int capacity = 0;
+    int used = 0;
+  };
+
+  // Location of a frame's slots within the slot arena.
+  struct SlotRange {
+    int block_index = 0;
+    int offset = 0;
+    int count = 0;
+  };
+
+  StatusOr<int> ReserveFrame();
+  absl::Span<hal::BufferView> AllocateSlots(int count);
+
+  // Frames are reused across pushes; only the first |stack_depth_| are live.
+  // std::deque is used so that growing the stack does not move live frames.
+  std::deque<StackFrame> frames_;
+  std::vector<SlotRange> frame_slots_;
   int stack_depth_ = 0;
+
+  std::vector<SlotBlock> slot_blocks_;
+  int slot_block_index_ = 0;
 };
 
 }  // namespace vm
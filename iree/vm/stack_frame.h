@@ -15,8 +15,6 @@
 #ifndef IREE_VM_STACK_FRAME_H_
 #define IREE_VM_STACK_FRAME_H_
 
-#include <vector>
-
 #include "absl/types/span.h"
 #include "iree/hal/buffer_view.h"
 #include "iree/vm/function.h"
@@ -25,18 +23,27 @@
 namespace iree {
 namespace vm {
 
+class DecodedFunction;
+
 // A single frame on the call stack containing current execution state and
 // local values.
 //
+// Local values are stored in slots owned by the Stack and the frame is only a
+// view into them; the slots remain valid until the frame is popped.
+//
 // StackFrames are designed to be serialized so that suspend and resume is
 // possible. This means that most state is stored either entirely within the
 // frame or references to non-pointer values (such as other function indices).
 // BufferViews require special care to allow rendezvous and liveness tracking.
 class StackFrame {
  public:
+  // Returns the number of local slots required by frames of |function|.
+  static int RequiredLocalCount(const Function& function);
+
   StackFrame() = default;
-  explicit StackFrame(Function function);
-  explicit StackFrame(const ImportFunction& function);
+  StackFrame(Function function, absl::Span<hal::BufferView> locals);
+  StackFrame(const ImportFunction& function,
+             absl::Span<hal::BufferView> locals);
   StackFrame(const StackFrame&) = delete;
   StackFrame& operator=(const StackFrame&) = delete;
   StackFrame(StackFrame&&) = default;
@@ -54,21 +61,31 @@ class StackFrame {
     return &locals_[ordinal];
   }
 
-  inline absl::Span<const hal::BufferView> locals() const {
-    return absl::MakeConstSpan(locals_);
+  inline absl::Span<const hal::BufferView> locals() const { return locals_; }
+  inline absl::Span<hal::BufferView> mutable_locals() { return locals_; }
+
+  // Prepared state of the function and its ordinal within the module function
+  // table. Set by the BytecodeReader when it first enters the frame such that
+  // resuming the frame after a call does not need to look them up again.
+  inline const DecodedFunction* decoded_function() const {
+    return decoded_function_;
   }
-  inline absl::Span<hal::BufferView> mutable_locals() {
-    return absl::MakeSpan(locals_);
+  inline int function_ordinal() const { return function_ordinal_; }
+  inline void set_decoded_function(const DecodedFunction* decoded_function,
+                                   int function_ordinal) {
+    decoded_function_ = decoded_function;
+    function_ordinal_ = function_ordinal;
   }
 
  private:
   Function function_;
-  const ImportFunction* import_function_;
+  const ImportFunction* import_function_ = nullptr;
   int offset_ = 0;
   int offset_limit_ = 0;
+  const DecodedFunction* decoded_function_ = nullptr;
+  int function_ordinal_ = -1;
 
-  // TODO(benvanik): replace with a placed allocation.
-  std::vector<hal::BufferView> locals_;
+  absl::Span<hal::BufferView> locals_;
 };
 
 }  // namespace vm
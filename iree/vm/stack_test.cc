@@ -0,0 +1,160 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/stack.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/schemas/bytecode/sequencer_bytecode_v0.h"
+#include "iree/vm/module.h"
+#include "iree/vm/testing/test_module.h"
+
+namespace iree {
+namespace vm {
+namespace {
+
+using ::iree::vm::testing::BuildTestModule;
+using ::iree::vm::testing::BytecodeBuilder;
+using ::iree::vm::testing::TestFunction;
+
+class StackTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto bytecode =
+        BytecodeBuilder().Opcode(SequencerOpcode::kReturn).Locals({});
+    std::vector<TestFunction> functions = {
+        {"small", 0, 0, /*local_count=*/2, bytecode.bytecode()},
+        {"large", 0, 0, /*local_count=*/300, bytecode.bytecode()},
+    };
+    ASSERT_OK_AND_ASSIGN(module_, BuildTestModule(functions));
+    ASSERT_OK_AND_ASSIGN(small_function_,
+                         module_->function_table().LookupFunction(0));
+    ASSERT_OK_AND_ASSIGN(large_function_,
+                         module_->function_table().LookupFunction(1));
+  }
+
+  // Returns true if the locals of |a| and |b| share any slots.
+  static bool LocalsOverlap(const StackFrame& a, const StackFrame& b) {
+    const auto* a_begin = a.locals().data();
+    const auto* b_begin = b.locals().data();
+    return a_begin < b_begin + b.locals().size() &&
+           b_begin < a_begin + a.locals().size();
+  }
+
+  std::unique_ptr<Module> module_;
+  Function small_function_;
+  Function large_function_;
+};
+
+TEST_F(StackTest, Empty) {
+  Stack stack;
+  EXPECT_EQ(0, stack.depth());
+  EXPECT_EQ(nullptr, stack.current_frame());
+  EXPECT_EQ(nullptr, stack.caller_frame());
+}
+
+TEST_F(StackTest, PushPop) {
+  Stack stack;
+  ASSERT_OK_AND_ASSIGN(auto* frame_0, stack.PushFrame(small_function_));
+  EXPECT_EQ(1, stack.depth());
+  EXPECT_EQ(frame_0, stack.current_frame());
+  EXPECT_EQ(nullptr, stack.caller_frame());
+  EXPECT_EQ(2, frame_0->locals().size());
+
+  ASSERT_OK_AND_ASSIGN(auto* frame_1, stack.PushFrame(large_function_));
+  EXPECT_EQ(2, stack.depth());
+  EXPECT_EQ(frame_1, stack.current_frame());
+  EXPECT_EQ(frame_0, stack.caller_frame());
+  EXPECT_EQ(300, frame_1->locals().size());
+  EXPECT_FALSE(LocalsOverlap(*frame_0, *frame_1));
+
+  EXPECT_OK(stack.PopFrame());
+  EXPECT_EQ(1, stack.depth());
+  EXPECT_EQ(frame_0, stack.current_frame());
+  EXPECT_OK(stack.PopFrame());
+  EXPECT_EQ(0, stack.depth());
+}
+
+TEST_F(StackTest, UnbalancedPop) {
+  Stack stack;
+  EXPECT_TRUE(IsInternal(stack.PopFrame()));
+  ASSERT_OK(stack.PushFrame(small_function_).status());
+  EXPECT_OK(stack.PopFrame());
+  EXPECT_TRUE(IsInternal(stack.PopFrame()));
+}
+
+TEST_F(StackTest, MaxStackDepth) {
+  Stack stack;
+  for (int i = 0; i < Stack::kMaxStackDepth; ++i) {
+    ASSERT_OK(stack.PushFrame(small_function_).status());
+  }
+  EXPECT_EQ(Stack::kMaxStackDepth, stack.depth());
+  EXPECT_TRUE(IsInternal(stack.PushFrame(small_function_).status()));
+  EXPECT_EQ(Stack::kMaxStackDepth, stack.depth());
+
+  // The stack remains usable once unwound.
+  for (int i = 0; i < Stack::kMaxStackDepth; ++i) {
+    ASSERT_OK(stack.PopFrame());
+  }
+  EXPECT_OK(stack.PushFrame(small_function_).status());
+}
+
+TEST_F(StackTest, FramesDoNotMove) {
+  Stack stack;
+  ASSERT_OK_AND_ASSIGN(auto* frame_0, stack.PushFrame(small_function_));
+  auto* locals_0 = frame_0->locals().data();
+  // Grow both the frame list and the slot arena.
+  for (int i = 0; i < 64; ++i) {
+    ASSERT_OK(stack.PushFrame(i % 2 ? large_function_ : small_function_)
+                  .status());
+  }
+  EXPECT_EQ(frame_0, stack.mutable_frame(0));
+  EXPECT_EQ(locals_0, frame_0->locals().data());
+  EXPECT_EQ(2, frame_0->locals().size());
+}
+
+TEST_F(StackTest, SlotsReusedAfterPop) {
+  Stack stack;
+  ASSERT_OK_AND_ASSIGN(auto* frame_0, stack.PushFrame(small_function_));
+  ASSERT_OK_AND_ASSIGN(auto* frame_1, stack.PushFrame(large_function_));
+  auto* locals_1 = frame_1->locals().data();
+  ASSERT_OK(stack.PopFrame());
+  ASSERT_OK_AND_ASSIGN(frame_1, stack.PushFrame(large_function_));
+  EXPECT_EQ(locals_1, frame_1->locals().data());
+  EXPECT_FALSE(LocalsOverlap(*frame_0, *frame_1));
+}
+
+TEST_F(StackTest, PopReleasesLocals) {
+  Stack stack;
+  ASSERT_OK_AND_ASSIGN(auto* frame, stack.PushFrame(small_function_));
+  *frame->mutable_local(1) = hal::BufferView(
+      hal::HeapBuffer::Allocate(hal::BufferUsage::kAll, 4), {1}, 4);
+  ASSERT_OK(stack.PopFrame());
+
+  ASSERT_OK_AND_ASSIGN(frame, stack.PushFrame(small_function_));
+  for (const auto& local : frame->locals()) {
+    EXPECT_EQ(nullptr, local.buffer);
+  }
+}
+
+}  // namespace
+}  // namespace vm
+}  // namespace iree
@@ -0,0 +1,80 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/vm/testing/test_module.h"
+
+#include "flatbuffers/flatbuffers.h"
+#include "iree/schemas/module_def_generated.h"
+
+namespace iree {
+namespace vm {
+namespace testing {
+
+namespace {
+
+::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<TypeDef>>>
+BuildMemRefTypes(::flatbuffers::FlatBufferBuilder* fbb, int count) {
+  std::vector<::flatbuffers::Offset<TypeDef>> types;
+  for (int i = 0; i < count; ++i) {
+    auto element_type = CreateElementTypeDef(
+        *fbb, ElementTypeDefUnion::FloatTypeDef,
+        CreateFloatTypeDef(*fbb, /*width=*/32).Union());
+    auto memref_type =
+        CreateMemRefTypeDef(*fbb, element_type, fbb->CreateVector<int>({-1}));
+    types.push_back(
+        CreateTypeDef(*fbb, TypeDefUnion::MemRefTypeDef, memref_type.Union()));
+  }
+  return fbb->CreateVector(types);
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<Module>> BuildTestModule(
+    absl::Span<const TestFunction> functions) {
+  ::flatbuffers::FlatBufferBuilder fbb;
+  std::vector<::flatbuffers::Offset<FunctionDef>> function_defs;
+  std::vector<int> exports;
+  for (const auto& function : functions) {
+    auto function_type = CreateFunctionTypeDef(
+        fbb, BuildMemRefTypes(&fbb, function.input_count),
+        BuildMemRefTypes(&fbb, function.result_count));
+    std::vector<int8_t> contents(function.bytecode.begin(),
+                                 function.bytecode.end());
+    auto bytecode_def = CreateBytecodeDef(fbb, function.local_count,
+                                          fbb.CreateVector(contents));
+    exports.push_back(function_defs.size());
+    function_defs.push_back(CreateFunctionDef(fbb,
+                                              fbb.CreateString(function.name),
+                                              function_type, 0, bytecode_def));
+  }
+  auto function_table =
+      CreateFunctionTableDef(fbb, fbb.CreateVector(function_defs), 0,
+                             fbb.CreateVector(exports));
+  auto executable_table = CreateExecutableTableDef(fbb);
+  auto module_def = CreateModuleDef(fbb, fbb.CreateString("test"), 0,
+                                    function_table, executable_table);
+  FinishModuleDefBuffer(fbb, module_def);
+
+  ASSIGN_OR_RETURN(
+      auto module_file,
+      ModuleFile::FromString(
+          ModuleDefIdentifier(),
+          std::string(reinterpret_cast<const char*>(fbb.GetBufferPointer()),
+                      fbb.GetSize())));
+  return Module::FromFile(std::move(module_file));
+}
+
+}  // namespace testing
+}  // namespace vm
+}  // namespace iree
@@ -0,0 +1,85 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_VM_TESTING_TEST_MODULE_H_
+#define IREE_VM_TESTING_TEST_MODULE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+#include "iree/vm/module.h"
+
+namespace iree {
+namespace vm {
+namespace testing {
+
+// Appends encoded bytecode operands for hand-written test functions.
+class BytecodeBuilder {
+ public:
+  BytecodeBuilder& Opcode(uint8_t opcode) { return Uint8(opcode); }
+  template <typename T>
+  BytecodeBuilder& Opcode(T opcode) {
+    return Uint8(static_cast<uint8_t>(opcode));
+  }
+
+  BytecodeBuilder& Uint8(uint8_t value) {
+    bytecode_.push_back(value);
+    return *this;
+  }
+  BytecodeBuilder& Uint16(uint16_t value) {
+    bytecode_.push_back(value & 0xFF);
+    bytecode_.push_back(value >> 8);
+    return *this;
+  }
+  BytecodeBuilder& Uint32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) bytecode_.push_back((value >> (i * 8)) & 0xFF);
+    return *this;
+  }
+
+  // Appends a count-prefixed list of local ordinals.
+  BytecodeBuilder& Locals(std::vector<uint16_t> ordinals) {
+    Uint8(ordinals.size());
+    for (uint16_t ordinal : ordinals) Uint16(ordinal);
+    return *this;
+  }
+
+  int size() const { return bytecode_.size(); }
+  const std::vector<uint8_t>& bytecode() const { return bytecode_; }
+
+ private:
+  std::vector<uint8_t> bytecode_;
+};
+
+// A bytecode function with memref<?xf32> inputs and results.
+struct TestFunction {
+  std::string name;
+  int input_count = 0;
+  int result_count = 0;
+  int local_count = 0;
+  std::vector<uint8_t> bytecode;
+};
+
+// Builds an in-memory module containing |functions| in order.
+// All functions are exported. The bytecode is not validated.
+StatusOr<std::unique_ptr<Module>> BuildTestModule(
+    absl::Span<const TestFunction> functions);
+
+}  // namespace testing
+}  // namespace vm
+}  // namespace iree
+
+#endif  // IREE_VM_TESTING_TEST_MODULE_H_
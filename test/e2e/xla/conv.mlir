@@ -0,0 +1,21 @@
+// RUN: iree-run-mlir --target_backends=interpreter-bytecode %s --input_values="1x3x3x1xf32=[1 2 3 4 5 6 7 8 9]" | FileCheck %s --dump-input=fail
+
+// CHECK-LABEL: EXEC @conv_valid
+func @conv_valid(%arg0: tensor<1x3x3x1xf32>) -> tensor<1x2x2x1xf32> {
+  %filter = constant dense<1.0> : tensor<2x2x1x1xf32>
+  %0 = "xla_hlo.conv"(%arg0, %filter) : (tensor<1x3x3x1xf32>, tensor<2x2x1x1xf32>) -> tensor<1x2x2x1xf32>
+  return %0 : tensor<1x2x2x1xf32>
+}
+// CHECK:      1x2x2x1xf32=[
+// CHECK-SAME: [12][16]
+// CHECK-SAME: [24][28]
+
+// CHECK-LABEL: EXEC @conv_strided_padded
+func @conv_strided_padded(%arg0: tensor<1x3x3x1xf32>) -> tensor<1x2x2x1xf32> {
+  %filter = constant dense<1.0> : tensor<2x2x1x1xf32>
+  %0 = "xla_hlo.conv"(%arg0, %filter) {window_strides = dense<2> : tensor<2xi64>, padding = dense<[[0, 1], [0, 1]]> : tensor<2x2xi64>} : (tensor<1x3x3x1xf32>, tensor<2x2x1x1xf32>) -> tensor<1x2x2x1xf32>
+  return %0 : tensor<1x2x2x1xf32>
+}
+// CHECK:      1x2x2x1xf32=[
+// CHECK-SAME: [12][9]
+// CHECK-SAME: [15][9]